@@ -0,0 +1,408 @@
+#! /usr/bin/env python3
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License version 2 as
+# published by the Free Software Foundation;
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#
+"""
+Parallel parameter sweep for the UAV scenarios.
+
+Every point of the grid (protocol x UAVs x server bandwidth x TCP cross
+traffic) is replicated over a range of RngRun values.  All replications share
+the same RngSeed, so each one draws from its own independent MRG32k3a
+substream.  Replications are executed in parallel (one simulation process per
+worker), every run gets its own working directory under OUTPUT/runs/ and the
+per run statistics are appended to OUTPUT/runs.jsonl as soon as a run is
+finished.  Re-running the same command resumes a partially completed sweep:
+runs already recorded in runs.jsonl are skipped, provided that they were run
+with the same seed, simulation time, pcap and warm-up settings.
+
+With --warmup the replications of all protocols that share the same
+scenario (UAVs x bandwidth x TCP) are run as forked variants of a single
+process: the common warm-up is simulated once, then every variant continues
+from that snapshot with its own protocol and RngRun (see
+ns3::WarmStartHelper).  The wall-clock time saved by skipping the repeated
+setups is reported at the end of the sweep.
+
+Examples:
+
+    ./fair-udp-sweep.py coap --protocols fdp cocoa --uavs 10 20 40 --runs 10
+    ./fair-udp-sweep.py wifi --protocols udp fdp --tcp on off --runs 5 -j 4
+    ./fair-udp-sweep.py coap --uavs 40 --runs 10 --warmup 5
+"""
+
+import argparse
+import concurrent.futures
+import csv
+import glob
+import itertools
+import json
+import math
+import os
+import re
+import statistics
+import subprocess
+import sys
+import time
+
+NS3_DIR = os.path.dirname(os.path.abspath(__file__))
+
+SCENARIOS = {
+    # CoAP + FDP/CoCoA over Wi-Fi (scratch/CoAP/example.cc --WhichTest=3)
+    "coap": {
+        "program": "scratch/CoAP/example.cc",
+        "protocols": ["fdp", "cocoa"],
+    },
+    # FDP/UDP over Wi-Fi (scratch/udp_application/example-wifi.cc)
+    "wifi": {
+        "program": "scratch/udp_application/example-wifi.cc",
+        "protocols": ["udp", "fdp"],
+    },
+}
+
+# two sided Student t quantiles, indexed by degrees of freedom (1..30)
+T_TABLE = {
+    0.90: [6.314, 2.920, 2.353, 2.132, 2.015, 1.943, 1.895, 1.860, 1.833, 1.812,
+           1.796, 1.782, 1.771, 1.761, 1.753, 1.746, 1.740, 1.734, 1.729, 1.725,
+           1.721, 1.717, 1.714, 1.711, 1.708, 1.706, 1.703, 1.701, 1.699, 1.697],
+    0.95: [12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+           2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+           2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042],
+    0.99: [63.657, 9.925, 5.841, 4.604, 4.032, 3.707, 3.499, 3.355, 3.250, 3.169,
+           3.106, 3.055, 3.012, 2.977, 2.947, 2.921, 2.898, 2.878, 2.861, 2.845,
+           2.831, 2.819, 2.807, 2.797, 2.787, 2.779, 2.771, 2.763, 2.756, 2.750],
+}
+
+
+def t_quantile(confidence, dof):
+    if dof <= len(T_TABLE[confidence]):
+        return T_TABLE[confidence][dof - 1]
+    return statistics.NormalDist().inv_cdf(0.5 + confidence / 2)
+
+
+class RunSpec:
+    """One replication of one grid point."""
+
+    def __init__(self, scenario, protocol, uavs, bandwidth, tcp, rng_run, args):
+        self.scenario = scenario
+        self.protocol = protocol
+        self.uavs = uavs
+        self.bandwidth = bandwidth
+        self.tcp = tcp
+        self.rng_run = rng_run
+        # settings shared by the whole sweep which still change the results
+        self.seed = args.seed
+        self.simul_time = args.simul_time
+        self.pcap = args.pcap
+        self.warmup = args.warmup
+
+    def point(self):
+        return {"protocol": self.protocol, "uavs": self.uavs,
+                "bandwidth": self.bandwidth, "tcp": self.tcp}
+
+    def point_key(self):
+        return "%s-uavs%d-bw%s-tcp%d" % (self.protocol, self.uavs, self.bandwidth, self.tcp)
+
+    def key(self):
+        """Every argument of the run: a recorded run is only reused if all of them match."""
+        return "%s-seed%d-t%gs-pcap%d-warmup%gs-run%d" % (self.point_key(), self.seed, self.simul_time,
+                                                        self.pcap, self.warmup, self.rng_run)
+
+    def scenario_key(self):
+        """Grid point without the protocol: what the forked variants share."""
+        return "uavs%d-bw%s-tcp%d" % (self.uavs, self.bandwidth, self.tcp)
+
+    def variant(self):
+        """Variant spec and directory name as understood by the programs."""
+        return "%s:%d" % (self.protocol, self.rng_run), "%s-run%d" % (self.protocol, self.rng_run)
+
+    def arguments(self, args, workdir):
+        if self.scenario == "coap":
+            program_args = ["--WhichTest=3",
+                            "--UseFDP=%d" % (self.protocol == "fdp"),
+                            "--SendTCP=%d" % self.tcp,
+                            "--NumUAVs=%d" % self.uavs,
+                            "--ServerBandwidth=%s" % self.bandwidth,
+                            "--SimulTime=%ss" % args.simul_time,
+                            "--Pcap=%d" % args.pcap]
+            # without capture the program keeps its own default file name
+            if args.pcap:
+                program_args.append("--PCAP_Name=%s" % os.path.join(workdir, "capture"))
+        else:
+            program_args = ["--protocol=%s" % self.protocol,
+                            "--tcp=%d" % self.tcp,
+                            "--uavs=%d" % self.uavs,
+                            "--server_bandwidth=%s" % self.bandwidth,
+                            "--simul_time=%d" % int(args.simul_time),
+                            "--pcap=%d" % args.pcap,
+                            "--summary=summary.csv"]
+        program_args += ["--RngSeed=%d" % args.seed, "--RngRun=%d" % self.rng_run]
+        return program_args
+
+    def fork_arguments(self, args, variants):
+        """Arguments of the warm-start process running all the given variants."""
+        program_args = self.arguments(args, "")
+        if self.scenario == "coap":
+            # forked variants cannot share one capture file
+            program_args = [a for a in program_args if not a.startswith(("--Pcap=", "--PCAP_Name="))]
+            program_args += ["--Pcap=0",
+                             "--WarmupTime=%ss" % args.warmup,
+                             "--ForkVariants=%s" % ",".join(variants),
+                             "--ForkJobs=%d" % args.jobs]
+        else:
+            program_args += ["--warmup=%s" % args.warmup,
+                             "--fork=%s" % ",".join(variants),
+                             "--fork_jobs=%d" % args.jobs]
+        return program_args
+
+
+def read_csv_column(path, column):
+    with open(path, newline="") as f:
+        return [float(row[column]) for row in csv.DictReader(f) if row[column] != ""]
+
+
+def collect_coap(workdir):
+    error_rates = read_csv_column(os.path.join(workdir, "error", "error_rates.csv"), "ErrorRate")
+    latencies = []
+    for path in glob.glob(os.path.join(workdir, "error", "latency_*.csv")):
+        latencies += read_csv_column(path, "Latency(s)")
+    latencies.sort()
+    stats = {"error_rate": statistics.fmean(error_rates) if error_rates else float("nan"),
+             "received": float(len(latencies))}
+    if latencies:
+        stats["latency_mean_s"] = statistics.fmean(latencies)
+        stats["latency_p95_s"] = latencies[min(len(latencies) - 1, int(0.95 * len(latencies)))]
+    return stats
+
+
+def collect_wifi(workdir):
+    with open(os.path.join(workdir, "summary.csv"), newline="") as f:
+        return {row["Metric"]: float(row["Value"]) for row in csv.DictReader(f)}
+
+
+def execute(spec, args):
+    """Runs one replication in its own directory, returns (spec, stats, wall clock)."""
+    workdir = os.path.join(os.path.abspath(args.output), "runs", spec.key())
+    for subdir in ("error", "log"):
+        os.makedirs(os.path.join(workdir, subdir), exist_ok=True)
+
+    program = " ".join([SCENARIOS[spec.scenario]["program"]] + spec.arguments(args, workdir))
+    command = [os.path.join(NS3_DIR, "ns3"), "run", "--no-build", "--cwd", workdir, program]
+
+    start = time.monotonic()
+    with open(os.path.join(workdir, "stdout.log"), "w") as out:
+        ret = subprocess.run(command, cwd=NS3_DIR, stdout=out, stderr=subprocess.STDOUT)
+    elapsed = time.monotonic() - start
+    if ret.returncode != 0:
+        raise RuntimeError("%s failed with code %d (see %s)"
+                           % (spec.key(), ret.returncode, os.path.join(workdir, "stdout.log")))
+
+    try:
+        stats = collect_coap(workdir) if spec.scenario == "coap" else collect_wifi(workdir)
+    except (OSError, KeyError, ValueError) as e:
+        raise RuntimeError("%s wrote no usable results: %s (see %s)"
+                           % (spec.key(), e, os.path.join(workdir, "stdout.log")))
+    return spec, stats, elapsed
+
+
+def execute_forked(specs, args):
+    """Runs replications sharing one scenario as forked variants of one process.
+
+    Returns a list of (spec, stats or exception, wall clock) and the
+    wall-clock time saved by the shared warm-up (seconds)."""
+    groupdir = os.path.join(os.path.abspath(args.output), "warm-start", specs[0].scenario_key())
+    os.makedirs(groupdir, exist_ok=True)
+
+    variants = [spec.variant()[0] for spec in specs]
+    program = " ".join([SCENARIOS[specs[0].scenario]["program"]]
+                       + specs[0].fork_arguments(args, variants))
+    command = [os.path.join(NS3_DIR, "ns3"), "run", "--no-build", "--cwd", groupdir, program]
+
+    log_path = os.path.join(groupdir, "stdout.log")
+    with open(log_path, "w") as out:
+        subprocess.run(command, cwd=NS3_DIR, stdout=out, stderr=subprocess.STDOUT)
+
+    # report lines of ns3::WarmStartHelper
+    elapsed = {}
+    saved_s = 0.0
+    with open(log_path) as f:
+        for line in f:
+            match = re.match(r"warm-start:\s+(\S+) (\d+) ms$", line.strip())
+            if match:
+                elapsed[match.group(1)] = int(match.group(2)) / 1000
+            match = re.search(r"saved (\d+) ms of setup", line)
+            if match:
+                saved_s = int(match.group(1)) / 1000
+
+    results = []
+    for spec in specs:
+        name = spec.variant()[1]
+        workdir = os.path.join(groupdir, name)
+        try:
+            stats = collect_coap(workdir) if spec.scenario == "coap" else collect_wifi(workdir)
+        except (OSError, KeyError, ValueError):
+            stats = RuntimeError("%s failed (see %s)" % (spec.key(), log_path))
+        results.append((spec, stats, elapsed.get(name, float("nan"))))
+    return results, saved_s
+
+
+def load_completed(path):
+    completed = {}
+    if os.path.exists(path):
+        with open(path) as f:
+            for line in f:
+                line = line.strip()
+                if not line:
+                    continue
+                try:
+                    record = json.loads(line)
+                except json.JSONDecodeError:
+                    continue  # interrupted while writing the last record
+                completed[record["key"]] = record
+    return completed
+
+
+def summarize(records, confidence):
+    """Aggregates replications per grid point: mean and confidence interval half width."""
+    groups = {}
+    for record in records:
+        groups.setdefault(record["point_key"], []).append(record)
+
+    rows = []
+    for point_key in sorted(groups):
+        group = groups[point_key]
+        metrics = sorted(set(itertools.chain.from_iterable(r["stats"].keys() for r in group)))
+        for metric in metrics:
+            values = [r["stats"][metric] for r in group
+                      if metric in r["stats"] and not math.isnan(r["stats"][metric])]
+            if not values:
+                continue
+            mean = statistics.fmean(values)
+            half_width = float("nan")
+            if len(values) > 1:
+                half_width = (t_quantile(confidence, len(values) - 1)
+                              * statistics.stdev(values) / math.sqrt(len(values)))
+            row = dict(group[0]["point"])
+            row.update({"metric": metric, "n": len(values), "mean": mean,
+                        "ci_low": mean - half_width, "ci_high": mean + half_width})
+            rows.append(row)
+    return rows
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("scenario", choices=sorted(SCENARIOS))
+    parser.add_argument("--protocols", nargs="+", default=None,
+                        help="protocols to sweep (default: all of the scenario)")
+    parser.add_argument("--uavs", nargs="+", type=int, default=[40])
+    parser.add_argument("--bandwidth", nargs="+", default=["1000Mbps"],
+                        help="server side p2p data rates")
+    parser.add_argument("--tcp", nargs="+", choices=["on", "off"], default=["off"],
+                        help="TCP OnOff cross traffic")
+    parser.add_argument("--runs", type=int, default=5, help="replications per grid point")
+    parser.add_argument("--first-run", type=int, default=1, help="first RngRun value")
+    parser.add_argument("--seed", type=int, default=1, help="RngSeed shared by all runs")
+    parser.add_argument("--simul-time", type=float, default=120, help="seconds")
+    parser.add_argument("--pcap", action="store_true", help="keep pcap capture enabled")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--confidence", type=float, choices=sorted(T_TABLE), default=0.95)
+    parser.add_argument("-o", "--output", default="sweep")
+    parser.add_argument("--no-build", action="store_true", help="do not build ns-3 first")
+    parser.add_argument("--warmup", type=float, default=0,
+                        help="seconds simulated once per scenario and shared by forked variants")
+    args = parser.parse_args(argv)
+
+    protocols = args.protocols or SCENARIOS[args.scenario]["protocols"]
+    unknown = set(protocols) - set(SCENARIOS[args.scenario]["protocols"])
+    if unknown:
+        parser.error("unknown protocol(s) for %s: %s" % (args.scenario, ", ".join(sorted(unknown))))
+
+    os.makedirs(args.output, exist_ok=True)
+    results_path = os.path.join(args.output, "runs.jsonl")
+    completed = load_completed(results_path)
+
+    specs = [RunSpec(args.scenario, protocol, uavs, bandwidth, int(tcp == "on"), rng_run, args)
+             for protocol, uavs, bandwidth, tcp, rng_run in itertools.product(
+                 protocols, args.uavs, args.bandwidth, args.tcp,
+                 range(args.first_run, args.first_run + args.runs))]
+    pending = [spec for spec in specs if spec.key() not in completed]
+    print("%d runs in the sweep, %d already done, %d to go (%d workers)"
+          % (len(specs), len(specs) - len(pending), len(pending), args.jobs))
+
+    if pending and not args.no_build:
+        subprocess.run([os.path.join(NS3_DIR, "ns3"), "build"], cwd=NS3_DIR, check=True)
+
+    failed = []
+    saved_s = 0.0
+    # with --warmup every process forks up to --jobs variants itself
+    workers = 1 if args.warmup > 0 else args.jobs
+    with open(results_path, "a") as results, \
+            concurrent.futures.ThreadPoolExecutor(max_workers=workers) as pool:
+
+        def record_run(done, spec, stats, elapsed):
+            record = {"key": spec.key(), "point_key": spec.point_key(), "point": spec.point(),
+                      "rng_run": spec.rng_run, "wall_clock_s": elapsed, "stats": stats}
+            results.write(json.dumps(record) + "\n")
+            results.flush()
+            completed[record["key"]] = record
+            print("[%d/%d] %s done in %.1fs" % (done, len(pending), spec.key(), elapsed))
+
+        done = 0
+        if args.warmup > 0:
+            groups = {}
+            for spec in pending:
+                groups.setdefault(spec.scenario_key(), []).append(spec)
+            futures = [pool.submit(execute_forked, group, args) for group in groups.values()]
+            for future in concurrent.futures.as_completed(futures):
+                group_results, group_saved_s = future.result()
+                saved_s += group_saved_s
+                for spec, stats, elapsed in group_results:
+                    done += 1
+                    if isinstance(stats, Exception):
+                        failed.append(spec.key())
+                        print("[%d/%d] %s" % (done, len(pending), stats), file=sys.stderr)
+                        continue
+                    record_run(done, spec, stats, elapsed)
+        else:
+            futures = {pool.submit(execute, spec, args): spec for spec in pending}
+            for future in concurrent.futures.as_completed(futures):
+                done += 1
+                try:
+                    spec, stats, elapsed = future.result()
+                except (RuntimeError, OSError) as e:
+                    # a failed run is retried by the next resume, the others go on
+                    failed.append(futures[future].key())
+                    print("[%d/%d] %s" % (done, len(pending), e), file=sys.stderr)
+                    continue
+                record_run(done, spec, stats, elapsed)
+
+    if args.warmup > 0:
+        print("warm-start saved %.1fs of wall-clock setup in this sweep" % saved_s)
+
+    keys = set(spec.key() for spec in specs)
+    rows = summarize([r for k, r in completed.items() if k in keys], args.confidence)
+    summary_path = os.path.join(args.output, "summary.csv")
+    with open(summary_path, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=["protocol", "uavs", "bandwidth", "tcp", "metric",
+                                               "n", "mean", "ci_low", "ci_high"])
+        writer.writeheader()
+        writer.writerows(rows)
+    print("summary (%d%% confidence intervals) written to %s" % (args.confidence * 100, summary_path))
+    if failed:
+        print("%d run(s) failed, rerun the sweep to retry them:\n  %s"
+              % (len(failed), "\n  ".join(sorted(failed))), file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -56,8 +56,15 @@ CoAPClient::Put ()
   //    3) the client fails to receive the reset feedback within RTO
   //       set RTO as RTT value.
 
-  CoAPHeader hdr;
-  CoAPHeader::PreparePut(hdr, 0, 0, m_mid++, false); // default is NON
+  // the PUT header only changes by its MID: serialize it once
+  if (m_put_hdr.GetSerializedSize() == 0)
+    {
+      CoAPHeader put_hdr;
+      CoAPHeader::PreparePut(put_hdr, 0, 0, 0, false); // default is NON
+      m_put_hdr.SetHeader(put_hdr);
+    }
+  HeaderTemplate &hdr = m_put_hdr;
+  CoAPHeader::SetMID(hdr, m_mid++);
   Ptr<Packet> packet = Create<Packet>(m_size);
 
   NotifyPacketTransmission(packet); // tracing purpose
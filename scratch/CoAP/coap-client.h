@@ -70,6 +70,7 @@ namespace ns3
 
     uint32_t m_size{0}; // packet payload size in bytes (for PUT)
     uint16_t m_mid{0};  // message id
+    HeaderTemplate m_put_hdr;   // serialized PUT header, MID patched per message
 
     Time m_ping_time{0};        // ping send time
     Time m_Rtt{0};              // measured actual RTT
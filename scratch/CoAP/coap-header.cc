@@ -17,6 +17,7 @@
  */
 #include "ns3/packet.h"
 #include "coap-header.h"
+#include <cstring>
 
 using namespace ns3;
 // XXX: Assume Big Endian!!!
@@ -42,30 +43,44 @@ uint32_t CoAPHeader::GetSerializedSize() const
 
 void CoAPHeader::Serialize(Buffer::Iterator start) const
 {
-  start.WriteU32(m_fixed_hdr.merged);
-  auto tkl = GetTKL();
-  union {
-    uint64_t token;
-    uint8_t buffer[4];
-  } convert;
-  convert.token = m_token;
-  start.Write(convert.buffer, tkl);
-  start.Write(&EOH, 1);
+  // the fixed header as WriteU32 writes it, the token as it is in memory
+  NS_ASSERT(GetTKL() <= sizeof(m_token));
+  const uint32_t size = GetSerializedSize();
+  uint8_t copy[sizeof(m_fixed_hdr) + sizeof(m_token) + sizeof(uint8_t)];
+  uint8_t *bytes = start.ReserveContiguous(size);
+  uint8_t *fields = bytes != nullptr ? bytes : copy;
+  for (uint32_t i = 0; i < sizeof(m_fixed_hdr); ++i)
+    fields[i] = (m_fixed_hdr.merged >> (8 * i)) & 0xff;
+  std::memcpy(fields + sizeof(m_fixed_hdr), &m_token, GetTKL());
+  fields[size - 1] = EOH;
+  if (bytes == nullptr)
+    start.Write(copy, size);
 }
 
 uint32_t CoAPHeader::Deserialize(Buffer::Iterator start)
 {
-  m_fixed_hdr.merged = start.ReadU32();
+  uint8_t copy[sizeof(m_fixed_hdr) + sizeof(m_token) + sizeof(uint8_t)];
+  const uint8_t *fields = start.ReserveContiguous(sizeof(m_fixed_hdr));
+  if (fields == nullptr)
+    {
+      start.Read(copy, sizeof(m_fixed_hdr));
+      fields = copy;
+    }
+  m_fixed_hdr.merged = 0;
+  for (uint32_t i = 0; i < sizeof(m_fixed_hdr); ++i)
+    m_fixed_hdr.merged |= uint32_t(fields[i]) << (8 * i);
 
+  // the token and the end of header
   auto tkl = GetTKL();
-  union {
-    uint64_t token;
-    uint8_t buffer[4];
-  } convert{0};
-  start.Read(convert.buffer, tkl);
-  m_token = convert.token;
-
-  start.Read(convert.buffer, 1); // get rids of EOH
+  NS_ASSERT(tkl <= sizeof(m_token));
+  fields = start.ReserveContiguous(tkl + 1);
+  if (fields == nullptr)
+    {
+      start.Read(copy, tkl + 1);
+      fields = copy;
+    }
+  m_token = 0;
+  std::memcpy(&m_token, fields, tkl);
 
   return sizeof(m_fixed_hdr) + GetTKL() + sizeof(uint8_t);
 }
@@ -148,6 +163,11 @@ void CoAPHeader::SetMID(uint16_t mid)
   m_fixed_hdr.slot[3] = s_mid.slot[0];
 }
 
+void CoAPHeader::SetMID(HeaderTemplate &tmpl, uint16_t mid)
+{
+  tmpl.SetU16(MID_OFFSET, mid);
+}
+
 uint64_t CoAPHeader::GetToken() const
 {
   return m_token;
@@ -19,6 +19,7 @@
 #ifndef COAP_HEADER_H
 #define COAP_HEADER_H
 #include "ns3/header.h"
+#include "ns3/header-template.h"
 
 namespace ns3
 {
@@ -150,6 +151,12 @@ namespace ns3
 
     void SetMID(uint16_t mid);
 
+    // offset of the MID in the serialized header (network byte order)
+    constexpr static uint32_t MID_OFFSET = 2;
+
+    // patch the MID of a header serialized into a template
+    static void SetMID(HeaderTemplate &tmpl, uint16_t mid);
+
     void SetToken(uint64_t token);
 
     uint8_t GetVersion() const;
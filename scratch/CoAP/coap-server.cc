@@ -24,6 +24,8 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/udp-socket.h"
 #include "coap-server.h"
 
 using namespace ns3;
@@ -42,6 +44,11 @@ TypeId CoAPServer::GetTypeId ()
                    UintegerValue (5683),
                    MakeUintegerAccessor (&CoAPServer::m_Port),
                    MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("CoalesceRecv",
+                   "Handle the datagrams received at the same time in one callback",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&CoAPServer::m_coalesceRecv),
+                   MakeBooleanChecker ())
     .AddTraceSource("PacketReceived",
                     "probe for packet receiving",
                     MakeTraceSourceAccessor(&CoAPServer::m_ReceiveCallback),
@@ -83,6 +90,7 @@ CoAPServer::StartApplication ()
           NS_FATAL_ERROR("Failed to bind socket");
         }
     }
+  m_socket->SetAttribute("CoalesceRecvNotify", BooleanValue(m_coalesceRecv));
   m_socket->SetRecvCallback(MakeCallback(&CoAPServer::HandleRecv, this));
 
   if (m_socket6 == 0)
@@ -97,6 +105,7 @@ CoAPServer::StartApplication ()
         }
     }
 
+  m_socket6->SetAttribute("CoalesceRecvNotify", BooleanValue(m_coalesceRecv));
   m_socket6->SetRecvCallback (MakeCallback (&CoAPServer::HandleRecv, this));
 }
 
@@ -112,48 +121,55 @@ void CoAPServer::HandleRecv(Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION(this);
 
-  Address addr;
+  // drain the socket RECV_BATCH datagrams at a time
+  Ptr<UdpSocket> udp = DynamicCast<UdpSocket>(socket);
+  UdpSocket::RecvItem batch[RECV_BATCH];
 
-  while (Ptr<Packet> p = socket->RecvFrom(addr))
+  while (uint32_t n = udp->RecvBatch(batch, RECV_BATCH))
     {
-      NotifyPacketReceive(p);   // for tracing purpose
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          Ptr<Packet> p = batch[i].packet;
+          const Address &addr = batch[i].from;
 
-      CoAPHeader hdr;
-      p->PeekHeader(hdr);
+          NotifyPacketReceive(p);   // for tracing purpose
 
-      NS_LOG_INFO(this << static_cast<uint8_t>(hdr.GetClass()));
-      switch (hdr.GetClass())
-        {
-          using Class = CoAPHeader::Class;
-        case Class::METHOD:
-          using Method = CoAPHeader::Method;
-          switch (hdr.GetCode<Class::METHOD>())
+          CoAPHeader hdr;
+          p->PeekHeader(hdr);
+
+          NS_LOG_INFO(this << static_cast<uint8_t>(hdr.GetClass()));
+          switch (hdr.GetClass())
             {
-            case Method::PUT:
-              NS_LOG_INFO(this << static_cast<uint8_t>(Method::PUT));
-              HandleMethod<Method::PUT>(p, addr);
+              using Class = CoAPHeader::Class;
+            case Class::METHOD:
+              using Method = CoAPHeader::Method;
+              switch (hdr.GetCode<Class::METHOD>())
+                {
+                case Method::PUT:
+                  NS_LOG_INFO(this << static_cast<uint8_t>(Method::PUT));
+                  HandleMethod<Method::PUT>(p, addr);
+                  break;
+                default:
+                  NS_ABORT_MSG("Not Implemented CoAP Success Code.");
+                  break;
+                }
               break;
-            default:
-              NS_ABORT_MSG("Not Implemented CoAP Success Code.");
+            case Class::SIGNAL:
+              using Signal = CoAPHeader::Signal;
+              switch (hdr.GetCode<Class::SIGNAL>())
+                {
+                case Signal::PING:
+                  ResponedToPing(hdr, addr);
+                default:
+                  break;
+                }
               break;
-            }
-          break;
-        case Class::SIGNAL:
-          using Signal = CoAPHeader::Signal;
-          switch (hdr.GetCode<Class::SIGNAL>())
-            {
-            case Signal::PING:
-              ResponedToPing(hdr, addr);
             default:
+              NS_ABORT_MSG("Not Implemented CoAP Classes.");
               break;
             }
-          break;
-        default:
-          NS_ABORT_MSG("Not Implemented CoAP Classes.");
-          break;
         }
     }
-
 }
 
 void
@@ -51,6 +51,9 @@ namespace ns3
     void StopApplication() override;
 
 
+    // datagrams read by each RecvBatch in HandleRecv
+    constexpr static uint32_t RECV_BATCH = 32;
+
     void HandleRecv(Ptr<Socket> socket);
 
     // Methods
@@ -66,6 +69,7 @@ namespace ns3
     uint16_t m_mid{0};     // message id
 
     uint16_t m_Port{5683};
+    bool m_coalesceRecv{false}; // one receive callback per simulated time
     Ptr<Socket> m_socket{0};
     Ptr<Socket> m_socket6{0};
 
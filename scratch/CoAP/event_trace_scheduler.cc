@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Chang-Hui Kim <kch9001@gmail.com>
+ */
+#include <algorithm>
+#include <iostream>
+#include <ns3/abort.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+#include <ns3/string.h>
+#include "event_trace_scheduler.h"
+
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE("EventTraceScheduler");
+NS_OBJECT_ENSURE_REGISTERED(EventTraceScheduler);
+
+
+TypeId
+EventTraceScheduler::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::EventTraceScheduler")
+    .SetParent<MapScheduler>()
+    .SetGroupName("Core")
+    .AddConstructor<EventTraceScheduler>()
+    .AddAttribute("FileName", "Where to write the relative event times.",
+                  TypeId::ATTR_CONSTRUCT,
+                  StringValue("events.txt"),
+                  MakeStringAccessor(&EventTraceScheduler::SetFileName),
+                  MakeStringChecker())
+    ;
+  return tid;
+}
+
+
+EventTraceScheduler::EventTraceScheduler () = default;
+
+
+EventTraceScheduler::~EventTraceScheduler ()
+{
+  if (output_.is_open())
+    {
+      std::cout << "event trace: " << events_ << " events, peak population "
+                << peak_population_ << std::endl;
+    }
+}
+
+
+void
+EventTraceScheduler::SetFileName (std::string const &fileName)
+{
+  output_.open(fileName);
+  NS_ABORT_MSG_UNLESS(output_.is_open(), "cannot open " << fileName);
+}
+
+
+void
+EventTraceScheduler::Insert (const Event &ev)
+{
+  auto const delay = TimeStep(ev.key.m_ts) - Simulator::Now();
+  output_ << delay.GetSeconds() << '\n';
+  ++events_;
+  peak_population_ = std::max(peak_population_, ++population_);
+  MapScheduler::Insert(ev);
+}
+
+
+Scheduler::Event
+EventTraceScheduler::RemoveNext ()
+{
+  --population_;
+  return MapScheduler::RemoveNext();
+}
+
+
+void
+EventTraceScheduler::Remove (const Event &ev)
+{
+  --population_;
+  MapScheduler::Remove(ev);
+}
@@ -0,0 +1,58 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Chang-Hui Kim <kch9001@gmail.com>
+ */
+#pragma once
+#ifndef EVENT_TRACE_SCHEDULER_H
+#define EVENT_TRACE_SCHEDULER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <ns3/map-scheduler.h>
+
+namespace ns3
+{
+  // MapScheduler that records how far ahead every event is scheduled,
+  // one relative time in seconds per line, the input of
+  // utils/bench-simulator --file
+  class EventTraceScheduler : public MapScheduler
+  {
+  public:
+    static TypeId GetTypeId (void);
+
+    EventTraceScheduler ();
+
+    ~EventTraceScheduler () override;
+
+    void Insert (const Event &ev) override;
+
+    Event RemoveNext () override;
+
+    void Remove (const Event &ev) override;
+
+  private:
+    void SetFileName (std::string const &fileName);
+
+    std::ofstream output_;
+    uint64_t events_{0};
+    uint64_t population_{0};
+    uint64_t peak_population_{0};
+  };
+}
+
+
+#endif /* EVENT_TRACE_SCHEDULER_H */
@@ -36,6 +36,7 @@ enum TestNumber : int
     CSMA = 1,
     HEADER = 2,
     WIFI = 3,
+    HEADER_BENCH = 4,
   };
 
 void CsmaExample()
@@ -144,13 +145,89 @@ void HeaderTest()
   }
 }
 
+// one FDP message: the header chain built and serialized field by field
+static Ptr<Packet> MakeMessageByChain(uint16_t mid, bool seq_bit, unsigned int msg_seq,
+                                      uint16_t interval)
+{
+  CoAPHeader coap_hdr;
+  CoAPHeader::PreparePut(coap_hdr, 0, 0, mid, false);
+  FDPMessageHeader fdp_hdr;
+  fdp_hdr.SetSeqBit(seq_bit);
+  fdp_hdr.SetMsgInterval(MilliSeconds(interval));
+  fdp_hdr.SetMsgSeq(msg_seq);
+
+  Ptr<Packet> p = Create<Packet>(HEADER_BENCH_PAYLOAD);
+  p->AddHeader(fdp_hdr);
+  p->AddHeader(coap_hdr);
+  return p;
+}
+
+// one FDP message: the header templates patched
+static Ptr<Packet> MakeMessageByTemplate(HeaderTemplate &coap_tmpl, HeaderTemplate &fdp_tmpl,
+                                         uint16_t mid, bool seq_bit, unsigned int msg_seq,
+                                         uint16_t interval)
+{
+  CoAPHeader::SetMID(coap_tmpl, mid);
+  FDPMessageHeader::SetFields(fdp_tmpl, seq_bit, msg_seq, interval);
+
+  Ptr<Packet> p = Create<Packet>(HEADER_BENCH_PAYLOAD);
+  p->AddHeader(fdp_tmpl);
+  p->AddHeader(coap_tmpl);
+  return p;
+}
+
+void HeaderBenchmark()
+{
+  NS_LOG_FUNCTION("Header Benchmark");
+
+  CoAPHeader coap_hdr;
+  CoAPHeader::PreparePut(coap_hdr, 0, 0, 0, false);
+  HeaderTemplate coap_tmpl{coap_hdr};
+  HeaderTemplate fdp_tmpl{FDPMessageHeader()};
+
+  // both ways write the same bytes
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      Ptr<Packet> a = MakeMessageByChain(i * 37, i & 1, i % 3, i % 5000);
+      Ptr<Packet> b = MakeMessageByTemplate(coap_tmpl, fdp_tmpl, i * 37, i & 1, i % 3, i % 5000);
+      std::vector<uint8_t> da(a->GetSize()), db(b->GetSize());
+      a->CopyData(da.data(), da.size());
+      b->CopyData(db.data(), db.size());
+      NS_ABORT_MSG_IF(da != db, "the header templates do not match the headers");
+    }
+
+  uint64_t sum = 0;
+  SystemWallClockMs clock;
+  clock.Start();
+  for (uint32_t i = 0; i < HEADER_BENCH_COUNT; ++i)
+    {
+      sum += MakeMessageByChain(i, i & 1, i % 3, i % 5000)->GetSize();
+    }
+  int64_t chain_ms = std::max(int64_t(1), clock.End());
+
+  clock.Start();
+  for (uint32_t i = 0; i < HEADER_BENCH_COUNT; ++i)
+    {
+      sum += MakeMessageByTemplate(coap_tmpl, fdp_tmpl, i, i & 1, i % 3, i % 5000)->GetSize();
+    }
+  int64_t template_ms = std::max(int64_t(1), clock.End());
+
+  // two headers (CoAP and FDP) per message
+  std::cout << "AddHeader chain: " << 2e3 * HEADER_BENCH_COUNT / chain_ms << " headers/s ("
+            << chain_ms << " ms)\n"
+            << "header templates: " << 2e3 * HEADER_BENCH_COUNT / template_ms << " headers/s ("
+            << template_ms << " ms)\n"
+            << "checksum: " << sum << std::endl;
+}
+
 int main(int argc, char *argv[])
 {
   int which_one;
   CommandLine cmd{__FILE__};
   cmd.AddValue("WhichTest",
                "1. csma test\n 2. header serialization test\n"
-               "3. CoAP Transfer Test.\n",
+               "3. CoAP Transfer Test.\n"
+               "4. header template benchmark\n",
                which_one);
   cmd.AddValue("UseFDP",
                "true: enable FDP, false: enable CoCoA\n",
@@ -158,9 +235,77 @@ int main(int argc, char *argv[])
   cmd.AddValue("SendTCP",
                "true: enable TCP",
                SendTCP);
+  cmd.AddValue("Pcap",
+               "true: capture the AP traffic into PCAP_Name",
+               ENABLE_PCAP);
   cmd.AddValue("PCAP_Name",
                "Pcap File Name with absolute path\n",
                PCAP_NAME);
+  cmd.AddValue("PcapFilter",
+               "capture only these packets, e.g. \"udp port 19574\"\n"
+               "(buffered capture, WifiTest)",
+               PCAP_FILTER);
+  cmd.AddValue("PcapSnapLen",
+               "payload bytes kept behind the headers, -1: all (buffered capture, WifiTest)",
+               PCAP_SNAPLEN);
+  cmd.AddValue("PcapMaxSize",
+               "bytes per pcap file before rotating, 0: one file (buffered capture, WifiTest)",
+               PCAP_MAX_SIZE);
+  cmd.AddValue("PcapMaxFiles",
+               "pcap files kept in the ring, 0: all (buffered capture, WifiTest)",
+               PCAP_MAX_FILES);
+  cmd.AddValue("NumUAVs",
+               "the number of UAVs (WifiTest)",
+               NUM_UAVS);
+  cmd.AddValue("SwarmRadius",
+               "radius of the disc of the UAVs around the AP, in meters (WifiTest)",
+               SWARM_RADIUS);
+  cmd.AddValue("SpatialIndex",
+               "only deliver frames to the PHYs within range (WifiTest)",
+               SPATIAL_INDEX);
+  cmd.AddValue("PropagationCache",
+               "meters a UAV may move before its cached propagation is computed again, "
+               "0: exact cache, < 0: no cache (WifiTest)",
+               PROPAGATION_CACHE);
+  cmd.AddValue("BatchMobility",
+               "evaluate the positions of all UAVs in one pass per time (WifiTest)",
+               BATCH_MOBILITY);
+  cmd.AddValue("CoalesceRecv",
+               "the server handles the datagrams of a simulated time in one callback (WifiTest)",
+               COALESCE_RECV);
+  cmd.AddValue("ServerBandwidth",
+               "p2p link data rate between AP and server (WifiTest)",
+               SERVER_BANDWIDTH);
+  cmd.AddValue("SimulTime",
+               "simulation time (WifiTest)",
+               SIMUL_TIME);
+  cmd.AddValue("FairnessFile",
+               "write the online fairness time series (csv) to this file",
+               FAIRNESS_FILE);
+  cmd.AddValue("FairnessCapacity",
+               "capacity the utilization is measured against, e.g. \"100Mbps\"\n"
+               "(default: highest PHY rate of the AP, the Wi-Fi link being the bottleneck)",
+               FAIRNESS_CAPACITY);
+  cmd.AddValue("StopOnFairness",
+               "true: stop once the Jain's index of the UAV flows converged",
+               STOP_ON_FAIRNESS);
+  cmd.AddValue("WarmupTime",
+               "shared warm-up before forking the variants (WifiTest)",
+               WARMUP_TIME);
+  cmd.AddValue("ForkVariants",
+               "fork these variants after the warm-up, e.g. \"fdp:1,cocoa:1\"\n"
+               "(protocol[:RngRun], each one writes into its own directory)",
+               FORK_VARIANTS);
+  cmd.AddValue("ForkJobs",
+               "maximum number of variants running at once (0: all)",
+               FORK_JOBS);
+  cmd.AddValue("EventTrace",
+               "write the delay of every scheduled event to this file\n"
+               "(input of bench-simulator --file, WifiTest)",
+               EVENT_TRACE);
+  cmd.AddValue("HeaderBenchCount",
+               "messages built by each way (header template benchmark)",
+               HEADER_BENCH_COUNT);
   cmd.Parse(argc, argv);
 
   switch (which_one)
@@ -174,6 +319,9 @@ int main(int argc, char *argv[])
     case TestNumber::WIFI:
       WifiTest();
       break;
+    case TestNumber::HEADER_BENCH:
+      HeaderBenchmark();
+      break;
     default:
       NS_LOG_ERROR("No such test number!" << cmd);
       break;
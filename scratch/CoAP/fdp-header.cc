@@ -41,17 +41,31 @@ uint32_t FDPMessageHeader::GetSerializedSize() const
   return sizeof(uint16_t);
 }
 
-void FDPMessageHeader::Serialize(Buffer::Iterator start) const
+uint16_t FDPMessageHeader::MakeField(bool seq_bit, uint8_t msg_seq, uint16_t interval_ms)
 {
   // XXX: have to check interval is in 12 bits value (overflow check)
-  auto interval = std::min(BIT_12_MAX, m_interval);
+  auto interval = std::min(BIT_12_MAX, interval_ms);
 
   uint16_t field{0};
 
-  field |= (static_cast<uint16_t>(m_seq_bit) << 15);
-  field |= (uint16_t(m_msg_seq) << 13);
+  field |= (static_cast<uint16_t>(seq_bit) << 15);
+  field |= (uint16_t(msg_seq) << 13);
   field |= (interval << 1);
-  start.WriteU16(field);
+  return field;
+}
+
+void FDPMessageHeader::Serialize(Buffer::Iterator start) const
+{
+  start.WriteU16(MakeField(m_seq_bit, m_msg_seq, m_interval));
+}
+
+void FDPMessageHeader::SetFields(HeaderTemplate &tmpl, bool seq_bit,
+                                 unsigned int msg_seq, uint16_t interval_ms)
+{
+  NS_ABORT_IF(msg_seq > 2);
+  // Serialize writes the field in host byte order
+  uint16_t field = MakeField(seq_bit, msg_seq, interval_ms);
+  tmpl.SetU16(0, (field >> 8) | (field << 8));
 }
 
 uint32_t FDPMessageHeader::Deserialize(Buffer::Iterator start)
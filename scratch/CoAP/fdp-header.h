@@ -16,6 +16,7 @@
  * Author: Chang-Hui Kim <kch9001@gmail.com>
  */
 #include "ns3/header.h"
+#include "ns3/header-template.h"
 #include "ns3/nstime.h"
 #include <stdint.h>
 #pragma once
@@ -55,7 +56,14 @@ namespace ns3
 
     void SetMsgInterval(Time interval_ms);
 
+    // patch all the fields of a header serialized into a template
+    static void SetFields(HeaderTemplate &tmpl, bool seq_bit,
+                          unsigned int msg_seq, uint16_t interval_ms);
+
   private:
+    // the serialized 16 bits field
+    static uint16_t MakeField(bool seq_bit, uint8_t msg_seq, uint16_t interval_ms);
+
     bool m_seq_bit{false};
     uint8_t m_msg_seq{0};
     uint16_t m_interval{0};
@@ -32,7 +32,7 @@ FdpSenderCC::FdpSenderCC()
 
 void
 FdpSenderCC::TransferMessage(Ptr<Socket> socket, Ptr<Packet> packet,
-                             CoAPHeader &coap_hdr)
+                             const Header &coap_hdr)
 {
   NS_LOG_FUNCTION(this);
   Time now = Simulator::Now();
@@ -40,13 +40,10 @@ FdpSenderCC::TransferMessage(Ptr<Socket> socket, Ptr<Packet> packet,
   auto interval = CastMilliSecondsToUint16(diff);
   m_PrevTransfer = now;
 
-  FDPMessageHeader hdr;
-  hdr.SetSeqBit(GetSeqBit());
-  hdr.SetMsgInterval(MilliSeconds(interval));
-  hdr.SetMsgSeq(GetMsgSeq());
-  NS_LOG_INFO(__FUNCTION__ << hdr);
+  FDPMessageHeader::SetFields(m_msg_hdr, GetSeqBit(), GetMsgSeq(), interval);
+  NS_LOG_INFO(__FUNCTION__ << m_msg_hdr);
 
-  packet->AddHeader(hdr);
+  packet->AddHeader(m_msg_hdr);
   packet->AddHeader(coap_hdr);
   socket->Send(packet);
 
@@ -22,6 +22,7 @@
 #include <functional>
 #include "ns3/nstime.h"
 #include "coap-header.h"
+#include "fdp-header.h"
 
 namespace ns3
 {
@@ -40,11 +41,12 @@ namespace ns3
     Time m_PrevTransfer{0};
     EventId m_ResetEvent;
     uint8_t m_recent_feedback_msg_seq{0};
+    HeaderTemplate m_msg_hdr{FDPMessageHeader()}; // fields patched per message
 
   public:
     FdpSenderCC();
 
-    void TransferMessage(Ptr<Socket> socket, Ptr<Packet> packet, CoAPHeader &hdr);
+    void TransferMessage(Ptr<Socket> socket, Ptr<Packet> packet, const Header &hdr);
     EventId ScheduleTransfer(std::function<void()> &&callback);
     void HandleFeedback(Ptr<Packet> packet);
     /*
@@ -18,10 +18,48 @@
 #pragma once
 #ifndef OPTION_H
 #define OPTION_H
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include "ns3/nstime.h"
 
 inline bool UseFDP = false;
 inline bool SendTCP = false;
+inline bool ENABLE_PCAP = true;
 inline std::string PCAP_NAME = "/tmp/tcp-cocoa";
 
+// size-bounded capture of the AP (WifiTest), used as soon as one is set
+inline std::string PCAP_FILTER = ""; // e.g. "udp port 19574"
+inline int64_t PCAP_SNAPLEN = -1;    // payload bytes kept per packet (-1: all)
+inline uint64_t PCAP_MAX_SIZE = 0;   // bytes per file before rotating (0: one file)
+inline uint32_t PCAP_MAX_FILES = 0;  // files in the ring (0: keep them all)
+
+// scenario parameters (WifiTest)
+inline std::string SERVER_BANDWIDTH = "1000Mbps";
+inline std::size_t NUM_UAVS = 40;
+inline ns3::Time SIMUL_TIME = ns3::Seconds(120);
+inline double SWARM_RADIUS = 30;   // meters around the AP
+inline bool SPATIAL_INDEX = false; // the channel skips the PHYs out of range
+inline double PROPAGATION_CACHE = -1; // tolerance (m) of the propagation cache, 0: exact, < 0: none
+inline bool BATCH_MOBILITY = false; // the drone positions are evaluated together
+inline bool COALESCE_RECV = false;  // one server receive callback per simulated time
+
+// warm-start snapshot (WifiTest)
+// variants are "protocol[:run]" separated by commas, e.g. "fdp:1,cocoa:1"
+inline ns3::Time WARMUP_TIME = ns3::Seconds(0);
+inline std::string FORK_VARIANTS = "";
+inline uint32_t FORK_JOBS = 0;
+
+// online fairness of the flows reaching the server (WifiTest)
+inline std::string FAIRNESS_FILE = ""; // empty: no time series
+inline bool STOP_ON_FAIRNESS = false;
+inline std::string FAIRNESS_CAPACITY = ""; // empty: highest PHY rate of the AP
+
+// relative times of all scheduled events (WifiTest), for utils/bench-simulator
+inline std::string EVENT_TRACE = ""; // empty: no trace
+
+// header template benchmark
+inline uint32_t HEADER_BENCH_COUNT = 1000000; // messages built by each way
+inline uint32_t HEADER_BENCH_PAYLOAD = 100;   // payload bytes per message
+
 #endif /* OPTION_H */
@@ -17,6 +17,7 @@
  */
 #include <cmath>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
 #include "pendulum_mobility.h"
 
 
@@ -52,6 +53,10 @@ PendulumMobility::GetTypeId ()
                   VectorValue(Vector{0, 0, 0}),
                   MakeVectorAccessor(&PendulumMobility::terminal_location_),
                   MakeVectorChecker())
+    .AddAttribute("Batch", "Evaluate the position with the other models in the BatchMobilityEngine.",
+                  BooleanValue(false),
+                  MakeBooleanAccessor(&PendulumMobility::batch_),
+                  MakeBooleanChecker())
     ;
   return tid;
 }
@@ -73,6 +78,14 @@ PendulumMobility::~PendulumMobility ()
 Vector
 PendulumMobility::DoGetPosition () const
 {
+  if (batch_)
+    {
+      if (!slot_.IsSet())
+        {
+          UpdateBatch();
+        }
+      return slot_.GetPosition();
+    }
   Vector distance_vector = ScaleVector(approach_ratio_, terminal_location_ - initial_position_);
   return initial_position_ + Vector{ CalculatePosition(distance_vector.x),
                                      CalculatePosition(distance_vector.y),
@@ -85,6 +98,20 @@ PendulumMobility::DoSetPosition (const Vector& position)
 {
   initial_position_ = position;
   start_time_ = Simulator::Now();
+  if (slot_.IsSet())
+    {
+      UpdateBatch();
+    }
+}
+
+
+void
+PendulumMobility::UpdateBatch () const
+{
+  // same terms as CalculatePosition, so that both paths give the same positions
+  slot_.Set(initial_position_, Vector{0, 0, 0},
+            ScaleVector(approach_ratio_, terminal_location_ - initial_position_),
+            GetPeriodCoeff(), start_time_);
 }
 
 
@@ -21,6 +21,7 @@
 
 #include <ns3/mobility-model.h>
 #include <ns3/simulator.h>
+#include <ns3/batch-mobility-engine.h>
 
 namespace ns3
 {
@@ -43,6 +44,7 @@ namespace ns3
     double GetPeriodCoeff () const;
     double CalculatePosition (double ele) const;
     double CalculateVelocity (double ele) const;
+    void UpdateBatch () const;
 
 
     Vector initial_position_{0, 0, 0};
@@ -50,6 +52,8 @@ namespace ns3
     Time start_time_{0};
     Time period_{0};
     double approach_ratio_{0.9};
+    bool batch_{false}; // evaluate the position in the BatchMobilityEngine
+    mutable BatchMobilitySlot slot_;
   };
 
 }    
@@ -23,7 +23,6 @@
 #include "ns3/simulator.h"
 #include "ns3/packet.h"
 #include "tests.h"
-#include "trace-tag.h"
 
 static std::string
 ParseNodeId(const std::string& context)
@@ -97,8 +96,7 @@ LatencyRecoder::RecordTransfer(std::string context, ns3::Ptr<const ns3::Packet>
 
   // convert string node id to uint16
   uint16_t node_uint_id = StringToUint16(node_id);
-  ns3::PacketTraceTag trace_tag{node_uint_id, packet_id};
-  p->AddPacketTag(trace_tag);
+  p->SetProvenance(ns3::PacketProvenance{node_uint_id, 0, packet_id, current_time});
 
   record_t record = { false, current_time, packet_id };
   m_LatencyRecords[node_id].push_back(std::make_tuple(ns3::Seconds(0), record));
@@ -109,16 +107,16 @@ LatencyRecoder::RecordTransfer(std::string context, ns3::Ptr<const ns3::Packet>
 void
 LatencyRecoder::RecordReceive(std::string context, ns3::Ptr<const ns3::Packet> p)
 {
-  ns3::PacketTraceTag trace_tag; // empty tag
-  if (!p->PeekPacketTag(trace_tag))
+  const auto& provenance = p->GetProvenance();
+  if (!provenance.IsSet())
     {
-      std::cerr << "unable to find packet trace tag!!!\n";
+      std::cerr << "unable to find packet provenance!!!\n";
       return;
     }
 
-  // extract data from packet tag
-  PUID_t packet_id = trace_tag.GetId();
-  std::string node_id = Uint16ToString(trace_tag.GetNodeId());
+  // extract data from packet provenance
+  PUID_t packet_id = provenance.GetSequence();
+  std::string node_id = Uint16ToString(provenance.GetNodeId());
   bool duplicated = false;
 
   auto& record_list = m_LatencyRecords[node_id];
@@ -18,6 +18,8 @@
 #include <string>
 #include <tuple>
 #include <algorithm>
+#include <sstream>
+#include <cstdlib>
 #include "ns3/core-module.h"
 #include "ns3/nstime.h"
 #include "ns3/node-container.h"
@@ -29,10 +31,14 @@
 #include "ns3/ipv4-global-routing-helper.h"
 #include "ns3/packet-sink-helper.h"
 #include "ns3/on-off-helper.h"
+#include "ns3/fairness-analyzer.h"
+#include "ns3/system-path.h"
+#include "ns3/warm-start-helper.h"
 #include "option.h"
 #include "coap-helper.h"
 #include "tests.h"
 #include "pendulum_mobility.h"
+#include "event_trace_scheduler.h"
 
 using namespace ns3;
 using namespace std::string_literals;
@@ -43,16 +49,16 @@ enum GroundNodes
     AP = 1,
   };
 
+// the drones swing towards the AP (AllocatePositionsForDrones)
+constexpr double PENDULUM_PERIOD_S = 10;
+constexpr double APPROACH_RATIO = 0.6;
+
 struct WifiTestArgs
 {
   Time simulationTime;
 
 };
 
-static auto SERVER_BANDWIDTH = "1000Mbps"s;
-static std::size_t NUM_UAVS = 40;
-static Time SIMUL_TIME = Seconds(120);
-
 static NetDeviceContainer
 InstallP2P(NodeContainer& Nodes)
 {
@@ -67,7 +73,21 @@ SettingWifi(Ptr<Node> apNode, NodeContainer& staNodes)
 {
   auto channel = YansWifiChannelHelper::Default();
   auto phy = YansWifiPhyHelper();
-  phy.SetChannel(channel.Create());
+  auto wifiChannel = channel.Create();
+  if (SPATIAL_INDEX)
+    {
+      // PendulumMobility notifies no course change: bound the speed of the
+      // drones, the highest for those at the edge of the disc
+      auto const maxSpeed = 2 * M_PI / PENDULUM_PERIOD_S * APPROACH_RATIO * SWARM_RADIUS;
+      wifiChannel->SetAttribute("SpatialIndex", BooleanValue(true));
+      wifiChannel->SetAttribute("MaxSpeed", DoubleValue(maxSpeed));
+    }
+  if (PROPAGATION_CACHE >= 0)
+    {
+      wifiChannel->SetAttribute("PropagationCache", BooleanValue(true));
+      wifiChannel->SetAttribute("CacheTolerance", DoubleValue(PROPAGATION_CACHE));
+    }
+  phy.SetChannel(wifiChannel);
 
   WifiMacHelper mac;
   auto ssid = Ssid("ns-3-ssid");
@@ -82,8 +102,21 @@ SettingWifi(Ptr<Node> apNode, NodeContainer& staNodes)
   auto apDevices = wifi.Install(phy, mac, apNode);
 
   // generate pcap file
-  phy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
-  phy.EnablePcap(PCAP_NAME, apDevices.Get(0));
+  // (forked variants would share the file, so no capture in fork mode)
+  if (ENABLE_PCAP && FORK_VARIANTS.empty())
+    {
+      phy.SetPcapDataLinkType(WifiPhyHelper::DLT_IEEE802_11_RADIO);
+      if (!PCAP_FILTER.empty() || PCAP_SNAPLEN >= 0 || PCAP_MAX_SIZE > 0)
+        {
+          auto const snapLen =
+            PCAP_SNAPLEN < 0 ? UINT32_MAX : static_cast<uint32_t>(PCAP_SNAPLEN);
+          phy.SetBufferedPcap("Filter", StringValue(PCAP_FILTER),
+                              "PayloadSnapLen", UintegerValue(snapLen),
+                              "MaxFileSize", UintegerValue(PCAP_MAX_SIZE),
+                              "MaxFiles", UintegerValue(PCAP_MAX_FILES));
+        }
+      phy.EnablePcap(PCAP_NAME, apDevices.Get(0));
+    }
 
   return {apDevices, staDevices};
 }
@@ -94,13 +127,14 @@ AllocatePositionsForDrones(NodeContainer& staNodes)
   // for drones
   MobilityHelper mobility;
   mobility.SetPositionAllocator("ns3::UniformDiscPositionAllocator", "rho",
-                                DoubleValue(30), "X", DoubleValue(50),
+                                DoubleValue(SWARM_RADIUS), "X", DoubleValue(50),
                                 "Y", DoubleValue(50));
   // mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
   mobility.SetMobilityModel("ns3::PendulumMobility",
-                            "Period", TimeValue(Seconds(10)),
-                            "ApproachRatio", DoubleValue(0.6),
-                            "Destination", VectorValue(Vector {50, 50, 0}));
+                            "Period", TimeValue(Seconds(PENDULUM_PERIOD_S)),
+                            "ApproachRatio", DoubleValue(APPROACH_RATIO),
+                            "Destination", VectorValue(Vector {50, 50, 0}),
+                            "Batch", BooleanValue(BATCH_MOBILITY));
   mobility.Install(staNodes);
 }
 
@@ -129,6 +163,7 @@ InstallCoAPServer(Ptr<Node> server, Time start = Seconds(0), Time end = SIMUL_TI
 {
   CoAPServerHelper installer;
   installer.SetAttribute("RemotePort", UintegerValue(19574));
+  installer.SetAttribute("CoalesceRecv", BooleanValue(COALESCE_RECV));
   auto server_app = installer.Install(server);
   server_app.Start(start);
   server_app.Stop(end);
@@ -173,7 +208,43 @@ InstallTcpOnOff(NodeContainer &nodes, Address dest, Time start = Seconds(1),
 }
 
 
-void WifiTest()
+// flows are told apart by the sender node of the packet provenance
+static void
+RecordFairness(Ptr<FairnessAnalyzer> analyzer, Ptr<const Packet> packet)
+{
+  const PacketProvenance& provenance = packet->GetProvenance();
+  if (provenance.IsSet())
+    {
+      analyzer->NotifyRx(provenance.GetNodeId(), packet->GetSize());
+    }
+}
+
+// the Wi-Fi link, not the p2p link to the server, is the bottleneck: its
+// capacity is the highest PHY rate of the device (long guard interval)
+static uint64_t
+GetWifiLinkRate(Ptr<NetDevice> device)
+{
+  auto phy = DynamicCast<WifiNetDevice>(device)->GetPhy();
+  auto width = phy->GetChannelWidth();
+  auto nss = phy->GetMaxSupportedTxSpatialStreams();
+  auto modes = phy->GetMcsList();
+  if (modes.empty())
+    {
+      modes = phy->GetModeList();
+    }
+  uint64_t rate = 0;
+  for (const auto& mode : modes)
+    {
+      if (mode.IsAllowed(width, nss))
+        {
+          rate = std::max(rate, mode.GetDataRate(width, 800, nss));
+        }
+    }
+  return rate;
+}
+
+static void
+PrintProtocol()
 {
   if (UseFDP)
     {
@@ -183,6 +254,81 @@ void WifiTest()
     {
       std::cout << "CoAP Test\n";
     }
+}
+
+// the trace collectors write into ./error/ and ./log/
+static void
+MakeTraceDirectories()
+{
+  SystemPath::MakeDirectories("error");
+  SystemPath::MakeDirectories("log");
+}
+
+// continue with another substream after the snapshot
+static void
+ReassignStreams(uint32_t run, NodeContainer nodes, NetDeviceContainer wifiDevices)
+{
+  RngSeedManager::SetRun(run);
+  int64_t stream = 0;
+  stream += WifiHelper().AssignStreams(wifiDevices, stream);
+  stream += MobilityHelper().AssignStreams(nodes, stream);
+  InternetStackHelper().AssignStreams(nodes, stream);
+}
+
+// FORK_VARIANTS: "protocol[:run],..."
+static void
+AddForkVariants(WarmStartHelper& warmStart, NodeContainer nodes,
+                NetDeviceContainer wifiDevices)
+{
+  std::istringstream variants{FORK_VARIANTS};
+  std::string variant;
+  while (std::getline(variants, variant, ','))
+    {
+      if (variant.empty())
+        {
+          continue;
+        }
+      auto const colon = variant.find(':');
+      auto const protocol = variant.substr(0, colon);
+      NS_ABORT_MSG_IF(protocol != "fdp" && protocol != "cocoa",
+                      "unknown protocol in ForkVariants: " << protocol);
+      auto const useFdp = protocol == "fdp";
+
+      if (colon == std::string::npos)
+        {
+          warmStart.AddVariant(protocol, [useFdp]() {
+            UseFDP = useFdp;
+            PrintProtocol();
+            MakeTraceDirectories();
+          });
+          continue;
+        }
+
+      auto const run = static_cast<uint32_t>(std::stoul(variant.substr(colon + 1)));
+      warmStart.AddVariant(protocol + "-run" + std::to_string(run),
+                           [useFdp, run, nodes, wifiDevices]() {
+        UseFDP = useFdp;
+        PrintProtocol();
+        MakeTraceDirectories();
+        ReassignStreams(run, nodes, wifiDevices);
+      });
+    }
+  warmStart.SetMaxParallel(FORK_JOBS);
+}
+
+void WifiTest()
+{
+  if (!EVENT_TRACE.empty())
+    {
+      ObjectFactory scheduler("ns3::EventTraceScheduler",
+                              "FileName", StringValue(EVENT_TRACE));
+      Simulator::SetScheduler(scheduler);
+    }
+  WarmStartHelper warmStart;
+  if (FORK_VARIANTS.empty())
+    {
+      PrintProtocol();
+    }
   // wired part
   auto p2pNodes = NodeContainer{2};
   auto p2pDevices = InstallP2P(p2pNodes);
@@ -201,7 +347,15 @@ void WifiTest()
   address.SetBase("10.1.1.0", "255.255.255.0");
   auto p2pInterfaces = address.Assign(p2pDevices);
 
-  address.SetBase("10.1.3.0", "255.255.255.0");
+  // a /24 only holds 253 UAVs besides the AP
+  if (NUM_UAVS < 254)
+    {
+      address.SetBase("10.1.3.0", "255.255.255.0");
+    }
+  else
+    {
+      address.SetBase("10.3.0.0", "255.255.0.0");
+    }
   address.Assign(staDevices);
   address.Assign(apDevices);
 
@@ -210,7 +364,9 @@ void WifiTest()
   const auto serverAddress = InetSocketAddress{serverIpv4, serverPort};
 
   auto coap_server = InstallCoAPServer(p2pNodes.Get(GroundNodes::GC));
-  auto coap_clients = InstallCoAPClient(wifiStaNodes, serverAddress);
+  // the protocols only differ once the clients start
+  auto const clientStart = std::max(Seconds(0.1), WARMUP_TIME);
+  auto coap_clients = InstallCoAPClient(wifiStaNodes, serverAddress, clientStart);
 
   if (SendTCP)
     {
@@ -244,10 +400,52 @@ void WifiTest()
                                             &latencyRecoder));
   }
 
+  auto fairness = CreateObject<FairnessAnalyzer>();
+  if (!FAIRNESS_FILE.empty() || STOP_ON_FAIRNESS)
+    {
+      fairness->SetAttribute("OutputFile", StringValue(FAIRNESS_FILE));
+      fairness->SetAttribute("Capacity",
+                             DoubleValue(FAIRNESS_CAPACITY.empty()
+                                         ? GetWifiLinkRate(apDevices.Get(0))
+                                         : DataRate(FAIRNESS_CAPACITY).GetBitRate()));
+      fairness->SetAttribute("StopOnConvergence", BooleanValue(STOP_ON_FAIRNESS));
+
+      std::ostringstream oss;
+      oss << "/NodeList/" << p2pNodes.Get(GroundNodes::GC)->GetId()
+          << "/ApplicationList/*/$ns3::CoAPServer/PacketReceived";
+      Config::ConnectWithoutContext(oss.str(), MakeBoundCallback(&RecordFairness, fairness));
+      // started with the clients, so forked variants open their own file
+      Simulator::Schedule(clientStart, &FairnessAnalyzer::Start, fairness);
+    }
+
 
   Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
-  Simulator::Stop(SIMUL_TIME);
+  AddForkVariants(warmStart, NodeContainer{p2pNodes, wifiStaNodes},
+                  NetDeviceContainer{apDevices, staDevices});
+  if (warmStart.Fork(WARMUP_TIME) == WarmStartHelper::PARENT)
+    {
+      warmStart.PrintReport(std::cout);
+      // the parent holds the state of the warm-up only, so it must not run
+      // the destructors of the scenario (they would write partial results)
+      std::exit(warmStart.GetNFailed() == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+  Simulator::Stop(SIMUL_TIME - Simulator::Now());
   Simulator::Run();
+  // simulator cost, compare with --EventPooling=false
+  std::cout << "events: " << EventImpl::GetNAllocated() << " allocated, "
+            << EventImpl::GetNHeapAllocated() << " from the heap ("
+            << EventImpl::GetNHeapAllocated() / Simulator::Now().GetSeconds()
+            << " per simulated second), "
+            << Simulator::GetEventCount() << " executed" << std::endl;
+  if (PROPAGATION_CACHE >= 0)
+    {
+      auto channel = DynamicCast<YansWifiChannel>(apDevices.Get(0)->GetChannel());
+      auto const lookups = channel->GetNCacheHits() + channel->GetNCacheMisses();
+      std::cout << "propagation cache: " << channel->GetNCacheHits() << " hits in "
+                << lookups << " lookups (" << 100.0 * channel->GetNCacheHits() / std::max<uint64_t>(lookups, 1)
+                << "%)" << std::endl;
+    }
   Simulator::Destroy();
 }
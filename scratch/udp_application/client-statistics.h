@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Chang-Hui Kim <kch9001@gmail.com>
+ */
+#pragma once
+#ifndef CLIENT_STATISTICS_H
+#define CLIENT_STATISTICS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "ns3/address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/nstime.h"
+
+namespace ns3
+{
+  // one client of a server, as seen by trace sinks
+  struct ClientStatisticsRecord
+  {
+    Address address;
+    uint64_t packets{0};
+    uint64_t bytes{0};
+    uint64_t nacks{0};  // NACKs sent to the client
+    uint64_t resets{0}; // RESETs (health probes) sent to the client
+    uint64_t gaps{0};   // received sequences that did not match the expected one
+    Time interArrivalMean{0};
+    double interArrivalVariance{0}; // seconds^2
+    Time lastSeen{0};
+  };
+
+  // Per client counters of a server, stored as struct of arrays.
+  // Every counter is a dense vector indexed by the slot the connection
+  // got from Add(), so updating one field touches one cache line and a
+  // snapshot streams through each column.
+  class ClientStatistics
+  {
+  public:
+    std::size_t Add(Address const &address)
+    {
+      m_address.push_back(address);
+      m_packets.push_back(0);
+      m_bytes.push_back(0);
+      m_nacks.push_back(0);
+      m_resets.push_back(0);
+      m_gaps.push_back(0);
+      m_lastSeen.push_back(0);
+      m_interArrivalMean.push_back(0);
+      m_interArrivalM2.push_back(0);
+      return m_address.size() - 1;
+    }
+
+    std::size_t GetN() const
+    {
+      return m_address.size();
+    }
+
+    void Clear()
+    {
+      m_address.clear();
+      m_packets.clear();
+      m_bytes.clear();
+      m_nacks.clear();
+      m_resets.clear();
+      m_gaps.clear();
+      m_lastSeen.clear();
+      m_interArrivalMean.clear();
+      m_interArrivalM2.clear();
+    }
+
+    void NotifyReceive(std::size_t i, uint32_t bytes, Time now)
+    {
+      auto const packets = ++m_packets[i];
+      m_bytes[i] += bytes;
+      if (packets > 1)
+        {
+          // Welford's online mean and variance of the inter-arrival time
+          auto const interval = (now - TimeStep(m_lastSeen[i])).GetSeconds();
+          auto const n = static_cast<double>(packets - 1);
+          auto const delta = interval - m_interArrivalMean[i];
+          m_interArrivalMean[i] += delta / n;
+          m_interArrivalM2[i] += delta * (interval - m_interArrivalMean[i]);
+        }
+      m_lastSeen[i] = now.GetTimeStep();
+    }
+
+    void NotifyNack(std::size_t i)
+    {
+      ++m_nacks[i];
+    }
+
+    void NotifyReset(std::size_t i)
+    {
+      ++m_resets[i];
+    }
+
+    void NotifyGap(std::size_t i)
+    {
+      ++m_gaps[i];
+    }
+
+    ClientStatisticsRecord Get(std::size_t i) const
+    {
+      ClientStatisticsRecord record;
+      record.address = m_address[i];
+      record.packets = m_packets[i];
+      record.bytes = m_bytes[i];
+      record.nacks = m_nacks[i];
+      record.resets = m_resets[i];
+      record.gaps = m_gaps[i];
+      record.interArrivalMean = Seconds(m_interArrivalMean[i]);
+      record.interArrivalVariance =
+        m_packets[i] > 2 ? m_interArrivalM2[i] / (m_packets[i] - 2) : 0;
+      record.lastSeen = TimeStep(m_lastSeen[i]);
+      return record;
+    }
+
+    static void WriteCsvHeader(std::ostream &os)
+    {
+      os << "Time(s),Client,Packets,Bytes,Nacks,Resets,Gaps,"
+         << "IatMean(s),IatVariance(s^2),LastSeen(s)\n";
+    }
+
+    // one row per client
+    void WriteCsv(std::ostream &os, Time now) const
+    {
+      for (std::size_t i = 0; i < GetN(); ++i)
+        {
+          auto const record = Get(i);
+          os << now.GetSeconds() << ',';
+          if (InetSocketAddress::IsMatchingType(record.address))
+            {
+              auto const inet = InetSocketAddress::ConvertFrom(record.address);
+              os << inet.GetIpv4() << ':' << inet.GetPort();
+            }
+          else if (Inet6SocketAddress::IsMatchingType(record.address))
+            {
+              auto const inet6 = Inet6SocketAddress::ConvertFrom(record.address);
+              os << '[' << inet6.GetIpv6() << "]:" << inet6.GetPort();
+            }
+          else
+            {
+              os << record.address;
+            }
+          os << ',' << record.packets << ',' << record.bytes
+             << ',' << record.nacks << ',' << record.resets << ',' << record.gaps
+             << ',' << record.interArrivalMean.GetSeconds()
+             << ',' << record.interArrivalVariance
+             << ',' << record.lastSeen.GetSeconds() << '\n';
+        }
+    }
+
+  private:
+    std::vector<Address> m_address;
+    std::vector<uint64_t> m_packets;
+    std::vector<uint64_t> m_bytes;
+    std::vector<uint64_t> m_nacks;
+    std::vector<uint64_t> m_resets;
+    std::vector<uint64_t> m_gaps;
+    std::vector<int64_t> m_lastSeen; // time steps
+    std::vector<double> m_interArrivalMean; // seconds
+    std::vector<double> m_interArrivalM2;
+  };
+}
+
+#endif /* CLIENT_STATISTICS_H */
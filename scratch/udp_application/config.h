@@ -16,6 +16,9 @@
  * Author: Chang-Hui Kim <kch9001@gmail.com>
  */
 
+#ifndef UDP_APPLICATION_CONFIG_H
+#define UDP_APPLICATION_CONFIG_H
+
 #include <cstdint>
 
 namespace ns3
@@ -33,3 +36,5 @@ namespace ns3
     };
   constexpr static target_protocol TARGET_PROTO = UDP;
 }
+
+#endif /* UDP_APPLICATION_CONFIG_H */
@@ -18,11 +18,17 @@
 
 #include "config.h"
 #include "fdp-client-server-helper.h"
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+
 #include "ns3/application-container.h"
 #include "ns3/applications-module.h"
 #include "ns3/command-line.h"
 #include "ns3/core-module.h"
 #include "ns3/double.h"
+#include "ns3/fairness-analyzer.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-module.h"
 #include "ns3/log.h"
@@ -40,6 +46,7 @@
 #include "ns3/string.h"
 #include "ns3/udp-client-server-helper.h"
 #include "ns3/udp-client.h"
+#include "ns3/warm-start-helper.h"
 #include "ns3/wifi-module.h"
 
 #include "config.h"
@@ -61,6 +68,167 @@ enum SpecialNodes {
   P2P_SERVER = 1,
 };
 
+// per-protocol bytes delivered to the server's transport layer
+class ServerRxSummary
+{
+public:
+  void OnLocalDeliver (Ipv4Header const &header, Ptr<Packet const> packet, u32)
+  {
+    auto &counter = _counters[header.GetProtocol ()];
+    counter.packets += 1;
+    counter.bytes += packet->GetSize ();
+    if (header.GetProtocol () == 17)
+      {
+        _uplink.Add (packet);
+      }
+  }
+
+  // UDP datagrams delivered to the stations, i.e. the FDP feedback
+  void OnStationDeliver (Ipv4Header const &header, Ptr<Packet const> packet, u32)
+  {
+    if (header.GetProtocol () == 17)
+      {
+        _downlink.Add (packet);
+      }
+  }
+
+  void Write (::std::string const &path, f64 seconds) const
+  {
+    auto summary = ::std::ofstream{path};
+    summary << "Metric,Value\n";
+    for (auto const &[protocol, name] : {::std::pair{17_u8, "udp"}, ::std::pair{6_u8, "tcp"}})
+      {
+        auto const iter = _counters.find (protocol);
+        auto const counter = iter == _counters.end () ? Counter{} : iter->second;
+        summary << name << "_rx_packets," << counter.packets << '\n'
+                << name << "_rx_bytes," << counter.bytes << '\n'
+                << name << "_goodput_mbps," << counter.bytes * 8 / seconds / 1e6 << '\n';
+      }
+    _uplink.Write (summary, "udp_uplink");
+    _downlink.Write (summary, "udp_downlink");
+    // simulator cost, compare with --EventPooling=false
+    auto const heapEvents = EventImpl::GetNHeapAllocated ();
+    summary << "events_allocated," << EventImpl::GetNAllocated () << '\n'
+            << "events_heap_allocated," << heapEvents << '\n'
+            << "events_heap_per_second," << heapEvents / seconds << '\n';
+  }
+
+private:
+  struct Counter
+  {
+    u64 packets = 0;
+    u64 bytes = 0;
+  };
+
+  // one-way latency of the datagrams stamped by StampProvenance
+  struct Latency
+  {
+    u64 packets = 0;
+    f64 sum = 0;
+    f64 max = 0;
+
+    void Add (Ptr<Packet const> packet)
+    {
+      auto const &provenance = packet->GetProvenance ();
+      if (provenance.IsSet ())
+        {
+          auto const latency = (Simulator::Now () - provenance.GetCreationTime ()).GetSeconds () * 1e3;
+          packets += 1;
+          sum += latency;
+          max = ::std::max (max, latency);
+        }
+    }
+
+    void Write (::std::ostream &summary, char const *name) const
+    {
+      summary << name << "_latency_mean_ms," << (packets == 0 ? 0 : sum / packets) << '\n'
+              << name << "_latency_max_ms," << max << '\n';
+    }
+  };
+
+  ::std::map<u8, Counter> _counters;
+  Latency _uplink;
+  Latency _downlink;
+};
+
+// stamps the UDP datagrams with their origin when they leave the IP layer
+// of the sender, the provenance follows the packet to the receiver
+static void StampProvenance (Ipv4Header const &header, Ptr<Packet const> packet, u32)
+{
+  if (header.GetProtocol () == 17 && !packet->GetProvenance ().IsSet ())
+    {
+      packet->SetProvenance (PacketProvenance{Simulator::GetContext (), 0, packet->GetUid (), Simulator::Now ()});
+    }
+}
+
+// airtime of the PPDUs sent by the AP to each station
+class AirtimeSummary
+{
+public:
+  void OnAirtime (Mac48Address station, Time airtime)
+  {
+    _airtime[station] += airtime;
+  }
+
+  void Write (::std::string const &path) const
+  {
+    auto total = Time{0};
+    for (auto const &[station, airtime] : _airtime)
+      {
+        total += airtime;
+      }
+    auto out = ::std::ofstream{path};
+    out << "Station,Airtime_s,Share\n";
+    for (auto const &[station, airtime] : _airtime)
+      {
+        out << station << ',' << airtime.GetSeconds () << ',' << airtime.GetSeconds () / total.GetSeconds () << '\n';
+      }
+  }
+
+private:
+  ::std::map<Mac48Address, Time> _airtime;
+};
+
+
+// flows are told apart by the client's IPv4 address
+static void RecordFairness (Ptr<FairnessAnalyzer> analyzer, Ptr<Packet const> packet, Address const &from)
+{
+  if (InetSocketAddress::IsMatchingType (from))
+    {
+      analyzer->NotifyRx (InetSocketAddress::ConvertFrom (from).GetIpv4 ().Get (), packet->GetSize ());
+    }
+}
+
+static void RecordUdpFairness (Ptr<FairnessAnalyzer> analyzer, Ptr<Packet const> packet, Address const &from,
+                               Address const &)
+{
+  RecordFairness (analyzer, packet, from);
+}
+
+
+// the Wi-Fi link, not the p2p link to the server, is the bottleneck: its
+// capacity is the highest PHY rate of the device (long guard interval)
+static u64 GetWifiLinkRate (Ptr<NetDevice> device)
+{
+  auto const phy = DynamicCast<WifiNetDevice> (device)->GetPhy ();
+  auto const width = phy->GetChannelWidth ();
+  auto const nss = phy->GetMaxSupportedTxSpatialStreams ();
+  auto modes = phy->GetMcsList ();
+  if (modes.empty ())
+    {
+      modes = phy->GetModeList ();
+    }
+  auto rate = 0_u64;
+  for (auto const &mode : modes)
+    {
+      if (mode.IsAllowed (width, nss))
+        {
+          rate = ::std::max (rate, mode.GetDataRate (width, 800, nss));
+        }
+    }
+  return rate;
+}
+
 
 int main (int argc, char *argv[])
 {
@@ -70,14 +238,51 @@ int main (int argc, char *argv[])
   auto PROTOCOL = "udp"s;
   auto SERVER_BANDWIDTH = "1000Mbps"s;
   auto NUM_UAVS = UAV_NUM;
+  auto SEND_TCP = true;
+  auto PCAP = true;
+  auto PCAP_FILTER = ""s;
+  auto PCAP_SNAPLEN = -1_i64;
+  auto PCAP_MAX_SIZE = 0_u64;
+  auto PCAP_MAX_FILES = 0_u32;
+  auto SUMMARY = ""s;
+  auto WARMUP = 0.0;
+  auto FORK = ""s;
+  auto FORK_JOBS = 0_u32;
+  auto CLIENT_STATS = ""s;
+  auto STATS_INTERVAL = 1.0;
+  auto FAIRNESS = ""s;
+  auto STOP_ON_FAIRNESS = false;
+  auto FAIRNESS_CAPACITY = ""s;
+  auto AIRTIME_FAIRNESS = false;
+  auto AIRTIME = ""s;
 
   auto cmd = CommandLine{__FILE__};
   cmd.AddValue ("protocol", "", PROTOCOL);
   cmd.AddValue ("server_bandwidth", "", SERVER_BANDWIDTH);
   cmd.AddValue ("uavs", "", NUM_UAVS);
   cmd.AddValue ("simul_time", "", SIMUL_TIME);
+  cmd.AddValue ("tcp", "install TCP OnOff cross traffic", SEND_TCP);
+  cmd.AddValue ("pcap", "capture radiotap pcap on the AP", PCAP);
+  cmd.AddValue ("pcap_filter", "capture only these packets, e.g. \"udp port 19574\" (buffered capture)", PCAP_FILTER);
+  cmd.AddValue ("pcap_snaplen", "payload bytes kept behind the headers, -1: all (buffered capture)", PCAP_SNAPLEN);
+  cmd.AddValue ("pcap_max_size", "bytes per pcap file before rotating, 0: one file (buffered capture)", PCAP_MAX_SIZE);
+  cmd.AddValue ("pcap_max_files", "pcap files kept in the ring, 0: all (buffered capture)", PCAP_MAX_FILES);
+  cmd.AddValue ("summary", "write server side rx summary (csv) to this file", SUMMARY);
+  cmd.AddValue ("client_stats", "write per client statistics of the FDP server (csv) to this file", CLIENT_STATS);
+  cmd.AddValue ("stats_interval", "seconds between two client statistics snapshots", STATS_INTERVAL);
+  cmd.AddValue ("fairness", "write the online fairness time series (csv) to this file", FAIRNESS);
+  cmd.AddValue ("fairness_capacity", "capacity the utilization is measured against, e.g. \"100Mbps\" (default: highest PHY rate of the AP)", FAIRNESS_CAPACITY);
+  cmd.AddValue ("stop_on_fairness", "stop once the Jain's index of the UAV flows converged", STOP_ON_FAIRNESS);
+  cmd.AddValue ("airtime_fairness", "schedule the AP downlink by airtime deficit round robin", AIRTIME_FAIRNESS);
+  cmd.AddValue ("airtime", "write the airtime share of each station in the AP downlink (csv) to this file", AIRTIME);
+  cmd.AddValue ("warmup", "seconds shared by the forked variants", WARMUP);
+  cmd.AddValue ("fork", "fork these variants after the warm-up, e.g. \"udp:1,fdp:1\" (protocol[:RngRun])", FORK);
+  cmd.AddValue ("fork_jobs", "maximum number of variants running at once (0: all)", FORK_JOBS);
   cmd.Parse (argc, argv);
 
+  // measures the setup time shared by the variants
+  auto warmStart = WarmStartHelper{};
+
   {
     constexpr auto ALLOWED_PROTOCOLS = ::std::array{"udp", "fdp"};
     if (::std::all_of (ALLOWED_PROTOCOLS.begin (), ALLOWED_PROTOCOLS.end (),
@@ -116,6 +321,18 @@ int main (int argc, char *argv[])
   mac.SetType ("ns3::ApWifiMac", "Ssid", SsidValue (ssid));
   auto apDevices = wifi.Install (phy, mac, wifiApNode);
 
+  auto airtimeSummary = AirtimeSummary{};
+  for (auto const ac : {"BE_Txop", "BK_Txop", "VI_Txop", "VO_Txop"})
+    {
+      auto const path = "/NodeList/" + ::std::to_string (wifiApNode->GetId ()) +
+                        "/DeviceList/*/$ns3::WifiNetDevice/Mac/" + ac + "/";
+      Config::Set (path + "AirtimeFairness", BooleanValue (AIRTIME_FAIRNESS));
+      if (!AIRTIME.empty ())
+        {
+          Config::ConnectWithoutContext (path + "Airtime", MakeCallback (&AirtimeSummary::OnAirtime, &airtimeSummary));
+        }
+    }
+
   // mobility for stas
   MobilityHelper mobility;
   mobility.SetPositionAllocator ("ns3::UniformDiscPositionAllocator", "rho", DoubleValue (10.0), "X", DoubleValue (50),
@@ -156,66 +373,178 @@ int main (int argc, char *argv[])
   // Setup UDP clients and server
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-  if (PROTOCOL == "fdp")
-    {
-      // LogComponentEnable ("FdpClient", LOG_LEVEL_INFO);
-      // LogComponentEnable ("FdpServer", LOG_LEVEL_INFO);
+  // everything that differs between the protocols, run at Seconds (0)
+  // or, with forked variants, in each child right after the warm-up
+  auto fairness = CreateObject<FairnessAnalyzer> ();
+  fairness->SetAttribute ("OutputFile", StringValue (FAIRNESS));
+  fairness->SetAttribute ("Capacity", DoubleValue (FAIRNESS_CAPACITY.empty () ? GetWifiLinkRate (apDevices.Get (0))
+                                                                               : DataRate (FAIRNESS_CAPACITY).GetBitRate ()));
+  fairness->SetAttribute ("StopOnConvergence", BooleanValue (STOP_ON_FAIRNESS));
+  auto const analyzeFairness = !FAIRNESS.empty () || STOP_ON_FAIRNESS;
+
+  auto const startProtocol = [&] () {
+    auto const clientStart = ::std::max (Seconds (1) - Simulator::Now (), Seconds (0));
+    auto const serverPath = "/NodeList/" + ::std::to_string (p2pNodes.Get (SpecialNodes::P2P_SERVER)->GetId ()) +
+                            "/ApplicationList/*/";
+
+    if (PROTOCOL == "fdp")
+      {
+        // LogComponentEnable ("FdpClient", LOG_LEVEL_INFO);
+        // LogComponentEnable ("FdpServer", LOG_LEVEL_INFO);
+
+        FdpServerHelper server;
+        if (!CLIENT_STATS.empty ())
+          {
+            server.SetAttribute ("SnapshotInterval", TimeValue (Seconds (STATS_INTERVAL)));
+            server.SetAttribute ("SnapshotFile", StringValue (CLIENT_STATS));
+          }
+        auto server_app = server.Install(p2pNodes.Get(SpecialNodes::P2P_SERVER));
+        server_app.Start(Seconds(0));
+
+
+        FdpClientHelper client{serverAddress};
+        client.SetAttribute("MinInterval", TimeValue(MilliSeconds(1)));
+        client.SetAttribute("MaxInterval", TimeValue(MilliSeconds(50)));
+        auto client_apps = client.Install(wifiStaNodes);
+        client_apps.Start(clientStart);
+
+        if (analyzeFairness)
+          {
+            Config::ConnectWithoutContext (serverPath + "$ns3::FdpServer/Rx",
+                                           MakeBoundCallback (&RecordFairness, fairness));
+          }
+      }
+    else // if (PROTOCOL == "udp")
+      {
+        UdpServerHelper udpServerHelper{serverPort};
+        auto udpServer = udpServerHelper.Install(p2pNodes.Get(SpecialNodes::P2P_SERVER));
+        udpServer.Start(Seconds(0));
+
+        uint32_t max_packet_size = 1024;
+        UdpClientHelper udpClientHelper{serverIpv4, serverPort};
+        udpClientHelper.SetAttribute ("MaxPackets", UintegerValue (UINT32_MAX));
+        udpClientHelper.SetAttribute ("Interval", TimeValue (MilliSeconds (1)));
+        udpClientHelper.SetAttribute ("PacketSize", UintegerValue (max_packet_size));
+
+        auto udpClients = udpClientHelper.Install(wifiStaNodes);
+        udpClients.Start(clientStart);
+
+        if (analyzeFairness)
+          {
+            Config::ConnectWithoutContext (serverPath + "$ns3::UdpServer/RxWithAddresses",
+                                           MakeBoundCallback (&RecordUdpFairness, fairness));
+          }
+      }
 
-      FdpServerHelper server;
-      auto server_app = server.Install(p2pNodes.Get(SpecialNodes::P2P_SERVER));
-      server_app.Start(Seconds(0));
+    if (analyzeFairness)
+      {
+        Simulator::Schedule (clientStart, &FairnessAnalyzer::Start, fairness);
+      }
 
+    // generate trace file
+    // p2pHelper.EnablePcapAll (PROTOCOL);
+    if (PCAP)
+      {
+        phy.SetPcapDataLinkType (WifiPhyHelper::DLT_IEEE802_11_RADIO);
+        if (!PCAP_FILTER.empty () || PCAP_SNAPLEN >= 0 || PCAP_MAX_SIZE > 0)
+          {
+            auto const snapLen = PCAP_SNAPLEN < 0 ? UINT32_MAX : static_cast<u32> (PCAP_SNAPLEN);
+            phy.SetBufferedPcap ("Filter", StringValue (PCAP_FILTER),
+                                 "PayloadSnapLen", UintegerValue (snapLen),
+                                 "MaxFileSize", UintegerValue (PCAP_MAX_SIZE),
+                                 "MaxFiles", UintegerValue (PCAP_MAX_FILES));
+          }
+        phy.EnablePcap (PROTOCOL, apDevices.Get (SpecialNodes::WIFI_AP));
+      }
+  };
 
-      FdpClientHelper client{serverAddress};
-      client.SetAttribute("MinInterval", TimeValue(MilliSeconds(1)));
-      client.SetAttribute("MaxInterval", TimeValue(MilliSeconds(50)));
-      auto client_apps = client.Install(wifiStaNodes);
-      client_apps.Start(Seconds(1));
-    }
-  else // if (PROTOCOL == "udp")
+  if (SEND_TCP)
     {
-      UdpServerHelper udpServerHelper{serverPort};
-      auto udpServer = udpServerHelper.Install(p2pNodes.Get(SpecialNodes::P2P_SERVER));
-      udpServer.Start(Seconds(0));
-
-      uint32_t max_packet_size = 1024;
-      UdpClientHelper udpClientHelper{serverIpv4, serverPort};
-      udpClientHelper.SetAttribute ("MaxPackets", UintegerValue (UINT32_MAX));
-      udpClientHelper.SetAttribute ("Interval", TimeValue (MilliSeconds (1)));
-      udpClientHelper.SetAttribute ("PacketSize", UintegerValue (max_packet_size));
-
-      auto udpClients = udpClientHelper.Install(wifiStaNodes);
-      udpClients.Start(Seconds(1));
+      auto tcpServerHelper = PacketSinkHelper{"ns3::TcpSocketFactory", serverAddress};
+      auto tcpServerApp = tcpServerHelper.Install (p2pNodes.Get (SpecialNodes::P2P_SERVER)).Get (0);
+      tcpServerApp->SetStartTime (Seconds (0));
+
+      // https://www.nsnam.org/doxygen/tcp-star-server_8cc_source.html
+      auto tcpClientHelper = OnOffHelper{"ns3::TcpSocketFactory", p2pInterfaces.GetAddress (SpecialNodes::P2P_SERVER)};
+      tcpClientHelper.SetAttribute ("Remote", AddressValue{serverAddress});
+      tcpClientHelper.SetAttribute("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=10]"));
+      tcpClientHelper.SetAttribute("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=10]"));
+      auto tcpClients = tcpClientHelper.Install(wifiStaNodes);
+      tcpClients.Start(Seconds(1));
     }
 
-    u32 const max_packet_size = 1024;
-    auto udpClientHelper = UdpClientHelper{serverIpv4, serverPort};
-    udpClientHelper.SetAttribute ("MaxPackets", UintegerValue (UINT32_MAX));
-    udpClientHelper.SetAttribute ("Interval", TimeValue (MilliSeconds (2)));
-    udpClientHelper.SetAttribute ("PacketSize", UintegerValue (max_packet_size));
-
-  auto tcpServerHelper = PacketSinkHelper{"ns3::TcpSocketFactory", serverAddress};
-  auto tcpServerApp = tcpServerHelper.Install (p2pNodes.Get (SpecialNodes::P2P_SERVER)).Get (0);
-  tcpServerApp->SetStartTime (Seconds (0));
-
-  // https://www.nsnam.org/doxygen/tcp-star-server_8cc_source.html
-  auto tcpClientHelper = OnOffHelper{"ns3::TcpSocketFactory", p2pInterfaces.GetAddress (SpecialNodes::P2P_SERVER)};
-  tcpClientHelper.SetAttribute ("Remote", AddressValue{serverAddress});
-  tcpClientHelper.SetAttribute("OnTime", StringValue ("ns3::ConstantRandomVariable[Constant=10]"));
-  tcpClientHelper.SetAttribute("OffTime", StringValue ("ns3::ConstantRandomVariable[Constant=10]"));
-  auto tcpClients = tcpClientHelper.Install(wifiStaNodes);
-  tcpClients.Start(Seconds(1));
-
-  // generate trace file
-  // p2pHelper.EnablePcapAll (PROTOCOL);
-  phy.SetPcapDataLinkType (WifiPhyHelper::DLT_IEEE802_11_RADIO);
-  phy.EnablePcap (PROTOCOL, apDevices.Get (SpecialNodes::WIFI_AP));
+  auto rxSummary = ServerRxSummary{};
+  if (!SUMMARY.empty ())
+    {
+      auto const path = "/NodeList/" + ::std::to_string (p2pNodes.Get (SpecialNodes::P2P_SERVER)->GetId ()) +
+                        "/$ns3::Ipv4L3Protocol/LocalDeliver";
+      Config::ConnectWithoutContext (path, MakeCallback (&ServerRxSummary::OnLocalDeliver, &rxSummary));
+      for (auto iter = wifiStaNodes.Begin (); iter != wifiStaNodes.End (); iter++)
+        {
+          Config::ConnectWithoutContext ("/NodeList/" + ::std::to_string ((*iter)->GetId ()) +
+                                         "/$ns3::Ipv4L3Protocol/LocalDeliver",
+                                         MakeCallback (&ServerRxSummary::OnStationDeliver, &rxSummary));
+        }
+      Config::ConnectWithoutContext ("/NodeList/*/$ns3::Ipv4L3Protocol/SendOutgoing", MakeCallback (&StampProvenance));
+    }
 
   Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
-  Simulator::Stop (Seconds (SIMUL_TIME));
+  // FORK: "protocol[:run],...", each variant runs in its own directory
+  auto variants = ::std::istringstream{FORK};
+  for (auto variant = ""s; ::std::getline (variants, variant, ',');)
+    {
+      if (variant.empty ())
+        {
+          continue;
+        }
+      auto const colon = variant.find (':');
+      auto const protocol = variant.substr (0, colon);
+      NS_ABORT_MSG_IF (protocol != "udp" && protocol != "fdp", "Unproper protocol name: " << protocol);
+      auto const run = colon == ::std::string::npos ? 0_u32 : static_cast<u32> (::std::stoul (variant.substr (colon + 1)));
+
+      auto const name = run == 0 ? protocol : protocol + "-run" + ::std::to_string (run);
+      warmStart.AddVariant (name, [&, protocol, run] () {
+        PROTOCOL = protocol;
+        if (run != 0)
+          {
+            // continue with another substream after the snapshot
+            RngSeedManager::SetRun (run);
+            auto const allNodes = NodeContainer{p2pNodes, wifiStaNodes};
+            auto stream = 0_i64;
+            stream += wifi.AssignStreams (NetDeviceContainer{apDevices, staDevices}, stream);
+            stream += mobility.AssignStreams (wifiStaNodes, stream);
+            stack.AssignStreams (allNodes, stream);
+          }
+        startProtocol ();
+      });
+    }
+  warmStart.SetMaxParallel (FORK_JOBS);
+
+  if (warmStart.GetNVariants () == 0)
+    {
+      startProtocol ();
+    }
+  if (warmStart.Fork (Seconds (WARMUP)) == WarmStartHelper::PARENT)
+    {
+      warmStart.PrintReport (::std::cout);
+      // the parent holds the state of the warm-up only, so it must not run
+      // the destructors of the scenario (they would write partial results)
+      ::std::exit (warmStart.GetNFailed () == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+  Simulator::Stop (Seconds (SIMUL_TIME) - Simulator::Now ());
   Simulator::Run ();
   Simulator::Destroy ();
 
+  if (!SUMMARY.empty ())
+    {
+      rxSummary.Write (SUMMARY, SIMUL_TIME);
+    }
+  if (!AIRTIME.empty ())
+    {
+      airtimeSummary.Write (AIRTIME);
+    }
+
   return 0;
 }
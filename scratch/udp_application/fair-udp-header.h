@@ -22,6 +22,7 @@
 
 #include "sequence_util.h"
 #include "ns3/header.h"
+#include "ns3/header-template.h"
 
 namespace ns3
 {
@@ -116,6 +117,19 @@ namespace ns3
       bit_field_ |= static_cast<uint32_t>(nack_seq.get()) << 8;
     }
 
+    // patch the sequence number of a header serialized into a template
+    static void SetSequence(HeaderTemplate &tmpl, sequence_t seq)
+    {
+      tmpl.SetU32(0, seq, SEQ_MASK);
+    }
+
+    // patch the NACK sequence of a header serialized into a template
+    static void SetNackSequence(HeaderTemplate &tmpl, nack_seq_t nack_seq)
+    {
+      NS_ASSERT(nack_seq.get() <= ((0x1u << 22) - 1));
+      tmpl.SetU32(0, static_cast<uint32_t>(nack_seq.get()) << 8, ((0x1u << 22) - 1) << 8);
+    }
+
     nack_seq_t GetNackSequence() const
     {
       uint32_t nack_seq = bit_field_ & ~(0x3u << 30);
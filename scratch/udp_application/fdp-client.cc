@@ -172,13 +172,12 @@ FdpClient::Send ()
   NS_ASSERT(m_sendEvent.IsExpired());
 
   // prepare for packet header and contents
-  FairUdpHeader header;
-  header.SetNackSequence(m_nack_seq);
-  header.SetSequence(m_seq++);
+  FairUdpHeader::SetNackSequence(m_header, m_nack_seq);
+  FairUdpHeader::SetSequence(m_header, m_seq++);
 
   // create packet
   Ptr<Packet> packet = Create<Packet>(m_size + sizeof(uint32_t));
-  packet->AddHeader(header);
+  packet->AddHeader(m_header);
 
   if (m_seq == 0)
     {
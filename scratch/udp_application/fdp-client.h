@@ -64,6 +64,7 @@ namespace ns3
     nack_seq_t m_nack_seq{0};
     sequence_t m_seq{0};
     bool m_reset_successed{false};
+    HeaderTemplate m_header{FairUdpHeader()}; // sequences patched per message
 
     void ReduceBandwidth();
     Time GetTransferInterval();
@@ -30,6 +30,9 @@
 #include "ns3/packet.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/trace-source-accessor.h"
 #include "fdp-server.h"
 
 using namespace ns3;
@@ -48,7 +51,34 @@ TypeId FdpServer::GetTypeId ()
                   "Server binds to this port",
                   UintegerValue(19574),
                   MakeUintegerAccessor(&FdpServer::m_port),
-                  MakeUintegerChecker<uint16_t>());
+                  MakeUintegerChecker<uint16_t>())
+    .AddAttribute("CoalesceRecv",
+                  "Handle the datagrams received at the same time in one callback",
+                  BooleanValue(false),
+                  MakeBooleanAccessor(&FdpServer::m_coalesceRecv),
+                  MakeBooleanChecker())
+    .AddAttribute("SnapshotInterval",
+                  "Period of the per client statistics snapshot (0: disabled)",
+                  TimeValue(Seconds(0)),
+                  MakeTimeAccessor(&FdpServer::m_snapshotInterval),
+                  MakeTimeChecker())
+    .AddAttribute("SnapshotFile",
+                  "Append every snapshot to this csv file (empty: no file)",
+                  StringValue(""),
+                  MakeStringAccessor(&FdpServer::m_snapshotFile),
+                  MakeStringChecker())
+    .AddTraceSource("Rx",
+                    "A packet has been received",
+                    MakeTraceSourceAccessor(&FdpServer::m_rxTrace),
+                    "ns3::Packet::AddressTracedCallback")
+    .AddTraceSource("ClientStatistics",
+                    "Statistics of a client, updated by a received packet",
+                    MakeTraceSourceAccessor(&FdpServer::m_clientStatisticsTrace),
+                    "ns3::FdpServer::ClientStatisticsCallback")
+    .AddTraceSource("StatisticsSnapshot",
+                    "Statistics of all the clients, every SnapshotInterval",
+                    MakeTraceSourceAccessor(&FdpServer::m_snapshotTrace),
+                    "ns3::FdpServer::StatisticsSnapshotCallback");
   return tid;
 }
 
@@ -68,6 +98,8 @@ void FdpServer::DoDispose()
   m_socket = 0;
   m_port = 0;
   m_connections.clear();
+  m_statistics.Clear();
+  m_snapshotEvent.Cancel();
 
   Application::DoDispose();
 }
@@ -86,6 +118,7 @@ void FdpServer::StartApplication ()
           NS_FATAL_ERROR("Failed to bind socket");
         }
     }
+  m_socket->SetAttribute("CoalesceRecvNotify", BooleanValue(m_coalesceRecv));
   m_socket->SetRecvCallback(MakeCallback(&FdpServer::HandleRecv, this));
 
   if (m_socket6 == 0)
@@ -100,7 +133,18 @@ void FdpServer::StartApplication ()
         }
     }
 
+  m_socket6->SetAttribute("CoalesceRecvNotify", BooleanValue(m_coalesceRecv));
   m_socket6->SetRecvCallback (MakeCallback (&FdpServer::HandleRecv, this));
+
+  if (!m_snapshotFile.empty() && !m_snapshotStream.is_open())
+    {
+      m_snapshotStream.open(m_snapshotFile);
+      ClientStatistics::WriteCsvHeader(m_snapshotStream);
+    }
+  if (m_snapshotInterval.IsStrictlyPositive())
+    {
+      m_snapshotEvent = Simulator::Schedule(m_snapshotInterval, &FdpServer::Snapshot, this);
+    }
 }
 
 void FdpServer::StopApplication ()
@@ -115,38 +159,88 @@ void FdpServer::StopApplication ()
     {
       m_socket->SetRecvCallback(MakeNullCallback<void, Ptr<Socket>>());
     }
+
+  // the final state of every client
+  if (m_snapshotEvent.IsRunning())
+    {
+      m_snapshotEvent.Cancel();
+      m_snapshotInterval = Seconds(0);
+      Snapshot();
+    }
+  m_snapshotStream.close();
 }
 
 void FdpServer::HandleRecv(Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_INFO("Receive MSG");
-  Ptr<Packet> packet;
-  Address from;
-  while ((packet = socket->RecvFrom(from)))
+  // drain the socket RECV_BATCH datagrams at a time
+  Ptr<UdpSocket> udp = DynamicCast<UdpSocket>(socket);
+  UdpSocket::RecvItem batch[RECV_BATCH];
+  while (uint32_t n = udp->RecvBatch(batch, RECV_BATCH))
     {
-      FairUdpHeader header;
-      packet->RemoveHeader(header);
-      auto& connection = GetConnection(from);
-
-      // strange methods, if you have no needs to calculate nack frequencies
-      // just merge does methods into connection class
-      auto feedbackType = connection.DetermineFeedback(header);
-      auto feedback = connection.GenerateFeedback(feedbackType, header);
-      if (feedback != nullptr)
+      for (uint32_t i = 0; i < n; ++i)
         {
-          socket->SendTo(feedback, 0, from);
+          Ptr<Packet> packet = batch[i].packet;
+          const Address &from = batch[i].from;
+          m_rxTrace(packet, from);
+          auto const size = packet->GetSize();
+          FairUdpHeader header;
+          packet->RemoveHeader(header);
+          auto& connection = GetConnection(from);
+          auto const index = connection.GetStatisticsIndex();
+          m_statistics.NotifyReceive(index, size, Simulator::Now());
+
+          // strange methods, if you have no needs to calculate nack frequencies
+          // just merge does methods into connection class
+          auto feedbackType = connection.DetermineFeedback(header);
+          if (feedbackType == fdp::FeedbackType::NEW_NACK)
+            {
+              m_statistics.NotifyGap(index);
+            }
+          auto feedback = connection.GenerateFeedback(feedbackType, header);
+          if (feedback != nullptr)
+            {
+              // OK is the only feedback without a packet, the others are NACKs
+              m_statistics.NotifyNack(index);
+              socket->SendTo(feedback, 0, from);
+            }
+          NotifyStatistics(index);
         }
     }
 }
 
+void FdpServer::NotifyStatistics(std::size_t index)
+{
+  if (!m_clientStatisticsTrace.IsEmpty())
+    {
+      m_clientStatisticsTrace(m_statistics.Get(index));
+    }
+}
+
+void FdpServer::Snapshot()
+{
+  NS_LOG_FUNCTION (this);
+  m_snapshotTrace(m_statistics);
+  if (m_snapshotStream.is_open())
+    {
+      m_statistics.WriteCsv(m_snapshotStream, Simulator::Now());
+      m_snapshotStream.flush();
+    }
+  if (m_snapshotInterval.IsStrictlyPositive())
+    {
+      m_snapshotEvent = Simulator::Schedule(m_snapshotInterval, &FdpServer::Snapshot, this);
+    }
+}
+
 FdpClientConnection& FdpServer::GetConnection(Address address)
 {
   NS_ASSERT(InetSocketAddress::IsMatchingType(address) ||
             Inet6SocketAddress::IsMatchingType(address));
   if (m_connections.find(address) == std::end(m_connections))
     {
-      m_connections.emplace(address, FdpClientConnection{address});
+      m_connections.emplace(address,
+                            FdpClientConnection{address, m_statistics.Add(address)});
     }
   return m_connections.at(address);
 }
@@ -168,11 +262,17 @@ FdpClientConnection::DetermineFeedback(FairUdpHeader header) const
   return fdp::FeedbackType::NEW_NACK;
 }
 
-FdpClientConnection::FdpClientConnection(Address address)
+FdpClientConnection::FdpClientConnection(Address address, std::size_t statistics)
+  : m_statistics(statistics)
 {
   NS_LOG_FUNCTION (this << address);
 }
 
+std::size_t FdpClientConnection::GetStatisticsIndex() const
+{
+  return m_statistics;
+}
+
 Ptr<Packet> FdpClientConnection::GenerateFeedback(fdp::FeedbackType ft,
                                                   FairUdpHeader header)
 {
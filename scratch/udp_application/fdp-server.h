@@ -21,14 +21,18 @@
 #ifndef FDP_SERVER_H
 #define FDP_SERVER_H
 
+#include <fstream>
 #include <unordered_map>
 #include "ns3/application.h"
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
 #include "ns3/address.h"
 #include "ns3/inet-socket-address.h"
+#include "ns3/nstime.h"
+#include "ns3/traced-callback.h"
 #include "sequence_util.h"
 #include "fair-udp-header.h"
+#include "client-statistics.h"
 
 namespace ns3
 {
@@ -51,8 +55,10 @@ namespace ns3
     // Address m_address; // only for InetSocketaddress or Inet6SocketAddress
     sequence_t m_seq{0};
     nack_seq_t m_nack_seq{0};
+    std::size_t m_statistics; // slot in FdpServer::m_statistics
   public:
-    FdpClientConnection(Address address);
+    FdpClientConnection(Address address, std::size_t statistics);
+    std::size_t GetStatisticsIndex() const;
     fdp::FeedbackType DetermineFeedback(FairUdpHeader header) const;
 
     // send nack or reset... ect
@@ -80,6 +86,10 @@ namespace ns3
     FdpServer ();
     ~FdpServer () override;
 
+    // trace signatures
+    typedef void (*ClientStatisticsCallback)(const ClientStatisticsRecord &record);
+    typedef void (*StatisticsSnapshotCallback)(const ClientStatistics &statistics);
+
   protected:
     void DoDispose () override;
 
@@ -88,9 +98,13 @@ namespace ns3
     void StopApplication () override;
 
 
+    // datagrams read by each RecvBatch in HandleRecv
+    constexpr static uint32_t RECV_BATCH = 32;
+
     void HandleRecv (Ptr<Socket> socket);
 
     uint16_t m_port{0}; // Server Port Number that it binds to
+    bool m_coalesceRecv{false}; // one receive callback per simulated time
     Ptr<Socket> m_socket{0};
     Ptr<Socket> m_socket6{0};
 
@@ -98,7 +112,19 @@ namespace ns3
 
     FdpClientConnection& GetConnection(Address address);
 
-    // XXX: Needs to add some Per Client Statistics
+    // per client statistics
+    void NotifyStatistics(std::size_t index);
+    void Snapshot();
+
+    ClientStatistics m_statistics;
+    Time m_snapshotInterval{0};
+    std::string m_snapshotFile;
+    std::ofstream m_snapshotStream;
+    EventId m_snapshotEvent;
+
+    TracedCallback<const ClientStatisticsRecord &> m_clientStatisticsTrace;
+    TracedCallback<const ClientStatistics &> m_snapshotTrace;
+    TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
   };
 }
 
@@ -1,10 +1,13 @@
 #include "fudp-application.h"
 
 #include "ns3/abort.h"
+#include "ns3/boolean.h"
 #include "ns3/callback.h"
 #include "ns3/fatal-error.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/string.h"
+#include "ns3/trace-source-accessor.h"
 #include "ns3/type-id.h"
 
 FudpApplication &FudpApplicationImpl::GetContainer ()
@@ -50,6 +53,61 @@ void FudpApplication::StopApplication ()
 ::ns3::TypeId FudpApplication::GetTypeId ()
 {
   static auto const tid =
-      ::ns3::TypeId{"ns3::FudpApplication"}.AddConstructor<FudpApplication> ().SetParent<::ns3::Application> ();
+      ::ns3::TypeId{"ns3::FudpApplication"}
+          .AddConstructor<FudpApplication> ()
+          .SetParent<::ns3::Application> ()
+          .AddAttribute ("SnapshotInterval", "Period of the per client statistics snapshot of servers (0: disabled)",
+                         ::ns3::TimeValue (::ns3::Seconds (0)),
+                         ::ns3::MakeTimeAccessor (&FudpApplication::_snapshotInterval), ::ns3::MakeTimeChecker ())
+          .AddAttribute ("SnapshotFile", "Append every snapshot to this csv file (empty: no file)",
+                         ::ns3::StringValue (""), ::ns3::MakeStringAccessor (&FudpApplication::_snapshotFile),
+                         ::ns3::MakeStringChecker ())
+          .AddAttribute ("CoalesceRecv", "Handle the datagrams received at the same time in one callback on servers",
+                         ::ns3::BooleanValue (false), ::ns3::MakeBooleanAccessor (&FudpApplication::_coalesceRecv),
+                         ::ns3::MakeBooleanChecker ())
+          .AddTraceSource ("Rx", "A packet has been received by a server",
+                           ::ns3::MakeTraceSourceAccessor (&FudpApplication::_rxTrace),
+                           "ns3::Packet::AddressTracedCallback")
+          .AddTraceSource ("ClientStatistics", "Statistics of a client, updated by a received packet",
+                           ::ns3::MakeTraceSourceAccessor (&FudpApplication::_clientStatisticsTrace),
+                           "ns3::FdpServer::ClientStatisticsCallback")
+          .AddTraceSource ("StatisticsSnapshot", "Statistics of all the clients, every SnapshotInterval",
+                           ::ns3::MakeTraceSourceAccessor (&FudpApplication::_statisticsSnapshotTrace),
+                           "ns3::FdpServer::StatisticsSnapshotCallback");
   return tid;
 }
+
+::ns3::Time FudpApplication::GetSnapshotInterval () const
+{
+  return _snapshotInterval;
+}
+
+::std::string const &FudpApplication::GetSnapshotFile () const
+{
+  return _snapshotFile;
+}
+
+bool FudpApplication::IsRecvCoalesced () const
+{
+  return _coalesceRecv;
+}
+
+bool FudpApplication::IsClientStatisticsTraced () const
+{
+  return !_clientStatisticsTrace.IsEmpty ();
+}
+
+void FudpApplication::NotifyClientStatistics (::ns3::ClientStatisticsRecord const &record)
+{
+  _clientStatisticsTrace (record);
+}
+
+void FudpApplication::NotifyStatisticsSnapshot (::ns3::ClientStatistics const &statistics)
+{
+  _statisticsSnapshotTrace (statistics);
+}
+
+void FudpApplication::NotifyRx (::ns3::Ptr<::ns3::Packet const> packet, ::ns3::Address const &from)
+{
+  _rxTrace (packet, from);
+}
@@ -20,12 +20,17 @@
 #define FUDP_APPLICATION_H
 
 #include <memory>
+#include <string>
 
 #include "ns3/application.h"
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
 #include "ns3/ptr.h"
 #include "ns3/socket.h"
+#include "ns3/traced-callback.h"
 #include "ns3/type-id.h"
 
+#include "client-statistics.h"
 #include "types.h"
 
 using FudpFeature = u32;
@@ -91,8 +96,36 @@ public:
 
   static ::ns3::TypeId GetTypeId ();
 
+  // per client statistics of servers
+  ::ns3::Time GetSnapshotInterval () const;
+
+  ::std::string const &GetSnapshotFile () const;
+
+  // one receive callback per simulated time on servers
+  bool IsRecvCoalesced () const;
+
+  bool IsClientStatisticsTraced () const;
+
+  void NotifyClientStatistics (::ns3::ClientStatisticsRecord const &);
+
+  void NotifyStatisticsSnapshot (::ns3::ClientStatistics const &);
+
+  void NotifyRx (::ns3::Ptr<::ns3::Packet const>, ::ns3::Address const &);
+
 private:
   ::std::shared_ptr<FudpApplicationImpl> _impl;
+
+  ::ns3::Time _snapshotInterval;
+
+  ::std::string _snapshotFile;
+
+  bool _coalesceRecv;
+
+  ::ns3::TracedCallback<::ns3::ClientStatisticsRecord const &> _clientStatisticsTrace;
+
+  ::ns3::TracedCallback<::ns3::ClientStatistics const &> _statisticsSnapshotTrace;
+
+  ::ns3::TracedCallback<::ns3::Ptr<::ns3::Packet const>, ::ns3::Address const &> _rxTrace;
 };
 
 template <typename T>
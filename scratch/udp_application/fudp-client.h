@@ -120,6 +120,9 @@ private:
   ::ns3::Ptr<::ns3::Socket> _socket;
 
   FudpClientState<FEATURES> _state;
+
+  // serialized header of the traffic, fields patched per message
+  ::ns3::HeaderTemplate _header{FudpHeader{}};
 };
 
 template <FudpFeature FEATURES>
@@ -194,16 +197,15 @@ void FudpClient<FEATURES>::SendTraffic ()
 {
   static auto dummyData = ::std::array<u8, 1024>{};
 
-  auto header = FudpHeader{};
-  header.SetSequence (GetState ().sequence++);
+  FudpHeader::SetSequence (_header, GetState ().sequence++);
 
   if constexpr (ContainsNackSequence (FEATURES))
     {
-      header.SetNackSequence (GetState ().nack_seq);
+      FudpHeader::SetNackSequence (_header, GetState ().nack_seq);
     }
 
   auto packet = ::ns3::Create<::ns3::Packet> (dummyData.data (), dummyData.size ());
-  packet->AddHeader (header);
+  packet->AddHeader (_header);
 
   GetSocket ().SendTo (packet, 0, ::ns3::InetSocketAddress::ConvertFrom (GetServerAddress ()));
   HandleOverflow<FEATURES> (GetState ());
@@ -24,6 +24,7 @@
 #include <iostream>
 
 #include "ns3/header.h"
+#include "ns3/header-template.h"
 
 #include "types.h"
 
@@ -136,6 +137,10 @@ class FudpHeader : public ::ns3::Header
 public:
   constexpr static u32 PROTOCOL_ID = 0x12345678;
 
+  // offsets of the fields in the serialized header
+  constexpr static u32 BITS_OFFSET = sizeof (u32);
+  constexpr static u32 NACK_SEQ_OFFSET = 2 * sizeof (u32);
+
   enum class Bit : u32 {
     NACK = 1_u32 << 31, // use enclosed sequence number in the next message
     RESET = 1_u32 << 30, // request reset sequence number to 0
@@ -170,18 +175,44 @@ public:
     return 3 * sizeof (u32);
   }
 
+  // the protocol id is stored as WriteU32 writes it, the other fields in
+  // network byte order
   void Serialize (::ns3::Buffer::Iterator buf) const override
   {
-    buf.WriteU32 (PROTOCOL_ID);
-    buf.WriteHtonU32 (_bits);
-    buf.WriteHtonU32 (_nack_seq);
+    u8 copy[3 * sizeof (u32)];
+    u8 *bytes = buf.ReserveContiguous (sizeof (copy));
+    u8 *fields = bytes != nullptr ? bytes : copy;
+    for (u32 i = 0; i < sizeof (u32); ++i)
+      {
+        fields[i] = (PROTOCOL_ID >> (8 * i)) & 0xff;
+        fields[BITS_OFFSET + i] = (_bits >> (24 - 8 * i)) & 0xff;
+        fields[NACK_SEQ_OFFSET + i] = (_nack_seq >> (24 - 8 * i)) & 0xff;
+      }
+    if (bytes == nullptr)
+      {
+        buf.Write (copy, sizeof (copy));
+      }
   }
 
   u32 Deserialize (::ns3::Buffer::Iterator buf) override
   {
-    NS_ASSERT (PROTOCOL_ID == buf.ReadU32 ());
-    _bits = buf.ReadNtohU32 ();
-    _nack_seq = buf.ReadNtohU32 ();
+    u8 copy[3 * sizeof (u32)];
+    const u8 *fields = buf.ReserveContiguous (sizeof (copy));
+    if (fields == nullptr)
+      {
+        buf.Read (copy, sizeof (copy));
+        fields = copy;
+      }
+    u32 protocolId = 0;
+    _bits = 0;
+    _nack_seq = 0;
+    for (u32 i = 0; i < sizeof (u32); ++i)
+      {
+        protocolId |= u32 (fields[i]) << (8 * i);
+        _bits = (_bits << 8) | fields[BITS_OFFSET + i];
+        _nack_seq = (_nack_seq << 8) | fields[NACK_SEQ_OFFSET + i];
+      }
+    NS_ASSERT (PROTOCOL_ID == protocolId);
     return GetSerializedSize ();
   }
 
@@ -212,6 +243,18 @@ public:
     SetSequence (*fudp_seq);
   }
 
+  // patch the sequence number of a header serialized into a template
+  static void SetSequence (::ns3::HeaderTemplate &tmpl, sequence_t seq)
+  {
+    tmpl.SetU32 (BITS_OFFSET, seq, SEQ_MASK);
+  }
+
+  template <typename FudpSeqMgmtRule>
+  static void SetSequence (::ns3::HeaderTemplate &tmpl, FudpSequence<FudpSeqMgmtRule> fudp_seq)
+  {
+    SetSequence (tmpl, *fudp_seq);
+  }
+
   nack_seq_t GetNackSequence () const
   {
     return _nack_seq;
@@ -222,6 +265,12 @@ public:
     _nack_seq = nack_seq;
   }
 
+  // patch the NACK sequence of a header serialized into a template
+  static void SetNackSequence (::ns3::HeaderTemplate &tmpl, nack_seq_t nack_seq)
+  {
+    tmpl.SetU32 (NACK_SEQ_OFFSET, nack_seq);
+  }
+
   ::ns3::TypeId GetInstanceTypeId () const override
   {
     return GetTypeId ();
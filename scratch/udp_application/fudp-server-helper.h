@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <stdint.h>
+#include <string>
 
 #include "ns3/application-container.h"
 #include "ns3/application.h"
@@ -40,6 +41,9 @@ public:
 
   void SetServerPort (u16);
 
+  // attributes of the FudpApplication, e.g. SnapshotInterval
+  void SetAttribute (::std::string const &name, ::ns3::AttributeValue const &value);
+
   ::ns3::ApplicationContainer Install (::ns3::Ptr<::ns3::Node> node) const;
 
   ::ns3::ApplicationContainer Install (::ns3::NodeContainer nodes) const;
@@ -64,6 +68,12 @@ void FudpServerHelper<FEATURES>::SetServerPort (u16 newServerPort)
   _serverPort = newServerPort;
 }
 
+template <FudpFeature FEATURES>
+void FudpServerHelper<FEATURES>::SetAttribute (::std::string const &name, ::ns3::AttributeValue const &value)
+{
+  _factory.Set (name, value);
+}
+
 template <FudpFeature FEATURES>
 ::ns3::ApplicationContainer FudpServerHelper<FEATURES>::Install (::ns3::Ptr<::ns3::Node> node) const
 {
@@ -22,20 +22,26 @@
 #include <iostream>
 #include "ns3/abort.h"
 #include "ns3/address.h"
+#include "ns3/boolean.h"
 #include "ns3/fatal-error.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/log.h"
 
+#include <fstream>
 #include <functional>
 #include <type_traits>
 #include <unordered_map>
 
+#include "client-statistics.h"
 #include "fudp-application.h"
 #include "fudp-client.h"
 #include "fudp-header.h"
+#include "ns3/event-id.h"
 #include "ns3/packet.h"
 #include "ns3/ptr.h"
+#include "ns3/simulator.h"
+#include "ns3/udp-socket.h"
 #include "optref.h"
 
 template <FudpFeature FEATURES, bool = ContainsNackSequence (FEATURES)>
@@ -59,6 +65,7 @@ template <FudpFeature FEATURES>
 struct FudpConnection : public FudpClientSequenceState<ContainsZigzag (FEATURES)>,
                         public FudpNackSequenceState<ContainsNackSequence (FEATURES)>
 {
+  sz statistics_index{}; // slot in FudpServer::_statistics
 };
 
 template <FudpFeature FEATURES>
@@ -88,21 +95,36 @@ public:
 
   void StartApplication () override;
 
-  void StopApplication () override{};
+  void StopApplication () override;
+
+  ::ns3::ClientStatistics const &GetStatistics () const;
 
 private:
   void SendNACK (::ns3::Address const &);
 
   void SendHealthProbe (::ns3::Address const &);
 
+  void Snapshot ();
+
 private:
+  // datagrams read by each RecvBatch in OnRecv
+  static constexpr u32 RECV_BATCH = 32;
+
   void OnRecv (::ns3::Ptr<::ns3::Socket> socket);
 
+  void OnPacket (::ns3::Ptr<::ns3::Packet> packet, ::ns3::Address const &address);
+
   u16 _serverPort;
 
   ::ns3::Ptr<::ns3::Socket> _socket;
 
   ::std::unordered_map<::ns3::Address, FudpConnection<FEATURES>, AddressHash> _connections;
+
+  ::ns3::ClientStatistics _statistics;
+
+  ::std::ofstream _snapshotStream;
+
+  ::ns3::EventId _snapshotEvent;
 };
 
 template <FudpFeature FEATURES>
@@ -121,6 +143,7 @@ template <FudpFeature FEATURES>
 void FudpServer<FEATURES>::EstablishConnection (::ns3::Address const &address)
 {
   _connections[address] = {};
+  _connections[address].statistics_index = _statistics.Add (address);
 }
 
 template <FudpFeature FEATURES>
@@ -139,6 +162,7 @@ template <FudpFeature FEATURES>
 void FudpServer<FEATURES>::SendNACK (::ns3::Address const &dest)
 {
   auto &connection = static_cast<FudpConnection<FEATURES> &> (*GetConnection (dest));
+  _statistics.NotifyNack (connection.statistics_index);
 
   auto header = FudpHeader{};
   header.On<FudpHeader::Bit::NACK> ();
@@ -159,6 +183,9 @@ void FudpServer<FEATURES>::SendNACK (::ns3::Address const &dest)
 template <FudpFeature FEATURES>
 void FudpServer<FEATURES>::SendHealthProbe (::ns3::Address const &dest)
 {
+  auto const &connection = static_cast<FudpConnection<FEATURES> &> (*GetConnection (dest));
+  _statistics.NotifyReset (connection.statistics_index);
+
   auto header = FudpHeader{};
   header.On<FudpHeader::Bit::RESET> ();
 
@@ -205,64 +232,85 @@ Status<FEATURES> ValidateHeader (const FudpConnection<FEATURES> &connection, con
 template <FudpFeature FEATURES>
 void FudpServer<FEATURES>::OnRecv (::ns3::Ptr<::ns3::Socket> socket)
 {
-  auto address = ::ns3::Address{};
-  if (auto packet = _socket->RecvFrom (address))
+  auto udp = ::ns3::DynamicCast<::ns3::UdpSocket> (socket);
+  ::ns3::UdpSocket::RecvItem batch[RECV_BATCH];
+  while (auto const n = udp->RecvBatch (batch, RECV_BATCH))
     {
-      if (!GetConnection (address))
+      for (u32 i = 0; i < n; ++i)
         {
-          // NS_LOG_DEBUG ("Connected");
-          EstablishConnection (address);
+          OnPacket (batch[i].packet, batch[i].from);
         }
+    }
+}
+
+template <FudpFeature FEATURES>
+void FudpServer<FEATURES>::OnPacket (::ns3::Ptr<::ns3::Packet> packet, ::ns3::Address const &address)
+{
+  if (!GetConnection (address))
+    {
+      // NS_LOG_DEBUG ("Connected");
+      EstablishConnection (address);
+    }
 
-      auto &connection = static_cast<FudpConnection<FEATURES> &> (*GetConnection (address));
+  GetContainer ().NotifyRx (packet, address);
 
-      auto header = FudpHeader{};
-      packet->RemoveHeader (header);
+  auto &connection = static_cast<FudpConnection<FEATURES> &> (*GetConnection (address));
+  auto const index = connection.statistics_index;
+  _statistics.NotifyReceive (index, packet->GetSize (), ::ns3::Simulator::Now ());
 
-      if constexpr (ContainsNackSequence (FEATURES))
+  auto header = FudpHeader{};
+  packet->RemoveHeader (header);
+
+  if constexpr (ContainsNackSequence (FEATURES))
+    {
+      switch (ValidateHeader(connection, header))
+        {
+        case Status<FEATURES>::OK:
+          connection.sequence++;
+          break;
+        case Status<FEATURES>::NEW_NACK:
+            _statistics.NotifyGap (index);
+            connection.nack_seq++;
+        case Status<FEATURES>::SAME_NACK:
+          {
+            connection.sequence = header.GetSequence () + 1;
+            SendNACK (address);
+          }
+          break;
+        default:
+          break;
+        }
+    }
+  else
+    {
+      if (!ValidateHeader (connection, header))
         {
-          switch (ValidateHeader(connection, header))
+          _statistics.NotifyGap (index);
+          if constexpr (ContainsZigzag (FEATURES))
             {
-            case Status<FEATURES>::OK:
-              connection.sequence++;
-              break;
-            case Status<FEATURES>::NEW_NACK:
-                connection.nack_seq++;
-            case Status<FEATURES>::SAME_NACK:
-              {
-                connection.sequence = header.GetSequence () + 1;
-                SendNACK (address);
-              }
-              break;
-            default:
-              break;
+              connection.sequence = connection.sequence.Get () + 1;
             }
+
+          SendNACK (address);
         }
       else
         {
-          if (!ValidateHeader (connection, header))
-            {
-              if constexpr (ContainsZigzag (FEATURES))
-                {
-                  connection.sequence = connection.sequence.Get () + 1;
-                }
-
-              SendNACK (address);
-            }
-          else
-            {
-              ++connection.sequence;
-            }
+          ++connection.sequence;
         }
+    }
 
-      if constexpr (ContainsHealthProbe (FEATURES))
+  if constexpr (ContainsHealthProbe (FEATURES))
+    {
+      if (connection.sequence.Overflowed ())
         {
-          if (connection.sequence.Overflowed ())
-            {
-              SendHealthProbe (address);
-            }
+          SendHealthProbe (address);
         }
     }
+
+  if (GetContainer ().IsClientStatisticsTraced ())
+    {
+      GetContainer ().NotifyClientStatistics (_statistics.Get (index));
+    }
 }
 
 template <FudpFeature FEATURES>
@@ -275,7 +323,54 @@ void FudpServer<FEATURES>::StartApplication ()
       NS_FATAL_ERROR ("failed to bind socket");
     }
 
+  _socket->SetAttribute ("CoalesceRecvNotify", ::ns3::BooleanValue (GetContainer ().IsRecvCoalesced ()));
   _socket->SetRecvCallback (::ns3::MakeCallback (&FudpServer<FEATURES>::OnRecv, this));
+
+  auto const &snapshotFile = GetContainer ().GetSnapshotFile ();
+  if (!snapshotFile.empty () && !_snapshotStream.is_open ())
+    {
+      _snapshotStream.open (snapshotFile);
+      ::ns3::ClientStatistics::WriteCsvHeader (_snapshotStream);
+    }
+
+  auto const interval = GetContainer ().GetSnapshotInterval ();
+  if (interval.IsStrictlyPositive ())
+    {
+      _snapshotEvent = ::ns3::Simulator::Schedule (interval, &FudpServer<FEATURES>::Snapshot, this);
+    }
+}
+
+template <FudpFeature FEATURES>
+void FudpServer<FEATURES>::StopApplication ()
+{
+  // the final state of every client
+  if (_snapshotEvent.IsRunning ())
+    {
+      _snapshotEvent.Cancel ();
+      Snapshot ();
+      _snapshotEvent.Cancel ();
+    }
+  _snapshotStream.close ();
+}
+
+template <FudpFeature FEATURES>
+::ns3::ClientStatistics const &FudpServer<FEATURES>::GetStatistics () const
+{
+  return _statistics;
+}
+
+template <FudpFeature FEATURES>
+void FudpServer<FEATURES>::Snapshot ()
+{
+  GetContainer ().NotifyStatisticsSnapshot (_statistics);
+  if (_snapshotStream.is_open ())
+    {
+      _statistics.WriteCsv (_snapshotStream, ::ns3::Simulator::Now ());
+      _snapshotStream.flush ();
+    }
+
+  _snapshotEvent =
+      ::ns3::Simulator::Schedule (GetContainer ().GetSnapshotInterval (), &FudpServer<FEATURES>::Snapshot, this);
 }
 
 #endif
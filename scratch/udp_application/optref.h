@@ -1,7 +1,5 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 /*
- * Copyright (c) 2008 INRIA
- *
  * This program is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License version 2 as
  * published by the Free Software Foundation;
@@ -15,54 +13,19 @@
  * along with this program; if not, write to the Free Software
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  *
- * Author: Chang-Hui Kim <kch9001@gmail.com>, Daeseong-Ki <kmeos1579@gmail.com>
+ * Author: Chang-Hui Kim <kch9001@gmail.com>
  */
-#pragma once
-#ifndef COAP_HELPER_H
-#define COAP_HELPER_H
-
-#include "ns3/application-container.h"
-#include "ns3/node-container.h"
-#include "ns3/object-factory.h"
-#include "ns3/ipv4-address.h"
-#include "coap-client.h"
-
-namespace ns3
-{
-  class CoAPClientHelper
-  {
-  public:
-    CoAPClientHelper();
-
-    CoAPClientHelper(Address ip, uint16_t port);
-
-    CoAPClientHelper(Address addr);
-
-    void SetAttribute(std::string name, const AttributeValue &value);
-
-    ApplicationContainer Install(Ptr<Node> node) const;
-    ApplicationContainer Install(NodeContainer c) const;
-
-  private:
-    Ptr<Application> InstallPriv(Ptr<Node> node) const;
-    ObjectFactory m_factory;
-  };
-
-
-  class CoAPServerHelper
-  {
-  public:
-    CoAPServerHelper();
 
-    void SetAttribute(std::string name, const AttributeValue &value);
+#ifndef OPTREF_H
+#define OPTREF_H
 
-    ApplicationContainer Install(Ptr<Node> node) const;
-    ApplicationContainer Install(NodeContainer c) const;
+#include <functional>
+#include <optional>
 
-  private:
-    Ptr<Application> InstallPriv(Ptr<Node> node) const;
-    ObjectFactory m_factory;
-  };
-}    
+// optional reference.
+// std::optional<T&> is ill-formed, so wrap the reference.
+// use static_cast<T &> (*opt) to get the referenced object.
+template <typename T>
+using OptRef = ::std::optional<::std::reference_wrapper<T>>;
 
-#endif /* COAP_HELPER_H */
+#endif /* OPTREF_H */
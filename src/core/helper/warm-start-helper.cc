@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "warm-start-helper.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/system-path.h"
+
+/**
+ * \file
+ * \ingroup core-helpers
+ * ns3::WarmStartHelper implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WarmStartHelper");
+
+const int64_t WarmStartHelper::NOT_FORKED;
+const int64_t WarmStartHelper::PARENT;
+
+WarmStartHelper::WarmStartHelper ()
+  : m_jobs (0),
+    m_setupMs (0),
+    m_forkedMs (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_clock.Start ();
+}
+
+void
+WarmStartHelper::AddVariant (std::string name, VariantSetup setup)
+{
+  NS_LOG_FUNCTION (this << name);
+  NS_ABORT_MSG_IF (name.empty (), "a warm-start variant needs a name");
+  m_variants.push_back ({name, setup, 0, false});
+}
+
+void
+WarmStartHelper::SetMaxParallel (uint32_t jobs)
+{
+  NS_LOG_FUNCTION (this << jobs);
+  m_jobs = jobs;
+}
+
+std::size_t
+WarmStartHelper::GetNVariants (void) const
+{
+  return m_variants.size ();
+}
+
+void
+WarmStartHelper::EnterChild (std::size_t index)
+{
+  const Variant &variant = m_variants[index];
+  SystemPath::MakeDirectories (variant.name);
+  if (chdir (variant.name.c_str ()) != 0)
+    {
+      NS_FATAL_ERROR ("cannot enter " << variant.name << ": " << std::strerror (errno));
+    }
+  if (variant.setup)
+    {
+      variant.setup ();
+    }
+}
+
+int64_t
+WarmStartHelper::Fork (Time warmup)
+{
+  NS_LOG_FUNCTION (this << warmup);
+  if (m_variants.empty ())
+    {
+      return NOT_FORKED;
+    }
+  NS_ABORT_MSG_IF (warmup < Simulator::Now (), "warm-up time already passed");
+
+  Simulator::Stop (warmup - Simulator::Now ());
+  Simulator::Run ();
+  m_warmup = warmup;
+  m_setupMs = m_clock.End ();
+  NS_LOG_INFO ("setup and warm-up took " << m_setupMs << " ms");
+
+  // the children inherit the stdio buffers
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (nullptr);
+
+  typedef std::chrono::steady_clock Clock;
+  struct Child
+  {
+    std::size_t index;
+    Clock::time_point start;
+  };
+  std::map<pid_t, Child> running;
+  const std::size_t jobs = m_jobs == 0 ? m_variants.size () : m_jobs;
+  std::size_t next = 0;
+
+  const Clock::time_point begin = Clock::now ();
+  while (next < m_variants.size () || !running.empty ())
+    {
+      while (next < m_variants.size () && running.size () < jobs)
+        {
+          pid_t pid = fork ();
+          NS_ABORT_MSG_IF (pid < 0, "fork failed: " << std::strerror (errno));
+          if (pid == 0)
+            {
+              EnterChild (next);
+              return static_cast<int64_t> (next);
+            }
+          NS_LOG_INFO ("variant " << m_variants[next].name << " runs as pid " << pid);
+          running[pid] = {next, Clock::now ()};
+          ++next;
+        }
+
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0)
+        {
+          NS_ABORT_MSG_IF (errno != EINTR, "waitpid failed: " << std::strerror (errno));
+          continue;
+        }
+      auto it = running.find (pid);
+      if (it == running.end ())
+        {
+          continue;
+        }
+      Variant &variant = m_variants[it->second.index];
+      variant.elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>
+        (Clock::now () - it->second.start).count ();
+      variant.failed = !WIFEXITED (status) || WEXITSTATUS (status) != 0;
+      NS_LOG_INFO ("variant " << variant.name << " took " << variant.elapsedMs << " ms");
+      if (variant.failed)
+        {
+          NS_LOG_WARN ("variant " << variant.name << " failed (status " << status << ")");
+        }
+      running.erase (it);
+    }
+  m_forkedMs = std::chrono::duration_cast<std::chrono::milliseconds>
+    (Clock::now () - begin).count ();
+  return PARENT;
+}
+
+int64_t
+WarmStartHelper::GetSetupMs (void) const
+{
+  return m_setupMs;
+}
+
+int64_t
+WarmStartHelper::GetVariantMs (std::size_t index) const
+{
+  NS_ASSERT (index < m_variants.size ());
+  return m_variants[index].elapsedMs;
+}
+
+int64_t
+WarmStartHelper::GetTotalMs (void) const
+{
+  return m_setupMs + m_forkedMs;
+}
+
+int64_t
+WarmStartHelper::GetSavedMs (void) const
+{
+  if (m_variants.empty ())
+    {
+      return 0;
+    }
+  return m_setupMs * static_cast<int64_t> (m_variants.size () - 1);
+}
+
+std::size_t
+WarmStartHelper::GetNFailed (void) const
+{
+  return std::count_if (m_variants.begin (), m_variants.end (),
+                        [] (const Variant &variant) { return variant.failed; });
+}
+
+void
+WarmStartHelper::PrintReport (std::ostream &os) const
+{
+  os << "warm-start: " << m_variants.size () << " variants forked at "
+     << m_warmup.As (Time::S) << ", setup " << m_setupMs << " ms" << std::endl;
+  for (const Variant &variant : m_variants)
+    {
+      os << "warm-start:   " << variant.name << " " << variant.elapsedMs << " ms"
+         << (variant.failed ? " (failed)" : "") << std::endl;
+    }
+  os << "warm-start: total " << GetTotalMs () << " ms, saved "
+     << GetSavedMs () << " ms of setup" << std::endl;
+}
+
+} // namespace ns3
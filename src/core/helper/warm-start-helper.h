@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef WARM_START_HELPER_H
+#define WARM_START_HELPER_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ns3/nstime.h"
+#include "ns3/system-wall-clock-ms.h"
+
+/**
+ * \file
+ * \ingroup core-helpers
+ * ns3::WarmStartHelper declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup core-helpers
+ *
+ * \brief Share the warm-up phase of a simulation between several runs.
+ *
+ * Many experiments only differ after the scenario is built: nodes are
+ * created, stations are associated and routing is populated before the
+ * compared protocols or seeds make any difference.  This helper runs
+ * that common prefix once, stops the simulator at the warm-up time and
+ * fork()s one child process per registered variant.  Each child
+ * continues from the in-memory snapshot of the parent with its own
+ * settings applied.
+ *
+ * Typical use:
+ * \code
+ *   WarmStartHelper warmStart;   // starts measuring setup time
+ *   // ... build the scenario, schedule applications after the warm-up ...
+ *   warmStart.AddVariant ("fdp", [] () { UseFdp = true; });
+ *   warmStart.AddVariant ("cocoa", [] () { UseFdp = false; });
+ *   if (warmStart.Fork (Seconds (5)) == WarmStartHelper::PARENT)
+ *     {
+ *       warmStart.PrintReport (std::cout);
+ *       std::exit (warmStart.GetNFailed () == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+ *     }
+ *   Simulator::Stop (endTime - Simulator::Now ());
+ *   Simulator::Run ();
+ * \endcode
+ *
+ * Every child changes its working directory to a sub-directory named
+ * after the variant, so relative output paths of the children do not
+ * collide.  The parent waits for all children and returns PARENT; the
+ * wall-clock times of the run are then available through the accessors.
+ * The parent holds the state of the warm-up only: it must neither run
+ * the simulation further nor destroy the scenario, whose destructors
+ * could write partial results, hence the std::exit() above.
+ *
+ * Output files opened before Fork() are shared by the children and
+ * must be avoided (e.g. pcap traces).  Random variables keep the state
+ * they had at the snapshot; a variant that changes the run number has
+ * to call RngSeedManager::SetRun() and re-assign the streams of the
+ * models it wants to diverge (see the AssignStreams() helper methods).
+ *
+ * Only available on POSIX systems.
+ */
+class WarmStartHelper
+{
+public:
+  /** Function applied by the child process of a variant. */
+  typedef std::function<void ()> VariantSetup;
+
+  /** Returned by Fork() when no variant is registered. */
+  static const int64_t NOT_FORKED = -1;
+  /** Returned by Fork() to the parent, once all the children exited. */
+  static const int64_t PARENT = -2;
+
+  /**
+   * Constructor.  Starts measuring the wall-clock setup time, so create
+   * it before building the scenario.
+   */
+  WarmStartHelper ();
+
+  /**
+   * \brief Register a variant.
+   * \param [in] name Name of the variant and of its output directory.
+   * \param [in] setup Function run in the child right after the fork.
+   */
+  void AddVariant (std::string name, VariantSetup setup);
+
+  /**
+   * \param [in] jobs Maximum number of children running at the same
+   *        time.  Zero (the default) runs every variant at once.
+   */
+  void SetMaxParallel (uint32_t jobs);
+
+  /** \returns The number of registered variants. */
+  std::size_t GetNVariants (void) const;
+
+  /**
+   * \brief Run the warm-up and fork the variants.
+   *
+   * Without registered variants the simulator is not touched and the
+   * function returns NOT_FORKED immediately, so the caller can keep a
+   * single code path for plain runs.
+   *
+   * \param [in] warmup Simulation time shared by all the variants.
+   * \returns The index of the variant in the child processes, PARENT
+   *          in the parent process or NOT_FORKED.
+   */
+  int64_t Fork (Time warmup);
+
+  /**
+   * \returns The wall-clock time of the setup and of the warm-up, in ms.
+   */
+  int64_t GetSetupMs (void) const;
+  /**
+   * \param [in] index The variant index.
+   * \returns The wall-clock time of the child process of the variant, in ms.
+   */
+  int64_t GetVariantMs (std::size_t index) const;
+  /**
+   * \returns The wall-clock time of the setup and of all the variants, in ms.
+   */
+  int64_t GetTotalMs (void) const;
+  /**
+   * \returns The wall-clock setup time saved by forking, in ms: every
+   *          variant but one would have built and warmed up the scenario.
+   */
+  int64_t GetSavedMs (void) const;
+  /**
+   * \returns The number of variants whose child process failed.
+   */
+  std::size_t GetNFailed (void) const;
+
+  /**
+   * \brief Print the wall-clock report of the forked run, one line per
+   * variant, each line prefixed with "warm-start:".
+   * \param [in,out] os The output stream.
+   */
+  void PrintReport (std::ostream &os) const;
+
+private:
+  /** A registered variant. */
+  struct Variant
+  {
+    std::string name;    //!< Name and output directory.
+    VariantSetup setup;  //!< Applied in the child.
+    int64_t elapsedMs;   //!< Wall-clock time of the child.
+    bool failed;         //!< Whether the child failed.
+  };
+
+  /**
+   * \brief Child side of the fork: prepare the output directory and
+   * apply the variant.
+   * \param [in] index The variant index.
+   */
+  void EnterChild (std::size_t index);
+
+  SystemWallClockMs m_clock;        //!< Measures the setup time.
+  std::vector<Variant> m_variants;  //!< Registered variants.
+  uint32_t m_jobs;                  //!< Maximum concurrent children.
+  Time m_warmup;                    //!< Simulation time of the fork.
+  int64_t m_setupMs;                //!< Wall-clock setup time.
+  int64_t m_forkedMs;               //!< Wall-clock time of all the children.
+};
+
+} // namespace ns3
+
+#endif /* WARM_START_HELPER_H */
@@ -20,6 +20,7 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include "size-class-pool.h"
 
 /**
  * \file
@@ -31,6 +32,47 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/**
+ * The free lists of the events: sizes rounded up to a cache line.
+ */
+typedef SizeClassPool<EventImpl, 64, EventImpl::MAX_POOLED_SIZE,
+                      EventImpl::MAX_CACHED_EVENTS> EventPool;
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  return EventPool::Allocate (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  EventPool::Deallocate (p, size);
+}
+
+void
+EventImpl::SetPooling (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  EventPool::SetPooling (enable);
+}
+
+uint64_t
+EventImpl::GetNAllocated (void)
+{
+  return EventPool::GetNAllocated ();
+}
+
+uint64_t
+EventImpl::GetNHeapAllocated (void)
+{
+  return EventPool::GetNHeapAllocated ();
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
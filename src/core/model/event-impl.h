@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,16 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated by size class: an event (with its bound
+ * arguments, or the captures of a lambda, stored inline) of up to
+ * MAX_POOLED_SIZE bytes is rounded up to a multiple of a cache line and
+ * recycled through a per-thread free list of that size class (see
+ * SizeClassPool) rather than returned to the heap, so that steady-state
+ * scheduling does not allocate.  Larger events use the global heap.  Each free list keeps at
+ * most MAX_CACHED_EVENTS blocks; an event scheduled by one thread and
+ * freed by another (e.g. with the realtime simulator) goes to the free
+ * list of the thread which frees it.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +77,40 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate an event from the free list of its size class.
+   * \param [in] size The size of the event object.
+   * \returns The memory block.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return an event to the free list of its size class.
+   * \param [in] p The memory block.
+   * \param [in] size The size of the event object.
+   */
+  static void operator delete (void *p, std::size_t size);
+
+  /**
+   * Enable or disable the recycling of freed events, for comparison.
+   * Can be changed at any time.
+   * \param [in] enable \c true to recycle events (the default).
+   */
+  static void SetPooling (bool enable);
+  /**
+   * \returns The number of events allocated by the calling thread.
+   */
+  static uint64_t GetNAllocated (void);
+  /**
+   * \returns The number of those which were taken from the heap rather
+   *          than from a free list.
+   */
+  static uint64_t GetNHeapAllocated (void);
+
+  /** Largest event, in bytes, served from the free lists. */
+  static const std::size_t MAX_POOLED_SIZE = 256;
+  /** Maximum number of free events kept per size class and thread. */
+  static const uint32_t MAX_CACHED_EVENTS = 1024;
+
 protected:
   /**
    * Implementation for Invoke().
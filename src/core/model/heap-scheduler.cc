@@ -237,6 +237,12 @@ HeapScheduler::Remove (const Event &ev)
           Exch (i, Last ());
           m_heap.pop_back ();
           TopDown (i);
+          // the last event may also be smaller than the parent of i
+          while (i < m_heap.size () && !IsRoot (i) && IsLessStrictly (i, Parent (i)))
+            {
+              Exch (i, Parent (i));
+              i = Parent (i);
+            }
           return;
         }
     }
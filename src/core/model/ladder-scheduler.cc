@@ -0,0 +1,338 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+    .AddAttribute ("Threshold",
+                   "Number of events in a bucket (or in Bottom) above which "
+                   "they are spread over a new rung instead of being sorted",
+                   UintegerValue (50),
+                   MakeUintegerAccessor (&LadderScheduler::m_threshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxRungs",
+                   "Maximum number of rungs of the ladder",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&LadderScheduler::m_maxRungs),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (std::numeric_limits<uint64_t>::max ()),
+    m_topMax (0),
+    m_topStart (0),
+    m_nRungs (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung)
+{
+  return rung.start + rung.current * rung.width;
+}
+
+LadderScheduler::Rung &
+LadderScheduler::PushRung (uint64_t start, uint64_t end, uint64_t spread, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << start << end << spread << n);
+  NS_ASSERT (end > start);
+  if (m_nRungs == m_rungs.size ())
+    {
+      m_rungs.push_back (Rung ());
+    }
+  Rung &rung = m_rungs[m_nRungs++];
+
+  // about one event per bucket over the spread of the events, but the
+  // rung must reach end, so bound the number of buckets when the events
+  // are clustered far before it
+  const uint64_t span = end - start;
+  const uint64_t maxBuckets = std::max<uint64_t> (16 * static_cast<uint64_t> (n), 64);
+  uint64_t width = std::max<uint64_t> (1, (spread + n - 1) / n);
+  if ((span + width - 1) / width > maxBuckets)
+    {
+      width = (span + maxBuckets - 1) / maxBuckets;
+    }
+  rung.width = width;
+  rung.nBuckets = static_cast<uint32_t> ((span + width - 1) / width);
+  rung.start = start;
+  rung.current = 0;
+  rung.count = 0;
+  if (rung.buckets.size () < rung.nBuckets)
+    {
+      rung.buckets.resize (rung.nBuckets);
+    }
+  return rung;
+}
+
+void
+LadderScheduler::InsertInRung (Rung &rung, const Scheduler::Event &ev)
+{
+  const uint64_t index = (ev.key.m_ts - rung.start) / rung.width;
+  NS_ASSERT (index >= rung.current && index < rung.nBuckets);
+  rung.buckets[index].push_back (ev);
+  ++rung.count;
+}
+
+void
+LadderScheduler::InsertInBottom (const Scheduler::Event &ev)
+{
+  // sorted in decreasing order, the next event is at the back
+  auto it = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev,
+                              std::greater<Scheduler::Event> ());
+  m_bottom.insert (it, ev);
+  if (m_bottom.size () > m_threshold)
+    {
+      SpillBottom ();
+    }
+}
+
+void
+LadderScheduler::SpillBottom (void)
+{
+  const uint64_t min = m_bottom.back ().key.m_ts;
+  const uint64_t max = m_bottom.front ().key.m_ts;
+  if (m_nRungs == m_maxRungs || min == max)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << m_bottom.size ());
+  const uint64_t end = m_nRungs == 0 ? m_topStart : GetCurrentStart (m_rungs[m_nRungs - 1]);
+  Rung &rung = PushRung (min, end, max - min + 1, m_bottom.size ());
+  for (const Scheduler::Event &ev : m_bottom)
+    {
+      InsertInRung (rung, ev);
+    }
+  m_bottom.clear ();
+}
+
+void
+LadderScheduler::FillBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_bottom.empty ())
+    {
+      if (m_nRungs == 0)
+        {
+          // Top becomes the first rung
+          NS_ASSERT (!m_top.empty ());
+          Rung &rung = PushRung (m_topMin, m_topMax + 1, m_topMax - m_topMin + 1, m_top.size ());
+          m_topStart = rung.start + rung.nBuckets * rung.width;
+          for (const Scheduler::Event &ev : m_top)
+            {
+              InsertInRung (rung, ev);
+            }
+          m_top.clear ();
+          m_topMin = std::numeric_limits<uint64_t>::max ();
+          m_topMax = 0;
+        }
+
+      const uint32_t r = m_nRungs - 1;
+      Rung *rung = &m_rungs[r];
+      if (rung->count == 0)
+        {
+          // the remaining buckets are all empty
+          --m_nRungs;
+          continue;
+        }
+      while (rung->buckets[rung->current].empty ())
+        {
+          ++rung->current;
+        }
+      const uint32_t index = rung->current;
+      Bucket &bucket = rung->buckets[index];
+      const uint64_t bucketEnd = GetCurrentStart (*rung) + rung->width;
+      ++rung->current;
+      rung->count -= bucket.size ();
+
+      if (bucket.size () > m_threshold && rung->width > 1 && m_nRungs < m_maxRungs)
+        {
+          uint64_t min = std::numeric_limits<uint64_t>::max ();
+          uint64_t max = 0;
+          for (const Scheduler::Event &ev : bucket)
+            {
+              min = std::min (min, ev.key.m_ts);
+              max = std::max (max, ev.key.m_ts);
+            }
+          if (min != max)
+            {
+              // refine the bucket into a new rung; PushRung may move the
+              // rungs, so take the events out first
+              m_spill.swap (bucket);
+              Rung &child = PushRung (min, bucketEnd, max - min + 1, m_spill.size ());
+              for (const Scheduler::Event &ev : m_spill)
+                {
+                  InsertInRung (child, ev);
+                }
+              m_spill.clear ();
+              m_spill.swap (m_rungs[r].buckets[index]);
+              continue;
+            }
+        }
+
+      // Bottom is empty, take the storage of the bucket
+      m_bottom.swap (bucket);
+      std::sort (m_bottom.begin (), m_bottom.end (), std::greater<Scheduler::Event> ());
+    }
+}
+
+bool
+LadderScheduler::RemoveFrom (std::vector<Scheduler::Event> &events, const Scheduler::Event &ev)
+{
+  for (auto it = events.begin (); it != events.end (); ++it)
+    {
+      if (it->key.m_uid == ev.key.m_uid)
+        {
+          *it = events.back ();
+          events.pop_back ();
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+LadderScheduler::Insert (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  ++m_qSize;
+  const uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; ++i)
+    {
+      Rung &rung = m_rungs[i];
+      if (ts >= GetCurrentStart (rung))
+        {
+          InsertInRung (rung, ev);
+          return;
+        }
+    }
+  InsertInBottom (ev);
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottom.empty ())
+    {
+      // refilling does not change the order of the events
+      const_cast<LadderScheduler *> (this)->FillBottom ();
+    }
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottom.empty ())
+    {
+      FillBottom ();
+    }
+  Scheduler::Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  --m_qSize;
+  NS_LOG_DEBUG ("remove " << ev.key.m_uid << " at " << ev.key.m_ts);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  const uint64_t ts = ev.key.m_ts;
+  bool found = false;
+  if (ts >= m_topStart)
+    {
+      found = RemoveFrom (m_top, ev);
+    }
+  else
+    {
+      uint32_t i = 0;
+      for (; i < m_nRungs; ++i)
+        {
+          Rung &rung = m_rungs[i];
+          if (ts >= GetCurrentStart (rung))
+            {
+              found = RemoveFrom (rung.buckets[(ts - rung.start) / rung.width], ev);
+              rung.count -= found ? 1 : 0;
+              break;
+            }
+        }
+      if (i == m_nRungs)
+        {
+          auto it = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev,
+                                      std::greater<Scheduler::Event> ());
+          found = it != m_bottom.end () && it->key.m_uid == ev.key.m_uid;
+          if (found)
+            {
+              m_bottom.erase (it);
+            }
+        }
+    }
+  NS_ASSERT_MSG (found, "event " << ev.key.m_uid << " not in the schedule");
+  --m_qSize;
+}
+
+} // namespace ns3
@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue of
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Tang, Goh and Thng][Tang].
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * Events are kept in three tiers:
+ *
+ *  - Top, an unsorted vector of the events far in the future, those at
+ *    or after `m_topStart`;
+ *  - the Ladder, a stack of rungs.  Each rung is an array of unsorted
+ *    buckets of a uniform width, and each bucket of a rung can be
+ *    refined into the next rung.  The width of a new rung is derived
+ *    from the spread of the events it receives, so it adapts to the
+ *    timestamp distribution;
+ *  - Bottom, a short sorted vector of the earliest events.
+ *
+ * Events only get sorted when they reach Bottom, in groups of at most
+ * `Threshold` events.  When Bottom is empty, the first non-empty bucket
+ * of the last rung is moved to Bottom, or, if it holds more than
+ * `Threshold` events, spawns a new rung.  When the Ladder is empty, Top
+ * becomes its first rung.  An insertion before the current bucket of
+ * the last rung goes to Bottom; if Bottom grows beyond `Threshold`
+ * events it is turned into a new rung as well, which keeps the cost of
+ * the many events scheduled a few microseconds ahead constant.
+ *
+ * Buckets whose events all share one timestamp cannot be refined and
+ * are sorted as a whole, by event uid.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | ~Constant       | Append to a bucket, or sorted insert in a short Bottom
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | ~Constant       | Refill Bottom from the Ladder
+ * Remove()     | Linear in a bucket | Locate the tier from the time stamp, search the bucket
+ * RemoveNext() | ~Constant       | Refill Bottom from the Ladder
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | `MaxRungs` rungs of buckets      | Bucket vectors are reused
+ * Per Event | 0                                | `std::vector`
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Unsorted events of one bucket. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    std::vector<Bucket> buckets; //!< The buckets, those from nBuckets on are unused.
+    uint32_t nBuckets;           //!< Buckets in use.
+    uint64_t width;              //!< Width of a bucket, in dimensionless time units.
+    uint64_t start;              //!< Time stamp at the start of bucket 0.
+    uint32_t current;            //!< First bucket that may hold events.
+    uint32_t count;              //!< Events in the rung.
+  };
+
+  /**
+   * \param rung the rung.
+   * \return the time stamp at the start of its current bucket.
+   */
+  static uint64_t GetCurrentStart (const Rung &rung);
+
+  /**
+   * Push a new rung covering [start, end), with a bucket width of
+   * about spread / n.
+   *
+   * \param [in] start The time stamp of the earliest event.
+   * \param [in] end The time stamp the rung must reach.
+   * \param [in] spread The time stamp range of the events.
+   * \param [in] n The number of events the rung will receive.
+   * \returns The new rung.
+   */
+  Rung &PushRung (uint64_t start, uint64_t end, uint64_t spread, uint32_t n);
+  /**
+   * Put an event in its bucket of a rung.
+   *
+   * \param [in] rung The rung.
+   * \param [in] ev The event.
+   */
+  static void InsertInRung (Rung &rung, const Scheduler::Event &ev);
+  /**
+   * Insert an event in Bottom, keeping it sorted.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertInBottom (const Scheduler::Event &ev);
+  /** Turn an overfull Bottom into a new rung. */
+  void SpillBottom (void);
+  /** Move the earliest events to Bottom, which must be empty. */
+  void FillBottom (void);
+  /**
+   * Remove an event from an unsorted vector.
+   *
+   * \param [in,out] events The vector.
+   * \param [in] ev The event.
+   * \returns \c true if the event was found.
+   */
+  static bool RemoveFrom (std::vector<Scheduler::Event> &events, const Scheduler::Event &ev);
+
+  /** Events at or after m_topStart, unsorted. */
+  std::vector<Scheduler::Event> m_top;
+  /** Smallest time stamp in Top. */
+  uint64_t m_topMin;
+  /** Largest time stamp in Top. */
+  uint64_t m_topMax;
+  /** Events from this time stamp on go to Top. */
+  uint64_t m_topStart;
+
+  /** The rungs, of which the first m_nRungs are in use. */
+  std::vector<Rung> m_rungs;
+  /** Rungs in use. */
+  uint32_t m_nRungs;
+
+  /** The earliest events, sorted in decreasing order. */
+  std::vector<Scheduler::Event> m_bottom;
+  /** Events of a bucket being refined into a new rung. */
+  std::vector<Scheduler::Event> m_spill;
+
+  /** Number of events in queue. */
+  uint32_t m_qSize;
+  /** Bucket size above which a new rung is spawned. */
+  uint32_t m_threshold;
+  /** Maximum number of rungs. */
+  uint32_t m_maxRungs;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -27,6 +27,7 @@
 
 #include "ptr.h"
 #include "string.h"
+#include "boolean.h"
 #include "object-factory.h"
 #include "global-value.h"
 #include "assert.h"
@@ -78,6 +79,17 @@ static GlobalValue g_schedTypeImpl = GlobalValue ("SchedulerType",
                                                   TypeIdValue (MapScheduler::GetTypeId ()),
                                                   MakeTypeIdChecker ());
 
+/**
+ * \ingroup events
+ * \anchor GlobalValueEventPooling
+ * Whether freed events are recycled by size class rather than returned
+ * to the heap, see EventImpl.
+ */
+static GlobalValue g_eventPooling = GlobalValue ("EventPooling",
+                                                 "Recycle the memory of the executed events",
+                                                 BooleanValue (true),
+                                                 MakeBooleanChecker ());
+
 /**
  * \ingroup simulator
  * \brief Get the static SimulatorImpl instance.
@@ -118,6 +130,11 @@ static SimulatorImpl * GetImpl (void)
         factory.SetTypeId (s.Get ());
         (*pimpl)->SetScheduler (factory);
       }
+      {
+        BooleanValue pooling;
+        g_eventPooling.GetValue (pooling);
+        EventImpl::SetPooling (pooling.Get ());
+      }
 
 //
 // Note: we call LogSetTimePrinter _after_ creating the implementation
@@ -338,6 +355,9 @@ Simulator::SetImplementation (Ptr<SimulatorImpl> impl)
   g_schedTypeImpl.GetValue (s);
   factory.SetTypeId (s.Get ());
   impl->SetScheduler (factory);
+  BooleanValue pooling;
+  g_eventPooling.GetValue (pooling);
+  EventImpl::SetPooling (pooling.Get ());
 //
 // Note: we call LogSetTimePrinter _after_ creating the implementation
 // object because the act of creation can trigger calls to the logging
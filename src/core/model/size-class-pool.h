@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SIZE_CLASS_POOL_H
+#define SIZE_CLASS_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::SizeClassPool declaration and implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief Per-thread free lists of memory blocks, by size class.
+ *
+ * A block of up to MAX_SIZE bytes is rounded up to a multiple of
+ * GRANULARITY bytes, and recycled through a free list of that size
+ * class rather than returned to the heap.  Larger blocks use the global
+ * heap.  Each free list keeps at most MAX_CACHED blocks.  The free lists
+ * belong to the thread: a block allocated by one thread and freed by
+ * another goes to the free list of the thread which frees it.
+ *
+ * The pool only has static members; the \p T parameter gives each user
+ * its own free lists, counters and switch.
+ *
+ * \tparam T The type owning the pool.
+ * \tparam GRANULARITY The granularity of the size classes, in bytes.
+ * \tparam MAX_SIZE The largest block served from the free lists, in bytes.
+ * \tparam MAX_CACHED The maximum number of free blocks per size class and thread.
+ */
+template <typename T, std::size_t GRANULARITY, std::size_t MAX_SIZE, uint32_t MAX_CACHED>
+class SizeClassPool
+{
+public:
+  /**
+   * Allocate a block from the free list of its size class.
+   * \param [in] size The size requested.
+   * \returns A block of at least GetBlockSize (size) bytes.
+   */
+  static void * Allocate (std::size_t size);
+  /**
+   * Return a block to the free list of its size class.
+   * \param [in] p The block.
+   * \param [in] size The size requested when it was allocated, or any
+   *        size up to its GetBlockSize().
+   */
+  static void Deallocate (void *p, std::size_t size);
+  /**
+   * \param [in] size A size requested.
+   * \returns The size of the block allocated for it.
+   */
+  static std::size_t GetBlockSize (std::size_t size);
+
+  /**
+   * Enable or disable the recycling of freed blocks, for comparison.
+   * Can be changed at any time.
+   * \param [in] enable \c true to recycle blocks (the default).
+   */
+  static void SetPooling (bool enable);
+  /**
+   * \returns The number of blocks allocated by the calling thread.
+   */
+  static uint64_t GetNAllocated (void);
+  /**
+   * \returns The number of those which were taken from the heap rather
+   *          than from a free list.
+   */
+  static uint64_t GetNHeapAllocated (void);
+
+private:
+  /** Number of size classes. */
+  static const std::size_t N_SIZE_CLASSES = MAX_SIZE / GRANULARITY;
+
+  /** A free block, linked through its first bytes. */
+  struct FreeBlock
+  {
+    FreeBlock *next; //!< The next free block of the size class.
+  };
+
+  /** The free lists and allocation counters of a thread. */
+  struct Lists
+  {
+    FreeBlock *head[N_SIZE_CLASSES] = {};   //!< Free blocks, per size class.
+    uint32_t nFree[N_SIZE_CLASSES] = {};    //!< Length of each free list.
+    uint64_t nAllocated = 0;                //!< Blocks allocated.
+    uint64_t nHeapAllocated = 0;            //!< Blocks taken from the heap.
+
+    /** Return the free blocks to the heap when the thread exits. */
+    ~Lists ();
+  };
+
+  /** The free lists of this thread. */
+  static thread_local Lists t_lists;
+  /**
+   * Set once t_lists is gone, for the blocks freed during static
+   * destruction.  A trivial type, so it remains usable.
+   */
+  static thread_local bool t_destroyed;
+  /** Whether freed blocks are recycled. */
+  static std::atomic<bool> g_pooling;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T, std::size_t G, std::size_t M, uint32_t C>
+thread_local typename SizeClassPool<T, G, M, C>::Lists SizeClassPool<T, G, M, C>::t_lists;
+
+template <typename T, std::size_t G, std::size_t M, uint32_t C>
+thread_local bool SizeClassPool<T, G, M, C>::t_destroyed = false;
+
+template <typename T, std::size_t G, std::size_t M, uint32_t C>
+std::atomic<bool> SizeClassPool<T, G, M, C>::g_pooling (true);
+
+template <typename T, std::size_t G, std::size_t M, uint32_t C>
+SizeClassPool<T, G, M, C>::Lists::~Lists ()
+{
+  t_destroyed = true;
+  for (std::size_t c = 0; c < N_SIZE_CLASSES; ++c)
+    {
+      while (head[c] != 0)
+        {
+          FreeBlock *block = head[c];
+          head[c] = block->next;
+          ::operator delete (block);
+        }
+    }
+}
+
+template <typename T, std::size_t G, std::size_t M, uint32_t C>
+std::size_t
+SizeClassPool<T, G, M, C>::GetBlockSize (std::size_t size)
+{
+  return size > M || size == 0 ? size : ((size - 1) / G + 1) * G;
+}
+
+template <typename T, std::size_t G, std::size_t M, uint32_t C>
+void *
+SizeClassPool<T, G, M, C>::Allocate (std::size_t size)
+{
+  if (size > M || size == 0)
+    {
+      if (!t_destroyed)
+        {
+          ++t_lists.nAllocated;
+          ++t_lists.nHeapAllocated;
+        }
+      return ::operator new (size);
+    }
+  // the block must be able to hold any request of its size class
+  const std::size_t c = (size - 1) / G;
+  if (t_destroyed)
+    {
+      return ::operator new ((c + 1) * G);
+    }
+  Lists &lists = t_lists;
+  ++lists.nAllocated;
+  FreeBlock *block = lists.head[c];
+  if (block != 0 && g_pooling.load (std::memory_order_relaxed))
+    {
+      lists.head[c] = block->next;
+      --lists.nFree[c];
+      return block;
+    }
+  ++lists.nHeapAllocated;
+  return ::operator new ((c + 1) * G);
+}
+
+template <typename T, std::size_t G, std::size_t M, uint32_t C>
+void
+SizeClassPool<T, G, M, C>::Deallocate (void *p, std::size_t size)
+{
+  if (size <= M && size != 0 && !t_destroyed
+      && g_pooling.load (std::memory_order_relaxed))
+    {
+      const std::size_t c = (size - 1) / G;
+      Lists &lists = t_lists;
+      if (lists.nFree[c] < C)
+        {
+          FreeBlock *block = static_cast<FreeBlock *> (p);
+          block->next = lists.head[c];
+          lists.head[c] = block;
+          ++lists.nFree[c];
+          return;
+        }
+    }
+  ::operator delete (p);
+}
+
+template <typename T, std::size_t G, std::size_t M, uint32_t C>
+void
+SizeClassPool<T, G, M, C>::SetPooling (bool enable)
+{
+  g_pooling.store (enable, std::memory_order_relaxed);
+}
+
+template <typename T, std::size_t G, std::size_t M, uint32_t C>
+uint64_t
+SizeClassPool<T, G, M, C>::GetNAllocated (void)
+{
+  return t_destroyed ? 0 : t_lists.nAllocated;
+}
+
+template <typename T, std::size_t G, std::size_t M, uint32_t C>
+uint64_t
+SizeClassPool<T, G, M, C>::GetNHeapAllocated (void)
+{
+  return t_destroyed ? 0 : t_lists.nHeapAllocated;
+}
+
+} // namespace ns3
+
+#endif /* SIZE_CLASS_POOL_H */
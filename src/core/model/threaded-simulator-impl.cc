@@ -0,0 +1,698 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "threaded-simulator-impl.h"
+#include "simulator.h"
+#include "event-impl.h"
+#include "uinteger.h"
+#include "abort.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::ThreadedSimulatorImpl implementation.
+ */
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("ThreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (ThreadedSimulatorImpl);
+
+thread_local ThreadedSimulatorImpl::Partition *ThreadedSimulatorImpl::m_current = 0;
+int64_t ThreadedSimulatorImpl::m_lookAhead = std::numeric_limits<int64_t>::max ();
+bool ThreadedSimulatorImpl::m_parallel = false;
+
+namespace {
+
+/** Time stamp of an empty partition. */
+const uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max ();
+
+/**
+ * \returns The partition of each context.
+ */
+std::vector<uint32_t> &
+GetPartitionMap (void)
+{
+  static std::vector<uint32_t> partitions;
+  return partitions;
+}
+
+} // unnamed namespace
+
+TypeId
+ThreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ThreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Core")
+    .AddConstructor<ThreadedSimulatorImpl> ()
+    .AddAttribute ("MaxThreads",
+                   "Maximum number of threads running the partitions, "
+                   "0 for one per core",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&ThreadedSimulatorImpl::m_maxThreads),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+ThreadedSimulatorImpl::ThreadedSimulatorImpl ()
+  : m_stop (false),
+    m_maxThreads (0),
+    m_window (0),
+    m_windowEnd (0),
+    m_busy (0),
+    m_exit (false),
+    m_nextPartition (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_global = CreatePartition (Simulator::NO_CONTEXT);
+  // the partitions and the lookahead of an earlier simulation do not
+  // apply to the nodes and channels of this one
+  GetPartitionMap ().clear ();
+  m_lookAhead = std::numeric_limits<int64_t>::max ();
+}
+
+ThreadedSimulatorImpl::~ThreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ThreadedSimulatorImpl::SetPartition (uint32_t context, uint32_t partition)
+{
+  NS_LOG_FUNCTION (context << partition);
+  std::vector<uint32_t> &partitions = GetPartitionMap ();
+  if (context >= partitions.size ())
+    {
+      partitions.resize (context + 1, 0);
+    }
+  partitions[context] = partition;
+}
+
+uint32_t
+ThreadedSimulatorImpl::GetPartition (uint32_t context)
+{
+  const std::vector<uint32_t> &partitions = GetPartitionMap ();
+  return context < partitions.size () ? partitions[context] : 0;
+}
+
+uint32_t
+ThreadedSimulatorImpl::GetCurrentPartition (void)
+{
+  return m_current != 0 ? m_current->index : Simulator::NO_CONTEXT;
+}
+
+void
+ThreadedSimulatorImpl::BoundLookAhead (const Time lookAhead)
+{
+  NS_LOG_FUNCTION (lookAhead);
+  NS_ABORT_MSG_UNLESS (lookAhead.IsStrictlyPositive (), "The lookahead must be > 0");
+  m_lookAhead = std::min (m_lookAhead, lookAhead.GetTimeStep ());
+}
+
+Time
+ThreadedSimulatorImpl::GetLookAhead (void)
+{
+  return TimeStep (m_lookAhead);
+}
+
+std::unique_ptr<ThreadedSimulatorImpl::Partition>
+ThreadedSimulatorImpl::CreatePartition (uint32_t index) const
+{
+  std::unique_ptr<Partition> partition (new Partition);
+  if (m_schedulerFactory.IsTypeIdSet ())
+    {
+      partition->events = m_schedulerFactory.Create<Scheduler> ();
+    }
+  partition->index = index;
+  partition->currentTs = 0;
+  partition->currentUid = EventId::UID::INVALID;
+  partition->currentContext = Simulator::NO_CONTEXT;
+  partition->uid = EventId::UID::VALID;
+  partition->eventCount = 0;
+  partition->unscheduledEvents = 0;
+  return partition;
+}
+
+void
+ThreadedSimulatorImpl::AddPartitions (uint32_t n)
+{
+  NS_ASSERT_MSG (m_current == 0, "partition " << n - 1 << " created while running");
+  while (m_partitions.size () < n)
+    {
+      m_partitions.push_back (CreatePartition (m_partitions.size ()));
+    }
+}
+
+ThreadedSimulatorImpl::Partition &
+ThreadedSimulatorImpl::GetPartitionOf (uint32_t context) const
+{
+  if (context == Simulator::NO_CONTEXT)
+    {
+      return *m_global;
+    }
+  const uint32_t partition = GetPartition (context);
+  NS_ASSERT_MSG (partition < m_partitions.size (), "no partition " << partition);
+  return *m_partitions[partition];
+}
+
+ThreadedSimulatorImpl::Partition &
+ThreadedSimulatorImpl::GetCurrent (void) const
+{
+  return m_current != 0 ? *m_current : *m_global;
+}
+
+void
+ThreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (auto &partition : m_partitions)
+    {
+      Merge (*partition);
+      while (!partition->events->IsEmpty ())
+        {
+          partition->events->RemoveNext ().impl->Unref ();
+        }
+    }
+  while (!m_global->events->IsEmpty ())
+    {
+      m_global->events->RemoveNext ().impl->Unref ();
+    }
+  m_partitions.clear ();
+  m_global->events = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+ThreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+ThreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  std::vector<Partition *> partitions (1, m_global.get ());
+  for (auto &partition : m_partitions)
+    {
+      partitions.push_back (partition.get ());
+    }
+  for (Partition *partition : partitions)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if (partition->events != 0)
+        {
+          while (!partition->events->IsEmpty ())
+            {
+              scheduler->Insert (partition->events->RemoveNext ());
+            }
+        }
+      partition->events = scheduler;
+    }
+}
+
+bool
+ThreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop || NextTs (*m_global) != NO_EVENT)
+    {
+      return m_stop;
+    }
+  for (const auto &partition : m_partitions)
+    {
+      if (NextTs (*partition) != NO_EVENT || !partition->inbox.empty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+Scheduler::EventKey
+ThreadedSimulatorImpl::Insert (Partition &partition, uint64_t ts,
+                               uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition.uid;
+  partition.uid++;
+  partition.unscheduledEvents++;
+  partition.events->Insert (ev);
+  return ev.key;
+}
+
+void
+ThreadedSimulatorImpl::Merge (Partition &partition)
+{
+  {
+    std::unique_lock lock {partition.inboxMutex};
+    partition.merging.swap (partition.inbox);
+  }
+  if (partition.merging.empty ())
+    {
+      return;
+    }
+  // the order in which the partitions filled the inbox is not
+  // reproducible, their own sequence numbers are
+  std::sort (partition.merging.begin (), partition.merging.end (),
+             [] (const Message &a, const Message &b) {
+               if (a.ev.key.m_ts != b.ev.key.m_ts)
+                 {
+                   return a.ev.key.m_ts < b.ev.key.m_ts;
+                 }
+               if (a.source != b.source)
+                 {
+                   return a.source < b.source;
+                 }
+               return a.ev.key.m_uid < b.ev.key.m_uid;
+             });
+  for (const Message &message : partition.merging)
+    {
+      Insert (partition, message.ev.key.m_ts, message.ev.key.m_context, message.ev.impl);
+    }
+  partition.merging.clear ();
+}
+
+uint64_t
+ThreadedSimulatorImpl::NextTs (const Partition &partition)
+{
+  if (partition.events->IsEmpty ())
+    {
+      return NO_EVENT;
+    }
+  return partition.events->PeekNext ().key.m_ts;
+}
+
+void
+ThreadedSimulatorImpl::ProcessWindow (Partition &partition, uint64_t end)
+{
+  m_current = &partition;
+  while (!partition.events->IsEmpty ()
+         && partition.events->PeekNext ().key.m_ts < end)
+    {
+      Scheduler::Event next = partition.events->RemoveNext ();
+      NS_ASSERT (next.key.m_ts >= partition.currentTs);
+      NS_ASSERT_MSG (GetPartition (next.key.m_context) == partition.index,
+                     "event of context " << next.key.m_context << " in partition "
+                     << partition.index << ", the partition was set after the event was scheduled");
+      partition.unscheduledEvents--;
+      partition.eventCount++;
+      partition.currentTs = next.key.m_ts;
+      partition.currentContext = next.key.m_context;
+      partition.currentUid = next.key.m_uid;
+      next.impl->Invoke ();
+      next.impl->Unref ();
+    }
+  m_current = 0;
+}
+
+void
+ThreadedSimulatorImpl::ProcessPartitions (void)
+{
+  const uint64_t end = m_windowEnd;
+  for (uint32_t i = m_nextPartition++; i < m_partitions.size (); i = m_nextPartition++)
+    {
+      ProcessWindow (*m_partitions[i], end);
+    }
+}
+
+void
+ThreadedSimulatorImpl::Worker (uint64_t window)
+{
+  std::unique_lock lock {m_mutex};
+  while (true)
+    {
+      m_windowStart.wait (lock, [this, window] () { return m_exit || m_window != window; });
+      if (m_exit)
+        {
+          return;
+        }
+      window = m_window;
+      lock.unlock ();
+      ProcessPartitions ();
+      lock.lock ();
+      if (--m_busy == 0)
+        {
+          m_windowDone.notify_one ();
+        }
+    }
+}
+
+void
+ThreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = false;
+  uint32_t n = 0;
+  for (uint32_t partition : GetPartitionMap ())
+    {
+      n = std::max (n, partition + 1);
+    }
+  AddPartitions (n);
+
+  uint32_t nThreads = m_maxThreads != 0 ? m_maxThreads : std::thread::hardware_concurrency ();
+  nThreads = std::max<uint32_t> (1, std::min<uint32_t> (nThreads, m_partitions.size ()));
+  // the threads do not outlive Run(), which keeps the process fork()-able
+  // between two runs
+  std::vector<std::thread> workers;
+  m_exit = false;
+  // set before the workers start, cleared once they are joined
+  m_parallel = nThreads > 1;
+  for (uint32_t i = 1; i < nThreads; ++i)
+    {
+      workers.emplace_back (&ThreadedSimulatorImpl::Worker, this, m_window);
+    }
+  NS_LOG_LOGIC (m_partitions.size () << " partitions on " << nThreads
+                << " threads, lookahead " << GetLookAhead ());
+
+  const uint64_t lookAhead = m_lookAhead;
+  while (!m_stop)
+    {
+      uint64_t next = NO_EVENT;
+      for (auto &partition : m_partitions)
+        {
+          Merge (*partition);
+          next = std::min (next, NextTs (*partition));
+        }
+      Merge (*m_global);
+      const uint64_t global = NextTs (*m_global);
+      if (next == NO_EVENT && global == NO_EVENT)
+        {
+          break;
+        }
+
+      if (global <= next)
+        {
+          // every partition reached the time stamp of the events without
+          // context, which run here one after the other
+          while (!m_stop && NextTs (*m_global) == global)
+            {
+              Scheduler::Event ev = m_global->events->RemoveNext ();
+              m_global->unscheduledEvents--;
+              m_global->eventCount++;
+              m_global->currentTs = ev.key.m_ts;
+              m_global->currentContext = ev.key.m_context;
+              m_global->currentUid = ev.key.m_uid;
+              ev.impl->Invoke ();
+              ev.impl->Unref ();
+            }
+          continue;
+        }
+
+      // no event sent during the window can arrive before its end
+      const uint64_t end = std::min (next > NO_EVENT - lookAhead ? NO_EVENT : next + lookAhead,
+                                     global);
+      uint32_t active = 0;
+      for (auto &partition : m_partitions)
+        {
+          active += NextTs (*partition) < end ? 1 : 0;
+        }
+      if (active <= 1 || workers.empty ())
+        {
+          for (auto &partition : m_partitions)
+            {
+              ProcessWindow (*partition, end);
+            }
+          continue;
+        }
+
+      {
+        std::unique_lock lock {m_mutex};
+        m_windowEnd = end;
+        m_nextPartition = 0;
+        m_busy = workers.size ();
+        ++m_window;
+      }
+      m_windowStart.notify_all ();
+      ProcessPartitions ();
+      std::unique_lock lock {m_mutex};
+      m_windowDone.wait (lock, [this] () { return m_busy == 0; });
+    }
+
+  {
+    std::unique_lock lock {m_mutex};
+    m_exit = true;
+  }
+  m_windowStart.notify_all ();
+  for (std::thread &worker : workers)
+    {
+      worker.join ();
+    }
+  m_parallel = false;
+
+  // Now () on the main thread
+  for (auto &partition : m_partitions)
+    {
+      m_global->currentTs = std::max (m_global->currentTs, partition->currentTs);
+    }
+}
+
+void
+ThreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+ThreadedSimulatorImpl::Stop (const Time &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+EventId
+ThreadedSimulatorImpl::Schedule (const Time &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (delay.IsPositive (), "ThreadedSimulatorImpl::Schedule(): Negative delay");
+  Partition &current = GetCurrent ();
+  Scheduler::EventKey key = Insert (current, current.currentTs + delay.GetTimeStep (),
+                                    current.currentContext, event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+ThreadedSimulatorImpl::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (delay.IsPositive (), "ThreadedSimulatorImpl::ScheduleWithContext(): Negative delay");
+  Partition &current = GetCurrent ();
+  const uint64_t ts = current.currentTs + delay.GetTimeStep ();
+  if (m_current == 0 && context != Simulator::NO_CONTEXT)
+    {
+      // between two windows, the nodes may be created at any time
+      AddPartitions (GetPartition (context) + 1);
+    }
+  Partition &target = GetPartitionOf (context);
+  if (m_current == 0 || &target == &current)
+    {
+      Insert (target, ts, context, event);
+      return;
+    }
+
+  if (delay.GetTimeStep () < m_lookAhead)
+    {
+      NS_FATAL_ERROR ("Event from partition " << current.index << " to context "
+                      << context << " after " << delay
+                      << ", less than the lookahead " << GetLookAhead ());
+    }
+  Message message;
+  message.ev.impl = event;
+  message.ev.key.m_ts = ts;
+  message.ev.key.m_context = context;
+  message.ev.key.m_uid = current.uid;
+  current.uid++;
+  message.source = current.index;
+  std::unique_lock lock {target.inboxMutex};
+  target.inbox.push_back (message);
+}
+
+EventId
+ThreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (Time (0), event);
+}
+
+EventId
+ThreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  EventId id (Ptr<EventImpl> (event, false), GetCurrent ().currentTs, 0xffffffff, 2);
+  std::unique_lock lock {m_mutex};
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+ThreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  return TimeStep (GetCurrent ().currentTs);
+}
+
+Time
+ThreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrent ().currentTs);
+    }
+}
+
+void
+ThreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == EventId::UID::DESTROY)
+    {
+      // destroy events.
+      std::unique_lock lock {m_mutex};
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition &owner = GetPartitionOf (id.GetContext ());
+  NS_ASSERT_MSG (m_current == 0 || m_current == &owner,
+                 "Remove of an event of context " << id.GetContext ()
+                 << " from partition " << m_current->index);
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  owner.events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  owner.unscheduledEvents--;
+}
+
+void
+ThreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+ThreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == EventId::UID::DESTROY)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  if (id.PeekEventImpl () == 0)
+    {
+      return true;
+    }
+  // the time stamps and uids of an event are those of its partition
+  const Partition &owner = GetPartitionOf (id.GetContext ());
+  if (id.GetTs () < owner.currentTs
+      || (id.GetTs () == owner.currentTs && id.GetUid () <= owner.currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+ThreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+ThreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+uint32_t
+ThreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrent ().currentContext;
+}
+
+uint64_t
+ThreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t count = m_global->eventCount;
+  for (const auto &partition : m_partitions)
+    {
+      count += partition->eventCount;
+    }
+  return count;
+}
+
+} // namespace ns3
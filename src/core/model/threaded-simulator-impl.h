@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef THREADED_SIMULATOR_IMPL_H
+#define THREADED_SIMULATOR_IMPL_H
+
+#include "simulator-impl.h"
+#include "scheduler.h"
+#include "nstime.h"
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::ThreadedSimulatorImpl declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Conservative parallel simulator running logical processes on
+ * threads of one process.
+ *
+ * The execution contexts (node ids) are divided into partitions, the
+ * logical processes, with SetPartition(); Node does it with its system
+ * id, so the nodes of NodeContainer::Create (n, systemId) share a
+ * partition.  Each partition has its own event list and clock, and the
+ * partitions run in parallel on up to MaxThreads threads, in windows of
+ * simulated time no longer than the lookahead: the smallest delay of
+ * an event sent from one partition to another.  The lookahead is set
+ * with BoundLookAhead(), which PointToPointChannel calls when it joins
+ * nodes of two partitions.  As with DistributedSimulatorImpl, the
+ * partitions must only interact through such channels, but the events
+ * which cross them are merged between two windows and nothing is
+ * serialized.  They carry a raw pointer to the receiving device and a
+ * Packet::DeepCopy() of the packet rather than the packet itself: the
+ * reference counts of a Packet and of the buffers it shares with its
+ * copies are not atomic, and the sender still holds the packet (trace
+ * sinks, the device transmitting it) while the receiver runs.
+ *
+ * Events without a context (Simulator::NO_CONTEXT), which include the
+ * ones scheduled before Simulator::Run() outside of a node, may touch
+ * any node: they run on the main thread between two windows, once all
+ * partitions have reached their time stamp.
+ *
+ * Event ordering only depends on the partitioning, so a run is
+ * reproducible whatever the number of threads, apart from the packet
+ * uids.  A Simulator::Stop() issued by an event with a context takes
+ * effect at the end of the current window.
+ *
+ * The events running in parallel must not share mutable state: any
+ * model that keeps global state (a FlowMonitor, trace sinks shared by
+ * several partitions, objects created at run time whose type has never
+ * been registered, random variables without an assigned stream, ...)
+ * has to be confined to one partition or to events without context.
+ */
+class ThreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  ThreadedSimulatorImpl ();
+  /** Destructor. */
+  ~ThreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (const Time &delay);
+  virtual EventId Schedule (const Time &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * Assign an execution context to a partition.  Contexts never
+   * assigned belong to partition 0.
+   *
+   * \param [in] context The context, usually a node id.
+   * \param [in] partition The partition.
+   */
+  static void SetPartition (uint32_t context, uint32_t partition);
+  /**
+   * \param [in] context The context.
+   * \returns The partition of the context.
+   */
+  static uint32_t GetPartition (uint32_t context);
+  /**
+   * \returns The partition running the calling event, or
+   *          Simulator::NO_CONTEXT outside of the windows (events without
+   *          context, other simulator implementations).
+   */
+  static uint32_t GetCurrentPartition (void);
+  /**
+   * Bound the lookahead, the smallest delay of an event scheduled from
+   * one partition into another.  The minimum of all bounds is used.
+   *
+   * \param [in] lookAhead The bound; must be > 0.
+   */
+  static void BoundLookAhead (const Time lookAhead);
+  /**
+   * \returns The lookahead, Time::Max() if it was never bounded.
+   */
+  static Time GetLookAhead (void);
+  /**
+   * \returns true while Run() has worker threads, i.e. while events may
+   *          run on several threads at once.  Packet uses it to number
+   *          its packets without an atomic operation otherwise.
+   */
+  static bool IsParallel (void);
+
+private:
+  // Inherited from Object
+  virtual void DoDispose (void);
+
+  /** An event sent by another partition, merged between two windows. */
+  struct Message
+  {
+    Scheduler::Event ev; //!< The event, m_uid is the sequence number at the source.
+    uint32_t source;     //!< The index of the source partition.
+  };
+
+  /** A logical process. */
+  struct Partition
+  {
+    Ptr<Scheduler> events;            //!< The event list.
+    uint32_t index;                   //!< Index in m_partitions, Simulator::NO_CONTEXT for m_global.
+    uint64_t currentTs;               //!< Timestamp of the current event.
+    uint32_t currentUid;              //!< Unique id of the current event.
+    uint32_t currentContext;          //!< Execution context of the current event.
+    uint32_t uid;                     //!< Next event unique id.
+    uint64_t eventCount;              //!< Events executed.
+    int unscheduledEvents;            //!< Events inserted but not yet executed.
+    std::mutex inboxMutex;            //!< Protects inbox.
+    std::vector<Message> inbox;       //!< Events sent by the other partitions.
+    std::vector<Message> merging;     //!< Inbox being merged, kept for its storage.
+  };
+
+  /**
+   * \param [in] context The context.
+   * \returns The partition running the events of the context, which
+   *          must exist.
+   */
+  Partition &GetPartitionOf (uint32_t context) const;
+  /**
+   * Create the partitions up to a number.
+   * \param [in] n The number of partitions.
+   */
+  void AddPartitions (uint32_t n);
+  /** \returns The partition of the running event, or m_global. */
+  Partition &GetCurrent (void) const;
+  /**
+   * Create a partition.
+   * \param [in] index Its index.
+   * \returns The new partition.
+   */
+  std::unique_ptr<Partition> CreatePartition (uint32_t index) const;
+  /**
+   * Insert an event in the event list of a partition.
+   * \param [in] partition The partition.
+   * \param [in] ts The time stamp.
+   * \param [in] context The context.
+   * \param [in] event The event.
+   * \returns The event key.
+   */
+  static Scheduler::EventKey Insert (Partition &partition, uint64_t ts,
+                                     uint32_t context, EventImpl *event);
+  /**
+   * Insert the events of the inbox of a partition in a deterministic
+   * order.
+   * \param [in] partition The partition.
+   */
+  static void Merge (Partition &partition);
+  /**
+   * \param [in] partition The partition.
+   * \returns The time stamp of its next event, or the maximum time.
+   */
+  static uint64_t NextTs (const Partition &partition);
+  /**
+   * Run the events of a partition up to (excluding) a time stamp.
+   * \param [in] partition The partition.
+   * \param [in] end The end of the window.
+   */
+  static void ProcessWindow (Partition &partition, uint64_t end);
+  /** Run the current window on the calling thread, partition by partition. */
+  void ProcessPartitions (void);
+  /**
+   * Body of the worker threads.
+   * \param [in] window The window counter when the thread was created.
+   */
+  void Worker (uint64_t window);
+
+  /** Container type for the events to run at Simulator::Destroy(). */
+  typedef std::list<EventId> DestroyEvents;
+
+  /** The container of events to run at Destroy(). */
+  DestroyEvents m_destroyEvents;
+  /** Flag calling for the end of the simulation. */
+  std::atomic<bool> m_stop;
+  /** The factory of the event lists. */
+  ObjectFactory m_schedulerFactory;
+  /** The logical processes. */
+  std::vector<std::unique_ptr<Partition> > m_partitions;
+  /** The events without context. */
+  std::unique_ptr<Partition> m_global;
+  /** Maximum number of threads, 0 for one per core. */
+  uint32_t m_maxThreads;
+
+  /** Protects the members below. */
+  std::mutex m_mutex;
+  /** Signals a new window to the workers. */
+  std::condition_variable m_windowStart;
+  /** Signals the end of the window to the main thread. */
+  std::condition_variable m_windowDone;
+  /** Window counter. */
+  uint64_t m_window;
+  /** End of the current window. */
+  uint64_t m_windowEnd;
+  /** Workers still running the current window. */
+  uint32_t m_busy;
+  /** Ask the workers to exit. */
+  bool m_exit;
+  /** Next partition of the current window to run. */
+  std::atomic<uint32_t> m_nextPartition;
+
+  /** The partition whose window the calling thread runs, if any. */
+  static thread_local Partition *m_current;
+  /** The lookahead, in time steps. */
+  static int64_t m_lookAhead;
+  /** Run() has worker threads. */
+  static bool m_parallel;
+};
+
+inline bool
+ThreadedSimulatorImpl::IsParallel (void)
+{
+  return m_parallel;
+}
+
+} // namespace ns3
+
+#endif /* THREADED_SIMULATOR_IMPL_H */
@@ -19,11 +19,17 @@
  */
 #include "ns3/test.h"
 #include "ns3/simulator.h"
+#include "ns3/event-impl.h"
+#include "ns3/uinteger.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include <set>
+#include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -212,6 +218,205 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the order of a scheduler against a sorted set, on a
+ * skewed event population.
+ *
+ * The timestamps mix events a few time steps ahead, bursts sharing
+ * one timestamp and events far in the future, and events are removed
+ * at random, as the Wi-Fi and transport timers do.
+ */
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param schedulerFactory Scheduler factory.
+   */
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Deterministic pseudo random numbers.
+   * \return The next number.
+   */
+  uint32_t Next (void);
+
+  ObjectFactory m_schedulerFactory; //!< Scheduler factory.
+  uint64_t m_state;                 //!< State of Next().
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the event order on a skewed population with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory),
+    m_state (1)
+{}
+
+uint32_t
+SchedulerOrderTestCase::Next (void)
+{
+  m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return static_cast<uint32_t> (m_state >> 33);
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  std::set<std::pair<uint64_t, uint32_t> > reference;
+  std::vector<Scheduler::Event> pending;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+
+  for (uint32_t step = 0; step < 20000; ++step)
+    {
+      const uint32_t action = Next () % 8;
+      if (action < 4 || reference.empty ())
+        {
+          uint64_t delay;
+          switch (Next () % 4)
+            {
+            case 0:
+              delay = Next () % 16;               // a few steps ahead
+              break;
+            case 1:
+              delay = 1000;                       // bursts on one timestamp
+              break;
+            case 2:
+              delay = Next () % 100000;
+              break;
+            default:
+              delay = 1000000000 + Next () % 10;  // far in the future
+              break;
+            }
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key.m_ts = now + delay;
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          reference.insert ({ev.key.m_ts, ev.key.m_uid});
+          pending.push_back (ev);
+        }
+      else if (action < 7)
+        {
+          NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "events pending");
+          const Scheduler::Event peek = scheduler->PeekNext ();
+          const Scheduler::Event ev = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (peek.key.m_uid, ev.key.m_uid, "PeekNext () == RemoveNext ()");
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_ts, reference.begin ()->first, "timestamp order");
+          NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, reference.begin ()->second, "uid order");
+          reference.erase (reference.begin ());
+          now = ev.key.m_ts;
+        }
+      else
+        {
+          // remove a random event, if still pending
+          const Scheduler::Event ev = pending[Next () % pending.size ()];
+          if (reference.erase ({ev.key.m_ts, ev.key.m_uid}) == 1)
+            {
+              scheduler->Remove (ev);
+            }
+        }
+    }
+  while (!reference.empty ())
+    {
+      const Scheduler::Event ev = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (ev.key.m_uid, reference.begin ()->second, "uid order while draining");
+      reference.erase (reference.begin ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "all events removed");
+}
+
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that executed events are recycled.
+ */
+class EventPoolingTestCase : public TestCase
+{
+public:
+  EventPoolingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Schedule the next event of a chain, alternating between a small
+   * event and a lambda of more than a cache line.
+   * \param remaining the number of events still to schedule.
+   */
+  void Chain (uint32_t remaining);
+  /**
+   * Run a chain of events.
+   * \param n the number of events.
+   * \return the number of events taken from the heap.
+   */
+  uint64_t RunChain (uint32_t n);
+
+  uint32_t m_executed; //!< Events executed.
+};
+
+EventPoolingTestCase::EventPoolingTestCase ()
+  : TestCase ("Executed events are recycled")
+{
+}
+
+void
+EventPoolingTestCase::Chain (uint32_t remaining)
+{
+  ++m_executed;
+  if (remaining == 0)
+    {
+      return;
+    }
+  // alternate between two size classes
+  if (remaining % 2 == 0)
+    {
+      Simulator::Schedule (NanoSeconds (1), &EventPoolingTestCase::Chain, this, remaining - 1);
+    }
+  else
+    {
+      uint8_t payload[100] = {};
+      payload[0] = 1;
+      Simulator::Schedule (NanoSeconds (1), [this, remaining, payload] () {
+        m_executed += payload[0] - 1;
+        Chain (remaining - 1);
+      });
+    }
+}
+
+uint64_t
+EventPoolingTestCase::RunChain (uint32_t n)
+{
+  m_executed = 0;
+  const uint64_t heap = EventImpl::GetNHeapAllocated ();
+  Simulator::Schedule (Seconds (0), &EventPoolingTestCase::Chain, this, n - 1);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_executed, n, "all events executed");
+  return EventImpl::GetNHeapAllocated () - heap;
+}
+
+void
+EventPoolingTestCase::DoRun (void)
+{
+  const uint64_t allocated = EventImpl::GetNAllocated ();
+  RunChain (10);
+  NS_TEST_ASSERT_MSG_EQ (EventImpl::GetNAllocated () - allocated, 10, "one allocation per event");
+  const uint64_t pooled = RunChain (1000);
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (pooled, 2, "events recycled");
+
+  EventImpl::SetPooling (false);
+  const uint64_t unpooled = RunChain (1000);
+  EventImpl::SetPooling (true);
+  NS_TEST_ASSERT_MSG_EQ (unpooled, 1000, "every event from the heap");
+  Simulator::Destroy ();
+}
+
 
 /**
  * \ingroup simulator-tests
@@ -554,6 +759,23 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (PriorityQueueScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    factory.Set ("Threshold", UintegerValue (4));
+    factory.Set ("MaxRungs", UintegerValue (3));
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+
+    AddTestCase (new EventPoolingTestCase, TestCase::QUICK);
   }
 };
 
@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/warm-start-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup core-helpers
+ * WarmStartHelper test suite.
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+
+/**
+ * \ingroup core-tests
+ *  Fork() without registered variants
+ */
+class WarmStartNotForkedTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  WarmStartNotForkedTestCase ();
+  virtual void DoRun (void);
+};
+
+WarmStartNotForkedTestCase::WarmStartNotForkedTestCase ()
+  : TestCase ("Check that Fork() without variants leaves the simulator alone")
+{}
+
+void
+WarmStartNotForkedTestCase::DoRun (void)
+{
+  WarmStartHelper warmStart;
+  NS_TEST_ASSERT_MSG_EQ (warmStart.GetNVariants (), 0, "No variant registered");
+  NS_TEST_ASSERT_MSG_EQ (warmStart.Fork (Seconds (1)), WarmStartHelper::NOT_FORKED,
+                         "Fork() without variants must not fork");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (0), "The warm-up must not be run");
+  NS_TEST_ASSERT_MSG_EQ (warmStart.GetNFailed (), 0, "No variant can fail");
+  NS_TEST_ASSERT_MSG_EQ (warmStart.GetSavedMs (), 0, "No setup can be saved");
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup core-tests
+ *  Fork() of several variants, one of which fails
+ *
+ *  Every child writes, in its own directory, the variant applied by its
+ *  setup function, the events run during the warm-up and the simulation
+ *  time at the fork; the parent reads these files back.
+ */
+class WarmStartForkTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  WarmStartForkTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /** Event of the warm-up. */
+  void Count (void);
+
+  uint32_t m_events;   //!< Events run
+  int64_t m_variant;   //!< Variant applied by the setup function
+};
+
+WarmStartForkTestCase::WarmStartForkTestCase ()
+  : TestCase ("Check that the variants continue from the warm-up in their directory")
+{}
+
+void
+WarmStartForkTestCase::Count (void)
+{
+  m_events++;
+}
+
+void
+WarmStartForkTestCase::DoRun (void)
+{
+  m_events = 0;
+  m_variant = -1;
+  const uint32_t nVariants = 3;
+  // the last variant fails
+  const int64_t failing = nVariants - 1;
+
+  WarmStartHelper warmStart;
+  std::vector<std::string> directories;
+  for (uint32_t i = 0; i < nVariants; i++)
+    {
+      std::ostringstream name;
+      name << "warm-start-variant-" << i;
+      directories.push_back (CreateTempDirFilename (name.str ()));
+      warmStart.AddVariant (directories.back (), [this, i] () { m_variant = i; });
+    }
+  warmStart.SetMaxParallel (2);
+
+  Simulator::Schedule (Seconds (1), &WarmStartForkTestCase::Count, this);
+  Simulator::Schedule (Seconds (3), &WarmStartForkTestCase::Count, this);
+
+  const int64_t index = warmStart.Fork (Seconds (2));
+  if (index >= 0)
+    {
+      // child: record its state and leave without returning to the test runner
+      std::ofstream result ("result");
+      result << m_variant << " " << m_events << " " << Simulator::Now ().GetSeconds () << std::endl;
+      result.close ();
+      _exit (index == failing ? 1 : 0);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (index, WarmStartHelper::PARENT, "The parent must return PARENT");
+  NS_TEST_ASSERT_MSG_EQ (m_events, 1, "The parent must have run the warm-up only");
+  NS_TEST_ASSERT_MSG_EQ (m_variant, -1, "The setup functions must only run in the children");
+  NS_TEST_ASSERT_MSG_EQ (warmStart.GetNFailed (), 1, "One variant failed");
+  NS_TEST_ASSERT_MSG_EQ ((warmStart.GetTotalMs () >= warmStart.GetSetupMs ()), true,
+                         "The total time includes the setup time");
+  NS_TEST_ASSERT_MSG_EQ (warmStart.GetSavedMs (), warmStart.GetSetupMs () * (nVariants - 1),
+                         "Every variant but one would have run the setup");
+
+  for (uint32_t i = 0; i < nVariants; i++)
+    {
+      std::ifstream result (directories[i] + "/result");
+      NS_TEST_ASSERT_MSG_EQ (result.is_open (), true, "Variant " << i << " must run in its directory");
+      int64_t variant;
+      uint32_t events;
+      double now;
+      result >> variant >> events >> now;
+      NS_TEST_EXPECT_MSG_EQ (variant, i, "Variant " << i << " must apply its own setup");
+      NS_TEST_EXPECT_MSG_EQ (events, 1, "Variant " << i << " must continue from the warm-up");
+      NS_TEST_EXPECT_MSG_EQ (now, 2, "Variant " << i << " must start at the warm-up time");
+    }
+
+  std::ostringstream report;
+  warmStart.PrintReport (report);
+  NS_TEST_EXPECT_MSG_EQ ((report.str ().find ("(failed)") != std::string::npos), true,
+                         "The report must show the failed variant");
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup core-tests
+ *  WarmStartHelper test suite
+ */
+class WarmStartHelperTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  WarmStartHelperTestSuite ()
+    : TestSuite ("warm-start-helper")
+  {
+    AddTestCase (new WarmStartNotForkedTestCase ());
+    AddTestCase (new WarmStartForkTestCase ());
+  }
+};
+
+/**
+ * \ingroup core-tests
+ * WarmStartHelperTestSuite instance variable.
+ */
+static WarmStartHelperTestSuite g_warmStartHelperTestSuite;
+
+
+}    // namespace tests
+
+}  // namespace ns3
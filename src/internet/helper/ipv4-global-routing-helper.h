@@ -85,6 +85,18 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Rebuild the representation of the global topology, and
+   * recompute the routes of the nodes whose shortest path tree may have
+   * changed since the last computation.
+   *
+   * The routes are the ones RecomputeRoutingTables() would install, but
+   * the nodes which cannot reach any changed link keep their routes, which
+   * saves most of the work after a local change in a partitioned
+   * topology.  The computations of the nodes may run in several threads,
+   * see the "GlobalRoutingThreads" global value.
+   */
+  static void UpdateRoutingTables (void);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
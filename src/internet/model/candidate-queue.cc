@@ -18,8 +18,10 @@
 
 #include <algorithm>
 #include <iostream>
+#include <vector>
 #include "ns3/log.h"
 #include "ns3/assert.h"
+#include "ns3/fatal-error.h"
 #include "candidate-queue.h"
 #include "global-route-manager-impl.h"
 
@@ -57,16 +59,18 @@ operator<< (std::ostream& os, const CandidateQueue& q)
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->second->GetVertexId () << ", "
+      << iter->second->GetDistanceFromRoot () << ", "
+      << iter->second->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_keys (),
+    m_nInserted (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +98,11 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  // a vertex goes after the vertices with the same distance and type,
+  // which the order of insertion in the key achieves
+  Key_t key = GetKey (vNew, m_nInserted++);
+  m_keys.insert (std::make_pair (vNew->GetVertexId (), key));
+  m_candidates.insert (std::make_pair (key, vNew));
 }
 
 SPFVertex *
@@ -110,8 +114,9 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.begin ()->second;
+  m_keys.erase (FindKey (v));
+  m_candidates.erase (m_candidates.begin ());
   return v;
 }
 
@@ -124,7 +129,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.begin ()->second;
 }
 
 bool
@@ -145,18 +150,19 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  // the first of the candidates with this ID, in the order of the queue
+  std::pair<KeyIndex_t::const_iterator, KeyIndex_t::const_iterator> range = m_keys.equal_range (addr);
+  if (range.first == range.second)
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return 0;
     }
 
-  return 0;
+  Key_t first = range.first->second;
+  for (KeyIndex_t::const_iterator i = range.first; i != range.second; i++)
+    {
+      first = std::min (first, i->second);
+    }
+  return m_candidates.find (first)->second;
 }
 
 void
@@ -164,11 +170,59 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  // a stable sort of the candidates in their current order, after which
+  // the order of insertion follows the new order
+  std::vector<SPFVertex *> vertices;
+  vertices.reserve (m_candidates.size ());
+  for (CandidateList_t::iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
+    {
+      vertices.push_back (i->second);
+    }
+  std::stable_sort (vertices.begin (), vertices.end (), &CandidateQueue::CompareSPFVertex);
+  m_candidates.clear ();
+  m_keys.clear ();
+  for (std::vector<SPFVertex *>::iterator i = vertices.begin (); i != vertices.end (); i++)
+    {
+      Push (*i);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  KeyIndex_t::iterator i = FindKey (v);
+  m_candidates.erase (i->second);
+  i->second = GetKey (v, m_nInserted++);
+  m_candidates.insert (std::make_pair (i->second, v));
+}
+
+CandidateQueue::KeyIndex_t::iterator
+CandidateQueue::FindKey (const SPFVertex* v)
+{
+  std::pair<KeyIndex_t::iterator, KeyIndex_t::iterator> range = m_keys.equal_range (v->GetVertexId ());
+  for (KeyIndex_t::iterator i = range.first; i != range.second; i++)
+    {
+      if (m_candidates.find (i->second)->second == v)
+        {
+          return i;
+        }
+    }
+  NS_FATAL_ERROR ("CandidateQueue: Vertex " << v->GetVertexId () << " not queued");
+  return m_keys.end ();
+}
+
+CandidateQueue::Key_t
+CandidateQueue::GetKey (const SPFVertex* v, uint64_t order)
+{
+  return Key_t (v->GetDistanceFromRoot (),
+                v->GetVertexType () == SPFVertex::VertexNetwork ? 0 : 1,
+                order);
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <map>
+#include <tuple>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +48,10 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The candidates are kept in a map ordered by distance, vertex type and
+ * order of insertion, with an index by vertex ID, so that Push (), Pop (),
+ * Find () and the Reorder () of one vertex take a logarithmic time.
  */
 class CandidateQueue
 {
@@ -154,6 +159,18 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Moves a Shortest Path First Vertex of the Candidate Queue after
+ * a change of its m_distanceFromRoot.
+ *
+ * The vertex is placed as if it were pushed again, which is where
+ * Reorder () would place it when its distance has decreased.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance has changed.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +201,35 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
+/**
+ * \brief Position of a candidate in the queue: its distance from the
+ * root, 0 for a network vertex and 1 otherwise, and its order of
+ * insertion
+ */
+  typedef std::tuple<uint32_t, uint32_t, uint64_t> Key_t;
+
+/**
+ * \brief Get the position of a vertex in the queue
+ *
+ * \param v the vertex
+ * \param order the order of its insertion
+ * \return the position of the vertex
+ */
+  static Key_t GetKey (const SPFVertex* v, uint64_t order);
+
+  typedef std::map<Key_t, SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers, by position
   CandidateList_t m_candidates;  //!< SPFVertex candidates
+  typedef std::multimap<Ipv4Address, Key_t> KeyIndex_t; //!< container of positions, by vertex ID
+  KeyIndex_t m_keys;             //!< Position of each candidate, by vertex ID
+  uint64_t m_nInserted;          //!< Number of insertions, for the order of the candidates
+
+/**
+ * \brief Find the position of a candidate in the index by vertex ID
+ *
+ * \param v the candidate
+ * \return the entry of the candidate
+ */
+  KeyIndex_t::iterator FindKey (const SPFVertex* v);
 
   /**
    * \brief Stream insertion operator.
@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -37,6 +38,7 @@ namespace ns3 {
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
 
 /**
@@ -674,6 +676,37 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+/**
+ * @brief Copy the database, with all of its Link State Advertisements.
+ *
+ * An SPF computation changes the status of the LSAs, so computations
+ * running at the same time each need their own copy of the database.
+ *
+ * @returns A new database, to be deleted by the caller.
+ */
+  GlobalRouteManagerLSDB* Copy (void) const;
+
+/**
+ * @brief Get the IDs of the Link State Advertisements on which the last SPF
+ * computation depends.
+ *
+ * These are the LSAs explored by the computation, that is whose status is
+ * not LSA_SPF_NOT_EXPLORED, and the ones their links and attached routers
+ * refer to, present in the database or not.
+ *
+ * @param ids The vector to which the IDs are appended, in increasing order.
+ */
+  void GetSPFDependencies (std::vector<Ipv4Address> &ids) const;
+
+/**
+ * @brief Get the IDs of the Link State Advertisements of this database
+ * which differ from the ones of another database or are not in it.
+ *
+ * @param other The other database.
+ * @param ids The set to which the IDs are added.
+ * @returns True if the External Link State Advertisements differ.
+ */
+  bool GetChangedLSAs (const GlobalRouteManagerLSDB* other, std::set<Ipv4Address> &ids) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -681,6 +714,8 @@ private:
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  mutable LSDBMap_t m_linkDataIndex; //!< first LSA with a transit link of each link data, built by GetLSAByLinkData
+  mutable bool m_linkDataIndexed; //!< whether m_linkDataIndex is up to date
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -735,6 +770,18 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and compute again the routes of the
+ * routers whose shortest path tree may have changed.
+ *
+ * The routes of a router are computed again if one of the Link State
+ * Advertisements its last tree depends on changed, or if an External Link
+ * State Advertisement changed.  The routes of the other
+ * routers are kept.  Without a database, this is DeleteGlobalRoutes (),
+ * BuildGlobalRoutingDatabase () and InitializeRoutes ().
+ */
+  virtual void UpdateRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  * @param lsdb the pre-built LSDB
@@ -769,6 +816,40 @@ private:
 
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  Ptr<Node> m_spfrootNode; //!< the node of the root, if any, during an SPF calculation
+  Ptr<Ipv4> m_spfrootIpv4; //!< the Ipv4 of the node of the root
+  Ptr<Ipv4GlobalRouting> m_spfrootRouting; //!< the global routing protocol of the node of the root
+  /// IDs of the LSAs on which the last SPF calculation of each router depends, by router ID
+  std::map<Ipv4Address, std::vector<Ipv4Address> > m_spfDependencies;
+
+  /// The routers of which to calculate the routes: router ID and node
+  typedef std::vector<std::pair<Ipv4Address, Ptr<Node> > > Roots_t;
+
+  /**
+   * \brief Get the routers of the nodes of this system with LSAs
+   *
+   * \returns the router ID and node of each router, in the order of the
+   * node list
+   */
+  Roots_t GetRoots (void) const;
+
+  /**
+   * \brief Calculate the routes of routers
+   *
+   * The SPF calculations run in the number of threads of the
+   * "GlobalRoutingThreads" global value, each thread with its own copy of
+   * the Link State DataBase.
+   *
+   * \param roots the routers
+   */
+  void CalculateRoutes (const Roots_t &roots);
+
+  /**
+   * \brief Delete all the routes of a node
+   *
+   * \param node the node
+   */
+  void DeleteRoutes (Ptr<Node> node);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -787,8 +868,9 @@ private:
    *
    * Equivalent to quagga ospf_spf_calculate
    * \param root the root node
+   * \param node the node of the root, to which the routes are added, or 0
    */
-  void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (Ipv4Address root, Ptr<Node> node);
 
   /**
    * \brief Process Stub nodes
@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <algorithm>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -53,13 +54,21 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("UsePrefixIndex",
+                   "Set to true to look up the host and network routes in an index by prefix; set to false for a linear search of the routes",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_usePrefixIndex),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_usePrefixIndex (true),
+    m_generation (1),
+    m_indexGeneration (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +89,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_generation++;
 }
 
 void 
@@ -90,6 +100,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_generation++;
 }
 
 void 
@@ -105,6 +116,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_generation++;
 }
 
 void 
@@ -118,6 +130,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_generation++;
 }
 
 void 
@@ -133,6 +146,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_generation++;
 }
 
 
@@ -146,47 +160,54 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  if (m_usePrefixIndex)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest () == dest)
+      LookupIndex (dest, oif, allRoutes);
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
+      for (HostRoutesCI i = m_hostRoutes.begin (); 
+           i != m_hostRoutes.end (); 
+           i++) 
         {
-          if (oif != 0)
+          NS_ASSERT ((*i)->IsHost ());
+          if ((*i)->GetDest () == dest)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != 0)
                 {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
+                  if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+                    {
+                      NS_LOG_LOGIC ("Not on requested interface, skipping");
+                      continue;
+                    }
                 }
+              allRoutes.push_back (*i);
+              NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
         }
-    }
-  if (allRoutes.size () == 0) // if no host route is found
-    {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      if (allRoutes.size () == 0) // if no host route is found
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
+          for (NetworkRoutesI j = m_networkRoutes.begin (); 
+               j != m_networkRoutes.end (); 
+               j++) 
             {
-              if (oif != 0)
+              Ipv4Mask mask = (*j)->GetDestNetworkMask ();
+              Ipv4Address entry = (*j)->GetDestNetwork ();
+              if (mask.IsMatch (dest, entry)) 
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                  if (oif != 0)
                     {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
+                      if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                        {
+                          NS_LOG_LOGIC ("Not on requested interface, skipping");
+                          continue;
+                        }
                     }
+                  allRoutes.push_back (*j);
+                  NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
             }
         }
     }
@@ -245,6 +266,80 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+void
+Ipv4GlobalRouting::LookupIndex (Ipv4Address dest, Ptr<NetDevice> oif, std::vector<Ipv4RoutingTableEntry *> &routes)
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  if (m_indexGeneration != m_generation)
+    {
+      NS_LOG_LOGIC ("Routes changed, rebuilding the prefix indexes");
+      m_hostIndex.Clear ();
+      for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+        {
+          m_hostIndex.Add (*i);
+        }
+      m_networkIndex.Clear ();
+      for (NetworkRoutesCI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
+        {
+          m_networkIndex.Add (*j);
+        }
+      m_indexGeneration = m_generation;
+    }
+
+  // all host routes are /32, in a single group
+  for (uint32_t g = 0; g < m_hostIndex.GetNGroups (); g++)
+    {
+      const std::vector<Ipv4PrefixIndex::Entry> *entries = m_hostIndex.Find (g, dest);
+      if (entries == 0)
+        {
+          continue;
+        }
+      for (std::vector<Ipv4PrefixIndex::Entry>::const_iterator i = entries->begin (); i != entries->end (); i++)
+        {
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (i->route->GetInterface ()))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          routes.push_back (i->route);
+          NS_LOG_LOGIC (routes.size () << "Found global host route" << i->route);
+        }
+    }
+  if (routes.size () != 0)
+    {
+      return;
+    }
+
+  // the network routes of all prefix lengths match, not only the longest
+  // one: take them in the order of m_networkRoutes
+  std::vector<Ipv4PrefixIndex::Entry> found;
+  for (uint32_t g = 0; g < m_networkIndex.GetNGroups (); g++)
+    {
+      const std::vector<Ipv4PrefixIndex::Entry> *entries = m_networkIndex.Find (g, dest);
+      if (entries == 0)
+        {
+          continue;
+        }
+      for (std::vector<Ipv4PrefixIndex::Entry>::const_iterator j = entries->begin (); j != entries->end (); j++)
+        {
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (j->route->GetInterface ()))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          found.push_back (*j);
+        }
+    }
+  std::sort (found.begin (), found.end (),
+             [] (const Ipv4PrefixIndex::Entry &a, const Ipv4PrefixIndex::Entry &b)
+             { return a.rank < b.rank; });
+  for (std::vector<Ipv4PrefixIndex::Entry>::const_iterator j = found.begin (); j != found.end (); j++)
+    {
+      routes.push_back (j->route);
+      NS_LOG_LOGIC (routes.size () << "Found global network route" << j->route);
+    }
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -309,6 +404,7 @@ void
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  m_generation++;
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -458,6 +554,13 @@ Ipv4GlobalRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Uni
   (*os).copyfmt (oldState);
 }
 
+uint32_t
+Ipv4GlobalRouting::GetRouteGeneration (void) const
+{
+  // a random choice among equal cost routes is made for each packet
+  return m_randomEcmpRouting ? 0 : m_generation;
+}
+
 Ptr<Ipv4Route>
 Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
 {
@@ -544,9 +647,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -556,9 +657,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -568,9 +667,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -580,9 +677,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateRoutes ();
     }
 }
 
@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ipv4-prefix-index.h"
 
 namespace ns3 {
 
@@ -99,6 +100,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  virtual uint32_t GetRouteGeneration (void) const;
 
   /**
    * \brief Add a host route to the global routing table.
@@ -236,6 +238,8 @@ private:
   bool m_randomEcmpRouting;
   /// Set to true if this interface should respond to interface events by globallly recomputing routes 
   bool m_respondToInterfaceEvents;
+  /// Set to true to look up the host and network routes in a prefix index, false for a linear search
+  bool m_usePrefixIndex;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
 
@@ -268,11 +272,28 @@ private:
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Find the host routes to a destination or, if there are none,
+   * the network routes, in the prefix indexes.
+   *
+   * The routes are those the linear search of LookupGlobal finds, in the
+   * same order.  The indexes are rebuilt first if the routes changed.
+   *
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \param routes the routes found, appended
+   */
+  void LookupIndex (Ipv4Address dest, Ptr<NetDevice> oif, std::vector<Ipv4RoutingTableEntry *> &routes);
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
+  uint32_t m_generation; //!< Changed with the routes
+  Ipv4PrefixIndex m_hostIndex;    //!< Index of m_hostRoutes
+  Ipv4PrefixIndex m_networkIndex; //!< Index of m_networkRoutes
+  uint32_t m_indexGeneration;     //!< Value of m_generation when the indexes were built
 };
 
 } // Namespace ns3
@@ -385,11 +385,18 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
 
+  uint8_t copy[20];
+  uint8_t *bytes = i.ReserveContiguous (20);
+  uint8_t *fields = bytes != 0 ? bytes : copy;
+
   uint8_t verIhl = (4 << 4) | (5);
-  i.WriteU8 (verIhl);
-  i.WriteU8 (m_tos);
-  i.WriteHtonU16 (m_payloadSize + 5*4);
-  i.WriteHtonU16 (m_identification);
+  fields[0] = verIhl;
+  fields[1] = m_tos;
+  uint16_t size = m_payloadSize + 5*4;
+  fields[2] = size >> 8;
+  fields[3] = size & 0xff;
+  fields[4] = m_identification >> 8;
+  fields[5] = m_identification & 0xff;
   uint32_t fragmentOffset = m_fragmentOffset / 8;
   uint8_t flagsFrag = (fragmentOffset >> 8) & 0x1f;
   if (m_flags & DONT_FRAGMENT) 
@@ -400,14 +407,23 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
     {
       flagsFrag |= (1<<5);
     }
-  i.WriteU8 (flagsFrag);
-  uint8_t frag = fragmentOffset & 0xff;
-  i.WriteU8 (frag);
-  i.WriteU8 (m_ttl);
-  i.WriteU8 (m_protocol);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU32 (m_source.Get ());
-  i.WriteHtonU32 (m_destination.Get ());
+  fields[6] = flagsFrag;
+  fields[7] = fragmentOffset & 0xff;
+  fields[8] = m_ttl;
+  fields[9] = m_protocol;
+  fields[10] = 0;
+  fields[11] = 0;
+  uint32_t source = m_source.Get ();
+  uint32_t destination = m_destination.Get ();
+  for (uint32_t j = 0; j < 4; j++)
+    {
+      fields[12 + j] = (source >> (24 - 8 * j)) & 0xff;
+      fields[16 + j] = (destination >> (24 - 8 * j)) & 0xff;
+    }
+  if (bytes == 0)
+    {
+      i.Write (copy, 20);
+    }
 
   if (m_calcChecksum) 
     {
@@ -425,7 +441,7 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
   NS_LOG_FUNCTION (this << &start);
   Buffer::Iterator i = start;
 
-  uint8_t verIhl = i.ReadU8 ();
+  uint8_t verIhl = i.PeekU8 ();
   uint8_t ihl = verIhl & 0x0f; 
   uint16_t headerSize = ihl * 4;
 
@@ -435,11 +451,18 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
       return 0;
     }
 
-  m_tos = i.ReadU8 ();
-  uint16_t size = i.ReadNtohU16 ();
+  uint8_t copy[20];
+  const uint8_t *fields = i.ReserveContiguous (20);
+  if (fields == 0)
+    {
+      i.Read (copy, 20);
+      fields = copy;
+    }
+  m_tos = fields[1];
+  uint16_t size = (fields[2] << 8) | fields[3];
   m_payloadSize = size - headerSize;
-  m_identification = i.ReadNtohU16 ();
-  uint8_t flags = i.ReadU8 ();
+  m_identification = (fields[4] << 8) | fields[5];
+  uint8_t flags = fields[6];
   m_flags = 0;
   if (flags & (1<<6)) 
     {
@@ -449,17 +472,23 @@ Ipv4Header::Deserialize (Buffer::Iterator start)
     {
       m_flags |= MORE_FRAGMENTS;
     }
-  i.Prev ();
-  m_fragmentOffset = i.ReadU8 () & 0x1f;
+  m_fragmentOffset = flags & 0x1f;
   m_fragmentOffset <<= 8;
-  m_fragmentOffset |= i.ReadU8 ();
+  m_fragmentOffset |= fields[7];
   m_fragmentOffset <<= 3;
-  m_ttl = i.ReadU8 ();
-  m_protocol = i.ReadU8 ();
-  m_checksum = i.ReadU16 ();
-  /* i.Next (2); // checksum */
-  m_source.Set (i.ReadNtohU32 ());
-  m_destination.Set (i.ReadNtohU32 ());
+  m_ttl = fields[8];
+  m_protocol = fields[9];
+  // the checksum is read as ReadU16 does
+  m_checksum = fields[10] | (fields[11] << 8);
+  uint32_t source = 0;
+  uint32_t destination = 0;
+  for (uint32_t j = 0; j < 4; j++)
+    {
+      source = (source << 8) | fields[12 + j];
+      destination = (destination << 8) | fields[16 + j];
+    }
+  m_source.Set (source);
+  m_destination.Set (destination);
   m_headerSize = headerSize;
 
   if (m_calcChecksum) 
@@ -211,11 +211,39 @@ Ipv4Interface::SetForwarding (bool val)
 
 void
 Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << *p << dest);
+  Address hardwareDestination;
+  DoSend (p, hdr, dest, &hardwareDestination);
+}
+
+void
+Ipv4Interface::Send (const std::list<std::pair<Ptr<Packet>, Ipv4Header> > &packets, Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << packets.size () << dest);
+  Address hardwareDestination;
+  bool resolved = false;
+  for (std::list<std::pair<Ptr<Packet>, Ipv4Header> >::const_iterator it = packets.begin ();
+       it != packets.end (); it++)
+    {
+      if (resolved)
+        {
+          m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (it->first, hardwareDestination, Ipv4L3Protocol::PROT_NUMBER, it->second));
+        }
+      else
+        {
+          resolved = DoSend (it->first, it->second, dest, &hardwareDestination);
+        }
+    }
+}
+
+bool
+Ipv4Interface::DoSend (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest, Address *hardwareDestination)
 {
   NS_LOG_FUNCTION (this << *p << dest);
   if (!IsUp ())
     {
-      return;
+      return false;
     }
 
   // Check for a loopback device, if it's the case we don't pass through
@@ -226,7 +254,7 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
       /// goes to loopback)?
       p->AddHeader (hdr);
       m_device->Send (p, m_device->GetBroadcast (), Ipv4L3Protocol::PROT_NUMBER);
-      return;
+      return false;
     } 
 
   NS_ASSERT (m_tc != 0);
@@ -241,19 +269,18 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
                          m_device->GetBroadcast (),
                          m_device->GetBroadcast (),
                          NetDevice::PACKET_HOST);
-          return;
+          return false;
         }
     }
   if (m_device->NeedsArp ())
     {
       NS_LOG_LOGIC ("Needs ARP" << " " << dest);
       Ptr<ArpL3Protocol> arp = m_node->GetObject<ArpL3Protocol> ();
-      Address hardwareDestination;
       bool found = false;
       if (dest.IsBroadcast ())
         {
           NS_LOG_LOGIC ("All-network Broadcast");
-          hardwareDestination = m_device->GetBroadcast ();
+          *hardwareDestination = m_device->GetBroadcast ();
           found = true;
         }
       else if (dest.IsMulticast ())
@@ -263,7 +290,7 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
                          "ArpIpv4Interface::SendTo (): Sending multicast packet over "
                          "non-multicast device");
 
-          hardwareDestination = m_device->GetMulticast (dest);
+          *hardwareDestination = m_device->GetMulticast (dest);
           found = true;
         }
       else
@@ -273,7 +300,7 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
               if (dest.IsSubnetDirectedBroadcast ((*i).GetMask ()))
                 {
                   NS_LOG_LOGIC ("Subnetwork Broadcast");
-                  hardwareDestination = m_device->GetBroadcast ();
+                  *hardwareDestination = m_device->GetBroadcast ();
                   found = true;
                   break;
                 }
@@ -281,20 +308,23 @@ Ipv4Interface::Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest)
           if (!found)
             {
               NS_LOG_LOGIC ("ARP Lookup");
-              found = arp->Lookup (p, hdr, dest, m_device, m_cache, &hardwareDestination);
+              found = arp->Lookup (p, hdr, dest, m_device, m_cache, hardwareDestination);
             }
         }
 
       if (found)
         {
           NS_LOG_LOGIC ("Address Resolved.  Send.");
-          m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (p, hardwareDestination, Ipv4L3Protocol::PROT_NUMBER, hdr));
+          m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (p, *hardwareDestination, Ipv4L3Protocol::PROT_NUMBER, hdr));
         }
+      return found;
     }
   else
     {
       NS_LOG_LOGIC ("Doesn't need ARP");
-      m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (p, m_device->GetBroadcast (), Ipv4L3Protocol::PROT_NUMBER, hdr));
+      *hardwareDestination = m_device->GetBroadcast ();
+      m_tc->Send (m_device, Create<Ipv4QueueDiscItem> (p, *hardwareDestination, Ipv4L3Protocol::PROT_NUMBER, hdr));
+      return true;
     }
 }
 
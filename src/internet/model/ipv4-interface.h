@@ -23,11 +23,13 @@
 #define IPV4_INTERFACE_H
 
 #include <list>
+#include <utility>
 #include "ns3/ptr.h"
 #include "ns3/object.h"
 
 namespace ns3 {
 
+class Address;
 class NetDevice;
 class Packet;
 class Node;
@@ -160,6 +162,15 @@ public:
    */ 
   void Send (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest);
 
+  /**
+   * \param packets packets to send, with their IPv4 header
+   * \param dest next hop address of the packets.
+   *
+   * Send packets to the same next hop, resolving its hardware address
+   * once for all of them.
+   */
+  void Send (const std::list<std::pair<Ptr<Packet>, Ipv4Header> > &packets, Ipv4Address dest);
+
   /**
    * \param address The Ipv4InterfaceAddress to add to the interface
    * \returns true if succeeded
@@ -201,6 +212,17 @@ private:
    */
   void DoSetup (void);
 
+  /**
+   * \brief Send a packet.
+   * \param p packet to send
+   * \param hdr IPv4 header
+   * \param dest next hop address of packet
+   * \param hardwareDestination the hardware address the packet was sent to
+   * \returns true if the packet was passed to the traffic control layer
+   *          with a resolved hardware address
+   */
+  bool DoSend (Ptr<Packet> p, const Ipv4Header & hdr, Ipv4Address dest, Address *hardwareDestination);
+
 
   /**
    * \brief Container for the Ipv4InterfaceAddresses.
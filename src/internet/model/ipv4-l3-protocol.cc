@@ -18,6 +18,8 @@
 // Author: George F. Riley<riley@ece.gatech.edu>
 //
 
+#include <algorithm>
+
 #include "ns3/packet.h"
 #include "ns3/log.h"
 #include "ns3/callback.h"
@@ -43,6 +45,9 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "udp-header.h"
+#include "udp-l4-protocol.h"
+#include "udp-segment-tag.h"
 
 namespace ns3 {
 
@@ -106,7 +111,8 @@ Ipv4L3Protocol::GetTypeId (void)
 
     .AddTraceSource ("SendOutgoing",
                      "A newly-generated packet by this node is "
-                     "about to be queued for transmission",
+                     "about to be queued for transmission; a UDP "
+                     "super-datagram is traced once per segment",
                      MakeTraceSourceAccessor (&Ipv4L3Protocol::m_sendOutgoingTrace),
                      "ns3::Ipv4L3Protocol::SentTracedCallback")
     .AddTraceSource ("UnicastForward",
@@ -130,6 +136,8 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_routeGeneration (1),
+    m_routingGeneration (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -293,6 +301,29 @@ Ipv4L3Protocol::SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol)
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv4 (this);
+  m_routeGeneration++;
+}
+
+uint32_t
+Ipv4L3Protocol::GetRouteGeneration (void) const
+{
+  if (m_routingProtocol == 0)
+    {
+      return 0;
+    }
+  uint32_t generation = m_routingProtocol->GetRouteGeneration ();
+  if (generation == 0)
+    {
+      return 0;
+    }
+  // the generation of the routing protocol only tells whether its routes
+  // changed: a protocol installed later may count from a lower value
+  if (generation != m_routingGeneration)
+    {
+      m_routingGeneration = generation;
+      m_routeGeneration++;
+    }
+  return m_routeGeneration;
 }
 
 
@@ -806,7 +837,12 @@ Ipv4L3Protocol::Send (Ptr<Packet> packet,
       // 1b) with a valid gateway
       NS_LOG_LOGIC ("Ipv4L3Protocol::Send case 1b:  passed in with route and valid gateway");
       int32_t interface = GetInterfaceForDevice (route->GetOutputDevice ());
-      m_sendOutgoingTrace (ipHeader, packet, interface);
+      UdpSegmentTag segmentTag;
+      if (!packet->PeekPacketTag (segmentTag))
+        {
+          // a super-datagram is traced per segment by SendRealOut
+          m_sendOutgoingTrace (ipHeader, packet, interface);
+        }
       if (m_enableDpd && ipHeader.GetDestination ().IsMulticast ())
         {
           UpdateDuplicate (packet, ipHeader);
@@ -996,7 +1032,31 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   if (outInterface->IsUp ())
     {
       NS_LOG_LOGIC ("Send to " << targetLabel << " " << target);
-      if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+      UdpSegmentTag segmentTag;
+      if (packet->RemovePacketTag (segmentTag))
+        {
+          std::list<Ipv4PayloadHeaderPair> listSegments;
+          DoSegmentation (packet, ipHeader, segmentTag.GetSegmentSize (), listSegments);
+          for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listSegments.begin (); it != listSegments.end (); it++ )
+            {
+              m_sendOutgoingTrace (it->second, it->first, interface);
+            }
+          if (listSegments.front ().first->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ())
+            {
+              // the datagrams are too large, each one must be fragmented
+              for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listSegments.begin (); it != listSegments.end (); it++ )
+                {
+                  SendRealOut (route, it->first, it->second);
+                }
+              return;
+            }
+          for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listSegments.begin (); it != listSegments.end (); it++ )
+            {
+              CallTxTrace (it->second, it->first, this, interface);
+            }
+          outInterface->Send (listSegments, target);
+        }
+      else if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
         {
           std::list<Ipv4PayloadHeaderPair> listFragments;
           DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -1160,6 +1220,7 @@ Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   bool retVal = interface->AddAddress (address);
+  m_routeGeneration++;
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
@@ -1191,6 +1252,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
   Ipv4InterfaceAddress address = interface->RemoveAddress (addressIndex);
   if (address != Ipv4InterfaceAddress ())
     {
+      m_routeGeneration++;
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -1214,6 +1276,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, Ipv4Address address)
   Ipv4InterfaceAddress ifAddr = interface->RemoveAddress (address);
   if (ifAddr != Ipv4InterfaceAddress ())
     {
+      m_routeGeneration++;
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
@@ -1348,6 +1411,7 @@ Ipv4L3Protocol::SetUp (uint32_t i)
   if (interface->GetDevice ()->GetMtu () >= 68)
     {
       interface->SetUp ();
+      m_routeGeneration++;
 
       if (m_routingProtocol != 0)
         {
@@ -1366,6 +1430,7 @@ Ipv4L3Protocol::SetDown (uint32_t ifaceIndex)
   NS_LOG_FUNCTION (this << ifaceIndex);
   Ptr<Ipv4Interface> interface = GetInterface (ifaceIndex);
   interface->SetDown ();
+  m_routeGeneration++;
 
   if (m_routingProtocol != 0)
     {
@@ -1439,6 +1504,49 @@ Ipv4L3Protocol::RouteInputError (Ptr<const Packet> p, const Ipv4Header & ipHeade
   // \todo Send an ICMP no route.
 }
 
+void
+Ipv4L3Protocol::DoSegmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, uint16_t segmentSize, std::list<Ipv4PayloadHeaderPair>& listSegments)
+{
+  NS_LOG_FUNCTION (this << *packet << segmentSize << &listSegments);
+  NS_ASSERT (segmentSize > 0);
+
+  UdpHeader superHeader;
+  packet->RemoveHeader (superHeader);
+  // the length and the checksum are computed for each datagram
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (superHeader.GetSourcePort ());
+  udpHeader.SetDestinationPort (superHeader.GetDestinationPort ());
+  if (Node::ChecksumEnabled ())
+    {
+      udpHeader.EnableChecksums ();
+      udpHeader.InitializeChecksum (ipv4Header.GetSource (), ipv4Header.GetDestination (), UdpL4Protocol::PROT_NUMBER);
+    }
+
+  // the first datagram keeps the identification of the header, the next
+  // ones take the following values of the counter
+  const uint32_t size = packet->GetSize ();
+  const uint32_t nSegments = size == 0 ? 1 : (size - 1) / segmentSize + 1;
+  uint64_t src = ipv4Header.GetSource ().Get ();
+  uint64_t dst = ipv4Header.GetDestination ().Get ();
+  std::pair<uint64_t, uint8_t> key = std::make_pair (dst | (src << 32), ipv4Header.GetProtocol ());
+  m_identification[key] += nSegments - 1;
+
+  uint16_t identification = ipv4Header.GetIdentification ();
+  uint32_t offset = 0;
+  do
+    {
+      uint32_t segment = std::min<uint32_t> (segmentSize, size - offset);
+      Ptr<Packet> datagram = packet->CreateFragment (offset, segment);
+      datagram->AddHeader (udpHeader);
+      Ipv4Header datagramHeader = ipv4Header;
+      datagramHeader.SetPayloadSize (datagram->GetSize ());
+      datagramHeader.SetIdentification (identification++);
+      listSegments.push_back (Ipv4PayloadHeaderPair (datagram, datagramHeader));
+      offset += segment;
+    }
+  while (offset < size);
+}
+
 void
 Ipv4L3Protocol::DoFragmentation (Ptr<Packet> packet, const Ipv4Header & ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments)
 {
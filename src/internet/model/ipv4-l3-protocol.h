@@ -115,6 +115,21 @@ public:
    */
   void SetNode (Ptr<Node> node);
 
+  /**
+   * \brief Get the generation of the routes
+   *
+   * A route returned by the routing protocol may be reused for the next
+   * packets to the same destination and output device as long as the
+   * generation does not change: it changes with the interfaces, their
+   * addresses and the routes of the routing protocol.
+   *
+   * \returns the generation, or 0 if the routing protocol does not
+   *          allow its routes to be reused
+   *
+   * \see Ipv4RoutingProtocol::GetRouteGeneration
+   */
+  uint32_t GetRouteGeneration (void) const;
+
   // functions defined in base class Ipv4
 
   void SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol);
@@ -404,6 +419,20 @@ private:
    */
   void DoFragmentation (Ptr<Packet> packet, const Ipv4Header& ipv4Header, uint32_t outIfaceMtu, std::list<Ipv4PayloadHeaderPair>& listFragments);
 
+  /**
+   * \brief Split a UDP super-datagram into datagrams
+   *
+   * Each datagram carries segmentSize bytes of the payload (the last one
+   * the rest), a copy of the UDP header and a copy of the IPv4 header,
+   * with its own identification.
+   *
+   * \param packet the packet, with its UDP header
+   * \param ipv4Header the IPv4 header
+   * \param segmentSize the payload size of each datagram
+   * \param listSegments the list of datagrams
+   */
+  void DoSegmentation (Ptr<Packet> packet, const Ipv4Header& ipv4Header, uint16_t segmentSize, std::list<Ipv4PayloadHeaderPair>& listSegments);
+
   /**
    * \brief Process a packet fragment
    * \param packet the packet
@@ -482,6 +511,8 @@ private:
   TracedCallback<const Ipv4Header &, Ptr<const Packet>, DropReason, Ptr<Ipv4>, uint32_t> m_dropTrace;
 
   Ptr<Ipv4RoutingProtocol> m_routingProtocol; //!< Routing protocol associated with the stack
+  mutable uint32_t m_routeGeneration; //!< Changed with the interfaces, their addresses and the routes
+  mutable uint32_t m_routingGeneration; //!< Last generation of the routing protocol seen by GetRouteGeneration
 
   SocketList m_sockets; //!< List of IPv4 raw sockets.
 
@@ -43,7 +43,8 @@ Ipv4ListRouting::GetTypeId (void)
 
 
 Ipv4ListRouting::Ipv4ListRouting () 
-  : m_ipv4 (0)
+  : m_ipv4 (0),
+    m_generation (1)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -124,6 +125,25 @@ Ipv4ListRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDe
   return 0;
 }
 
+uint32_t
+Ipv4ListRouting::GetRouteGeneration (void) const
+{
+  // the routes of the list can be reused only if those of every
+  // protocol can
+  uint32_t generation = m_generation;
+  for (Ipv4RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      uint32_t protocolGeneration = (*i).second->GetRouteGeneration ();
+      if (protocolGeneration == 0)
+        {
+          return 0;
+        }
+      generation += protocolGeneration;
+    }
+  return generation;
+}
+
 // Patterned after Linux ip_route_input and ip_route_input_slow
 bool 
 Ipv4ListRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev, 
@@ -255,6 +275,7 @@ Ipv4ListRouting::AddRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol, i
   NS_LOG_FUNCTION (this << routingProtocol->GetInstanceTypeId () << priority);
   m_routingProtocols.push_back (std::make_pair (priority, routingProtocol));
   m_routingProtocols.sort ( Compare );
+  m_generation++;
   if (m_ipv4 != 0)
     {
       routingProtocol->SetIpv4 (m_ipv4);
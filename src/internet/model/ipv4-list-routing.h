@@ -90,6 +90,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  virtual uint32_t GetRouteGeneration (void) const;
 
 protected:
   virtual void DoDispose (void);
@@ -113,6 +114,7 @@ private:
    */
   static bool Compare (const Ipv4RoutingProtocolEntry& a, const Ipv4RoutingProtocolEntry& b);
   Ptr<Ipv4> m_ipv4; //!< Ipv4 this protocol is associated with.
+  uint32_t m_generation; //!< Changed with the list of routing protocols.
 
 
 };
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-prefix-index.h"
+#include "ipv4-routing-table-entry.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+Ipv4PrefixIndex::Ipv4PrefixIndex ()
+  : m_nEntries (0)
+{
+}
+
+void
+Ipv4PrefixIndex::Clear (void)
+{
+  m_groups.clear ();
+  m_nEntries = 0;
+}
+
+void
+Ipv4PrefixIndex::Add (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  Ipv4Mask mask = route->GetDestNetworkMask ();
+  uint16_t prefixLength = mask.GetPrefixLength ();
+  std::vector<Group>::iterator group = m_groups.begin ();
+  while (group != m_groups.end ()
+         && (group->prefixLength > prefixLength
+             || (group->prefixLength == prefixLength && group->mask != mask.Get ())))
+    {
+      group++;
+    }
+  if (group == m_groups.end () || group->mask != mask.Get ())
+    {
+      Group newGroup;
+      newGroup.mask = mask.Get ();
+      newGroup.prefixLength = prefixLength;
+      group = m_groups.insert (group, newGroup);
+    }
+  Entry entry = {m_nEntries++, route, metric};
+  group->networks[route->GetDestNetwork ().Get () & group->mask].push_back (entry);
+}
+
+uint32_t
+Ipv4PrefixIndex::GetNEntries (void) const
+{
+  return m_nEntries;
+}
+
+uint32_t
+Ipv4PrefixIndex::GetNGroups (void) const
+{
+  return m_groups.size ();
+}
+
+uint16_t
+Ipv4PrefixIndex::GetPrefixLength (uint32_t group) const
+{
+  NS_ASSERT (group < m_groups.size ());
+  return m_groups[group].prefixLength;
+}
+
+const std::vector<Ipv4PrefixIndex::Entry> *
+Ipv4PrefixIndex::Find (uint32_t group, Ipv4Address dest) const
+{
+  NS_ASSERT (group < m_groups.size ());
+  const Group &g = m_groups[group];
+  std::unordered_map<uint32_t, std::vector<Entry> >::const_iterator it = g.networks.find (dest.Get () & g.mask);
+  return it == g.networks.end () ? 0 : &it->second;
+}
+
+} // namespace ns3
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IPV4_PREFIX_INDEX_H
+#define IPV4_PREFIX_INDEX_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief An index of routing table entries by prefix, for the lookups of
+ * the routes matching a destination.
+ *
+ * The entries are grouped by network mask, the groups ordered by
+ * decreasing prefix length, and each group is a hash table from the
+ * network address to its entries.  Finding the entries of a group which
+ * match a destination is a single hash lookup, so finding the longest
+ * matching prefix takes at most one lookup per distinct prefix length
+ * of the table, whatever its number of entries.
+ *
+ * The index does not own the entries: the routing protocol keeps them in
+ * its lists, and rebuilds the index after they change.  Each entry keeps
+ * its rank in the order it was added, so that a protocol whose choice
+ * among several matching routes depends on their order in its lists
+ * makes the same choice.
+ */
+class Ipv4PrefixIndex
+{
+public:
+  /**
+   * \brief An entry of the index.
+   */
+  struct Entry
+  {
+    uint32_t rank;                  //!< Order in which the entry was added
+    Ipv4RoutingTableEntry *route;   //!< The routing table entry
+    uint32_t metric;                //!< The metric of the route
+  };
+
+  Ipv4PrefixIndex ();
+
+  /**
+   * \brief Remove all the entries.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Add an entry, after those already added.
+   * \param route the routing table entry
+   * \param metric the metric of the route
+   */
+  void Add (Ipv4RoutingTableEntry *route, uint32_t metric = 0);
+
+  /**
+   * \returns the number of entries
+   */
+  uint32_t GetNEntries (void) const;
+
+  /**
+   * \returns the number of network masks of the entries
+   */
+  uint32_t GetNGroups (void) const;
+
+  /**
+   * \param group the index of a group, by decreasing prefix length
+   * \returns the prefix length of the network mask of the group
+   */
+  uint16_t GetPrefixLength (uint32_t group) const;
+
+  /**
+   * \brief Find the entries of a group matching a destination.
+   * \param group the index of a group, by decreasing prefix length
+   * \param dest the destination
+   * \returns the entries, in the order they were added, or 0 if none
+   */
+  const std::vector<Entry> *Find (uint32_t group, Ipv4Address dest) const;
+
+private:
+  /**
+   * \brief The entries with the same network mask.
+   */
+  struct Group
+  {
+    uint32_t mask;                  //!< The network mask
+    uint16_t prefixLength;          //!< Its prefix length
+    std::unordered_map<uint32_t, std::vector<Entry> > networks; //!< Entries by network address
+  };
+
+  std::vector<Group> m_groups;      //!< Groups by decreasing prefix length
+  uint32_t m_nEntries;              //!< Number of entries
+};
+
+} // namespace ns3
+
+#endif /* IPV4_PREFIX_INDEX_H */
@@ -171,6 +171,20 @@ public:
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const = 0;
 
+  /**
+   * \brief Get the generation of the routes
+   *
+   * A route returned by RouteOutput may be reused for the next packets
+   * to the same destination as long as the generation does not change.
+   * A protocol whose routes depend on anything else than the destination
+   * and the output device, or which does not track its route changes,
+   * returns 0.
+   *
+   * \returns a counter changed with the routes, or 0 if the routes can
+   *          not be reused (the default)
+   */
+  virtual uint32_t GetRouteGeneration (void) const;
+
 };
 
 } // namespace ns3
@@ -31,6 +31,7 @@
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
 #include "ns3/output-stream-wrapper.h"
+#include "ns3/boolean.h"
 #include "ipv4-static-routing.h"
 #include "ipv4-routing-table-entry.h"
 
@@ -49,12 +50,20 @@ Ipv4StaticRouting::GetTypeId (void)
     .SetParent<Ipv4RoutingProtocol> ()
     .SetGroupName ("Internet")
     .AddConstructor<Ipv4StaticRouting> ()
+    .AddAttribute ("UsePrefixIndex",
+                   "Set to true to look up the network routes in an index by prefix; set to false for a linear search of the routes",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&Ipv4StaticRouting::m_usePrefixIndex),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_ipv4 (0),
+    m_generation (1),
+    m_usePrefixIndex (true),
+    m_indexGeneration (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -77,6 +86,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
     {
       Ipv4RoutingTableEntry *routePtr = new Ipv4RoutingTableEntry (route);
       m_networkRoutes.push_back (make_pair (routePtr, metric));
+      m_generation++;
     }
 }
 
@@ -96,6 +106,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
       Ipv4RoutingTableEntry *routePtr = new Ipv4RoutingTableEntry (route);
 
       m_networkRoutes.push_back (make_pair (routePtr, metric));
+      m_generation++;
     }
 }
 
@@ -154,6 +165,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_generation++;
 }
 
 uint32_t 
@@ -268,6 +280,25 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
       return rtentry;
     }
 
+  if (m_usePrefixIndex)
+    {
+      Ipv4RoutingTableEntry* route = LookupIndex (dest, oif);
+      if (route != 0)
+        {
+          uint32_t interfaceIdx = route->GetInterface ();
+          rtentry = Create<Ipv4Route> ();
+          rtentry->SetDestination (route->GetDest ());
+          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+          rtentry->SetGateway (route->GetGateway ());
+          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+          NS_LOG_LOGIC ("Matching route via " << rtentry->GetGateway () << " in the prefix index");
+        }
+      else
+        {
+          NS_LOG_LOGIC ("No matching route to " << dest << " found");
+        }
+      return rtentry;
+    }
 
   for (NetworkRoutesI i = m_networkRoutes.begin (); 
        i != m_networkRoutes.end (); 
@@ -330,6 +361,60 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
   return rtentry;
 }
 
+Ipv4RoutingTableEntry *
+Ipv4StaticRouting::LookupIndex (Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  if (m_indexGeneration != m_generation)
+    {
+      NS_LOG_LOGIC ("Routes changed, rebuilding the prefix index");
+      m_networkIndex.Clear ();
+      for (NetworkRoutesCI i = m_networkRoutes.begin (); i != m_networkRoutes.end (); i++)
+        {
+          m_networkIndex.Add (i->first, i->second);
+        }
+      m_indexGeneration = m_generation;
+    }
+
+  // the longest prefix wins, then the shortest metric and, between equal
+  // metrics, the last route added, as in the linear search; a /32 route
+  // wins at the first match
+  const Ipv4PrefixIndex::Entry *best = 0;
+  uint16_t longest_mask = 0;
+  for (uint32_t g = 0; g < m_networkIndex.GetNGroups (); g++)
+    {
+      uint16_t masklen = m_networkIndex.GetPrefixLength (g);
+      if (best != 0 && masklen < longest_mask)
+        {
+          break;
+        }
+      const std::vector<Ipv4PrefixIndex::Entry> *entries = m_networkIndex.Find (g, dest);
+      if (entries == 0)
+        {
+          continue;
+        }
+      for (std::vector<Ipv4PrefixIndex::Entry>::const_iterator i = entries->begin (); i != entries->end (); i++)
+        {
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (i->route->GetInterface ()))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          if (masklen == 32)
+            {
+              return i->route;
+            }
+          if (best == 0 || i->metric < best->metric
+              || (i->metric == best->metric && i->rank > best->rank))
+            {
+              best = &(*i);
+              longest_mask = masklen;
+            }
+        }
+    }
+  return best == 0 ? 0 : best->route;
+}
+
 Ptr<Ipv4MulticastRoute>
 Ipv4StaticRouting::LookupStatic (
   Ipv4Address origin, 
@@ -478,6 +563,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
         {
           delete j->first;
           m_networkRoutes.erase (j);
+          m_generation++;
           return;
         }
       tmp++;
@@ -644,6 +730,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_generation++;
         }
       else
         {
@@ -691,6 +778,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
         {
           delete it->first;
           it = m_networkRoutes.erase (it);
+          m_generation++;
         }
       else
         {
@@ -717,6 +805,12 @@ Ipv4StaticRouting::SetIpv4 (Ptr<Ipv4> ipv4)
         }
     }
 }
+uint32_t
+Ipv4StaticRouting::GetRouteGeneration (void) const
+{
+  return m_generation;
+}
+
 // Formatted like output of "route -n" command
 void
 Ipv4StaticRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ipv4-prefix-index.h"
 
 namespace ns3 {
 
@@ -86,6 +87,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  virtual uint32_t GetRouteGeneration (void) const;
 
 /**
  * \brief Add a network route to the static routing table.
@@ -392,6 +394,18 @@ private:
    */
   Ptr<Ipv4Route> LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief Lookup in the prefix index of the forwarding table for destination.
+   *
+   * The route is the one the linear search of LookupStatic selects.  The
+   * index is rebuilt first if the network routes changed.
+   *
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \return the routing table entry selected, or 0 if none
+   */
+  Ipv4RoutingTableEntry * LookupIndex (Ipv4Address dest, Ptr<NetDevice> oif);
+
   /**
    * \brief Lookup in the multicast forwarding table for destination.
    * \param origin source address
@@ -416,6 +430,26 @@ private:
    * \brief Ipv4 reference.
    */
   Ptr<Ipv4> m_ipv4;
+
+  /**
+   * \brief Changed with the network routes.
+   */
+  uint32_t m_generation;
+
+  /**
+   * \brief Whether to look up the network routes in m_networkIndex.
+   */
+  bool m_usePrefixIndex;
+
+  /**
+   * \brief Index of the network routes by prefix.
+   */
+  Ipv4PrefixIndex m_networkIndex;
+
+  /**
+   * \brief Value of m_generation when m_networkIndex was built.
+   */
+  uint32_t m_indexGeneration;
 };
 
 } // Namespace ns3
@@ -185,45 +185,50 @@ UdpHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
 
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
-  if (m_payloadSize == 0)
+  uint8_t copy[8];
+  uint8_t *bytes = i.ReserveContiguous (8);
+  uint8_t *fields = bytes != 0 ? bytes : copy;
+  fields[0] = m_sourcePort >> 8;
+  fields[1] = m_sourcePort & 0xff;
+  fields[2] = m_destinationPort >> 8;
+  fields[3] = m_destinationPort & 0xff;
+  uint16_t length = m_payloadSize == 0 ? start.GetSize () : m_payloadSize;
+  fields[4] = length >> 8;
+  fields[5] = length & 0xff;
+  // the checksum is written as WriteU16 does
+  fields[6] = m_checksum & 0xff;
+  fields[7] = m_checksum >> 8;
+  if (bytes == 0)
     {
-      i.WriteHtonU16 (start.GetSize ());
-    }
-  else
-    {
-      i.WriteHtonU16 (m_payloadSize);
+      i.Write (copy, 8);
     }
 
-  if ( m_checksum == 0)
-    {
-      i.WriteU16 (0);
-
-      if (m_calcChecksum)
-        {
-          uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
-          i = start;
-          uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-
-          i = start;
-          i.Next (6);
-          i.WriteU16 (checksum);
-        }
-    }
-  else
+  if (m_checksum == 0 && m_calcChecksum)
     {
-      i.WriteU16 (m_checksum);
+      uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
+      i = start;
+      uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
+
+      i = start;
+      i.Next (6);
+      i.WriteU16 (checksum);
     }
 }
 uint32_t
 UdpHeader::Deserialize (Buffer::Iterator start)
 {
   Buffer::Iterator i = start;
-  m_sourcePort = i.ReadNtohU16 ();
-  m_destinationPort = i.ReadNtohU16 ();
-  m_payloadSize = i.ReadNtohU16 () - GetSerializedSize ();
-  m_checksum = i.ReadU16 ();
+  uint8_t copy[8];
+  const uint8_t *fields = i.ReserveContiguous (8);
+  if (fields == 0)
+    {
+      i.Read (copy, 8);
+      fields = copy;
+    }
+  m_sourcePort = (fields[0] << 8) | fields[1];
+  m_destinationPort = (fields[2] << 8) | fields[3];
+  m_payloadSize = ((fields[4] << 8) | fields[5]) - GetSerializedSize ();
+  m_checksum = fields[6] | (fields[7] << 8);
 
   if (m_calcChecksum)
     {
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "udp-segment-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (UdpSegmentTag);
+
+TypeId
+UdpSegmentTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::UdpSegmentTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<UdpSegmentTag> ()
+  ;
+  return tid;
+}
+
+UdpSegmentTag::UdpSegmentTag ()
+  : m_segmentSize (0)
+{
+}
+
+UdpSegmentTag::UdpSegmentTag (uint16_t segmentSize)
+  : m_segmentSize (segmentSize)
+{
+}
+
+void
+UdpSegmentTag::SetSegmentSize (uint16_t segmentSize)
+{
+  m_segmentSize = segmentSize;
+}
+
+uint16_t
+UdpSegmentTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+TypeId
+UdpSegmentTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+UdpSegmentTag::GetSerializedSize (void) const
+{
+  return 2;
+}
+
+void
+UdpSegmentTag::Serialize (TagBuffer i) const
+{
+  i.WriteU16 (m_segmentSize);
+}
+
+void
+UdpSegmentTag::Deserialize (TagBuffer i)
+{
+  m_segmentSize = i.ReadU16 ();
+}
+
+void
+UdpSegmentTag::Print (std::ostream &os) const
+{
+  os << "SegmentSize=" << m_segmentSize;
+}
+
+} // namespace ns3
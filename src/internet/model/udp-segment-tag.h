@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef UDP_SEGMENT_TAG_H
+#define UDP_SEGMENT_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup udp
+ *
+ * \brief This class implements a tag that carries the segment size of a
+ * UDP super-datagram down to the IPv4 layer.
+ *
+ * A UDP socket with a SegmentSize sends a large payload as one packet
+ * with this tag: the route, the UDP header and the IPv4 header are set
+ * up once, and Ipv4L3Protocol splits the packet into datagrams of
+ * SegmentSize payload bytes, each with its own UDP and IPv4 header,
+ * just before they are handed to the output interface (like the
+ * UDP_SEGMENT socket option of Linux).
+ */
+class UdpSegmentTag : public Tag
+{
+public:
+  UdpSegmentTag ();
+  /**
+   * \brief Constructor
+   * \param segmentSize the payload size of each datagram
+   */
+  UdpSegmentTag (uint16_t segmentSize);
+
+  /**
+   * \brief Set the payload size of each datagram
+   * \param segmentSize the payload size of each datagram
+   */
+  void SetSegmentSize (uint16_t segmentSize);
+
+  /**
+   * \brief Get the payload size of each datagram
+   * \returns the payload size of each datagram
+   */
+  uint16_t GetSegmentSize (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint16_t m_segmentSize; //!< the payload size of each datagram
+};
+
+} // namespace ns3
+
+#endif /* UDP_SEGMENT_TAG_H */
@@ -19,6 +19,9 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/simulator.h"
 #include "ns3/node.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/inet6-socket-address.h"
@@ -36,8 +39,11 @@
 #include "ns3/ipv6-packet-info-tag.h"
 #include "udp-socket-impl.h"
 #include "udp-l4-protocol.h"
+#include "ipv4-l3-protocol.h"
+#include "udp-segment-tag.h"
 #include "ipv4-end-point.h"
 #include "ipv6-end-point.h"
+#include <algorithm>
 #include <limits>
 
 namespace ns3 {
@@ -71,6 +77,21 @@ UdpSocketImpl::GetTypeId (void)
                    CallbackValue (),
                    MakeCallbackAccessor (&UdpSocketImpl::m_icmpCallback6),
                    MakeCallbackChecker ())
+    .AddAttribute ("CoalesceRecvNotify",
+                   "Invoke the receive callback once for all the datagrams received "
+                   "at the same simulated time, after them, instead of once per datagram. "
+                   "The callback must then read all the datagrams (see RecvBatch).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&UdpSocketImpl::m_coalesceRecvNotify),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SegmentSize",
+                   "Send a larger payload as datagrams of this payload size, "
+                   "split by the IPv4 layer after the route and the headers are "
+                   "set up once (like UDP_SEGMENT in Linux). 0 disables it. "
+                   "IPv6 datagrams are split by the socket.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&UdpSocketImpl::m_segmentSize),
+                   MakeUintegerChecker<uint16_t> (0, MAX_IPV4_UDP_DATAGRAM_SIZE))
   ;
   return tid;
 }
@@ -84,7 +105,10 @@ UdpSocketImpl::UdpSocketImpl ()
     m_shutdownSend (false),
     m_shutdownRecv (false),
     m_connected (false),
-    m_rxAvailable (0)
+    m_rxAvailable (0),
+    m_coalesceRecvNotify (false),
+    m_segmentSize (0),
+    m_routeGeneration (0)
 {
   NS_LOG_FUNCTION (this);
   m_allowBroadcast = false;
@@ -95,6 +119,7 @@ UdpSocketImpl::~UdpSocketImpl ()
   NS_LOG_FUNCTION (this);
 
   /// \todo  leave any multicast groups that have been joined
+  m_recvNotifyEvent.Cancel ();
   m_node = 0;
   /**
    * Note: actually this function is called AFTER
@@ -513,6 +538,13 @@ UdpSocketImpl::DoSendTo (Ptr<Packet> p, Ipv4Address dest, uint16_t port, uint8_t
       return -1;
     }
 
+  if (m_segmentSize != 0 && p->GetSize () > m_segmentSize)
+    {
+      // split into datagrams by Ipv4L3Protocol
+      UdpSegmentTag segmentTag (m_segmentSize);
+      p->ReplacePacketTag (segmentTag);
+    }
+
   uint8_t priority = GetPriority ();
   if (tos)
     {
@@ -617,7 +649,20 @@ UdpSocketImpl::DoSendTo (Ptr<Packet> p, Ipv4Address dest, uint16_t port, uint8_t
       Socket::SocketErrno errno_;
       Ptr<Ipv4Route> route;
       Ptr<NetDevice> oif = m_boundnetdevice; //specify non-zero if bound to a specific device
-      // TBD-- we could cache the route and just check its validity
+      // the route of the last send is still valid if no route, interface
+      // or address changed since
+      Ptr<Ipv4L3Protocol> ipv4L3 = DynamicCast<Ipv4L3Protocol> (ipv4);
+      uint32_t generation = ipv4L3 != 0 && !dest.IsMulticast () ? ipv4L3->GetRouteGeneration () : 0;
+      if (generation != 0 && generation == m_routeGeneration
+          && dest == m_routeDestination && oif == m_routeDevice)
+        {
+          NS_LOG_LOGIC ("Cached route");
+          header.SetSource (m_route->GetSource ());
+          m_udp->Send (p->Copy (), header.GetSource (), header.GetDestination (),
+                       m_endPoint->GetLocalPort (), port, m_route);
+          NotifyDataSent (p->GetSize ());
+          return p->GetSize ();
+        }
       route = ipv4->GetRoutingProtocol ()->RouteOutput (p, header, oif, errno_); 
       if (route != 0)
         {
@@ -638,6 +683,13 @@ UdpSocketImpl::DoSendTo (Ptr<Packet> p, Ipv4Address dest, uint16_t port, uint8_t
                 }
             }
 
+          if (generation != 0)
+            {
+              m_route = route;
+              m_routeDestination = dest;
+              m_routeDevice = oif;
+              m_routeGeneration = generation;
+            }
           header.SetSource (route->GetSource ());
           m_udp->Send (p->Copy (), header.GetSource (), header.GetDestination (),
                        m_endPoint->GetLocalPort (), port, route);
@@ -696,6 +748,20 @@ UdpSocketImpl::DoSendTo (Ptr<Packet> p, Ipv6Address dest, uint16_t port)
       return -1;
     }
 
+  if (m_segmentSize != 0 && p->GetSize () > m_segmentSize)
+    {
+      // Ipv6L3Protocol has no segmentation: send the datagrams one by one
+      for (uint32_t offset = 0; offset < p->GetSize (); offset += m_segmentSize)
+        {
+          uint32_t size = std::min<uint32_t> (m_segmentSize, p->GetSize () - offset);
+          if (DoSendTo (p->CreateFragment (offset, size), dest, port) < 0)
+            {
+              return -1;
+            }
+        }
+      return p->GetSize ();
+    }
+
   if (IsManualIpv6Tclass ())
     {
       SocketIpv6TclassTag ipTclassTag;
@@ -864,6 +930,51 @@ UdpSocketImpl::RecvFrom (uint32_t maxSize, uint32_t flags,
   return p;
 }
 
+uint32_t
+UdpSocketImpl::RecvBatch (RecvItem *items, uint32_t count, uint32_t flags)
+{
+  NS_LOG_FUNCTION (this << items << count << flags);
+  NS_ASSERT_MSG (flags == 0, "RecvBatch only dequeues datagrams, flags must be 0");
+
+  uint32_t n = 0;
+  for (; n < count && !m_deliveryQueue.empty (); ++n)
+    {
+      std::pair<Ptr<Packet>, Address> &front = m_deliveryQueue.front ();
+      m_rxAvailable -= front.first->GetSize ();
+      items[n].packet = front.first;
+      items[n].from = front.second;
+      m_deliveryQueue.pop ();
+    }
+  if (n == 0)
+    {
+      m_errno = ERROR_AGAIN;
+    }
+  return n;
+}
+
+void
+UdpSocketImpl::NotifyRecv (void)
+{
+  if (!m_coalesceRecvNotify)
+    {
+      NotifyDataRecv ();
+    }
+  else if (!m_recvNotifyEvent.IsRunning ())
+    {
+      m_recvNotifyEvent = Simulator::ScheduleNow (&UdpSocketImpl::NotifyCoalescedRecv, this);
+    }
+}
+
+void
+UdpSocketImpl::NotifyCoalescedRecv (void)
+{
+  NS_LOG_FUNCTION (this << m_deliveryQueue.size ());
+  if (!m_deliveryQueue.empty ())
+    {
+      NotifyDataRecv ();
+    }
+}
+
 int
 UdpSocketImpl::GetSockName (Address &address) const
 {
@@ -1041,7 +1152,7 @@ UdpSocketImpl::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
       Address address = InetSocketAddress (header.GetSource (), port);
       m_deliveryQueue.push (std::make_pair (packet, address));
       m_rxAvailable += packet->GetSize ();
-      NotifyDataRecv ();
+      NotifyRecv ();
     }
   else
     {
@@ -1101,7 +1212,7 @@ UdpSocketImpl::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
       Address address = Inet6SocketAddress (header.GetSource (), port);
       m_deliveryQueue.push (std::make_pair (packet, address));
       m_rxAvailable += packet->GetSize ();
-      NotifyDataRecv ();
+      NotifyRecv ();
     }
   else
     {
@@ -1204,6 +1315,8 @@ bool
 UdpSocketImpl::SetAllowBroadcast (bool allowBroadcast)
 {
   m_allowBroadcast = allowBroadcast;
+  // the broadcast check of the cached route is not done again
+  m_routeGeneration = 0;
   return true;
 }
 
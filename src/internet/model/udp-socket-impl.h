@@ -26,6 +26,7 @@
 #include "ns3/traced-callback.h"
 #include "ns3/socket.h"
 #include "ns3/ptr.h"
+#include "ns3/event-id.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/udp-socket.h"
 #include "ns3/ipv4-interface.h"
@@ -39,6 +40,7 @@ class Node;
 class Packet;
 class UdpL4Protocol;
 class Ipv6Header;
+class Ipv4Route;
 class Ipv6Interface;
 
 /**
@@ -109,6 +111,7 @@ public:
   virtual Ptr<Packet> Recv (uint32_t maxSize, uint32_t flags);
   virtual Ptr<Packet> RecvFrom (uint32_t maxSize, uint32_t flags,
                                 Address &fromAddress);
+  virtual uint32_t RecvBatch (RecvItem *items, uint32_t count, uint32_t flags = 0);
   virtual int GetSockName (Address &address) const; 
   virtual int GetPeerName (Address &address) const;
   virtual int MulticastJoinGroup (uint32_t interfaceIndex, const Address &groupAddress);
@@ -232,6 +235,17 @@ private:
    */
   void ForwardIcmp6 (Ipv6Address icmpSource, uint8_t icmpTtl, uint8_t icmpType, uint8_t icmpCode, uint32_t icmpInfo);
 
+  /**
+   * \brief Notify the application of a datagram queued for it, or
+   * schedule one notification for all the datagrams of this simulated
+   * time if CoalesceRecvNotify is set.
+   */
+  void NotifyRecv (void);
+  /**
+   * \brief Run the receive callback of the coalesced notification.
+   */
+  void NotifyCoalescedRecv (void);
+
   // Connections to other layers of TCP/IP
   Ipv4EndPoint*       m_endPoint;   //!< the IPv4 endpoint
   Ipv6EndPoint*       m_endPoint6;  //!< the IPv6 endpoint
@@ -252,6 +266,14 @@ private:
 
   std::queue<std::pair<Ptr<Packet>, Address> > m_deliveryQueue; //!< Queue for incoming packets
   uint32_t m_rxAvailable;                   //!< Number of available bytes to be received
+  bool m_coalesceRecvNotify;                //!< One receive callback per simulated time
+  EventId m_recvNotifyEvent;                //!< Pending coalesced receive callback
+  uint16_t m_segmentSize;                   //!< Payload size of the datagrams of a send, 0 if not split
+
+  Ptr<Ipv4Route> m_route;                   //!< Route of the last send
+  Ipv4Address m_routeDestination;           //!< Destination of m_route
+  Ptr<NetDevice> m_routeDevice;             //!< Bound device m_route was looked up for
+  uint32_t m_routeGeneration;               //!< Route generation of m_route, 0 if none
 
   // Socket attributes
   uint32_t m_rcvBufSize;    //!< Receive buffer size
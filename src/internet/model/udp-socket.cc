@@ -20,11 +20,13 @@
 
 #include "ns3/object.h"
 #include "ns3/log.h"
+#include "ns3/assert.h"
 #include "ns3/uinteger.h"
 #include "ns3/integer.h"
 #include "ns3/boolean.h"
 #include "ns3/trace-source-accessor.h"
 #include "udp-socket.h"
+#include <limits>
 
 namespace ns3 {
 
@@ -87,4 +89,23 @@ UdpSocket::~UdpSocket ()
   NS_LOG_FUNCTION (this);
 }
 
+uint32_t
+UdpSocket::RecvBatch (RecvItem *items, uint32_t count, uint32_t flags)
+{
+  NS_LOG_FUNCTION (this << items << count << flags);
+  // a peeking RecvFrom would return the same datagram again and again
+  NS_ASSERT_MSG (flags == 0, "RecvBatch only dequeues datagrams, flags must be 0");
+  uint32_t n = 0;
+  while (n < count)
+    {
+      items[n].packet = RecvFrom (std::numeric_limits<uint32_t>::max (), flags, items[n].from);
+      if (items[n].packet == 0)
+        {
+          break;
+        }
+      ++n;
+    }
+  return n;
+}
+
 } // namespace ns3
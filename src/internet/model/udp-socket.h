@@ -28,6 +28,7 @@
 #include "ns3/callback.h"
 #include "ns3/ptr.h"
 #include "ns3/object.h"
+#include "ns3/address.h"
 
 namespace ns3 {
 
@@ -103,6 +104,32 @@ public:
    */
   virtual int MulticastLeaveGroup (uint32_t interface, const Address &groupAddress) = 0;
 
+  /**
+   * \brief A datagram read by RecvBatch, with the address of its sender.
+   */
+  struct RecvItem
+  {
+    Ptr<Packet> packet; //!< The datagram
+    Address from;       //!< The address of its sender
+  };
+
+  /**
+   * \brief Read several datagrams in one call, like recvmmsg
+   *
+   * \param items caller-provided array receiving the datagrams
+   * \param count the number of entries of \p items
+   * \param flags Socket control flags, which must be 0: the datagrams
+   *        are always dequeued (no MSG_PEEK)
+   * \returns the number of datagrams read, in the order they were
+   *          received.  Zero if none is available, and errno is set to
+   *          ERROR_AGAIN.
+   *
+   * A receive callback can drain the socket with a few calls instead of
+   * one RecvFrom per datagram.  The default implementation calls
+   * RecvFrom.
+   */
+  virtual uint32_t RecvBatch (RecvItem *items, uint32_t count, uint32_t flags = 0);
+
 private:
   // Indirect the attribute setting and getting through private virtual methods
   /**
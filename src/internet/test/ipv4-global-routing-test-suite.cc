@@ -14,6 +14,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <sstream>
 #include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
@@ -41,7 +42,10 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/global-value.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -1244,6 +1248,279 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting prefix index Test
+ *
+ * Fills two Ipv4GlobalRouting with the same random routes, one looking
+ * them up in its prefix indexes and the other with a linear search, and
+ * checks that they select the same route for random destinations, with
+ * and without random ECMP routing.
+ */
+class Ipv4GlobalRoutingPrefixIndexTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingPrefixIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Compare the routes selected by the two routing protocols.
+   * \param indexed The routing protocol using the prefix indexes.
+   * \param linear The routing protocol using a linear search.
+   * \param devices The devices of the node.
+   * \param rng The random destinations and output devices.
+   */
+  void CheckLookups (Ptr<Ipv4GlobalRouting> indexed, Ptr<Ipv4GlobalRouting> linear,
+                     NetDeviceContainer devices, Ptr<UniformRandomVariable> rng);
+};
+
+Ipv4GlobalRoutingPrefixIndexTestCase::Ipv4GlobalRoutingPrefixIndexTestCase ()
+  : TestCase ("Prefix index selects the routes of the linear search")
+{
+}
+
+void
+Ipv4GlobalRoutingPrefixIndexTestCase::CheckLookups (Ptr<Ipv4GlobalRouting> indexed, Ptr<Ipv4GlobalRouting> linear,
+                                                    NetDeviceContainer devices, Ptr<UniformRandomVariable> rng)
+{
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      Ipv4Header header;
+      // a quarter of the destinations among those of the host routes
+      header.SetDestination (Ipv4Address ((10 << 24) | rng->GetInteger (0, i % 4 == 0 ? 0xff : 0x3ffff)));
+      uint32_t device = rng->GetInteger (0, devices.GetN ());
+      Ptr<NetDevice> oif = device == devices.GetN () ? 0 : devices.Get (device);
+      Socket::SocketErrno errnoIndexed;
+      Socket::SocketErrno errnoLinear;
+      Ptr<Ipv4Route> routeIndexed = indexed->RouteOutput (Create<Packet> (), header, oif, errnoIndexed);
+      Ptr<Ipv4Route> routeLinear = linear->RouteOutput (Create<Packet> (), header, oif, errnoLinear);
+      NS_TEST_ASSERT_MSG_EQ ((routeIndexed == 0), (routeLinear == 0), "Route found by one search only to " << header.GetDestination ());
+      if (routeLinear != 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (routeIndexed->GetDestination (), routeLinear->GetDestination (), "Different route to " << header.GetDestination ());
+          NS_TEST_ASSERT_MSG_EQ (routeIndexed->GetGateway (), routeLinear->GetGateway (), "Different route to " << header.GetDestination ());
+          NS_TEST_ASSERT_MSG_EQ (routeIndexed->GetOutputDevice (), routeLinear->GetOutputDevice (), "Different device to " << header.GetDestination ());
+        }
+    }
+}
+
+void
+Ipv4GlobalRoutingPrefixIndexTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices = devHelper.Install (NodeContainer (node, node, node));
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("172.16.1.0", "255.255.255.0");
+  ipv4.Assign (devices);
+
+  Ptr<Ipv4GlobalRouting> indexed = CreateObject<Ipv4GlobalRouting> ();
+  Ptr<Ipv4GlobalRouting> linear = CreateObject<Ipv4GlobalRouting> ();
+  linear->SetAttribute ("UsePrefixIndex", BooleanValue (false));
+  indexed->SetIpv4 (node->GetObject<Ipv4> ());
+  linear->SetIpv4 (node->GetObject<Ipv4> ());
+
+  // many routes in 10.0.0.0/14, with overlapping prefixes of all lengths,
+  // and host routes, some of them to the same hosts
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  const uint8_t lengths[] = {0, 8, 14, 16, 18, 20, 24, 28, 30, 32};
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      uint8_t length = lengths[rng->GetInteger (0, sizeof (lengths) - 1)];
+      Ipv4Address network ((10 << 24) | rng->GetInteger (0, 0x3ffff));
+      Ipv4Mask mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+      Ipv4Address gateway ((192 << 24) | (168 << 16) | i);
+      uint32_t interface = rng->GetInteger (1, 3);
+      indexed->AddNetworkRouteTo (network.CombineMask (mask), mask, gateway, interface);
+      linear->AddNetworkRouteTo (network.CombineMask (mask), mask, gateway, interface);
+      if (i % 5 == 0)
+        {
+          Ipv4Address host ((10 << 24) | rng->GetInteger (0, 0xff));
+          indexed->AddHostRouteTo (host, gateway, interface);
+          linear->AddHostRouteTo (host, gateway, interface);
+        }
+    }
+  CheckLookups (indexed, linear, devices, rng);
+
+  // random ECMP routing picks the same route among the same candidates
+  indexed->SetAttribute ("RandomEcmpRouting", BooleanValue (true));
+  linear->SetAttribute ("RandomEcmpRouting", BooleanValue (true));
+  indexed->AssignStreams (2);
+  linear->AssignStreams (2);
+  CheckLookups (indexed, linear, devices, rng);
+
+  // the indexes follow the changes of the routes
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      uint32_t index = rng->GetInteger (0, linear->GetNRoutes () - 1);
+      indexed->RemoveRoute (index);
+      linear->RemoveRoute (index);
+    }
+  CheckLookups (indexed, linear, devices, rng);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting incremental and threaded computation Test
+ *
+ * Brings an interface down and up again, and checks that the routes
+ * computed again only for the routers affected are the ones of a full
+ * computation, that the routers of another area keep their routes, and
+ * that the computation in several threads gives the same routes.
+ */
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingUpdateTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Get the routing tables of nodes.
+   * \param nodes The nodes.
+   * \return The routing table of each node, printed.
+   */
+  std::vector<std::string> GetTables (NodeContainer nodes);
+  /**
+   * \brief Get the generations of the routes of nodes.
+   * \param nodes The nodes.
+   * \return The route generation of each node.
+   */
+  std::vector<uint32_t> GetGenerations (NodeContainer nodes);
+  /**
+   * \brief Check that the incremental, full and threaded computations of
+   * the routes give the same tables.
+   * \param nodes All the nodes.
+   * \param other The nodes which the change does not affect.
+   */
+  void CheckUpdate (NodeContainer nodes, NodeContainer other);
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase ()
+  : TestCase ("Incremental and threaded computations give the routes of a full computation")
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingUpdateTestCase::GetTables (NodeContainer nodes)
+{
+  std::vector<std::string> tables;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = (*i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::ostringstream table;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          table << *routing->GetRoute (j) << std::endl;
+        }
+      tables.push_back (table.str ());
+    }
+  return tables;
+}
+
+std::vector<uint32_t>
+Ipv4GlobalRoutingUpdateTestCase::GetGenerations (NodeContainer nodes)
+{
+  std::vector<uint32_t> generations;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); i++)
+    {
+      generations.push_back ((*i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ()->GetRouteGeneration ());
+    }
+  return generations;
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::CheckUpdate (NodeContainer nodes, NodeContainer other)
+{
+  std::vector<uint32_t> generations = GetGenerations (other);
+  Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+  std::vector<std::string> updated = GetTables (nodes);
+  NS_TEST_EXPECT_MSG_EQ ((GetGenerations (other) == generations), true, "The routes of the other area were computed again");
+
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::vector<std::string> recomputed = GetTables (nodes);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (updated[i], recomputed[i], "Different routes of node " << i);
+    }
+
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (3));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (1));
+  std::vector<std::string> threaded = GetTables (nodes);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (threaded[i], recomputed[i], "Different routes of node " << i << " with threads");
+    }
+}
+
+// Two areas with no path between them, and a stub router:
+//
+//   n0 -- n1     n4 -- n5 -- n6
+//   |  \   |
+//   n3 -- n2
+//   |
+//   n7 (point-to-point)
+//
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (8);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  const uint32_t lans[][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {0, 2}, {4, 5}, {5, 6}};
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < sizeof (lans) / sizeof (lans[0]); i++)
+    {
+      devices.Add (devHelper.Install (NodeContainer (nodes.Get (lans[i][0]), nodes.Get (lans[i][1]))));
+      ipv4.Assign (NetDeviceContainer (devices.Get (2 * i), devices.Get (2 * i + 1)));
+      ipv4.NewNetwork ();
+    }
+  devHelper.SetNetDevicePointToPointMode (true);
+  ipv4.Assign (devHelper.Install (NodeContainer (nodes.Get (3), nodes.Get (7))));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  NodeContainer other (nodes.Get (4), nodes.Get (5), nodes.Get (6));
+
+  // nothing changed
+  CheckUpdate (nodes, other);
+
+  // the interface of n2 to n3 goes down, then up again
+  Ptr<Ipv4> ipv4n2 = nodes.Get (2)->GetObject<Ipv4> ();
+  int32_t interface = ipv4n2->GetInterfaceForDevice (devices.Get (4));
+  ipv4n2->SetDown (interface);
+  CheckUpdate (nodes, other);
+  ipv4n2->SetUp (interface);
+  CheckUpdate (nodes, other);
+
+  // n5 goes down: only n4 and n6 are affected
+  Ptr<Ipv4> ipv4n5 = nodes.Get (5)->GetObject<Ipv4> ();
+  for (uint32_t i = 1; i < ipv4n5->GetNInterfaces (); i++)
+    {
+      ipv4n5->SetDown (i);
+    }
+  CheckUpdate (nodes, NodeContainer (nodes.Get (0), nodes.Get (1), nodes.Get (2), nodes.Get (3)));
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1544,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingPrefixIndexTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -35,6 +35,9 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -201,6 +204,115 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting prefix index Test
+ *
+ * Fills two Ipv4StaticRouting with the same random routes, one looking
+ * them up in its prefix index and the other with a linear search, and
+ * checks that they select the same route for random destinations.
+ */
+class Ipv4StaticRoutingPrefixIndexTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingPrefixIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Compare the routes selected by the two routing protocols.
+   * \param indexed The routing protocol using the prefix index.
+   * \param linear The routing protocol using a linear search.
+   * \param devices The devices of the node.
+   * \param rng The random destinations and output devices.
+   */
+  void CheckLookups (Ptr<Ipv4StaticRouting> indexed, Ptr<Ipv4StaticRouting> linear,
+                     NetDeviceContainer devices, Ptr<UniformRandomVariable> rng);
+};
+
+Ipv4StaticRoutingPrefixIndexTestCase::Ipv4StaticRoutingPrefixIndexTestCase ()
+  : TestCase ("Prefix index selects the routes of the linear search")
+{
+}
+
+void
+Ipv4StaticRoutingPrefixIndexTestCase::CheckLookups (Ptr<Ipv4StaticRouting> indexed, Ptr<Ipv4StaticRouting> linear,
+                                                    NetDeviceContainer devices, Ptr<UniformRandomVariable> rng)
+{
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      Ipv4Header header;
+      header.SetDestination (Ipv4Address ((10 << 24) | rng->GetInteger (0, 0x3ffff)));
+      uint32_t device = rng->GetInteger (0, devices.GetN ());
+      Ptr<NetDevice> oif = device == devices.GetN () ? 0 : devices.Get (device);
+      Socket::SocketErrno errnoIndexed;
+      Socket::SocketErrno errnoLinear;
+      Ptr<Ipv4Route> routeIndexed = indexed->RouteOutput (Create<Packet> (), header, oif, errnoIndexed);
+      Ptr<Ipv4Route> routeLinear = linear->RouteOutput (Create<Packet> (), header, oif, errnoLinear);
+      NS_TEST_ASSERT_MSG_EQ ((routeIndexed == 0), (routeLinear == 0), "Route found by one search only to " << header.GetDestination ());
+      if (routeLinear != 0)
+        {
+          NS_TEST_ASSERT_MSG_EQ (routeIndexed->GetGateway (), routeLinear->GetGateway (), "Different route to " << header.GetDestination ());
+          NS_TEST_ASSERT_MSG_EQ (routeIndexed->GetOutputDevice (), routeLinear->GetOutputDevice (), "Different device to " << header.GetDestination ());
+          NS_TEST_ASSERT_MSG_EQ (routeIndexed->GetSource (), routeLinear->GetSource (), "Different source to " << header.GetDestination ());
+        }
+    }
+}
+
+void
+Ipv4StaticRoutingPrefixIndexTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices = devHelper.Install (NodeContainer (node, node, node));
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("172.16.1.0", "255.255.255.0");
+  ipv4.Assign (devices);
+
+  Ptr<Ipv4StaticRouting> indexed = CreateObject<Ipv4StaticRouting> ();
+  Ptr<Ipv4StaticRouting> linear = CreateObject<Ipv4StaticRouting> ();
+  linear->SetAttribute ("UsePrefixIndex", BooleanValue (false));
+  indexed->SetIpv4 (node->GetObject<Ipv4> ());
+  linear->SetIpv4 (node->GetObject<Ipv4> ());
+
+  // many routes in 10.0.0.0/14, with overlapping prefixes of all lengths
+  // and equal metrics
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  const uint8_t lengths[] = {0, 8, 14, 16, 18, 20, 24, 28, 30, 32};
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      uint8_t length = lengths[rng->GetInteger (0, sizeof (lengths) - 1)];
+      Ipv4Address network ((10 << 24) | rng->GetInteger (0, 0x3ffff));
+      Ipv4Mask mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+      Ipv4Address gateway ((192 << 24) | (168 << 16) | i);
+      uint32_t interface = rng->GetInteger (1, 3);
+      uint32_t metric = rng->GetInteger (0, 3);
+      indexed->AddNetworkRouteTo (network.CombineMask (mask), mask, gateway, interface, metric);
+      linear->AddNetworkRouteTo (network.CombineMask (mask), mask, gateway, interface, metric);
+    }
+  NS_TEST_ASSERT_MSG_EQ (indexed->GetNRoutes (), linear->GetNRoutes (), "Different routes");
+  CheckLookups (indexed, linear, devices, rng);
+
+  // the index follows the changes of the routes
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      uint32_t index = rng->GetInteger (0, linear->GetNRoutes () - 1);
+      indexed->RemoveRoute (index);
+      linear->RemoveRoute (index);
+    }
+  indexed->AddHostRouteTo (Ipv4Address ("10.0.0.1"), 2);
+  linear->AddHostRouteTo (Ipv4Address ("10.0.0.1"), 2);
+  CheckLookups (indexed, linear, devices, rng);
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -217,6 +329,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingPrefixIndexTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite ipv4StaticRoutingTestSuite; //!< Static variable for test initialization
@@ -30,9 +30,11 @@
 #include "ns3/simple-net-device.h"
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket.h"
+#include "ns3/udp-socket.h"
 #include "ns3/traffic-control-helper.h"
 
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/log.h"
 #include "ns3/node.h"
 #include "ns3/inet-socket-address.h"
@@ -49,12 +51,16 @@
 #include "ns3/tcp-l4-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
 #include "ns3/ipv6-list-routing.h"
 #include "ns3/ipv6-static-routing.h"
 #include "ns3/ipv6-address-helper.h"
 
+#include <algorithm>
 #include <string>
 #include <limits>
+#include <vector>
 
 using namespace ns3;
 
@@ -111,6 +117,216 @@ UdpSocketLoopbackTest::DoRun ()
   NS_TEST_EXPECT_MSG_EQ (m_receivedPacket->GetSize (), 246, "first socket should not receive it (it is bound specifically to the second interface's address");
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief UDP batched receive test
+ *
+ * Five datagrams sent over the loopback arrive at the same time: they are
+ * read with RecvBatch, with one receive callback per datagram, then with
+ * the callbacks coalesced.
+ */
+class UdpSocketRecvBatchTest : public TestCase
+{
+public:
+  UdpSocketRecvBatchTest ();
+  virtual void DoRun (void);
+
+  /**
+   * \brief Receive the available datagrams, three at most per call.
+   * \param socket The receiving socket.
+   */
+  void ReceivePkts (Ptr<Socket> socket);
+  uint32_t m_callbacks;                   //!< Receive callbacks
+  std::vector<uint32_t> m_batches;        //!< Datagrams read by each RecvBatch
+  std::vector<uint32_t> m_sizes;          //!< Size of the datagrams read
+};
+
+UdpSocketRecvBatchTest::UdpSocketRecvBatchTest ()
+  : TestCase ("UDP batched receive test")
+{
+}
+
+void UdpSocketRecvBatchTest::ReceivePkts (Ptr<Socket> socket)
+{
+  ++m_callbacks;
+  Ptr<UdpSocket> udp = DynamicCast<UdpSocket> (socket);
+  UdpSocket::RecvItem items[3];
+  uint32_t n;
+  while ((n = udp->RecvBatch (items, 3)) > 0)
+    {
+      m_batches.push_back (n);
+      for (uint32_t i = 0; i < n; ++i)
+        {
+          m_sizes.push_back (items[i].packet->GetSize ());
+          NS_TEST_EXPECT_MSG_EQ (InetSocketAddress::ConvertFrom (items[i].from).GetPort (), 1234,
+                                 "source port of the datagram");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (socket->GetErrno (), Socket::ERROR_AGAIN, "the socket is drained");
+  NS_TEST_EXPECT_MSG_EQ (socket->GetRxAvailable (), 0, "no byte left");
+}
+
+void
+UdpSocketRecvBatchTest::DoRun ()
+{
+  for (bool coalesce : {false, true})
+    {
+      m_callbacks = 0;
+      m_batches.clear ();
+      m_sizes.clear ();
+
+      Ptr<Node> rxNode = CreateObject<Node> ();
+      InternetStackHelper internet;
+      internet.Install (rxNode);
+
+      Ptr<SocketFactory> rxSocketFactory = rxNode->GetObject<UdpSocketFactory> ();
+      Ptr<Socket> rxSocket = rxSocketFactory->CreateSocket ();
+      rxSocket->SetAttribute ("CoalesceRecvNotify", BooleanValue (coalesce));
+      rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 80));
+      rxSocket->SetRecvCallback (MakeCallback (&UdpSocketRecvBatchTest::ReceivePkts, this));
+
+      Ptr<Socket> txSocket = rxSocketFactory->CreateSocket ();
+      txSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+      for (uint32_t i = 1; i <= 5; ++i)
+        {
+          txSocket->SendTo (Create<Packet> (100 + i), 0, InetSocketAddress ("127.0.0.1", 80));
+        }
+      Simulator::Run ();
+      Simulator::Destroy ();
+
+      NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), 5, "all datagrams received");
+      for (uint32_t i = 0; i < 5; ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_sizes[i], 101 + i, "datagrams in order");
+        }
+      if (coalesce)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_callbacks, 1, "one callback for the simulated time");
+          NS_TEST_ASSERT_MSG_EQ (m_batches.size (), 2, "two batches");
+          NS_TEST_EXPECT_MSG_EQ (m_batches[0], 3, "a full batch");
+          NS_TEST_EXPECT_MSG_EQ (m_batches[1], 2, "the rest");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_callbacks, 5, "one callback per datagram");
+          NS_TEST_EXPECT_MSG_EQ (m_batches.size (), 5, "one datagram per batch");
+        }
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief UDP segmentation offload test
+ *
+ * A socket with a SegmentSize sends payloads larger than it as several
+ * datagrams, over a link whose MTU fits them and, with a larger
+ * SegmentSize, over a link where each datagram is fragmented.  The
+ * SendOutgoing trace of IPv4 sees the same datagrams.
+ */
+class UdpSocketSegmentTest : public TestCase
+{
+public:
+  UdpSocketSegmentTest ();
+  virtual void DoRun (void);
+
+  /**
+   * \brief Receive the available datagrams.
+   * \param socket The receiving socket.
+   */
+  void ReceivePkts (Ptr<Socket> socket);
+  /**
+   * \brief Record a datagram traced by SendOutgoing.
+   * \param header The IPv4 header.
+   * \param packet The datagram payload.
+   * \param interface The output interface.
+   */
+  void SendOutgoing (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface);
+  std::vector<uint32_t> m_sizes;          //!< Size of the datagrams received
+  std::vector<uint32_t> m_sentSizes;      //!< Size of the datagrams traced by SendOutgoing
+};
+
+UdpSocketSegmentTest::UdpSocketSegmentTest ()
+  : TestCase ("UDP segmentation offload test")
+{
+}
+
+void UdpSocketSegmentTest::ReceivePkts (Ptr<Socket> socket)
+{
+  while (Ptr<Packet> packet = socket->Recv ())
+    {
+      m_sizes.push_back (packet->GetSize ());
+    }
+}
+
+void
+UdpSocketSegmentTest::SendOutgoing (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+{
+  // the payload still carries the UDP header
+  m_sentSizes.push_back (packet->GetSize () - 8);
+}
+
+void
+UdpSocketSegmentTest::DoRun ()
+{
+  for (uint16_t segmentSize : {1000, 2000})
+    {
+      m_sizes.clear ();
+      m_sentSizes.clear ();
+
+      Ptr<Node> rxNode = CreateObject<Node> ();
+      Ptr<Node> txNode = CreateObject<Node> ();
+      NodeContainer nodes (rxNode, txNode);
+      SimpleNetDeviceHelper helperChannel;
+      helperChannel.SetNetDevicePointToPointMode (true);
+      NetDeviceContainer net = helperChannel.Install (nodes);
+      InternetStackHelper internet;
+      internet.Install (nodes);
+
+      Ptr<Ipv4> ipv4 = rxNode->GetObject<Ipv4> ();
+      uint32_t netdev_idx = ipv4->AddInterface (net.Get (0));
+      ipv4->AddAddress (netdev_idx, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("/24")));
+      ipv4->SetUp (netdev_idx);
+      ipv4 = txNode->GetObject<Ipv4> ();
+      netdev_idx = ipv4->AddInterface (net.Get (1));
+      ipv4->AddAddress (netdev_idx, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.2"), Ipv4Mask ("/24")));
+      ipv4->SetUp (netdev_idx);
+      txNode->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext ("SendOutgoing", MakeCallback (&UdpSocketSegmentTest::SendOutgoing, this));
+
+      Ptr<Socket> rxSocket = rxNode->GetObject<UdpSocketFactory> ()->CreateSocket ();
+      rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 80));
+      rxSocket->SetRecvCallback (MakeCallback (&UdpSocketSegmentTest::ReceivePkts, this));
+
+      Ptr<Socket> txSocket = txNode->GetObject<UdpSocketFactory> ()->CreateSocket ();
+      txSocket->SetAttribute ("SegmentSize", UintegerValue (segmentSize));
+      txSocket->Connect (InetSocketAddress (Ipv4Address ("10.0.0.1"), 80));
+      NS_TEST_EXPECT_MSG_EQ (txSocket->Send (Create<Packet> (4500)), 4500, "super-datagram sent");
+      NS_TEST_EXPECT_MSG_EQ (txSocket->Send (Create<Packet> (300)), 300, "small datagram sent");
+      Simulator::Run ();
+      Simulator::Destroy ();
+
+      std::vector<uint32_t> expected;
+      for (uint32_t size = 4500; size > 0; size -= std::min<uint32_t> (size, segmentSize))
+        {
+          expected.push_back (std::min<uint32_t> (size, segmentSize));
+        }
+      expected.push_back (300);
+      NS_TEST_ASSERT_MSG_EQ (m_sizes.size (), expected.size (), "datagrams received with segments of " << segmentSize);
+      for (uint32_t i = 0; i < expected.size (); ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_sizes[i], expected[i], "size of datagram " << i);
+        }
+      NS_TEST_ASSERT_MSG_EQ (m_sentSizes.size (), expected.size (), "datagrams traced with segments of " << segmentSize);
+      for (uint32_t i = 0; i < expected.size (); ++i)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_sentSizes[i], expected[i], "size of traced datagram " << i);
+        }
+    }
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -478,6 +694,116 @@ UdpSocketImplTest::DoRun (void)
 
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief UDP route cache test
+ *
+ * A connected socket reuses its route while the route generation of
+ * Ipv4L3Protocol is unchanged, and follows the route changes.
+ */
+class UdpSocketRouteCacheTest : public TestCase
+{
+public:
+  UdpSocketRouteCacheTest ();
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record the interface a packet is sent on.
+   * \param packet The packet.
+   * \param ipv4 The IPv4 stack.
+   * \param interface The output interface.
+   */
+  void Tx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+  uint32_t m_interface;                   //!< Interface of the last packet sent
+};
+
+UdpSocketRouteCacheTest::UdpSocketRouteCacheTest ()
+  : TestCase ("UDP route cache test")
+{
+}
+
+void
+UdpSocketRouteCacheTest::Tx (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  m_interface = interface;
+}
+
+void
+UdpSocketRouteCacheTest::DoRun ()
+{
+  Ptr<Node> rxNode = CreateObject<Node> ();
+  Ptr<Node> txNode = CreateObject<Node> ();
+  NodeContainer nodes (rxNode, txNode);
+  SimpleNetDeviceHelper helperChannel;
+  helperChannel.SetNetDevicePointToPointMode (true);
+  NetDeviceContainer net1 = helperChannel.Install (nodes);
+  NetDeviceContainer net2 = helperChannel.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ptr<Ipv4> ipv4 = rxNode->GetObject<Ipv4> ();
+  uint32_t netdev_idx = ipv4->AddInterface (net1.Get (0));
+  ipv4->AddAddress (netdev_idx, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("/24")));
+  ipv4->SetUp (netdev_idx);
+  netdev_idx = ipv4->AddInterface (net2.Get (0));
+  ipv4->AddAddress (netdev_idx, Ipv4InterfaceAddress (Ipv4Address ("10.0.1.1"), Ipv4Mask ("/24")));
+  ipv4->SetUp (netdev_idx);
+  Ptr<Ipv4L3Protocol> txIpv4 = txNode->GetObject<Ipv4L3Protocol> ();
+  uint32_t if1 = txIpv4->AddInterface (net1.Get (1));
+  txIpv4->AddAddress (if1, Ipv4InterfaceAddress (Ipv4Address ("10.0.0.2"), Ipv4Mask ("/24")));
+  txIpv4->SetUp (if1);
+  uint32_t if2 = txIpv4->AddInterface (net2.Get (1));
+  txIpv4->AddAddress (if2, Ipv4InterfaceAddress (Ipv4Address ("10.0.1.2"), Ipv4Mask ("/24")));
+  txIpv4->SetUp (if2);
+  txIpv4->TraceConnectWithoutContext ("Tx", MakeCallback (&UdpSocketRouteCacheTest::Tx, this));
+
+  Ptr<Socket> txSocket = txNode->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  txSocket->Connect (InetSocketAddress (Ipv4Address ("10.0.0.1"), 80));
+
+  uint32_t generation = txIpv4->GetRouteGeneration ();
+  NS_TEST_ASSERT_MSG_NE (generation, 0, "static and global routes can be reused");
+  txSocket->Send (Create<Packet> (100));
+  NS_TEST_EXPECT_MSG_EQ (m_interface, if1, "route of the connected network");
+  txSocket->Send (Create<Packet> (100));
+  NS_TEST_EXPECT_MSG_EQ (m_interface, if1, "cached route");
+  NS_TEST_EXPECT_MSG_EQ (txIpv4->GetRouteGeneration (), generation, "no change");
+
+  // a host route through the other interface
+  Ptr<Ipv4StaticRouting> staticRouting = Ipv4StaticRoutingHelper ().GetStaticRouting (txIpv4);
+  staticRouting->AddHostRouteTo (Ipv4Address ("10.0.0.1"), if2);
+  NS_TEST_EXPECT_MSG_NE (txIpv4->GetRouteGeneration (), generation, "new route");
+  txSocket->Send (Create<Packet> (100));
+  NS_TEST_EXPECT_MSG_EQ (m_interface, if2, "host route");
+
+  // the interface of the host route goes down
+  generation = txIpv4->GetRouteGeneration ();
+  txIpv4->SetDown (if2);
+  NS_TEST_EXPECT_MSG_NE (txIpv4->GetRouteGeneration (), generation, "interface down");
+  txSocket->Send (Create<Packet> (100));
+  NS_TEST_EXPECT_MSG_EQ (m_interface, if1, "route of the connected network again");
+  generation = txIpv4->GetRouteGeneration ();
+
+  // random ECMP routes can not be reused
+  Ptr<Ipv4GlobalRouting> globalRouting = Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting> (txIpv4->GetRoutingProtocol ());
+  NS_TEST_ASSERT_MSG_NE (globalRouting, 0, "global routing installed");
+  globalRouting->SetAttribute ("RandomEcmpRouting", BooleanValue (true));
+  NS_TEST_EXPECT_MSG_EQ (txIpv4->GetRouteGeneration (), 0, "random ECMP");
+
+  // a new routing protocol, whose own generation is lower than that of
+  // the list, with a host route through the other interface
+  txIpv4->SetUp (if2);
+  Ptr<Ipv4StaticRouting> newRouting = CreateObject<Ipv4StaticRouting> ();
+  txIpv4->SetRoutingProtocol (newRouting);
+  newRouting->AddHostRouteTo (Ipv4Address ("10.0.0.1"), if2);
+  NS_TEST_EXPECT_MSG_GT (txIpv4->GetRouteGeneration (), generation, "the generation never goes back");
+  txSocket->Send (Create<Packet> (100));
+  NS_TEST_EXPECT_MSG_EQ (m_interface, if2, "host route of the new routing protocol");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -721,6 +1047,9 @@ public:
   {
     AddTestCase (new UdpSocketImplTest, TestCase::QUICK);
     AddTestCase (new UdpSocketLoopbackTest, TestCase::QUICK);
+    AddTestCase (new UdpSocketRecvBatchTest, TestCase::QUICK);
+    AddTestCase (new UdpSocketSegmentTest, TestCase::QUICK);
+    AddTestCase (new UdpSocketRouteCacheTest, TestCase::QUICK);
     AddTestCase (new Udp6SocketImplTest, TestCase::QUICK);
     AddTestCase (new Udp6SocketLoopbackTest, TestCase::QUICK);
   }
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-waypoint-mobility-helper.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryWaypointMobilityHelper");
+
+BinaryWaypointMobilityHelper::BinaryWaypointMobilityHelper (std::string filename)
+  : m_file (Create<BinaryWaypointFile> (filename))
+{
+  NS_LOG_FUNCTION (this << filename);
+}
+
+bool
+BinaryWaypointMobilityHelper::HasWaypoints (Ptr<Node> node, uint32_t traceNode) const
+{
+  if (traceNode >= m_file->GetNNodes ())
+    {
+      NS_LOG_WARN ("Node " << node->GetId () << " skipped, the file has "
+                   << m_file->GetNNodes () << " nodes only");
+      return false;
+    }
+  uint64_t count = 0;
+  m_file->GetWaypoints (traceNode, &count);
+  if (count == 0)
+    {
+      NS_LOG_WARN ("Node " << node->GetId () << " skipped, node " << traceNode
+                   << " of the file has no waypoints");
+      return false;
+    }
+  return true;
+}
+
+void
+BinaryWaypointMobilityHelper::Install (void) const
+{
+  NS_LOG_FUNCTION (this);
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
+    {
+      if (HasWaypoints (*i, (*i)->GetId ()))
+        {
+          Install (*i, (*i)->GetId ());
+        }
+    }
+}
+
+void
+BinaryWaypointMobilityHelper::Install (NodeContainer c) const
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < c.GetN (); ++i)
+    {
+      if (HasWaypoints (c.Get (i), i))
+        {
+          Install (c.Get (i), i);
+        }
+    }
+}
+
+void
+BinaryWaypointMobilityHelper::Install (Ptr<Node> node, uint32_t traceNode) const
+{
+  NS_LOG_FUNCTION (this << node << traceNode);
+  Ptr<BinaryWaypointMobilityModel> model = node->GetObject<BinaryWaypointMobilityModel> ();
+  if (model == 0)
+    {
+      NS_ABORT_MSG_IF (node->GetObject<MobilityModel> () != 0,
+                       "Node " << node->GetId () << " already has another mobility model");
+      model = CreateObject<BinaryWaypointMobilityModel> ();
+      node->AggregateObject (model);
+    }
+  model->SetTrace (m_file, traceNode);
+}
+
+Ptr<BinaryWaypointFile>
+BinaryWaypointMobilityHelper::GetFile (void) const
+{
+  return m_file;
+}
+
+} // namespace ns3
@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef BINARY_WAYPOINT_MOBILITY_HELPER_H
+#define BINARY_WAYPOINT_MOBILITY_HELPER_H
+
+#include <string>
+#include "ns3/ptr.h"
+#include "ns3/node-container.h"
+#include "ns3/binary-waypoint-mobility-model.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mobility
+ * \brief Helper class which makes nodes follow the trajectories of a
+ * binary waypoint file.
+ *
+ * Unlike Ns2MobilityHelper, which parses a text trace and schedules
+ * its movements up front, the file is mapped in memory and every node
+ * gets a BinaryWaypointMobilityModel reading its own waypoints when
+ * its position is queried.  Installing a node costs a lookup in the
+ * index of the file, whatever the length of its trajectory.
+ *
+ * See BinaryWaypointFile for the format, and BinaryWaypointFile::Write
+ * to create a file.
+ */
+class BinaryWaypointMobilityHelper
+{
+public:
+  /**
+   * \param filename the binary waypoint file
+   */
+  BinaryWaypointMobilityHelper (std::string filename);
+
+  /**
+   * Make each node of the global ns3::NodeList follow the node of the
+   * file having its id.  The nodes beyond the end of the file, or whose
+   * node of the file has no waypoints, are skipped with a warning.
+   */
+  void Install (void) const;
+  /**
+   * Make the i-th node of the container follow node i of the file.  The
+   * nodes beyond the end of the file, or whose node of the file has no
+   * waypoints, are skipped with a warning.
+   * \param c the nodes
+   */
+  void Install (NodeContainer c) const;
+  /**
+   * Make a node follow a node of the file.
+   * \param node the node
+   * \param traceNode the node of the file
+   */
+  void Install (Ptr<Node> node, uint32_t traceNode) const;
+
+  /**
+   * \return the file
+   */
+  Ptr<BinaryWaypointFile> GetFile (void) const;
+
+private:
+  /**
+   * \param node the node to install
+   * \param traceNode the node of the file
+   * \return true if the file has waypoints for traceNode, otherwise warn
+   *         that node is skipped
+   */
+  bool HasWaypoints (Ptr<Node> node, uint32_t traceNode) const;
+
+  Ptr<BinaryWaypointFile> m_file; //!< The file
+};
+
+} // namespace ns3
+
+#endif /* BINARY_WAYPOINT_MOBILITY_HELPER_H */
@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "batch-mobility-engine.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BatchMobilityEngine");
+
+BatchMobilityEngine::BatchMobilityEngine ()
+  : m_time (0),
+    m_valid (false),
+    m_passes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+BatchMobilityEngine::AddSlot (void)
+{
+  uint32_t slot;
+  if (!m_free.empty ())
+    {
+      slot = m_free.back ();
+      m_free.pop_back ();
+    }
+  else
+    {
+      slot = m_originX.size ();
+      for (std::vector<double> *v : {&m_originX, &m_originY, &m_originZ,
+                                     &m_velocityX, &m_velocityY, &m_velocityZ,
+                                     &m_amplitudeX, &m_amplitudeY, &m_amplitudeZ,
+                                     &m_omega, &m_elapsed, &m_x, &m_y, &m_z})
+        {
+          v->push_back (0);
+        }
+      m_start.push_back (0);
+    }
+  NS_LOG_FUNCTION (this << slot);
+  SetMotion (slot, Vector (), Vector (), Vector (), 0, Simulator::Now ());
+  return slot;
+}
+
+void
+BatchMobilityEngine::RemoveSlot (uint32_t slot)
+{
+  NS_LOG_FUNCTION (this << slot);
+  NS_ASSERT (slot < m_originX.size ());
+  // a released slot stays at rest until it is reused
+  SetMotion (slot, Vector (), Vector (), Vector (), 0, TimeStep (m_time));
+  m_free.push_back (slot);
+}
+
+void
+BatchMobilityEngine::SetMotion (uint32_t slot, const Vector &origin, const Vector &velocity,
+                                const Vector &amplitude, double omega, Time start)
+{
+  NS_LOG_FUNCTION (this << slot << origin << velocity << amplitude << omega << start);
+  m_originX[slot] = origin.x;
+  m_originY[slot] = origin.y;
+  m_originZ[slot] = origin.z;
+  m_velocityX[slot] = velocity.x;
+  m_velocityY[slot] = velocity.y;
+  m_velocityZ[slot] = velocity.z;
+  m_amplitudeX[slot] = amplitude.x;
+  m_amplitudeY[slot] = amplitude.y;
+  m_amplitudeZ[slot] = amplitude.z;
+  m_omega[slot] = omega;
+  m_start[slot] = start.GetTimeStep ();
+  if (m_valid)
+    {
+      m_elapsed[slot] = (TimeStep (m_time) - start).GetSeconds ();
+      EvaluateSlot (slot);
+    }
+}
+
+Vector
+BatchMobilityEngine::GetPosition (uint32_t slot)
+{
+  if (!m_valid || Simulator::Now ().GetTimeStep () != m_time)
+    {
+      Evaluate ();
+    }
+  return Vector (m_x[slot], m_y[slot], m_z[slot]);
+}
+
+void
+BatchMobilityEngine::Evaluate (void)
+{
+  const Time now = Simulator::Now ();
+  NS_LOG_FUNCTION (this << now);
+  if (!m_valid)
+    {
+      // the next simulation restarts from time zero
+      Simulator::ScheduleDestroy (&BatchMobilityEngine::Invalidate, this);
+    }
+  m_time = now.GetTimeStep ();
+  m_valid = true;
+  ++m_passes;
+  const std::size_t n = m_originX.size ();
+  // most slots share their start time: convert each distinct elapsed
+  // time to seconds once
+  int64_t lastStart = 0;
+  double lastElapsed = now.GetSeconds ();
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      if (m_start[i] != lastStart)
+        {
+          lastStart = m_start[i];
+          lastElapsed = (now - TimeStep (lastStart)).GetSeconds ();
+        }
+      m_elapsed[i] = lastElapsed;
+    }
+  const double *elapsed = m_elapsed.data ();
+  const double *omega = m_omega.data ();
+  const double *originX = m_originX.data ();
+  const double *originY = m_originY.data ();
+  const double *originZ = m_originZ.data ();
+  const double *velocityX = m_velocityX.data ();
+  const double *velocityY = m_velocityY.data ();
+  const double *velocityZ = m_velocityZ.data ();
+  const double *amplitudeX = m_amplitudeX.data ();
+  const double *amplitudeY = m_amplitudeY.data ();
+  const double *amplitudeZ = m_amplitudeZ.data ();
+  double *x = m_x.data ();
+  double *y = m_y.data ();
+  double *z = m_z.data ();
+  for (std::size_t i = 0; i < n; ++i)
+    {
+      const double s = std::sin (elapsed[i] * omega[i]);
+      x[i] = originX[i] + velocityX[i] * elapsed[i] + amplitudeX[i] * s;
+      y[i] = originY[i] + velocityY[i] * elapsed[i] + amplitudeY[i] * s;
+      z[i] = originZ[i] + velocityZ[i] * elapsed[i] + amplitudeZ[i] * s;
+    }
+}
+
+void
+BatchMobilityEngine::Invalidate (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_valid = false;
+}
+
+void
+BatchMobilityEngine::EvaluateSlot (uint32_t i)
+{
+  const double s = std::sin (m_elapsed[i] * m_omega[i]);
+  m_x[i] = m_originX[i] + m_velocityX[i] * m_elapsed[i] + m_amplitudeX[i] * s;
+  m_y[i] = m_originY[i] + m_velocityY[i] * m_elapsed[i] + m_amplitudeY[i] * s;
+  m_z[i] = m_originZ[i] + m_velocityZ[i] * m_elapsed[i] + m_amplitudeZ[i] * s;
+}
+
+uint64_t
+BatchMobilityEngine::GetNPasses (void) const
+{
+  return m_passes;
+}
+
+uint32_t
+BatchMobilityEngine::GetNSlots (void) const
+{
+  return m_originX.size () - m_free.size ();
+}
+
+
+BatchMobilitySlot::BatchMobilitySlot ()
+  : m_slot (NONE)
+{
+}
+
+BatchMobilitySlot::~BatchMobilitySlot ()
+{
+  Reset ();
+}
+
+bool
+BatchMobilitySlot::IsSet (void) const
+{
+  return m_slot != NONE;
+}
+
+void
+BatchMobilitySlot::Set (const Vector &origin, const Vector &velocity,
+                        const Vector &amplitude, double omega, Time start)
+{
+  if (m_slot == NONE)
+    {
+      m_slot = BatchMobilityEngine::Get ()->AddSlot ();
+    }
+  BatchMobilityEngine::Get ()->SetMotion (m_slot, origin, velocity, amplitude, omega, start);
+}
+
+void
+BatchMobilitySlot::Set (const Vector &position, const Vector &velocity)
+{
+  Set (position, velocity, Vector (), 0, Simulator::Now ());
+}
+
+Vector
+BatchMobilitySlot::GetPosition (void) const
+{
+  NS_ASSERT (m_slot != NONE);
+  return BatchMobilityEngine::Get ()->GetPosition (m_slot);
+}
+
+void
+BatchMobilitySlot::Reset (void)
+{
+  if (m_slot != NONE)
+    {
+      BatchMobilityEngine::Get ()->RemoveSlot (m_slot);
+      m_slot = NONE;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef BATCH_MOBILITY_ENGINE_H
+#define BATCH_MOBILITY_ENGINE_H
+
+#include "ns3/nstime.h"
+#include "ns3/singleton.h"
+#include "ns3/vector.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mobility
+ *
+ * \brief Evaluates the positions of many mobility models at once.
+ *
+ * Each model which opts in owns a slot describing its motion since a
+ * start time t0 as
+ *
+ *     position (t) = origin + velocity * (t - t0) + amplitude * sin (omega * (t - t0))
+ *
+ * which covers the constant position, constant velocity (between two
+ * course changes) and pendulum motions.  The parameters of all slots
+ * are kept as structure of arrays.  The first position query at a new
+ * simulation time evaluates every slot in one pass over the arrays,
+ * and the queries at the same time are then array lookups.  A slot
+ * whose parameters change is evaluated again on its own.
+ *
+ * The pass costs one evaluation per slot for each simulation time at
+ * which a position is queried, which pays off when most nodes are
+ * queried at the same times, as when a wireless channel delivers a
+ * frame to every node.
+ *
+ * The engine is shared by all the models of the process, so it cannot
+ * be used with a simulator running nodes on several threads.
+ */
+class BatchMobilityEngine : public Singleton<BatchMobilityEngine>
+{
+public:
+  BatchMobilityEngine ();
+
+  /**
+   * Allocate a slot, at rest at the origin.
+   * \return the slot
+   */
+  uint32_t AddSlot (void);
+  /**
+   * Release a slot.
+   * \param slot the slot
+   */
+  void RemoveSlot (uint32_t slot);
+  /**
+   * Set the motion of a slot.
+   *
+   * \param slot the slot
+   * \param origin the position at start, without the sine term
+   * \param velocity the velocity of the linear term, in m/s
+   * \param amplitude the amplitude of the sine term, in m
+   * \param omega the angular frequency of the sine term, in rad/s
+   * \param start the start time t0
+   */
+  void SetMotion (uint32_t slot, const Vector &origin, const Vector &velocity,
+                  const Vector &amplitude, double omega, Time start);
+  /**
+   * \param slot the slot
+   * \return its position at the current simulation time
+   */
+  Vector GetPosition (uint32_t slot);
+
+  /**
+   * \return the number of passes over all slots so far
+   */
+  uint64_t GetNPasses (void) const;
+  /**
+   * \return the number of slots in use
+   */
+  uint32_t GetNSlots (void) const;
+
+private:
+  /** Evaluate all slots at the current simulation time. */
+  void Evaluate (void);
+  /**
+   * Evaluate one slot at the time of the last pass.
+   * \param slot the slot
+   */
+  void EvaluateSlot (uint32_t slot);
+  /** Forget the last pass when the simulator is destroyed. */
+  void Invalidate (void);
+
+  std::vector<double> m_originX;    //!< x of the origins
+  std::vector<double> m_originY;    //!< y of the origins
+  std::vector<double> m_originZ;    //!< z of the origins
+  std::vector<double> m_velocityX;  //!< x of the velocities
+  std::vector<double> m_velocityY;  //!< y of the velocities
+  std::vector<double> m_velocityZ;  //!< z of the velocities
+  std::vector<double> m_amplitudeX; //!< x of the amplitudes
+  std::vector<double> m_amplitudeY; //!< y of the amplitudes
+  std::vector<double> m_amplitudeZ; //!< z of the amplitudes
+  std::vector<double> m_omega;      //!< angular frequencies
+  std::vector<int64_t> m_start;     //!< start times, in time steps
+  std::vector<double> m_elapsed;    //!< seconds since the start at the last pass
+  std::vector<double> m_x;          //!< x of the positions at the last pass
+  std::vector<double> m_y;          //!< y of the positions at the last pass
+  std::vector<double> m_z;          //!< z of the positions at the last pass
+  std::vector<uint32_t> m_free;     //!< released slots
+  int64_t m_time;                   //!< time of the last pass, in time steps
+  bool m_valid;                     //!< whether the last pass is up to date
+  uint64_t m_passes;                //!< passes so far
+};
+
+/**
+ * \ingroup mobility
+ *
+ * \brief The slot of a mobility model in the BatchMobilityEngine,
+ * allocated by the first Set() and released on destruction.
+ */
+class BatchMobilitySlot
+{
+public:
+  BatchMobilitySlot ();
+  ~BatchMobilitySlot ();
+  // Delete copy constructor and assignment operator to avoid misuse
+  BatchMobilitySlot (const BatchMobilitySlot &) = delete;
+  BatchMobilitySlot &operator = (const BatchMobilitySlot &) = delete;
+
+  /**
+   * \return true once Set() was called
+   */
+  bool IsSet (void) const;
+  /**
+   * Set the motion from now on, see BatchMobilityEngine::SetMotion.
+   *
+   * \param origin the position at start, without the sine term
+   * \param velocity the velocity of the linear term, in m/s
+   * \param amplitude the amplitude of the sine term, in m
+   * \param omega the angular frequency of the sine term, in rad/s
+   * \param start the start time
+   */
+  void Set (const Vector &origin, const Vector &velocity,
+            const Vector &amplitude, double omega, Time start);
+  /**
+   * Set a linear motion from now on.
+   *
+   * \param position the current position
+   * \param velocity the velocity, in m/s
+   */
+  void Set (const Vector &position, const Vector &velocity);
+  /**
+   * \return the position at the current simulation time
+   */
+  Vector GetPosition (void) const;
+  /** Release the slot. */
+  void Reset (void);
+
+private:
+  uint32_t m_slot; //!< The slot, or NONE
+  static const uint32_t NONE = 0xffffffff; //!< No slot
+};
+
+} // namespace ns3
+
+#endif /* BATCH_MOBILITY_ENGINE_H */
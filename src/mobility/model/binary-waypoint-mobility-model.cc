@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-waypoint-mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryWaypointMobilityModel");
+
+NS_OBJECT_ENSURE_REGISTERED (BinaryWaypointMobilityModel);
+
+static_assert (sizeof (BinaryWaypoint) == 64, "the waypoints are 64 bytes in the file");
+
+namespace {
+
+/// Magic number of the binary waypoint files
+const char MAGIC[8] = {'N', 'S', '3', 'W', 'A', 'Y', 'P', 'T'};
+/// Version of the binary waypoint files
+const uint32_t VERSION = 1;
+/// Size of the header: magic, version, nodes and waypoints
+const uint64_t HEADER_SIZE = 8 + 4 + 4 + 8;
+
+} // unnamed namespace
+
+BinaryWaypointFile::BinaryWaypointFile (std::string filename)
+  : m_filename (filename),
+    m_data (0),
+    m_size (0),
+    m_nNodes (0),
+    m_nWaypoints (0),
+    m_index (0),
+    m_waypoints (0)
+{
+  NS_LOG_FUNCTION (this << filename);
+  int fd = open (filename.c_str (), O_RDONLY);
+  NS_ABORT_MSG_IF (fd < 0, "Could not open waypoint file " << filename);
+  struct stat st;
+  NS_ABORT_MSG_IF (fstat (fd, &st) != 0, "Could not stat waypoint file " << filename);
+  m_size = st.st_size;
+  NS_ABORT_MSG_IF (m_size < HEADER_SIZE, "Waypoint file " << filename << " is truncated");
+  void *data = mmap (0, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  NS_ABORT_MSG_IF (data == MAP_FAILED, "Could not map waypoint file " << filename);
+  // the nodes read their waypoints in time order, but in no order
+  // between them: do not read ahead
+  madvise (data, m_size, MADV_RANDOM);
+  m_data = static_cast<const uint8_t *> (data);
+
+  uint32_t version;
+  std::memcpy (&version, m_data + 8, 4);
+  std::memcpy (&m_nNodes, m_data + 12, 4);
+  std::memcpy (&m_nWaypoints, m_data + 16, 8);
+  NS_ABORT_MSG_IF (std::memcmp (m_data, MAGIC, 8) != 0 || version != VERSION,
+                   filename << " is not a binary waypoint file of version " << VERSION);
+  NS_ABORT_MSG_IF (m_size != HEADER_SIZE + 16 * uint64_t (m_nNodes) + sizeof (BinaryWaypoint) * m_nWaypoints,
+                   "Waypoint file " << filename << " does not have the size given by its header");
+  m_index = reinterpret_cast<const uint64_t *> (m_data + HEADER_SIZE);
+  m_waypoints = reinterpret_cast<const BinaryWaypoint *> (m_data + HEADER_SIZE + 16 * uint64_t (m_nNodes));
+}
+
+BinaryWaypointFile::~BinaryWaypointFile ()
+{
+  NS_LOG_FUNCTION (this);
+  munmap (const_cast<uint8_t *> (m_data), m_size);
+}
+
+uint32_t
+BinaryWaypointFile::GetNNodes (void) const
+{
+  return m_nNodes;
+}
+
+uint64_t
+BinaryWaypointFile::GetNWaypoints (void) const
+{
+  return m_nWaypoints;
+}
+
+const BinaryWaypoint *
+BinaryWaypointFile::GetWaypoints (uint32_t node, uint64_t *count) const
+{
+  NS_LOG_FUNCTION (this << node);
+  NS_ABORT_MSG_IF (node >= m_nNodes, "Node " << node << " is not in waypoint file " << m_filename);
+  const uint64_t first = m_index[2 * node];
+  *count = m_index[2 * node + 1];
+  NS_ABORT_MSG_IF (first > m_nWaypoints || *count > m_nWaypoints - first,
+                   "Bad index entry for node " << node << " in waypoint file " << m_filename);
+  return m_waypoints + first;
+}
+
+void
+BinaryWaypointFile::Write (std::string filename, std::vector<BinaryWaypoint> waypoints)
+{
+  NS_LOG_FUNCTION (filename << waypoints.size ());
+  std::stable_sort (waypoints.begin (), waypoints.end (),
+                    [] (const BinaryWaypoint &a, const BinaryWaypoint &b)
+                    {
+                      return a.node < b.node || (a.node == b.node && a.time < b.time);
+                    });
+  const uint32_t nNodes = waypoints.empty () ? 0 : waypoints.back ().node + 1;
+  const uint64_t nWaypoints = waypoints.size ();
+  std::vector<uint64_t> index (2 * uint64_t (nNodes), 0);
+  for (uint64_t i = nWaypoints; i-- > 0; )
+    {
+      BinaryWaypoint &waypoint = waypoints[i];
+      waypoint.reserved = 0;
+      index[2 * waypoint.node] = i;
+      ++index[2 * waypoint.node + 1];
+    }
+
+  std::ofstream out (filename, std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_IF (!out.is_open (), "Could not open waypoint file " << filename << " for writing");
+  out.write (MAGIC, 8);
+  out.write (reinterpret_cast<const char *> (&VERSION), 4);
+  out.write (reinterpret_cast<const char *> (&nNodes), 4);
+  out.write (reinterpret_cast<const char *> (&nWaypoints), 8);
+  out.write (reinterpret_cast<const char *> (index.data ()), index.size () * sizeof (uint64_t));
+  out.write (reinterpret_cast<const char *> (waypoints.data ()), nWaypoints * sizeof (BinaryWaypoint));
+  NS_ABORT_MSG_IF (!out.good (), "Could not write waypoint file " << filename);
+}
+
+
+TypeId
+BinaryWaypointMobilityModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BinaryWaypointMobilityModel")
+    .SetParent<MobilityModel> ()
+    .SetGroupName ("Mobility")
+    .AddConstructor<BinaryWaypointMobilityModel> ()
+    .AddAttribute ("UseVelocity",
+                   "Interpolate between the waypoints with a cubic curve matching "
+                   "their velocities, instead of linearly between their positions.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&BinaryWaypointMobilityModel::m_useVelocity),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+BinaryWaypointMobilityModel::BinaryWaypointMobilityModel ()
+  : m_waypoints (0),
+    m_count (0),
+    m_cursor (0),
+    m_useVelocity (true)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BinaryWaypointMobilityModel::~BinaryWaypointMobilityModel ()
+{
+}
+
+void
+BinaryWaypointMobilityModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_waypoints = 0;
+  m_count = 0;
+  m_file = 0;
+  MobilityModel::DoDispose ();
+}
+
+void
+BinaryWaypointMobilityModel::SetTrace (Ptr<const BinaryWaypointFile> file, uint32_t node)
+{
+  NS_LOG_FUNCTION (this << file << node);
+  m_file = file;
+  m_waypoints = file->GetWaypoints (node, &m_count);
+  NS_ABORT_MSG_IF (m_count == 0, "Node " << node << " has no waypoints");
+  m_cursor = 0;
+  NotifyCourseChange ();
+}
+
+uint64_t
+BinaryWaypointMobilityModel::Seek (void) const
+{
+  const int64_t now = Simulator::Now ().GetNanoSeconds ();
+  // time moves forward: now is usually within the segment found last,
+  // or within the next one
+  for (uint64_t cursor = m_cursor; cursor < m_cursor + 2 && cursor + 1 < m_count; ++cursor)
+    {
+      if (m_waypoints[cursor].time > now)
+        {
+          break;
+        }
+      if (now < m_waypoints[cursor + 1].time)
+        {
+          m_cursor = cursor;
+          return m_cursor;
+        }
+    }
+  const BinaryWaypoint *next = std::upper_bound (m_waypoints, m_waypoints + m_count, now,
+                                                 [] (int64_t time, const BinaryWaypoint &waypoint)
+                                                 {
+                                                   return time < waypoint.time;
+                                                 });
+  m_cursor = next == m_waypoints ? 0 : next - m_waypoints - 1;
+  return m_cursor;
+}
+
+void
+BinaryWaypointMobilityModel::Interpolate (Vector *position, Vector *velocity) const
+{
+  NS_ASSERT_MSG (m_count > 0, "SetTrace was not called");
+  const uint64_t i = Seek ();
+  const BinaryWaypoint &a = m_waypoints[i];
+  const int64_t now = Simulator::Now ().GetNanoSeconds ();
+  if (now < a.time || i + 1 == m_count)
+    {
+      // before the first waypoint or from the last one
+      *position = Vector (a.x, a.y, a.z) + m_offset;
+      *velocity = Vector ();
+      return;
+    }
+  const BinaryWaypoint &b = m_waypoints[i + 1];
+  const double dt = (b.time - a.time) * 1e-9;
+  const double s = double (now - a.time) / double (b.time - a.time);
+  if (!m_useVelocity)
+    {
+      *position = Vector (a.x + s * (b.x - a.x), a.y + s * (b.y - a.y), a.z + s * (b.z - a.z)) + m_offset;
+      *velocity = Vector ((b.x - a.x) / dt, (b.y - a.y) / dt, (b.z - a.z) / dt);
+      return;
+    }
+  // cubic Hermite basis and its derivative
+  const double s2 = s * s;
+  const double s3 = s2 * s;
+  const double h00 = 2 * s3 - 3 * s2 + 1;
+  const double h10 = (s3 - 2 * s2 + s) * dt;
+  const double h01 = -2 * s3 + 3 * s2;
+  const double h11 = (s3 - s2) * dt;
+  const double d00 = (6 * s2 - 6 * s) / dt;
+  const double d10 = 3 * s2 - 4 * s + 1;
+  const double d01 = -d00;
+  const double d11 = 3 * s2 - 2 * s;
+  *position = Vector (h00 * a.x + h10 * a.vx + h01 * b.x + h11 * b.vx,
+                      h00 * a.y + h10 * a.vy + h01 * b.y + h11 * b.vy,
+                      h00 * a.z + h10 * a.vz + h01 * b.z + h11 * b.vz) + m_offset;
+  *velocity = Vector (d00 * a.x + d10 * a.vx + d01 * b.x + d11 * b.vx,
+                      d00 * a.y + d10 * a.vy + d01 * b.y + d11 * b.vy,
+                      d00 * a.z + d10 * a.vz + d01 * b.z + d11 * b.vz);
+}
+
+Vector
+BinaryWaypointMobilityModel::DoGetPosition (void) const
+{
+  Vector position;
+  Vector velocity;
+  Interpolate (&position, &velocity);
+  return position;
+}
+
+void
+BinaryWaypointMobilityModel::DoSetPosition (const Vector &position)
+{
+  NS_LOG_FUNCTION (this << position);
+  m_offset = m_offset + (position - DoGetPosition ());
+  NotifyCourseChange ();
+}
+
+Vector
+BinaryWaypointMobilityModel::DoGetVelocity (void) const
+{
+  Vector position;
+  Vector velocity;
+  Interpolate (&position, &velocity);
+  return velocity;
+}
+
+} // namespace ns3
@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef BINARY_WAYPOINT_MOBILITY_MODEL_H
+#define BINARY_WAYPOINT_MOBILITY_MODEL_H
+
+#include "mobility-model.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/vector.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mobility
+ * \brief A waypoint of a binary waypoint file, as laid out in the file.
+ */
+struct BinaryWaypoint
+{
+  uint32_t node;     //!< Node of the trace
+  uint32_t reserved; //!< Zero
+  int64_t time;      //!< Time, in nanoseconds
+  double x;          //!< x of the position, in m
+  double y;          //!< y of the position, in m
+  double z;          //!< z of the position, in m
+  double vx;         //!< x of the velocity, in m/s
+  double vy;         //!< y of the velocity, in m/s
+  double vz;         //!< z of the velocity, in m/s
+};
+
+/**
+ * \ingroup mobility
+ * \brief A binary waypoint file, mapped in memory.
+ *
+ * The file holds, in host byte order:
+ *  - a header: the magic "NS3WAYPT", a version (uint32_t, 1), the
+ *    number of nodes N (uint32_t) and the number of waypoints
+ *    (uint64_t);
+ *  - an index of N entries, one per node: the position of its first
+ *    waypoint and its number of waypoints (two uint64_t);
+ *  - the waypoints (BinaryWaypoint), sorted by node, then by time.
+ *
+ * The file is mapped read-only: opening it reads nothing but the
+ * header, and the pages of the index and of the waypoints are loaded by
+ * the kernel when a node first uses them.  Write() creates such a file.
+ */
+class BinaryWaypointFile : public SimpleRefCount<BinaryWaypointFile>
+{
+public:
+  /**
+   * Map a file, aborting if it is not a valid binary waypoint file.
+   * \param filename the file
+   */
+  BinaryWaypointFile (std::string filename);
+  ~BinaryWaypointFile ();
+  // Delete copy constructor and assignment operator to avoid misuse
+  BinaryWaypointFile (const BinaryWaypointFile &) = delete;
+  BinaryWaypointFile &operator = (const BinaryWaypointFile &) = delete;
+
+  /**
+   * \return the number of nodes of the index
+   */
+  uint32_t GetNNodes (void) const;
+  /**
+   * \return the number of waypoints of all nodes
+   */
+  uint64_t GetNWaypoints (void) const;
+  /**
+   * \param node a node of the trace
+   * \param count the number of waypoints of the node, set on return
+   * \return the waypoints of the node, sorted by time
+   */
+  const BinaryWaypoint *GetWaypoints (uint32_t node, uint64_t *count) const;
+
+  /**
+   * Write a binary waypoint file.
+   * \param filename the file
+   * \param waypoints the waypoints of all nodes, in any order; nodes
+   *        with the same time keep their order
+   */
+  static void Write (std::string filename, std::vector<BinaryWaypoint> waypoints);
+
+private:
+  std::string m_filename;          //!< The file
+  const uint8_t *m_data;           //!< The mapping
+  uint64_t m_size;                 //!< Size of the mapping, in bytes
+  uint32_t m_nNodes;               //!< Number of nodes of the index
+  uint64_t m_nWaypoints;           //!< Number of waypoints
+  const uint64_t *m_index;         //!< The index
+  const BinaryWaypoint *m_waypoints; //!< The waypoints
+};
+
+/**
+ * \ingroup mobility
+ * \brief Mobility model which follows the waypoints of a node of a
+ * BinaryWaypointFile.
+ *
+ * Between two waypoints, the position is interpolated when it is
+ * queried: with a cubic Hermite curve matching the positions and
+ * velocities of both waypoints, or, if UseVelocity is false, linearly
+ * between the positions.  Before its first waypoint and after its last
+ * one, the node stays at their position with a zero velocity.
+ *
+ * No event is scheduled at the waypoints, so course change listeners
+ * are only notified by SetPosition(), which moves the whole trajectory
+ * by the difference between the position set and the current one.
+ *
+ * Use BinaryWaypointMobilityHelper to install the model on nodes.
+ */
+class BinaryWaypointMobilityModel : public MobilityModel
+{
+public:
+  /**
+   * Register this type with the TypeId system.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  BinaryWaypointMobilityModel ();
+  virtual ~BinaryWaypointMobilityModel ();
+
+  /**
+   * Follow a node of a file.
+   * \param file the file
+   * \param node the node of the file, which must have waypoints
+   */
+  void SetTrace (Ptr<const BinaryWaypointFile> file, uint32_t node);
+
+private:
+  virtual void DoDispose (void);
+  virtual Vector DoGetPosition (void) const;
+  virtual void DoSetPosition (const Vector &position);
+  virtual Vector DoGetVelocity (void) const;
+  /**
+   * Find the waypoint at or before now, or the first one.
+   * \return its position in m_waypoints
+   */
+  uint64_t Seek (void) const;
+  /**
+   * Interpolate the trajectory at the current time.
+   * \param position the position, set on return
+   * \param velocity the velocity, set on return
+   */
+  void Interpolate (Vector *position, Vector *velocity) const;
+
+  Ptr<const BinaryWaypointFile> m_file; //!< The file
+  const BinaryWaypoint *m_waypoints;    //!< The waypoints of the node
+  uint64_t m_count;                     //!< Their number
+  mutable uint64_t m_cursor;            //!< The last waypoint found by Seek()
+  Vector m_offset;                      //!< Moves the trajectory
+  bool m_useVelocity;                   //!< Interpolate with the velocities
+};
+
+} // namespace ns3
+
+#endif /* BINARY_WAYPOINT_MOBILITY_MODEL_H */
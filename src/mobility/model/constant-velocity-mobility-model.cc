@@ -19,6 +19,7 @@
  */
 #include "constant-velocity-mobility-model.h"
 #include "ns3/simulator.h"
+#include "ns3/boolean.h"
 
 namespace ns3 {
 
@@ -29,11 +30,18 @@ TypeId ConstantVelocityMobilityModel::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::ConstantVelocityMobilityModel")
     .SetParent<MobilityModel> ()
     .SetGroupName ("Mobility")
-    .AddConstructor<ConstantVelocityMobilityModel> ();
+    .AddConstructor<ConstantVelocityMobilityModel> ()
+    .AddAttribute ("Batch",
+                   "Evaluate the positions with the BatchMobilityEngine, "
+                   "together with the other models queried at the same time.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ConstantVelocityMobilityModel::m_batch),
+                   MakeBooleanChecker ());
   return tid;
 }
 
 ConstantVelocityMobilityModel::ConstantVelocityMobilityModel ()
+  : m_batch (false)
 {
 }
 
@@ -47,13 +55,32 @@ ConstantVelocityMobilityModel::SetVelocity (const Vector &speed)
   m_helper.Update ();
   m_helper.SetVelocity (speed);
   m_helper.Unpause ();
+  UpdateBatch ();
   NotifyCourseChange ();
 }
 
+void
+ConstantVelocityMobilityModel::UpdateBatch (void)
+{
+  if (m_slot.IsSet ())
+    {
+      m_slot.Set (m_helper.GetCurrentPosition (), m_helper.GetVelocity ());
+    }
+}
+
 
 Vector
 ConstantVelocityMobilityModel::DoGetPosition (void) const
 {
+  if (m_batch)
+    {
+      if (!m_slot.IsSet ())
+        {
+          m_helper.Update ();
+          m_slot.Set (m_helper.GetCurrentPosition (), m_helper.GetVelocity ());
+        }
+      return m_slot.GetPosition ();
+    }
   m_helper.Update ();
   return m_helper.GetCurrentPosition ();
 }
@@ -61,6 +88,7 @@ void
 ConstantVelocityMobilityModel::DoSetPosition (const Vector &position)
 {
   m_helper.SetPosition (position);
+  UpdateBatch ();
   NotifyCourseChange ();
 }
 Vector
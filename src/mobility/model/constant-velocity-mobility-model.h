@@ -24,6 +24,7 @@
 #include "ns3/nstime.h"
 #include "mobility-model.h"
 #include "constant-velocity-helper.h"
+#include "batch-mobility-engine.h"
 
 namespace ns3 {
 
@@ -31,6 +32,10 @@ namespace ns3 {
  * \ingroup mobility
  *
  * \brief Mobility model for which the current speed does not change once it has been set and until it is set again explicitly to a new value.
+ *
+ * With the Batch attribute, the positions are evaluated by the
+ * BatchMobilityEngine, from the last position and velocity set, instead
+ * of being advanced at each query.
  */
 class ConstantVelocityMobilityModel : public MobilityModel 
 {
@@ -58,7 +63,11 @@ private:
   virtual Vector DoGetPosition (void) const;
   virtual void DoSetPosition (const Vector &position);
   virtual Vector DoGetVelocity (void) const;
+  /** Copy the motion of the helper to the batch slot, once it is used. */
+  void UpdateBatch (void);
   ConstantVelocityHelper m_helper;  //!< helper object for this model
+  bool m_batch;                     //!< whether the batch engine evaluates the positions
+  mutable BatchMobilitySlot m_slot; //!< slot in the batch engine
 };
 
 } // namespace ns3
@@ -22,6 +22,7 @@
 #include "ns3/double.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include <cmath>
@@ -70,7 +71,13 @@ RandomWalk2dMobilityModel::GetTypeId (void)
                    "A random variable used to pick the speed (m/s).",
                    StringValue ("ns3::UniformRandomVariable[Min=2.0|Max=4.0]"),
                    MakePointerAccessor (&RandomWalk2dMobilityModel::m_speed),
-                   MakePointerChecker<RandomVariableStream> ());
+                   MakePointerChecker<RandomVariableStream> ())
+    .AddAttribute ("Batch",
+                   "Evaluate the positions with the BatchMobilityEngine, "
+                   "together with the other models queried at the same time.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RandomWalk2dMobilityModel::m_batch),
+                   MakeBooleanChecker ());
   return tid;
 }
 
@@ -125,9 +132,19 @@ RandomWalk2dMobilityModel::DoWalk (Time delayLeft)
       m_event = Simulator::Schedule (delay, &RandomWalk2dMobilityModel::Rebound, this,
                                      delayLeft - delay);
     }
+  UpdateBatch ();
   NotifyCourseChange ();
 }
 
+void
+RandomWalk2dMobilityModel::UpdateBatch (void)
+{
+  if (m_slot.IsSet ())
+    {
+      m_slot.Set (m_helper.GetCurrentPosition (), m_helper.GetVelocity ());
+    }
+}
+
 void
 RandomWalk2dMobilityModel::Rebound (Time delayLeft)
 {
@@ -159,6 +176,16 @@ RandomWalk2dMobilityModel::DoDispose (void)
 Vector
 RandomWalk2dMobilityModel::DoGetPosition (void) const
 {
+  if (m_batch)
+    {
+      // the walk reschedules itself before leaving the bounds
+      if (!m_slot.IsSet ())
+        {
+          m_helper.UpdateWithBounds (m_bounds);
+          m_slot.Set (m_helper.GetCurrentPosition (), m_helper.GetVelocity ());
+        }
+      return m_slot.GetPosition ();
+    }
   m_helper.UpdateWithBounds (m_bounds);
   return m_helper.GetCurrentPosition ();
 }
@@ -167,6 +194,7 @@ RandomWalk2dMobilityModel::DoSetPosition (const Vector &position)
 {
   NS_ASSERT (m_bounds.IsInside (position));
   m_helper.SetPosition (position);
+  UpdateBatch ();
   m_event.Cancel ();
   m_event = Simulator::ScheduleNow (&RandomWalk2dMobilityModel::DoInitializePrivate, this);
 }
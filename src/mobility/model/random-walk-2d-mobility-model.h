@@ -27,6 +27,7 @@
 #include "ns3/random-variable-stream.h"
 #include "mobility-model.h"
 #include "constant-velocity-helper.h"
+#include "batch-mobility-engine.h"
 
 namespace ns3 {
 
@@ -42,6 +43,9 @@ namespace ns3 {
  * of the model, we rebound on the boundary with a reflexive angle
  * and speed. This model is often identified as a brownian motion
  * model.
+ *
+ * With the Batch attribute, the positions between two course changes
+ * are evaluated by the BatchMobilityEngine.
  */
 class RandomWalk2dMobilityModel : public MobilityModel 
 {
@@ -79,8 +83,12 @@ private:
   virtual void DoSetPosition (const Vector &position);
   virtual Vector DoGetVelocity (void) const;
   virtual int64_t DoAssignStreams (int64_t);
+  /** Copy the motion of the helper to the batch slot, once it is used. */
+  void UpdateBatch (void);
 
   ConstantVelocityHelper m_helper; //!< helper for this object
+  bool m_batch; //!< whether the batch engine evaluates the positions
+  mutable BatchMobilitySlot m_slot; //!< slot in the batch engine
   EventId m_event; //!< stored event ID 
   enum Mode m_mode; //!< whether in time or distance mode
   double m_modeDistance; //!< Change direction and speed after this distance
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <vector>
+
+#include "ns3/batch-mobility-engine.h"
+#include "ns3/boolean.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/random-walk-2d-mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief BatchMobilityEngine - Test case for the evaluation of the slots.
+ */
+class BatchMobilityEngineSlotTestCase : public TestCase
+{
+public:
+  BatchMobilityEngineSlotTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Check the positions of the slots and count the passes.
+  void Check (void);
+
+  std::vector<BatchMobilitySlot> m_slots; //!< the slots
+};
+
+BatchMobilityEngineSlotTestCase::BatchMobilityEngineSlotTestCase ()
+  : TestCase ("Evaluate all slots in one pass per time"),
+    m_slots (10)
+{
+}
+
+void
+BatchMobilityEngineSlotTestCase::Check (void)
+{
+  BatchMobilityEngine *engine = BatchMobilityEngine::Get ();
+  const uint64_t passes = engine->GetNPasses ();
+  const double t = Simulator::Now ().GetSeconds ();
+  for (uint32_t i = 0; i < m_slots.size (); ++i)
+    {
+      // slot i oscillates around (i, 0, 0) along y, and drifts along z
+      Vector position = m_slots[i].GetPosition ();
+      NS_TEST_EXPECT_MSG_EQ_TOL (position.x, i, 1e-12, "x of slot " << i);
+      NS_TEST_EXPECT_MSG_EQ_TOL (position.y, 2 * std::sin (i * t), 1e-12, "y of slot " << i);
+      NS_TEST_EXPECT_MSG_EQ_TOL (position.z, 0.5 * t, 1e-12, "z of slot " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (engine->GetNPasses (), passes + 1, "one pass for all slots");
+
+  // a slot moved now is evaluated alone
+  m_slots[0].Set (Vector (-1, 0, 0), Vector ());
+  NS_TEST_EXPECT_MSG_EQ (m_slots[0].GetPosition ().x, -1, "moved slot");
+  NS_TEST_EXPECT_MSG_EQ (engine->GetNPasses (), passes + 1, "no second pass");
+  m_slots[0].Set (Vector (0, 0, 0), Vector (0, 0, 0.5), Vector (0, 2, 0), 0, Seconds (0));
+}
+
+void
+BatchMobilityEngineSlotTestCase::DoRun (void)
+{
+  const uint32_t before = BatchMobilityEngine::Get ()->GetNSlots ();
+  for (uint32_t i = 0; i < m_slots.size (); ++i)
+    {
+      m_slots[i].Set (Vector (i, 0, 0), Vector (0, 0, 0.5), Vector (0, 2, 0), i, Seconds (0));
+    }
+  NS_TEST_ASSERT_MSG_EQ (BatchMobilityEngine::Get ()->GetNSlots (), before + 10, "slots allocated");
+  for (uint32_t k = 1; k <= 5; ++k)
+    {
+      Simulator::Schedule (Seconds (0.7 * k), &BatchMobilityEngineSlotTestCase::Check, this);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_slots.clear ();
+  NS_TEST_ASSERT_MSG_EQ (BatchMobilityEngine::Get ()->GetNSlots (), before, "slots released");
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief BatchMobilityEngine - Test case for the models which opt in.
+ *
+ * The same motions with and without the Batch attribute must give the
+ * same positions, up to rounding.
+ */
+class BatchMobilityEngineModelTestCase : public TestCase
+{
+public:
+  BatchMobilityEngineModelTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record the positions of the models.
+   * \param models the models
+   * \param positions the positions, appended
+   */
+  static void Record (std::vector<Ptr<MobilityModel> > models, std::vector<Vector> *positions);
+  /**
+   * Run a constant velocity model and random walks.
+   * \param batch the value of the Batch attributes
+   * \return the positions every 100 ms
+   */
+  std::vector<Vector> RunOne (bool batch);
+};
+
+BatchMobilityEngineModelTestCase::BatchMobilityEngineModelTestCase ()
+  : TestCase ("Models give the same positions with the batch engine")
+{
+}
+
+void
+BatchMobilityEngineModelTestCase::Record (std::vector<Ptr<MobilityModel> > models,
+                                          std::vector<Vector> *positions)
+{
+  for (Ptr<MobilityModel> model : models)
+    {
+      positions->push_back (model->GetPosition ());
+    }
+}
+
+std::vector<Vector>
+BatchMobilityEngineModelTestCase::RunOne (bool batch)
+{
+  std::vector<Ptr<MobilityModel> > models;
+  Ptr<ConstantVelocityMobilityModel> linear = CreateObject<ConstantVelocityMobilityModel> ();
+  linear->SetAttribute ("Batch", BooleanValue (batch));
+  linear->SetPosition (Vector (1, 2, 3));
+  linear->SetVelocity (Vector (0.3, -0.2, 0.1));
+  Simulator::Schedule (Seconds (4.05), &ConstantVelocityMobilityModel::SetVelocity, linear, Vector (-1, 0, 0));
+  Simulator::Schedule (Seconds (6.05), &MobilityModel::SetPosition, linear, Vector (0, 0, 0));
+  models.push_back (linear);
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      Ptr<RandomWalk2dMobilityModel> walk = CreateObject<RandomWalk2dMobilityModel> ();
+      walk->SetAttribute ("Batch", BooleanValue (batch));
+      walk->AssignStreams (2 * i);
+      walk->SetPosition (Vector (10 + 10 * i, 50, 0));
+      walk->Initialize ();
+      models.push_back (walk);
+    }
+
+  std::vector<Vector> positions;
+  for (uint32_t k = 0; k < 100; ++k)
+    {
+      Simulator::Schedule (MilliSeconds (100 * k), &BatchMobilityEngineModelTestCase::Record,
+                           models, &positions);
+    }
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return positions;
+}
+
+void
+BatchMobilityEngineModelTestCase::DoRun (void)
+{
+  std::vector<Vector> expected = RunOne (false);
+  const uint64_t passes = BatchMobilityEngine::Get ()->GetNPasses ();
+  std::vector<Vector> positions = RunOne (true);
+  NS_TEST_ASSERT_MSG_EQ (positions.size (), expected.size (), "same number of positions");
+  for (std::size_t i = 0; i < expected.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_LT (CalculateDistance (positions[i], expected[i]), 1e-6,
+                             "position " << i << ": " << positions[i] << " instead of " << expected[i]);
+    }
+  // the six models are evaluated together at each time
+  NS_TEST_EXPECT_MSG_EQ (BatchMobilityEngine::Get ()->GetNPasses () - passes, 100, "one pass per time");
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief BatchMobilityEngine TestSuite
+ */
+class BatchMobilityEngineTestSuite : public TestSuite
+{
+public:
+  BatchMobilityEngineTestSuite ();
+};
+
+BatchMobilityEngineTestSuite::BatchMobilityEngineTestSuite ()
+  : TestSuite ("batch-mobility-engine", UNIT)
+{
+  AddTestCase (new BatchMobilityEngineSlotTestCase, TestCase::QUICK);
+  AddTestCase (new BatchMobilityEngineModelTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static BatchMobilityEngineTestSuite batchMobilityEngineTestSuite;
@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+
+#include "ns3/binary-waypoint-mobility-helper.h"
+#include "ns3/binary-waypoint-mobility-model.h"
+#include "ns3/boolean.h"
+#include "ns3/node-container.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Binary waypoint file test.
+ *
+ * Writes a file, installs it on three nodes and checks the interpolated
+ * positions and velocities.
+ */
+class BinaryWaypointMobilityTestCase : public TestCase
+{
+public:
+  BinaryWaypointMobilityTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the position and velocity of a node.
+   * \param model the mobility model of the node
+   * \param position the expected position
+   * \param velocity the expected velocity
+   */
+  void Check (Ptr<MobilityModel> model, Vector position, Vector velocity);
+};
+
+BinaryWaypointMobilityTestCase::BinaryWaypointMobilityTestCase ()
+  : TestCase ("Follow the waypoints of a binary waypoint file")
+{
+}
+
+void
+BinaryWaypointMobilityTestCase::Check (Ptr<MobilityModel> model, Vector position, Vector velocity)
+{
+  NS_TEST_EXPECT_MSG_LT (CalculateDistance (model->GetPosition (), position), 1e-9,
+                         "position " << model->GetPosition () << " at " << Simulator::Now ().As (Time::S));
+  NS_TEST_EXPECT_MSG_LT (CalculateDistance (model->GetVelocity (), velocity), 1e-9,
+                         "velocity " << model->GetVelocity () << " at " << Simulator::Now ().As (Time::S));
+}
+
+void
+BinaryWaypointMobilityTestCase::DoRun (void)
+{
+  // node 1 has no waypoints; the waypoints are not sorted
+  std::vector<BinaryWaypoint> waypoints = {
+    {2, 0, 21000000000, 10, 10, 0, 0, 0, 0},
+    {0, 0, 11000000000, 10, 0, 0, 1, 0, 0},
+    {2, 0, 1000000000, 0, 0, 0, 1, 0, 0},
+    {0, 0, 21000000000, 10, 10, 0, 0, 0, 0},
+    {2, 0, 11000000000, 10, 0, 0, 1, 0, 0},
+    {0, 0, 1000000000, 0, 0, 0, 1, 0, 0},
+  };
+  std::string filename = CreateTempDirFilename ("waypoints.bin");
+  BinaryWaypointFile::Write (filename, waypoints);
+
+  // node 3 is beyond the end of the file
+  NodeContainer nodes;
+  nodes.Create (4);
+  BinaryWaypointMobilityHelper helper (filename);
+  NS_TEST_ASSERT_MSG_EQ (helper.GetFile ()->GetNNodes (), 3, "nodes of the index");
+  NS_TEST_ASSERT_MSG_EQ (helper.GetFile ()->GetNWaypoints (), 6, "waypoints");
+  helper.Install (nodes);
+  Ptr<MobilityModel> cubic = nodes.Get (0)->GetObject<MobilityModel> ();
+  Ptr<MobilityModel> linear = nodes.Get (2)->GetObject<MobilityModel> ();
+  NS_TEST_ASSERT_MSG_NE (cubic, 0, "node 0 follows the file");
+  NS_TEST_ASSERT_MSG_EQ (nodes.Get (1)->GetObject<MobilityModel> (), 0, "node 1 has no waypoints");
+  NS_TEST_ASSERT_MSG_NE (linear, 0, "node 2 follows the file");
+  NS_TEST_ASSERT_MSG_EQ (nodes.Get (3)->GetObject<MobilityModel> (), 0, "node 3 is not in the file");
+  linear->SetAttribute ("UseVelocity", BooleanValue (false));
+
+  // before the first waypoint
+  Simulator::Schedule (Seconds (0.5), &BinaryWaypointMobilityTestCase::Check, this,
+                       cubic, Vector (0, 0, 0), Vector (0, 0, 0));
+  // the velocities of the first segment match the straight line
+  Simulator::Schedule (Seconds (6), &BinaryWaypointMobilityTestCase::Check, this,
+                       cubic, Vector (5, 0, 0), Vector (1, 0, 0));
+  Simulator::Schedule (Seconds (6), &BinaryWaypointMobilityTestCase::Check, this,
+                       linear, Vector (5, 0, 0), Vector (1, 0, 0));
+  Simulator::Schedule (Seconds (11), &BinaryWaypointMobilityTestCase::Check, this,
+                       cubic, Vector (10, 0, 0), Vector (1, 0, 0));
+  // the second segment turns
+  Simulator::Schedule (Seconds (16), &BinaryWaypointMobilityTestCase::Check, this,
+                       cubic, Vector (11.25, 5, 0), Vector (-0.25, 1.5, 0));
+  Simulator::Schedule (Seconds (16), &BinaryWaypointMobilityTestCase::Check, this,
+                       linear, Vector (10, 5, 0), Vector (0, 1, 0));
+  // after the last waypoint
+  Simulator::Schedule (Seconds (25), &BinaryWaypointMobilityTestCase::Check, this,
+                       cubic, Vector (10, 10, 0), Vector (0, 0, 0));
+  // setting the position moves the whole trajectory
+  Simulator::Schedule (Seconds (25), &MobilityModel::SetPosition, cubic, Vector (1, 2, 3));
+  Simulator::Schedule (Seconds (30), &BinaryWaypointMobilityTestCase::Check, this,
+                       cubic, Vector (1, 2, 3), Vector (0, 0, 0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Binary waypoint mobility TestSuite
+ */
+class BinaryWaypointMobilityTestSuite : public TestSuite
+{
+public:
+  BinaryWaypointMobilityTestSuite ();
+};
+
+BinaryWaypointMobilityTestSuite::BinaryWaypointMobilityTestSuite ()
+  : TestSuite ("binary-waypoint-mobility", UNIT)
+{
+  AddTestCase (new BinaryWaypointMobilityTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static BinaryWaypointMobilityTestSuite binaryWaypointMobilityTestSuite;
@@ -20,6 +20,14 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/size-class-pool.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define BUFFER_CHECKSUM_X86
+#include <immintrin.h>
+#endif
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -50,99 +58,19 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
+namespace {
+
+/**
+ * The free lists of the data storage, in size classes of a cache line.
+ * A packet buffer larger than a jumbo frame comes from the heap.
  */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
-
-Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
-{
-  NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
-    {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
-        {
-          Buffer::Deallocate (*i);
-        }
-      delete g_freeList;
-      g_freeList = DESTROYED;
-    }
-}
+typedef SizeClassPool<Buffer, 64, 10240, 1000> DataPool;
 
-void
-Buffer::Recycle (struct Buffer::Data *data)
-{
-  NS_LOG_FUNCTION (data);
-  NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
-    {
-      Buffer::Deallocate (data);
-    }
-  else
-    {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
-    }
-}
+} // unnamed namespace
+#endif /* BUFFER_FREE_LIST */
 
-Buffer::Data *
-Buffer::Create (uint32_t dataSize)
-{
-  NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
-    {
-      g_freeList = new Buffer::FreeList ();
-    }
-  else if (IS_INITIALIZED (g_freeList))
-    {
-      while (!g_freeList->empty ()) 
-        {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
-        }
-    }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
-  NS_ASSERT (data->m_count == 1);
-  return data;
-}
-#else /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
@@ -157,7 +85,6 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
-#endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data *
 Buffer::Allocate (uint32_t reqSize)
@@ -169,7 +96,13 @@ Buffer::Allocate (uint32_t reqSize)
     }
   NS_ASSERT (reqSize >= 1);
   uint32_t size = reqSize - 1 + sizeof (struct Buffer::Data);
+#ifdef BUFFER_FREE_LIST
+  uint8_t *b = static_cast<uint8_t *> (DataPool::Allocate (size));
+  // the rest of the size class is usable too
+  reqSize += DataPool::GetBlockSize (size) - size;
+#else
   uint8_t *b = new uint8_t [size];
+#endif
   struct Buffer::Data *data = reinterpret_cast<struct Buffer::Data*>(b);
   data->m_size = reqSize;
   data->m_count = 1;
@@ -182,7 +115,30 @@ Buffer::Deallocate (struct Buffer::Data *data)
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
   uint8_t *buf = reinterpret_cast<uint8_t *> (data);
+#ifdef BUFFER_FREE_LIST
+  DataPool::Deallocate (buf, data->m_size - 1 + sizeof (struct Buffer::Data));
+#else
   delete [] buf;
+#endif
+}
+
+void
+Buffer::SetPooling (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+#ifdef BUFFER_FREE_LIST
+  DataPool::SetPooling (enable);
+#endif
+}
+
+uint64_t
+Buffer::GetNHeapAllocated (void)
+{
+#ifdef BUFFER_FREE_LIST
+  return DataPool::GetNHeapAllocated ();
+#else
+  return 0;
+#endif
 }
 
 Buffer::Buffer ()
@@ -1130,6 +1086,178 @@ Buffer::Iterator::Read (uint8_t *buffer, uint32_t size)
     }
 }
 
+namespace {
+
+/**
+ * \ingroup packet
+ * A kernel of the one's complement sum: the sum of the 16 bit words of
+ * a block of bytes, in host byte order, not folded.  An odd last byte is
+ * the first byte of a word whose second byte is zero.
+ */
+typedef uint64_t (*ChecksumKernel) (const uint8_t *data, uint32_t size);
+
+/**
+ * \ingroup packet
+ * The portable checksum kernel, by 32 bit words.  Since 2^16 is 1 modulo
+ * 0xffff, a 32 bit word adds to the one's complement sum what its two 16
+ * bit words add.
+ * \param data the block
+ * \param size the size of the block
+ * \return the sum of its words
+ */
+uint64_t
+ChecksumAddScalar (const uint8_t *data, uint32_t size)
+{
+  uint64_t sum = 0;
+  while (size >= 8)
+    {
+      uint32_t words[2];
+      std::memcpy (words, data, 8);
+      sum += words[0];
+      sum += words[1];
+      data += 8;
+      size -= 8;
+    }
+  while (size >= 2)
+    {
+      uint16_t word;
+      std::memcpy (&word, data, 2);
+      sum += word;
+      data += 2;
+      size -= 2;
+    }
+  if (size == 1)
+    {
+      uint16_t word = 0;
+      std::memcpy (&word, data, 1);
+      sum += word;
+    }
+  return sum;
+}
+
+#ifdef BUFFER_CHECKSUM_X86
+#ifdef __SSE2__
+/**
+ * \ingroup packet
+ * The SSE2 checksum kernel, by 16 byte blocks: each block is widened to
+ * eight 32 bit lanes, which are flushed to the 64 bit sum before they
+ * can overflow.
+ * \param data the block
+ * \param size the size of the block
+ * \return the sum of its words
+ */
+uint64_t
+ChecksumAddSse2 (const uint8_t *data, uint32_t size)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  uint64_t sum = 0;
+  while (size >= 16)
+    {
+      // a lane takes at most 2 * 0xffff per block
+      const uint32_t blocks = std::min<uint32_t> (size / 16, 1 << 14);
+      __m128i lanes = zero;
+      for (uint32_t b = 0; b < blocks; b++)
+        {
+          __m128i v = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data));
+          lanes = _mm_add_epi32 (lanes, _mm_unpacklo_epi16 (v, zero));
+          lanes = _mm_add_epi32 (lanes, _mm_unpackhi_epi16 (v, zero));
+          data += 16;
+        }
+      size -= blocks * 16;
+      uint32_t words[4];
+      _mm_storeu_si128 (reinterpret_cast<__m128i *> (words), lanes);
+      sum += uint64_t (words[0]) + words[1] + words[2] + words[3];
+    }
+  return sum + ChecksumAddScalar (data, size);
+}
+#endif /* __SSE2__ */
+
+/**
+ * \ingroup packet
+ * The AVX2 checksum kernel, by 32 byte blocks, as the SSE2 one.  Built
+ * for AVX2 whatever the compiler flags, and only selected when the
+ * processor has it.
+ * \param data the block
+ * \param size the size of the block
+ * \return the sum of its words
+ */
+__attribute__ ((target ("avx2"))) uint64_t
+ChecksumAddAvx2 (const uint8_t *data, uint32_t size)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  uint64_t sum = 0;
+  while (size >= 32)
+    {
+      const uint32_t blocks = std::min<uint32_t> (size / 32, 1 << 14);
+      __m256i lanes = zero;
+      for (uint32_t b = 0; b < blocks; b++)
+        {
+          __m256i v = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data));
+          lanes = _mm256_add_epi32 (lanes, _mm256_unpacklo_epi16 (v, zero));
+          lanes = _mm256_add_epi32 (lanes, _mm256_unpackhi_epi16 (v, zero));
+          data += 32;
+        }
+      size -= blocks * 32;
+      uint32_t words[8];
+      _mm256_storeu_si256 (reinterpret_cast<__m256i *> (words), lanes);
+      for (uint32_t w = 0; w < 8; w++)
+        {
+          sum += words[w];
+        }
+    }
+  return sum + ChecksumAddScalar (data, size);
+}
+#endif /* BUFFER_CHECKSUM_X86 */
+
+/**
+ * \ingroup packet
+ * \return the widest checksum kernel this processor runs
+ */
+ChecksumKernel
+GetChecksumKernel (void)
+{
+#ifdef BUFFER_CHECKSUM_X86
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2"))
+    {
+      return &ChecksumAddAvx2;
+    }
+#ifdef __SSE2__
+  return &ChecksumAddSse2;
+#endif /* __SSE2__ */
+#endif /* BUFFER_CHECKSUM_X86 */
+  return &ChecksumAddScalar;
+}
+
+/**
+ * \ingroup packet
+ * Fold a sum of 16 bit words into the one's complement sum.
+ * \param sum the sum
+ * \return the one's complement sum
+ */
+uint16_t
+ChecksumFold (uint64_t sum)
+{
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return sum;
+}
+
+/**
+ * \ingroup packet
+ * \param sum a one's complement sum
+ * \return the one's complement sum of the same words, byte-swapped
+ */
+uint16_t
+ChecksumSwap (uint16_t sum)
+{
+  return (sum << 8) | (sum >> 8);
+}
+
+} // unnamed namespace
+
 uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size)
 {
@@ -1141,18 +1269,39 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
-  /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  /* see RFC 1071 to understand this code: the words are read as ReadU16
+   * does, the first byte in the low-order byte. The bytes before and after
+   * the zero area are summed in place, each part a whole block, and the sum
+   * of a block at an odd offset is byte-swapped (RFC 1071, 2.B); the zero
+   * area only shifts the offset. */
+  static const ChecksumKernel kernel = GetChecksumKernel ();
+  const uint32_t end = m_current + size;
+  NS_ASSERT_MSG (m_current >= m_dataStart && end <= m_dataEnd,
+                 GetReadErrorMessage ());
+
+  uint64_t sum = 0;
+  if (m_current < m_zeroStart)
+    {
+      const uint32_t blockEnd = std::min (end, m_zeroStart);
+      sum += ChecksumFold (kernel (m_data + m_current, blockEnd - m_current));
+    }
+  if (end > m_zeroEnd)
+    {
+      const uint32_t blockStart = std::max (m_current, m_zeroEnd);
+      uint16_t blockSum = ChecksumFold (kernel (m_data + blockStart - (m_zeroEnd - m_zeroStart),
+                                                end - blockStart));
+      sum += (blockStart - m_current) & 1 ? ChecksumSwap (blockSum) : blockSum;
+    }
+  m_current = end;
 
-  while (sum >> 16)
-    sum = (sum & 0xffff) + (sum >> 16);
-  return ~sum;
+  uint16_t folded = ChecksumFold (sum);
+  const uint16_t one = 1;
+  if (*reinterpret_cast<const uint8_t *> (&one) == 0)
+    {
+      // on a big-endian host, the kernels read the first byte high
+      folded = ChecksumSwap (folded);
+    }
+  return ~ChecksumFold (uint64_t (folded) + initialChecksum);
 }
 
 uint32_t 
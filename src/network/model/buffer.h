@@ -356,6 +356,28 @@ public:
      */
     inline void Read (Iterator start, uint32_t size);
 
+    /**
+     * \param size number of bytes
+     * \returns a pointer to the next size bytes of the buffer, or zero if
+     *          they are not contiguous: they overlap the zero area or go
+     *          beyond the buffer.
+     *
+     * Advance the Iterator by size bytes if they are contiguous, and leave
+     * it unchanged otherwise.  A Header can then serialize or deserialize
+     * its fields with plain stores and loads, and fall back to Write and
+     * Read through a local copy of the bytes otherwise:
+     * \code
+     *   uint8_t copy[8];
+     *   uint8_t *bytes = i.ReserveContiguous (8);
+     *   ... // store the fields into bytes, or into copy if it is zero
+     *   if (bytes == 0)
+     *     {
+     *       i.Write (copy, 8);
+     *     }
+     * \endcode
+     */
+    inline uint8_t *ReserveContiguous (uint32_t size);
+
     /**
      * \brief Calculate the checksum.
      * \param size size of the buffer.
@@ -368,6 +390,9 @@ public:
      * \param size size of the buffer.
      * \param initialChecksum initial value
      * \return checksum
+     *
+     * The bytes on each side of the zero area are summed in blocks, with
+     * the AVX2 or SSE2 instructions when the processor has them.
      */
     uint16_t CalculateIpChecksum (uint16_t size, uint32_t initialChecksum);
 
@@ -642,6 +667,18 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * Enable or disable the recycling of the freed data storage, for
+   * comparison.  Can be changed at any time.
+   * \param enable true to recycle the data storage (the default)
+   */
+  static void SetPooling (bool enable);
+  /**
+   * \returns the number of data storages taken from the heap rather than
+   *          from a free list by the calling thread
+   */
+  static uint64_t GetNHeapAllocated (void);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -765,9 +802,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value (per thread, like the free lists of the data).
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -790,18 +827,6 @@ private:
    */
   uint32_t m_end;
 
-#ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
-  /// Local static destructor structure
-  struct LocalStaticDestructor 
-  {
-    ~LocalStaticDestructor ();
-  };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
-#endif
 };
 
 } // namespace ns3
@@ -942,6 +967,26 @@ Buffer::Iterator::WriteHtonU32 (uint32_t data)
   m_current+= 4;
 }
 
+uint8_t *
+Buffer::Iterator::ReserveContiguous (uint32_t size)
+{
+  uint8_t *buffer;
+  if (m_current >= m_dataStart && m_current + size <= m_zeroStart)
+    {
+      buffer = &m_data[m_current];
+    }
+  else if (m_current >= m_zeroEnd && m_current + size <= m_dataEnd)
+    {
+      buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  else
+    {
+      return 0;
+    }
+  m_current += size;
+  return buffer;
+}
+
 uint16_t 
 Buffer::Iterator::ReadNtohU16 (void)
 {
@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "header-template.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include <iomanip>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HeaderTemplate");
+
+NS_OBJECT_ENSURE_REGISTERED (HeaderTemplate);
+
+TypeId
+HeaderTemplate::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HeaderTemplate")
+    .SetParent<Header> ()
+    .SetGroupName ("Network")
+    .AddConstructor<HeaderTemplate> ()
+  ;
+  return tid;
+}
+
+HeaderTemplate::HeaderTemplate ()
+  : m_tid (GetTypeId ()),
+    m_size (0)
+{
+}
+
+HeaderTemplate::HeaderTemplate (const Header &header)
+  : m_tid (GetTypeId ()),
+    m_size (0)
+{
+  SetHeader (header);
+}
+
+void
+HeaderTemplate::SetHeader (const Header &header)
+{
+  NS_LOG_FUNCTION (this << &header);
+  uint32_t size = header.GetSerializedSize ();
+  NS_ABORT_MSG_IF (size > MAX_SIZE, "Header " << header.GetInstanceTypeId ().GetName ()
+                   << " of " << size << " bytes is too large for a HeaderTemplate");
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  header.Serialize (buffer.Begin ());
+  buffer.CopyData (m_bytes, size);
+  m_size = size;
+  m_tid = header.GetInstanceTypeId ();
+}
+
+const uint8_t *
+HeaderTemplate::GetBytes (void) const
+{
+  return m_bytes;
+}
+
+TypeId
+HeaderTemplate::GetInstanceTypeId (void) const
+{
+  return m_tid;
+}
+
+uint32_t
+HeaderTemplate::GetSerializedSize (void) const
+{
+  return m_size;
+}
+
+void
+HeaderTemplate::Serialize (Buffer::Iterator start) const
+{
+  start.Write (m_bytes, m_size);
+}
+
+uint32_t
+HeaderTemplate::Deserialize (Buffer::Iterator start)
+{
+  // the size is the one of the header the template was built from
+  start.Read (m_bytes, m_size);
+  return m_size;
+}
+
+void
+HeaderTemplate::Print (std::ostream &os) const
+{
+  os << m_tid.GetName () << " template:";
+  std::ios_base::fmtflags flags = os.flags ();
+  for (uint32_t i = 0; i < m_size; ++i)
+    {
+      os << " " << std::hex << std::setw (2) << std::setfill ('0') << uint32_t (m_bytes[i]);
+    }
+  os.flags (flags);
+  os << std::setfill (' ');
+}
+
+} // namespace ns3
@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef HEADER_TEMPLATE_H
+#define HEADER_TEMPLATE_H
+
+#include "header.h"
+#include "ns3/assert.h"
+#include <cstring>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief A header serialized once, whose changing fields are patched in
+ * place.
+ *
+ * A sender which adds the same kind of header to every packet of a flow,
+ * with only a few fields changing between packets (a message id, a
+ * sequence number), can serialize the header once into a HeaderTemplate
+ * and then only patch these fields before each Packet::AddHeader.  A
+ * patch is a single 8, 16 or 32 bit store into the serialized bytes, in
+ * network byte order, optionally under a mask for bit fields; adding the
+ * template to a packet copies the bytes in one block.
+ *
+ * The template reports the TypeId of the header it was built from, so
+ * that the packet metadata records that header: the receiver removes it
+ * with the original Header class, and Packet::Print shows it as such.
+ *
+ * \code
+ *   MyHeader header;
+ *   header.SetFlowId (flowId);
+ *   HeaderTemplate tmpl (header);          // once per flow
+ *   ...
+ *   tmpl.SetU16 (MyHeader::SEQ_OFFSET, seq++);  // per packet
+ *   packet->AddHeader (tmpl);
+ * \endcode
+ */
+class HeaderTemplate : public Header
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /** Largest header a template can hold, in bytes. */
+  static const uint32_t MAX_SIZE = 64;
+
+  /** Create an empty template. */
+  HeaderTemplate ();
+  /**
+   * Serialize a header into a new template.
+   * \param header the header
+   */
+  HeaderTemplate (const Header &header);
+
+  /**
+   * Serialize a header into this template, replacing its content.
+   * \param header the header
+   */
+  void SetHeader (const Header &header);
+
+  /**
+   * Patch a byte of the serialized header.
+   * \param offset the offset of the byte in the header
+   * \param value the new value of the bits of \p mask
+   * \param mask the bits of the byte to change
+   */
+  inline void SetU8 (uint32_t offset, uint8_t value, uint8_t mask = 0xff);
+  /**
+   * Patch a 16 bit field of the serialized header, in network byte order.
+   * \param offset the offset of the field in the header
+   * \param value the new value of the bits of \p mask
+   * \param mask the bits of the field to change
+   */
+  inline void SetU16 (uint32_t offset, uint16_t value, uint16_t mask = 0xffff);
+  /**
+   * Patch a 32 bit field of the serialized header, in network byte order.
+   * \param offset the offset of the field in the header
+   * \param value the new value of the bits of \p mask
+   * \param mask the bits of the field to change
+   */
+  inline void SetU32 (uint32_t offset, uint32_t value, uint32_t mask = 0xffffffff);
+
+  /**
+   * \param offset the offset of the field in the header
+   * \returns the 16 bit field, in host byte order
+   */
+  inline uint16_t GetU16 (uint32_t offset) const;
+  /**
+   * \param offset the offset of the field in the header
+   * \returns the 32 bit field, in host byte order
+   */
+  inline uint32_t GetU32 (uint32_t offset) const;
+  /**
+   * \returns the serialized header
+   */
+  const uint8_t *GetBytes (void) const;
+
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  TypeId m_tid;                   //!< TypeId of the header serialized
+  uint32_t m_size;                //!< Size of the header serialized
+  uint8_t m_bytes[MAX_SIZE];      //!< The header serialized
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the inline methods declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+void
+HeaderTemplate::SetU8 (uint32_t offset, uint8_t value, uint8_t mask)
+{
+  NS_ASSERT (offset + 1 <= m_size);
+  m_bytes[offset] = (m_bytes[offset] & ~mask) | (value & mask);
+}
+
+void
+HeaderTemplate::SetU16 (uint32_t offset, uint16_t value, uint16_t mask)
+{
+  NS_ASSERT (offset + 2 <= m_size);
+  uint16_t field = (GetU16 (offset) & ~mask) | (value & mask);
+  uint8_t bytes[2] = {uint8_t (field >> 8), uint8_t (field)};
+  std::memcpy (m_bytes + offset, bytes, 2);
+}
+
+void
+HeaderTemplate::SetU32 (uint32_t offset, uint32_t value, uint32_t mask)
+{
+  NS_ASSERT (offset + 4 <= m_size);
+  uint32_t field = (GetU32 (offset) & ~mask) | (value & mask);
+  uint8_t bytes[4] = {uint8_t (field >> 24), uint8_t (field >> 16), uint8_t (field >> 8), uint8_t (field)};
+  std::memcpy (m_bytes + offset, bytes, 4);
+}
+
+uint16_t
+HeaderTemplate::GetU16 (uint32_t offset) const
+{
+  NS_ASSERT (offset + 2 <= m_size);
+  return (uint16_t (m_bytes[offset]) << 8) | m_bytes[offset + 1];
+}
+
+uint32_t
+HeaderTemplate::GetU32 (uint32_t offset) const
+{
+  NS_ASSERT (offset + 4 <= m_size);
+  return (uint32_t (m_bytes[offset]) << 24) | (uint32_t (m_bytes[offset + 1]) << 16)
+         | (uint32_t (m_bytes[offset + 2]) << 8) | m_bytes[offset + 3];
+}
+
+} // namespace ns3
+
+#endif /* HEADER_TEMPLATE_H */
@@ -30,6 +30,7 @@
 #include "ns3/log.h"
 #include "ns3/assert.h"
 #include "ns3/global-value.h"
+#include "ns3/threaded-simulator-impl.h"
 #include "ns3/boolean.h"
 
 namespace ns3 {
@@ -97,6 +98,9 @@ void
 Node::Construct (void)
 {
   NS_LOG_FUNCTION (this);
+  // a node runs in the partition of its system id under ThreadedSimulatorImpl;
+  // NodeList::Add schedules Node::Initialize, which must already go there
+  ThreadedSimulatorImpl::SetPartition (NodeList::GetNNodes (), m_sid);
   m_id = NodeList::Add (this);
 }
 
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "packet-provenance.h"
+
+namespace ns3 {
+
+PacketProvenance::PacketProvenance ()
+  : m_nodeId (UNSET),
+    m_flowId (0),
+    m_sequence (0),
+    m_creation (0)
+{
+}
+
+PacketProvenance::PacketProvenance (uint32_t nodeId, uint32_t flowId, uint64_t sequence, Time creation)
+  : m_nodeId (nodeId),
+    m_flowId (flowId),
+    m_sequence (sequence),
+    m_creation (creation.GetTimeStep ())
+{
+}
+
+bool
+PacketProvenance::IsSet (void) const
+{
+  return m_nodeId != UNSET;
+}
+
+uint32_t
+PacketProvenance::GetNodeId (void) const
+{
+  return m_nodeId;
+}
+
+uint32_t
+PacketProvenance::GetFlowId (void) const
+{
+  return m_flowId;
+}
+
+uint64_t
+PacketProvenance::GetSequence (void) const
+{
+  return m_sequence;
+}
+
+Time
+PacketProvenance::GetCreationTime (void) const
+{
+  return TimeStep (m_creation);
+}
+
+void
+PacketProvenance::Print (std::ostream &os) const
+{
+  if (!IsSet ())
+    {
+      os << "unset";
+      return;
+    }
+  os << "node=" << m_nodeId << " flow=" << m_flowId
+     << " seq=" << m_sequence << " created=" << GetCreationTime ();
+}
+
+std::ostream &
+operator << (std::ostream &os, const PacketProvenance &provenance)
+{
+  provenance.Print (os);
+  return os;
+}
+
+} // namespace ns3
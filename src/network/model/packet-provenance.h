@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_PROVENANCE_H
+#define PACKET_PROVENANCE_H
+
+#include "ns3/nstime.h"
+#include <ostream>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief The origin of a packet: the node and application flow which
+ * created it, its sequence number in the flow and its creation time.
+ *
+ * Every Packet holds one such fixed-size record, unset until the
+ * application sets it with Packet::SetProvenance.  It is copied with
+ * the packet, to its copies and fragments, without any allocation, and
+ * trace sinks read it with Packet::GetProvenance.  It replaces a packet
+ * tag, or the full PacketMetadata, when only the origin of the packets
+ * is needed, e.g. to measure their latency.
+ */
+class PacketProvenance
+{
+public:
+  /** Create an unset record. */
+  PacketProvenance ();
+  /**
+   * \param nodeId the id of the node which created the packet
+   * \param flowId the flow of the packet, chosen by the application
+   * \param sequence the sequence number of the packet in its flow
+   * \param creation the time the packet was created
+   */
+  PacketProvenance (uint32_t nodeId, uint32_t flowId, uint64_t sequence, Time creation);
+
+  /**
+   * \returns true if the record was set
+   */
+  bool IsSet (void) const;
+  /**
+   * \returns the id of the node which created the packet
+   */
+  uint32_t GetNodeId (void) const;
+  /**
+   * \returns the flow of the packet
+   */
+  uint32_t GetFlowId (void) const;
+  /**
+   * \returns the sequence number of the packet in its flow
+   */
+  uint64_t GetSequence (void) const;
+  /**
+   * \returns the time the packet was created
+   */
+  Time GetCreationTime (void) const;
+
+  /**
+   * \param os the output stream
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  /** The node id of an unset record. */
+  static const uint32_t UNSET = 0xffffffff;
+
+  uint32_t m_nodeId;   //!< The node which created the packet
+  uint32_t m_flowId;   //!< The flow of the packet
+  uint64_t m_sequence; //!< The sequence number of the packet
+  int64_t m_creation;  //!< The creation time, in time steps
+};
+
+/**
+ * \brief Stream insertion operator.
+ *
+ * \param os the stream
+ * \param provenance the record
+ * \returns a reference to the stream
+ */
+std::ostream & operator << (std::ostream &os, const PacketProvenance &provenance);
+
+} // namespace ns3
+
+#endif /* PACKET_PROVENANCE_H */
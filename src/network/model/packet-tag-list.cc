@@ -28,12 +28,20 @@
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/size-class-pool.h"
 #include <cstring>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
+namespace {
+
+/** The free lists of the TagData, in size classes of 16 bytes. */
+typedef SizeClassPool<PacketTagList, 16, 256, 1024> TagDataPool;
+
+} // unnamed namespace
+
 PacketTagList::TagData *
 PacketTagList::CreateTagData (size_t dataSize)
 {
@@ -43,14 +51,55 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << " exceeds maximum "
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+  void * p = TagDataPool::Allocate (sizeof (TagData) + dataSize - 1);
+  // The matching frees are in FreeTagData
 
   TagData * tag = new (p) TagData;
   tag->size = dataSize;
   return tag;
 }
 
+void
+PacketTagList::FreeTagData (TagData * tag)
+{
+  const std::size_t size = sizeof (TagData) + tag->size - 1;
+  tag->~TagData ();
+  TagDataPool::Deallocate (tag, size);
+}
+
+PacketTagList::TagData *
+PacketTagList::CreateInlineTagData (size_t dataSize)
+{
+  if (dataSize > INLINE_TAG_SIZE)
+    {
+      return 0;
+    }
+  for (uint32_t slot = 0; slot < INLINE_TAGS; ++slot)
+    {
+      if ((m_inlineUsed & (1 << slot)) == 0)
+        {
+          m_inlineUsed |= 1 << slot;
+          TagData * tag = new (m_inline[slot]) TagData;
+          tag->size = dataSize;
+          return tag;
+        }
+    }
+  return 0;
+}
+
+void
+PacketTagList::SetPooling (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  TagDataPool::SetPooling (enable);
+}
+
+uint64_t
+PacketTagList::GetNHeapAllocated (void)
+{
+  return TagDataPool::GetNHeapAllocated ();
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -194,8 +243,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      DeleteTagData (cur);
     }
   else
     {
@@ -266,14 +314,50 @@ PacketTagList::Add (const Tag &tag) const
       NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
                      "Error: cannot add the same kind of tag twice.");
     }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
+  PacketTagList * self = const_cast<PacketTagList *> (this);
+  struct TagData * head = self->CreateInlineTagData (tag.GetSerializedSize ());
+  struct TagData ** prevNext = &self->m_next;
+  if (head == 0)
+    {
+      // prepend to the TagData after the inline ones
+      head = CreateTagData (tag.GetSerializedSize ());
+      while (*prevNext != 0 && IsInline (*prevNext))
+        {
+          prevNext = &(*prevNext)->next;
+        }
+    }
   head->count = 1;
-  head->next = 0;
   head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
+  head->next = *prevNext;
   tag.Serialize (TagBuffer (head->data, head->data + head->size));
 
-  const_cast<PacketTagList *> (this)->m_next = head;
+  *prevNext = head;
+}
+
+PacketTagList
+PacketTagList::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketTagList copy;
+  struct TagData **prevNext = &copy.m_next;
+  bool inlined = true;
+  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      // the inline TagData must stay at the head of the list
+      struct TagData * tag = inlined ? copy.CreateInlineTagData (cur->size) : 0;
+      if (tag == 0)
+        {
+          inlined = false;
+          tag = CreateTagData (cur->size);
+        }
+      tag->count = 1;
+      tag->next = 0;
+      tag->tid = cur->tid;
+      std::memcpy (tag->data, cur->data, cur->size);
+      *prevNext = tag;
+      prevNext = &tag->next;
+    }
+  return copy;
 }
 
 bool
@@ -408,6 +492,7 @@ PacketTagList::Deserialize (const uint32_t* buffer, uint32_t size)
   NS_LOG_INFO("Deserializing number of tags " << numberOfTags);
 
   struct TagData * prevTag = 0;
+  bool inlined = true;
   for (uint32_t i = 0; i < numberOfTags; ++i)
     {
       NS_ASSERT (sizeCheck >= 4);
@@ -425,7 +510,13 @@ PacketTagList::Deserialize (const uint32_t* buffer, uint32_t size)
 
       NS_LOG_INFO ("Deserializing tag of type " << tid);
 
-      struct TagData * newTag = CreateTagData (tagSize);
+      // the inline TagData must stay at the head of the list
+      struct TagData * newTag = inlined ? CreateInlineTagData (tagSize) : 0;
+      if (newTag == 0)
+        {
+          inlined = false;
+          newTag = CreateTagData (tagSize);
+        }
       newTag->count = 1;
       newTag->next = 0;
       newTag->tid = tid;
@@ -26,6 +26,9 @@
 */
 
 #include <stdint.h>
+#include <cstddef>
+#include <cstring>
+#include <new>
 #include <ostream>
 #include "ns3/type-id.h"
 
@@ -98,7 +101,8 @@ class Tag;
  * \par <b> Copy-on-write </b> is implemented as follows:
  *
  *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
+ *     as \c T6; a tag which is not stored inline goes after the inline
+ *     ones). This is a constant time operation, and does not affect
  *     any other #PacketTagList's, hence this is a \c const function.
  *
  *   - Copy constructor (PacketTagList(const PacketTagList & o))
@@ -119,6 +123,18 @@ class Tag;
  *       The portion of the list between the first branch and the target is
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
+ *
+ * \par <b> Allocation </b>
+ *
+ *   - The first INLINE_TAGS tags of up to INLINE_TAG_SIZE bytes are
+ *     stored in TagData slots inside the PacketTagList itself, so that a
+ *     packet with one or two small tags allocates nothing.  The inline
+ *     TagData always form the head of the list, before any shared
+ *     TagData: the copy constructor and assignment copy them into the
+ *     slots of the new list, and join the tree after them.
+ *
+ *   - The other TagData are recycled through per-thread free lists by
+ *     size class (see SizeClassPool).
  */
 class PacketTagList 
 {
@@ -177,6 +193,13 @@ public:
    */
   inline ~PacketTagList ();
 
+  /**
+   * Copy the tags into new TagData, shared with no other list.
+   *
+   * \returns the copy
+   */
+  PacketTagList DeepCopy (void) const;
+
   /**
    * Add a tag to the head of this branch.
    *
@@ -242,6 +265,24 @@ public:
    */
   uint32_t Deserialize (const uint32_t* buffer, uint32_t size);
 
+  /**
+   * Enable or disable the recycling of the freed TagData, for
+   * comparison.  Can be changed at any time.
+   *
+   * \param [in] enable True to recycle TagData (the default).
+   */
+  static void SetPooling (bool enable);
+  /**
+   * \returns The number of TagData taken from the heap rather than from
+   *          a free list by the calling thread.
+   */
+  static uint64_t GetNHeapAllocated (void);
+
+  /** Number of tags stored inside the list rather than on the heap. */
+  static const uint32_t INLINE_TAGS = 2;
+  /** Largest serialized tag, in bytes, stored inside the list. */
+  static const uint32_t INLINE_TAG_SIZE = 16;
+
 private:
   /**
    * Allocate and construct a TagData struct, sizing the data area
@@ -252,6 +293,39 @@ private:
    */
   static
   TagData * CreateTagData (size_t dataSize);
+  /**
+   * Destroy and free a TagData created by CreateTagData().
+   *
+   * \param [in] tag The TagData.
+   */
+  static
+  void FreeTagData (TagData * tag);
+  /**
+   * Construct a TagData in a free inline slot.
+   *
+   * \param [in] dataSize The serialized size of the Tag.
+   * \returns The TagData, or 0 if the tag is too large or no slot is free.
+   */
+  TagData * CreateInlineTagData (size_t dataSize);
+  /**
+   * \param [in] tag A TagData of the list.
+   * \returns True if \pname{tag} is stored in an inline slot of this list.
+   */
+  inline bool IsInline (const TagData * tag) const;
+  /**
+   * Destroy a TagData which is no longer referenced, freeing its inline
+   * slot or its memory.
+   *
+   * \param [in] tag The TagData.
+   */
+  inline void DeleteTagData (TagData * tag);
+  /**
+   * Make this empty list a copy of another one: copy its inline
+   * TagData into the slots of this list, then join its tree.
+   *
+   * \param [in] o The PacketTagList to copy.
+   */
+  inline void CopyFrom (PacketTagList const &o);
   
   /**
    * Typedef of method function pointer for copy-on-write operations
@@ -306,6 +380,13 @@ private:
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /** Size of an inline slot: a TagData with INLINE_TAG_SIZE bytes of data. */
+  static const std::size_t INLINE_SLOT_SIZE =
+    (sizeof (TagData) + INLINE_TAG_SIZE - 1 + alignof (TagData) - 1) / alignof (TagData) * alignof (TagData);
+  /** Which inline slots hold a TagData, one bit per slot. */
+  uint8_t m_inlineUsed;
+  /** The inline slots. */
+  alignas (TagData) uint8_t m_inline[INLINE_TAGS][INLINE_SLOT_SIZE];
 };
 
 } // namespace ns3
@@ -317,33 +398,28 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_inlineUsed (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_next (),
+    m_inlineUsed (0)
 {
-  if (m_next != 0)
-    {
-      m_next->count++;
-    }
+  CopyFrom (o);
 }
 
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o || m_next == o.m_next)
     {
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
-    {
-      m_next->count++;
-    }
+  CopyFrom (o);
   return *this;
 }
 
@@ -352,6 +428,49 @@ PacketTagList::~PacketTagList ()
   RemoveAll ();
 }
 
+bool
+PacketTagList::IsInline (const TagData *tag) const
+{
+  const uint8_t *p = reinterpret_cast<const uint8_t *> (tag);
+  return p >= &m_inline[0][0] && p < &m_inline[0][0] + sizeof (m_inline);
+}
+
+void
+PacketTagList::DeleteTagData (TagData *tag)
+{
+  if (IsInline (tag))
+    {
+      const std::size_t slot = (reinterpret_cast<uint8_t *> (tag) - &m_inline[0][0]) / INLINE_SLOT_SIZE;
+      m_inlineUsed &= ~(1 << slot);
+      tag->~TagData ();
+    }
+  else
+    {
+      FreeTagData (tag);
+    }
+}
+
+void
+PacketTagList::CopyFrom (PacketTagList const &o)
+{
+  struct TagData **prevNext = &m_next;
+  const struct TagData *cur = o.m_next;
+  // the inline TagData are the head of the list
+  for (uint32_t slot = 0; cur != 0 && o.IsInline (cur); ++slot, cur = cur->next)
+    {
+      struct TagData *copy = new (m_inline[slot]) TagData (*cur);
+      std::memcpy (copy->data, cur->data, cur->size);
+      m_inlineUsed |= 1 << slot;
+      *prevNext = copy;
+      prevNext = &copy->next;
+    }
+  *prevNext = const_cast<struct TagData *> (cur);
+  if (cur != 0)
+    {
+      (*prevNext)->count++;
+    }
+}
+
 void
 PacketTagList::RemoveAll (void)
 {
@@ -365,15 +484,13 @@ PacketTagList::RemoveAll (void)
         }
       if (prev != 0) 
         {
-          prev->~TagData ();
-          std::free (prev);
+          DeleteTagData (prev);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
-      prev->~TagData ();
-      std::free (prev);
+      DeleteTagData (prev);
     }
   m_next = 0;
 }
@@ -21,6 +21,8 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/size-class-pool.h"
+#include "ns3/threaded-simulator-impl.h"
 #include <string>
 #include <cstdarg>
 
@@ -28,7 +30,7 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+std::atomic<uint32_t> Packet::m_globalUid (0);
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -126,6 +128,40 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+uint32_t
+Packet::NextUid (void)
+{
+  if (ThreadedSimulatorImpl::IsParallel ())
+    {
+      return m_globalUid.fetch_add (1, std::memory_order_relaxed);
+    }
+  // a single thread creates packets: no need for a locked increment
+  uint32_t uid = m_globalUid.load (std::memory_order_relaxed);
+  m_globalUid.store (uid + 1, std::memory_order_relaxed);
+  return uid;
+}
+
+Ptr<Packet>
+Packet::DeepCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Buffer buffer;
+  buffer.AddAtStart (m_buffer.GetSize ());
+  buffer.Begin ().Write (m_buffer.Begin (), m_buffer.End ());
+  // byte tag offsets are relative to the start of the packet
+  ByteTagList byteTagList;
+  byteTagList.Add (m_byteTagList);
+  Ptr<Packet> copy = Ptr<Packet> (new Packet (buffer, byteTagList,
+                                              m_packetTagList.DeepCopy (),
+                                              m_metadata.DeepCopy ()), false);
+  if (m_nixVector)
+    {
+      copy->m_nixVector = m_nixVector->Copy ();
+    }
+  copy->m_provenance = m_provenance;
+  return copy;
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
@@ -136,17 +172,17 @@ Packet::Packet ()
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | NextUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
-    m_metadata (o.m_metadata)
+    m_metadata (o.m_metadata),
+    m_provenance (o.m_provenance)
 {
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
@@ -165,6 +201,7 @@ Packet::operator = (const Packet &o)
   m_metadata = o.m_metadata;
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
     : m_nixVector = 0;
+  m_provenance = o.m_provenance;
   return *this;
 }
 
@@ -178,10 +215,9 @@ Packet::Packet (uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | NextUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -204,10 +240,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | NextUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -237,6 +272,7 @@ Packet::CreateFragment (uint32_t start, uint32_t length) const
   // through Create because it is private.
   Ptr<Packet> ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, metadata), false);
   ret->SetNixVector (GetNixVector ());
+  ret->m_provenance = m_provenance;
   return ret;
 }
 
@@ -250,7 +286,19 @@ Ptr<NixVector>
 Packet::GetNixVector (void) const
 {
   return m_nixVector;
-} 
+}
+
+void
+Packet::SetProvenance (const PacketProvenance &provenance) const
+{
+  m_provenance = provenance;
+}
+
+const PacketProvenance &
+Packet::GetProvenance (void) const
+{
+  return m_provenance;
+}
 
 void
 Packet::AddHeader (const Header &header)
@@ -342,6 +390,10 @@ Packet::AddAtEnd (Ptr<const Packet> packet)
   m_byteTagList.Add (copy);
   m_buffer.AddAtEnd (packet->m_buffer);
   m_metadata.AddAtEnd (packet->m_metadata);
+  if (!m_provenance.IsSet ())
+    {
+      m_provenance = packet->m_provenance;
+    }
 }
 void
 Packet::AddPaddingAtEnd (uint32_t size)
@@ -582,6 +634,41 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+namespace {
+
+/** The free list of the packets. */
+typedef SizeClassPool<Packet, sizeof (Packet), sizeof (Packet), 1024> PacketPool;
+
+} // unnamed namespace
+
+void *
+Packet::operator new (std::size_t size)
+{
+  return PacketPool::Allocate (size);
+}
+
+void
+Packet::operator delete (void *p, std::size_t size)
+{
+  PacketPool::Deallocate (p, size);
+}
+
+void
+Packet::SetPooling (bool enable)
+{
+  NS_LOG_FUNCTION (enable);
+  PacketPool::SetPooling (enable);
+  Buffer::SetPooling (enable);
+  PacketTagList::SetPooling (enable);
+}
+
+uint64_t
+Packet::GetNHeapAllocated (void)
+{
+  return PacketPool::GetNHeapAllocated () + Buffer::GetNHeapAllocated ()
+    + PacketTagList::GetNHeapAllocated ();
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
@@ -21,6 +21,7 @@
 #define PACKET_H
 
 #include <stdint.h>
+#include <atomic>
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -29,6 +30,7 @@
 #include "byte-tag-list.h"
 #include "packet-tag-list.h"
 #include "nix-vector.h"
+#include "packet-provenance.h"
 #include "ns3/mac48-address.h"
 #include "ns3/callback.h"
 #include "ns3/assert.h"
@@ -227,6 +229,12 @@ private:
  *
  * The performance aspects copy-on-write semantics of the
  * Packet API are discussed in \ref packetperf
+ *
+ * Packet objects, the data of their byte buffer and their packet tags
+ * are recycled through per-thread free lists (see SizeClassPool) rather
+ * than returned to the heap, and the first small packet tags are stored
+ * inside the packet (see PacketTagList), so that applications sending
+ * packets at a high rate do not allocate in steady state.
  */
 class Packet : public SimpleRefCount<Packet>
 {
@@ -453,6 +461,18 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a copy of the packet which shares no data with it.
+   *
+   * \returns a copy of the packet.
+   *
+   * Unlike Copy(), the returned packet and the original can be used
+   * at the same time from two threads, as ThreadedSimulatorImpl does
+   * when a packet crosses from one partition to another.  The copy
+   * keeps the uid of the original.
+   */
+  Ptr<Packet> DeepCopy (void) const;
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -531,6 +551,33 @@ public:
    */
   static void EnableChecking (void);
 
+  /**
+   * \brief Allocate a packet from the free list of packets.
+   * \param size the size of the packet object
+   * \returns the memory block
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * \brief Return a packet to the free list of packets.
+   * \param p the memory block
+   * \param size the size of the packet object
+   */
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * \brief Enable or disable the recycling of the freed packets, buffer
+   * data and packet tags, for comparison.
+   *
+   * Can be changed at any time.
+   *
+   * \param enable true to recycle them (the default)
+   */
+  static void SetPooling (bool enable);
+  /**
+   * \returns the number of packets, buffer data and packet tags taken
+   * from the heap rather than from a free list by the calling thread
+   */
+  static uint64_t GetNHeapAllocated (void);
+
   /**
    * \brief Returns number of bytes required for packet
    * serialization.
@@ -710,6 +757,26 @@ public:
    */
   Ptr<NixVector> GetNixVector (void) const; 
 
+  /**
+   * \brief Set the origin of the packet.
+   *
+   * The record is stored in the packet, and copied to its copies and
+   * fragments.  A packet made of several packets with AddAtEnd keeps its
+   * own record, or takes the one of the packet added if it has none.
+   *
+   * As AddPacketTag, this method is const so that trace sinks can set
+   * the record of the const packets they are given.
+   *
+   * \param provenance the origin of the packet
+   */
+  void SetProvenance (const PacketProvenance &provenance) const;
+  /**
+   * \brief Get the origin of the packet.
+   *
+   * \returns the record set by SetProvenance, unset if none was
+   */
+  const PacketProvenance & GetProvenance (void) const;
+
   /**
    * TracedCallback signature for Ptr<Packet>
    *
@@ -791,7 +858,19 @@ private:
   /* Please see comments above about nix-vector */
   mutable Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  mutable PacketProvenance m_provenance; //!< the packet's origin
+
+  /**
+   * \brief Take the next packet Uid.
+   *
+   * The counter is only incremented atomically while a
+   * ThreadedSimulatorImpl runs events on several threads.
+   *
+   * \returns the Uid
+   */
+  static uint32_t NextUid (void);
+
+  static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
 };
 
 /**
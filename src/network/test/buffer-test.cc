@@ -22,6 +22,9 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include <algorithm>
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -385,6 +388,149 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // contiguous bytes on each side of the zero area, but not across it
+  buffer = Buffer (4);
+  buffer.AddAtStart (3);
+  buffer.AddAtEnd (2);
+  i = buffer.Begin ();
+  uint8_t *contiguous = i.ReserveContiguous (3);
+  NS_TEST_ASSERT_MSG_EQ ((contiguous != 0), true, "Bytes before the zero area not contiguous");
+  contiguous[0] = 0x1;
+  contiguous[1] = 0x2;
+  contiguous[2] = 0x3;
+  NS_TEST_ASSERT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), 3, "Iterator not advanced");
+  i.Prev ();
+  NS_TEST_ASSERT_MSG_EQ ((i.ReserveContiguous (2) == 0), true, "Bytes across the zero area contiguous");
+  NS_TEST_ASSERT_MSG_EQ (i.GetDistanceFrom (buffer.Begin ()), 2, "Iterator moved");
+  i.Next (1);
+  NS_TEST_ASSERT_MSG_EQ ((i.ReserveContiguous (1) == 0), true, "Zero area contiguous");
+  i.Next (4);
+  NS_TEST_ASSERT_MSG_EQ ((i.ReserveContiguous (3) == 0), true, "Bytes beyond the end contiguous");
+  contiguous = i.ReserveContiguous (2);
+  NS_TEST_ASSERT_MSG_EQ ((contiguous != 0), true, "Bytes after the zero area not contiguous");
+  contiguous[0] = 0x4;
+  contiguous[1] = 0x5;
+  NS_TEST_ASSERT_MSG_EQ (i.IsEnd (), true, "Iterator not advanced");
+  ENSURE_WRITTEN_BYTES (buffer, 9, 0x1, 0x2, 0x3, 0x0, 0x0, 0x0, 0x0, 0x4, 0x5);
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer::Iterator::CalculateIpChecksum test: the checksum of any part
+ * of a buffer with a zero area, at even and odd offsets, against the sum
+ * of its bytes, 16 bits at a time.
+ */
+class BufferChecksumTest : public TestCase {
+private:
+  /**
+   * \param data the bytes
+   * \param size the number of bytes
+   * \param initialChecksum the initial value
+   * \return the checksum of the bytes, as CalculateIpChecksum computes it
+   */
+  static uint16_t ReferenceChecksum (const uint8_t *data, uint32_t size, uint32_t initialChecksum);
+  /**
+   * Checks the checksums of the parts of a buffer
+   * \param head the number of bytes before the zero area
+   * \param zero the size of the zero area
+   * \param tail the number of bytes after the zero area
+   * \param value the value of the bytes, or 256 for random bytes
+   */
+  void CheckChecksums (uint32_t head, uint32_t zero, uint32_t tail, uint32_t value);
+  Ptr<UniformRandomVariable> m_rng; //!< Bytes and initial values
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer checksum")
+{
+}
+
+uint16_t
+BufferChecksumTest::ReferenceChecksum (const uint8_t *data, uint32_t size, uint32_t initialChecksum)
+{
+  uint64_t sum = initialChecksum;
+  for (uint32_t j = 0; j + 1 < size; j += 2)
+    {
+      sum += data[j] | (data[j + 1] << 8);
+    }
+  if (size & 1)
+    {
+      sum += data[size - 1];
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+void
+BufferChecksumTest::CheckChecksums (uint32_t head, uint32_t zero, uint32_t tail, uint32_t value)
+{
+  Buffer buffer (zero);
+  buffer.AddAtStart (head);
+  buffer.AddAtEnd (tail);
+  Buffer::Iterator i = buffer.Begin ();
+  for (uint32_t j = 0; j < head; j++)
+    {
+      i.WriteU8 (value < 256 ? value : m_rng->GetInteger (0, 255));
+    }
+  i = buffer.End ();
+  i.Prev (tail);
+  for (uint32_t j = 0; j < tail; j++)
+    {
+      i.WriteU8 (value < 256 ? value : m_rng->GetInteger (0, 255));
+    }
+  const uint32_t total = head + zero + tail;
+  std::vector<uint8_t> bytes (total);
+  buffer.CopyData (bytes.data (), total);
+
+  for (uint32_t start = 0; start < std::min<uint32_t> (total, 4); start++)
+    {
+      for (uint32_t size = total - start; size + 3 > total - start && size > 0; size--)
+        {
+          const uint32_t initialChecksum = m_rng->GetInteger (0, 0xffff);
+          i = buffer.Begin ();
+          i.Next (start);
+          uint16_t checksum = i.CalculateIpChecksum (size, initialChecksum);
+          std::ostringstream oss;
+          oss << "head=" << head << " zero=" << zero << " tail=" << tail
+              << " start=" << start << " size=" << size;
+          NS_TEST_EXPECT_MSG_EQ (checksum, ReferenceChecksum (&bytes[start], size, initialChecksum),
+                                 "Bad checksum of " << oss.str ());
+          NS_TEST_EXPECT_MSG_EQ (i.GetRemainingSize (), total - start - size,
+                                 "Iterator not advanced over " << oss.str ());
+        }
+    }
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+  const uint32_t heads[] = {0, 1, 8, 20, 33, 64};
+  const uint32_t zeros[] = {0, 1, 6, 1000};
+  const uint32_t tails[] = {0, 1, 2, 17, 40, 1500};
+  for (uint32_t head : heads)
+    {
+      for (uint32_t zero : zeros)
+        {
+          for (uint32_t tail : tails)
+            {
+              CheckChecksums (head, zero, tail, 256);
+            }
+        }
+    }
+  // all-ones words carry out of every lane
+  CheckChecksums (20, 0, 9000, 0xff);
+  CheckChecksums (7, 101, 60000, 0xff);
+  CheckChecksums (9001, 0, 0, 256);
 }
 
 /**
@@ -403,6 +549,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
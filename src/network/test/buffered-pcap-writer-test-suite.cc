@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/buffered-pcap-writer.h"
+#include "ns3/packet.h"
+#include "ns3/pcap-file.h"
+#include "ns3/radiotap-header.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+namespace {
+
+/// One record read back from a pcap file.
+struct Record
+{
+  uint32_t inclLen;           //!< Captured length.
+  uint32_t origLen;           //!< Length on the wire.
+  std::vector<uint8_t> data;  //!< Captured bytes.
+};
+
+/**
+ * \param filename the pcap file.
+ * \return all its records.
+ */
+std::vector<Record>
+ReadRecords (std::string filename)
+{
+  std::vector<Record> records;
+  PcapFile file;
+  file.Open (filename, std::ios::in);
+  while (true)
+    {
+      Record r;
+      r.data.resize (65535);
+      uint32_t tsSec, tsUsec, readLen;
+      file.Read (r.data.data (), r.data.size (), tsSec, tsUsec, r.inclLen, r.origLen, readLen);
+      if (file.Eof () || file.Fail ())
+        {
+          break;
+        }
+      r.data.resize (readLen);
+      records.push_back (r);
+    }
+  return records;
+}
+
+/**
+ * \param protocol the IP protocol (6 or 17).
+ * \param source the source port.
+ * \param destination the destination port.
+ * \param payload the number of payload bytes.
+ * \return an IPv4 packet without options.
+ */
+std::vector<uint8_t>
+MakeIpv4 (uint8_t protocol, uint16_t source, uint16_t destination, uint32_t payload)
+{
+  const uint32_t l4 = protocol == 6 ? 20 : 8;
+  std::vector<uint8_t> bytes (20 + l4 + payload, 0xee);
+  std::fill (bytes.begin (), bytes.begin () + 20 + l4, 0);
+  bytes[0] = 0x45;
+  bytes[9] = protocol;
+  bytes[20] = source >> 8;
+  bytes[21] = source & 0xff;
+  bytes[22] = destination >> 8;
+  bytes[23] = destination & 0xff;
+  if (protocol == 6)
+    {
+      bytes[20 + 12] = 5 << 4;
+    }
+  return bytes;
+}
+
+/**
+ * \param ip the network packet.
+ * \return a QoS data frame from the DS carrying ip behind LLC/SNAP.
+ */
+std::vector<uint8_t>
+MakeQosData (const std::vector<uint8_t> &ip)
+{
+  std::vector<uint8_t> frame (26, 0);
+  frame[0] = 0x88; // data, QoS data
+  frame[1] = 0x02; // from DS
+  const uint8_t snap[8] = {0xaa, 0xaa, 0x03, 0, 0, 0, 0x08, 0x00};
+  frame.insert (frame.end (), snap, snap + 8);
+  frame.insert (frame.end (), ip.begin (), ip.end ());
+  return frame;
+}
+
+/**
+ * \param bytes the content.
+ * \return a packet holding bytes.
+ */
+Ptr<Packet>
+MakePacket (const std::vector<uint8_t> &bytes)
+{
+  return Create<Packet> (bytes.data (), bytes.size ());
+}
+
+} // unnamed namespace
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief BufferedPcapWriter - Test case for the filter and the snap length.
+ */
+class BufferedPcapWriterFilterTestCase : public TestCase
+{
+public:
+  BufferedPcapWriterFilterTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BufferedPcapWriterFilterTestCase::BufferedPcapWriterFilterTestCase ()
+  : TestCase ("Filter by protocol and port, truncate the payload")
+{
+}
+
+void
+BufferedPcapWriterFilterTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("buffered-raw.pcap");
+  Ptr<BufferedPcapWriter> writer = CreateObject<BufferedPcapWriter> ();
+  writer->SetAttribute ("Filter", StringValue ("udp port 19574 or port 5683"));
+  writer->SetAttribute ("PayloadSnapLen", UintegerValue (16));
+  writer->Open (filename, 101);
+
+  writer->Write (Seconds (1), MakePacket (MakeIpv4 (17, 49153, 19574, 100)));
+  writer->Write (Seconds (2), MakePacket (MakeIpv4 (17, 5683, 49153, 4)));
+  writer->Write (Seconds (3), MakePacket (MakeIpv4 (17, 49153, 9, 100)));
+  writer->Write (Seconds (4), MakePacket (MakeIpv4 (6, 49153, 19574, 100)));
+  writer->Close ();
+
+  NS_TEST_ASSERT_MSG_EQ (writer->GetNCaptured (), 2, "two UDP packets on the ports");
+  NS_TEST_ASSERT_MSG_EQ (writer->GetNFiltered (), 2, "other port and TCP dropped");
+  std::vector<Record> records = ReadRecords (filename);
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 2, "records in the file");
+  NS_TEST_ASSERT_MSG_EQ (records[0].inclLen, 20 + 8 + 16, "headers plus 16 payload bytes");
+  NS_TEST_ASSERT_MSG_EQ (records[0].origLen, 20 + 8 + 100, "original length kept");
+  NS_TEST_ASSERT_MSG_EQ (records[0].data[23], (19574 & 0xff), "UDP header captured");
+  NS_TEST_ASSERT_MSG_EQ (records[1].inclLen, 20 + 8 + 4, "short payload kept whole");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief BufferedPcapWriter - Test case for 802.11 frames behind radiotap.
+ */
+class BufferedPcapWriterWifiTestCase : public TestCase
+{
+public:
+  BufferedPcapWriterWifiTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BufferedPcapWriterWifiTestCase::BufferedPcapWriterWifiTestCase ()
+  : TestCase ("Classify 802.11 QoS data frames behind a radiotap header")
+{
+}
+
+void
+BufferedPcapWriterWifiTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("buffered-radio.pcap");
+  Ptr<BufferedPcapWriter> writer = CreateObject<BufferedPcapWriter> ();
+  writer->SetAttribute ("Filter", StringValue ("udp"));
+  writer->SetAttribute ("PayloadSnapLen", UintegerValue (0));
+  writer->Open (filename, 127);
+
+  RadiotapHeader radiotap;
+  radiotap.SetTsft (1);
+  const uint32_t radiotapSize = radiotap.GetSerializedSize ();
+
+  std::vector<uint8_t> beacon (60, 0);
+  beacon[0] = 0x80;
+  writer->Write (Seconds (1), radiotap, MakePacket (beacon));
+  writer->Write (Seconds (2), radiotap, MakePacket (MakeQosData (MakeIpv4 (17, 1, 2, 500))));
+  writer->Write (Seconds (3), radiotap, MakePacket (MakeQosData (MakeIpv4 (6, 1, 2, 500))));
+  // filtered ahead of building the radiotap header, as WifiPhyHelper does
+  Ptr<const Packet> udp = MakePacket (MakeQosData (MakeIpv4 (17, 1, 2, 500)));
+  NS_TEST_EXPECT_MSG_EQ (writer->Accept (MakePacket (beacon)), false, "beacon rejected");
+  NS_TEST_EXPECT_MSG_EQ (writer->Accept (udp), true, "UDP frame accepted");
+  writer->Write (Seconds (4), radiotap, udp);
+  NS_TEST_EXPECT_MSG_EQ (writer->GetNFiltered (), 3, "an accepted frame is not filtered again");
+  writer->Close ();
+
+  std::vector<Record> records = ReadRecords (filename);
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 2, "only the UDP frames");
+  NS_TEST_EXPECT_MSG_EQ (records[1].inclLen, records[0].inclLen, "same record after Accept");
+  NS_TEST_ASSERT_MSG_EQ (records[0].inclLen, radiotapSize + 26 + 8 + 20 + 8,
+                         "radiotap and headers, no payload");
+  NS_TEST_ASSERT_MSG_EQ (records[0].origLen, radiotapSize + 26 + 8 + 20 + 8 + 500,
+                         "original length kept");
+  NS_TEST_ASSERT_MSG_EQ (records[0].data[radiotapSize], 0x88, "frame behind radiotap");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief BufferedPcapWriter - Test case for the ring of rotated files.
+ */
+class BufferedPcapWriterRotationTestCase : public TestCase
+{
+public:
+  BufferedPcapWriterRotationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BufferedPcapWriterRotationTestCase::BufferedPcapWriterRotationTestCase ()
+  : TestCase ("Rotate through a ring of size-bounded files")
+{
+}
+
+void
+BufferedPcapWriterRotationTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("buffered-ring.pcap");
+  Ptr<BufferedPcapWriter> writer = CreateObject<BufferedPcapWriter> ();
+  writer->SetAttribute ("MaxFileSize", UintegerValue (1000));
+  writer->SetAttribute ("MaxFiles", UintegerValue (3));
+  writer->SetAttribute ("BufferSize", UintegerValue (64));
+  writer->Open (filename, 101);
+
+  // 16 + 128 bytes per record: six records fit in 1000 bytes
+  for (uint32_t i = 0; i < 20; ++i)
+    {
+      writer->Write (MilliSeconds (i), MakePacket (MakeIpv4 (17, 1, 2, 100)));
+    }
+  writer->Close ();
+
+  NS_TEST_ASSERT_MSG_EQ (writer->GetNFiles (), 4, "6 + 6 + 6 + 2 records");
+  NS_TEST_ASSERT_MSG_EQ (BufferedPcapWriter::GetRotatedFilename ("a/b.c/trace.pcap", 2),
+                         "a/b.c/trace-2.pcap", "index before the extension");
+  NS_TEST_ASSERT_MSG_EQ (BufferedPcapWriter::GetRotatedFilename ("a/b.c/trace", 2),
+                         "a/b.c/trace-2", "no extension");
+
+  const uint32_t expected[3] = {2, 6, 6}; // the fourth file reused the first name
+  for (uint32_t k = 0; k < 3; ++k)
+    {
+      std::string name = BufferedPcapWriter::GetRotatedFilename (filename, k);
+      std::ifstream in (name, std::ios::binary | std::ios::ate);
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (static_cast<uint64_t> (in.tellg ()), 1000, "size cap of " << name);
+      NS_TEST_ASSERT_MSG_EQ (ReadRecords (name).size (), expected[k], "records in " << name);
+    }
+  std::ifstream fourth (BufferedPcapWriter::GetRotatedFilename (filename, 3));
+  NS_TEST_ASSERT_MSG_EQ (fourth.is_open (), false, "only three names in the ring");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief BufferedPcapWriter TestSuite
+ */
+class BufferedPcapWriterTestSuite : public TestSuite
+{
+public:
+  BufferedPcapWriterTestSuite ();
+};
+
+BufferedPcapWriterTestSuite::BufferedPcapWriterTestSuite ()
+  : TestSuite ("buffered-pcap-writer", UNIT)
+{
+  AddTestCase (new BufferedPcapWriterFilterTestCase, TestCase::QUICK);
+  AddTestCase (new BufferedPcapWriterWifiTestCase, TestCase::QUICK);
+  AddTestCase (new BufferedPcapWriterRotationTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static BufferedPcapWriterTestSuite bufferedPcapWriterTestSuite;
@@ -19,6 +19,7 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/header-template.h"
 #include "ns3/test.h"
 #include <limits>     // std:numeric_limits
 #include <string>
@@ -1150,6 +1151,252 @@ PacketTagListTest::DoRun (void)
 
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet tags stored inside the PacketTagList, alone and mixed with
+ * tags on the heap.
+ */
+class PacketInlineTagTest : public TestCase
+{
+public:
+  PacketInlineTagTest ();
+private:
+  void DoRun (void);
+  /**
+   * Count the packet tags with an iterator.
+   * \param p The packet.
+   * \returns The number of packet tags.
+   */
+  uint32_t CountTags (Ptr<const Packet> p);
+};
+
+PacketInlineTagTest::PacketInlineTagTest ()
+  : TestCase ("PacketInlineTagTest")
+{
+}
+
+uint32_t
+PacketInlineTagTest::CountTags (Ptr<const Packet> p)
+{
+  uint32_t n = 0;
+  PacketTagIterator i = p->GetPacketTagIterator ();
+  while (i.HasNext ())
+    {
+      i.Next ();
+      ++n;
+    }
+  return n;
+}
+
+void
+PacketInlineTagTest::DoRun (void)
+{
+  ATestTag<1> small1 (1);     // inline
+  ATestTag<15> small2 (2);    // inline, INLINE_TAG_SIZE bytes
+  ATestTag<16> large (3);     // one byte too large
+  ATestTag<2> small3 (4);     // no inline slot left
+
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddPacketTag (small1);
+  p->AddPacketTag (large);
+  p->AddPacketTag (small2);
+  p->AddPacketTag (small3);
+  NS_TEST_EXPECT_MSG_EQ (CountTags (p), 4, "all tags are iterated");
+
+  Ptr<Packet> copy = p->Copy ();
+  NS_TEST_EXPECT_MSG_EQ (CountTags (copy), 4, "all tags are copied");
+
+  // changing one copy does not change the other, inline or not
+  ATestTag<1> r1;
+  NS_TEST_EXPECT_MSG_EQ (copy->RemovePacketTag (r1), true, "inline tag removed");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) r1.GetData (), 1, "inline tag value");
+  ATestTag<16> r3 (7);
+  NS_TEST_EXPECT_MSG_EQ (copy->ReplacePacketTag (r3), true, "heap tag replaced");
+  ATestTag<15> r2 (8);
+  NS_TEST_EXPECT_MSG_EQ (p->ReplacePacketTag (r2), true, "inline tag replaced");
+
+  ATestTag<1> q1;
+  ATestTag<15> q2;
+  ATestTag<16> q3;
+  ATestTag<2> q4;
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (q1), true, "original keeps its inline tag");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (q3), true, "original keeps its heap tag");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) q3.GetData (), 3, "original heap tag unchanged");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (q2), true, "original replaced tag");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) q2.GetData (), 8, "original replaced tag value");
+  NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (q1), false, "copy lost its inline tag");
+  NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (q2), true, "copy keeps its inline tag");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) q2.GetData (), 2, "copy inline tag unchanged");
+  NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (q3), true, "copy replaced tag");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) q3.GetData (), 7, "copy replaced tag value");
+  NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (q4), true, "copy keeps the last tag");
+  NS_TEST_EXPECT_MSG_EQ (CountTags (p), 4, "original tags");
+  NS_TEST_EXPECT_MSG_EQ (CountTags (copy), 3, "copy tags");
+
+  // an inline slot freed by a removal is used again
+  copy->AddPacketTag (small1);
+  NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (q1), true, "tag added again");
+  NS_TEST_EXPECT_MSG_EQ (CountTags (copy), 4, "copy tags after add");
+
+  p->RemoveAllPacketTags ();
+  NS_TEST_EXPECT_MSG_EQ (CountTags (p), 0, "original tags removed");
+  NS_TEST_EXPECT_MSG_EQ (CountTags (copy), 4, "copy tags kept");
+
+  // once warm, a packet with small tags does not allocate from the heap
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      Ptr<Packet> warm = Create<Packet> (100);
+      warm->AddPacketTag (small1);
+      warm->AddPacketTag (small2);
+      Ptr<Packet> fragment = warm->CreateFragment (0, 50);
+      warm->AddPacketTag (large);
+    }
+  const uint64_t heap = Packet::GetNHeapAllocated ();
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Ptr<Packet> steady = Create<Packet> (100);
+      steady->AddPacketTag (small1);
+      steady->AddPacketTag (small2);
+      Ptr<Packet> fragment = steady->CreateFragment (0, 50);
+      steady->AddPacketTag (large);
+      NS_TEST_EXPECT_MSG_EQ (fragment->PeekPacketTag (q1), true, "fragment keeps the inline tags");
+    }
+  NS_TEST_EXPECT_MSG_EQ (Packet::GetNHeapAllocated (), heap, "no heap allocation in steady state");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * HeaderTemplate: the bytes added match the header it was built from,
+ * patches change only their field, and the packet metadata records the
+ * original header.
+ */
+class HeaderTemplateTest : public TestCase
+{
+public:
+  HeaderTemplateTest ();
+private:
+  void DoRun (void);
+};
+
+HeaderTemplateTest::HeaderTemplateTest ()
+  : TestCase ("HeaderTemplateTest")
+{
+}
+
+void
+HeaderTemplateTest::DoRun (void)
+{
+  Packet::EnableChecking ();
+
+  ATestHeader<10> header;
+  HeaderTemplate tmpl (header);
+  NS_TEST_ASSERT_MSG_EQ (tmpl.GetSerializedSize (), 10, "template size");
+  NS_TEST_EXPECT_MSG_EQ (tmpl.GetInstanceTypeId (), header.GetTypeId (), "template type");
+
+  // the metadata accept the original header class
+  Ptr<Packet> p = Create<Packet> (10);
+  p->AddHeader (tmpl);
+  ATestHeader<10> removed;
+  NS_TEST_EXPECT_MSG_EQ (p->RemoveHeader (removed), 10, "header removed");
+  NS_TEST_EXPECT_MSG_EQ (removed.m_error, false, "header content");
+
+  tmpl.SetU16 (2, 0x1234);
+  tmpl.SetU32 (4, 0xabcdef01, 0x00ffff00);
+  tmpl.SetU8 (9, 0xf0, 0xf0);
+  NS_TEST_EXPECT_MSG_EQ (tmpl.GetU16 (2), 0x1234, "16 bits field");
+  NS_TEST_EXPECT_MSG_EQ (tmpl.GetU32 (4), 0x0acdef0a, "32 bits field under mask");
+  p->AddHeader (tmpl);
+  uint8_t expected[10] = {10, 10, 0x12, 0x34, 0x0a, 0xcd, 0xef, 0x0a, 10, 0xfa};
+  uint8_t bytes[10];
+  p->CopyData (bytes, 10);
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t) bytes[i], (uint32_t) expected[i], "byte " << i);
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * PacketProvenance: the record set on a packet is found on its copies,
+ * fragments and reassembled packets, and costs no allocation.
+ */
+class PacketProvenanceTest : public TestCase
+{
+public:
+  PacketProvenanceTest ();
+private:
+  void DoRun (void);
+};
+
+PacketProvenanceTest::PacketProvenanceTest ()
+  : TestCase ("PacketProvenanceTest")
+{
+}
+
+void
+PacketProvenanceTest::DoRun (void)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  NS_TEST_EXPECT_MSG_EQ (p->GetProvenance ().IsSet (), false, "unset by default");
+
+  Ptr<const Packet> c = p;
+  c->SetProvenance (PacketProvenance (3, 7, 42, MilliSeconds (5)));
+  const PacketProvenance &provenance = p->GetProvenance ();
+  NS_TEST_EXPECT_MSG_EQ (provenance.IsSet (), true, "set");
+  NS_TEST_EXPECT_MSG_EQ (provenance.GetNodeId (), 3, "node");
+  NS_TEST_EXPECT_MSG_EQ (provenance.GetFlowId (), 7, "flow");
+  NS_TEST_EXPECT_MSG_EQ (provenance.GetSequence (), 42, "sequence");
+  NS_TEST_EXPECT_MSG_EQ (provenance.GetCreationTime (), MilliSeconds (5), "creation time");
+
+  ATestHeader<20> header;
+  p->AddHeader (header);
+  Ptr<Packet> copy = p->Copy ();
+  NS_TEST_EXPECT_MSG_EQ (copy->GetProvenance ().GetSequence (), 42, "copy");
+  NS_TEST_EXPECT_MSG_EQ (p->DeepCopy ()->GetProvenance ().GetSequence (), 42, "deep copy");
+  Packet assigned;
+  assigned = *p;
+  NS_TEST_EXPECT_MSG_EQ (assigned.GetProvenance ().GetSequence (), 42, "assignment");
+
+  // changing the record of a copy does not change the original
+  copy->SetProvenance (PacketProvenance (4, 7, 43, MilliSeconds (6)));
+  NS_TEST_EXPECT_MSG_EQ (p->GetProvenance ().GetSequence (), 42, "original kept");
+
+  // fragmentation and reassembly
+  Ptr<Packet> first = p->CreateFragment (0, 500);
+  Ptr<Packet> second = p->CreateFragment (500, 520);
+  NS_TEST_EXPECT_MSG_EQ (first->GetProvenance ().GetNodeId (), 3, "first fragment");
+  NS_TEST_EXPECT_MSG_EQ (second->GetProvenance ().GetNodeId (), 3, "second fragment");
+  first->AddAtEnd (second);
+  NS_TEST_EXPECT_MSG_EQ (first->GetProvenance ().GetSequence (), 42, "reassembled");
+  Ptr<Packet> empty = Create<Packet> ();
+  empty->AddAtEnd (copy);
+  NS_TEST_EXPECT_MSG_EQ (empty->GetProvenance ().GetSequence (), 43, "taken from the packet added");
+  first->AddAtEnd (copy);
+  NS_TEST_EXPECT_MSG_EQ (first->GetProvenance ().GetSequence (), 42, "own record kept");
+
+  // no allocation once warm
+  for (uint32_t i = 0; i < 10; ++i)
+    {
+      Ptr<Packet> warm = Create<Packet> (100);
+      warm->CreateFragment (0, 50);
+    }
+  const uint64_t heap = Packet::GetNHeapAllocated ();
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      Ptr<Packet> steady = Create<Packet> (100);
+      steady->SetProvenance (PacketProvenance (1, 0, i, Seconds (1)));
+      Ptr<Packet> fragment = steady->CreateFragment (0, 50);
+      NS_TEST_EXPECT_MSG_EQ (fragment->GetProvenance ().GetSequence (), i, "fragment record");
+    }
+  NS_TEST_EXPECT_MSG_EQ (Packet::GetNHeapAllocated (), heap, "no heap allocation in steady state");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1414,9 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketInlineTagTest, TestCase::QUICK);
+  AddTestCase (new HeaderTemplateTest, TestCase::QUICK);
+  AddTestCase (new PacketProvenanceTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
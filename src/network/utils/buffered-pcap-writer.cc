@@ -0,0 +1,619 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "buffered-pcap-writer.h"
+#include "ns3/abort.h"
+#include "ns3/buffer.h"
+#include "ns3/header.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BufferedPcapWriter");
+
+NS_OBJECT_ENSURE_REGISTERED (BufferedPcapWriter);
+
+namespace {
+
+const uint32_t PCAP_MAGIC = 0xa1b2c3d4;       //!< Microsecond resolution, native byte order.
+const uint32_t PCAP_HEADER_SIZE = 24;         //!< Global header.
+const uint32_t PCAP_RECORD_HEADER_SIZE = 16;  //!< Per record header.
+const uint32_t PCAP_SNAPLEN = 65535;          //!< Snap length announced in the file header.
+
+/// Bytes looked at to classify a frame: 802.11 header with HT control,
+/// LLC/SNAP, IPv6 and a TCP header with options.
+const uint32_t PEEK_SIZE = 36 + 8 + 60 + 60;
+
+const uint32_t DLT_EN10MB = 1;                //!< Ethernet.
+const uint32_t DLT_PPP = 9;                   //!< PPP.
+const uint32_t DLT_RAW = 101;                 //!< Raw IP.
+const uint32_t DLT_IEEE802_11 = 105;          //!< 802.11.
+const uint32_t DLT_IEEE802_11_RADIO = 127;    //!< Radiotap + 802.11.
+
+const uint16_t ETHERTYPE_IPV4 = 0x0800;       //!< IPv4 ethertype.
+const uint16_t ETHERTYPE_IPV6 = 0x86dd;       //!< IPv6 ethertype.
+const uint16_t ETHERTYPE_VLAN = 0x8100;       //!< 802.1Q tag.
+
+const uint8_t PROTOCOL_TCP = 6;               //!< TCP protocol number.
+const uint8_t PROTOCOL_UDP = 17;              //!< UDP protocol number.
+
+/**
+ * \param data the bytes.
+ * \param i the offset.
+ * \return the big endian 16 bits word at i.
+ */
+uint16_t
+ReadNtoh16 (const uint8_t *data, uint32_t i)
+{
+  return static_cast<uint16_t> ((data[i] << 8) | data[i + 1]);
+}
+
+/**
+ * \param data the bytes.
+ * \param size the number of bytes.
+ * \param i the offset.
+ * \return true if an LLC/SNAP header starts at i.
+ */
+bool
+IsSnap (const uint8_t *data, uint32_t size, uint32_t i)
+{
+  return size >= i + 8 && data[i] == 0xaa && data[i + 1] == 0xaa && data[i + 2] == 0x03;
+}
+
+/**
+ * \brief Append a 32 bits word in host byte order, as pcap files are.
+ * \param out the buffer.
+ * \param v the value.
+ */
+void
+Append32 (std::vector<uint8_t> &out, uint32_t v)
+{
+  uint8_t bytes[4];
+  std::memcpy (bytes, &v, 4);
+  out.insert (out.end (), bytes, bytes + 4);
+}
+
+} // unnamed namespace
+
+TypeId
+BufferedPcapWriter::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BufferedPcapWriter")
+    .SetParent<Object> ()
+    .SetGroupName ("Network")
+    .AddConstructor<BufferedPcapWriter> ()
+    .AddAttribute ("PayloadSnapLen",
+                   "Transport payload bytes kept in every record, behind the headers.",
+                   UintegerValue (0xffffffff),
+                   MakeUintegerAccessor (&BufferedPcapWriter::m_payloadSnapLen),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Filter",
+                   "Capture only these packets, e.g. \"udp port 19574\" "
+                   "(empty: everything).",
+                   StringValue (""),
+                   MakeStringAccessor (&BufferedPcapWriter::m_filter),
+                   MakeStringChecker ())
+    .AddAttribute ("MaxFileSize",
+                   "Rotate to the next file before exceeding this many bytes "
+                   "(0: a single file).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&BufferedPcapWriter::m_maxFileSize),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("MaxFiles",
+                   "Number of files in the rotation ring, the oldest is "
+                   "overwritten (0: never overwrite).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&BufferedPcapWriter::m_maxFiles),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BufferSize",
+                   "Bytes of records collected before they are handed to the "
+                   "writer thread.",
+                   UintegerValue (1 << 20),
+                   MakeUintegerAccessor (&BufferedPcapWriter::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxPendingBuffers",
+                   "Buffers waiting for the writer thread before the "
+                   "simulation blocks.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&BufferedPcapWriter::m_maxPending),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+BufferedPcapWriter::BufferedPcapWriter ()
+  : m_protocol (0),
+    m_dataLinkType (0),
+    m_open (false),
+    m_fileBytes (0),
+    m_peek (0),
+    m_headers (0),
+    m_captured (0),
+    m_filtered (0),
+    m_stop (false),
+    m_files (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_chunk.newFile = false;
+}
+
+BufferedPcapWriter::~BufferedPcapWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+BufferedPcapWriter::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+std::string
+BufferedPcapWriter::GetRotatedFilename (std::string filename, uint32_t k)
+{
+  std::string::size_type dot = filename.rfind ('.');
+  std::string::size_type slash = filename.rfind ('/');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    {
+      dot = filename.size ();
+    }
+  std::ostringstream oss;
+  oss << filename.substr (0, dot) << '-' << k << filename.substr (dot);
+  return oss.str ();
+}
+
+void
+BufferedPcapWriter::SetFilter (std::string filter)
+{
+  NS_LOG_FUNCTION (this << filter);
+  std::replace (filter.begin (), filter.end (), ',', ' ');
+  std::istringstream iss (filter);
+  std::string token;
+  bool port = false;
+  m_protocol = 0;
+  m_ports.clear ();
+  while (iss >> token)
+    {
+      if (token == "udp")
+        {
+          m_protocol = PROTOCOL_UDP;
+        }
+      else if (token == "tcp")
+        {
+          m_protocol = PROTOCOL_TCP;
+        }
+      else if (token == "port")
+        {
+          port = true;
+        }
+      else if (token == "or" || token == "and")
+        {
+          continue;
+        }
+      else
+        {
+          char *end;
+          unsigned long value = std::strtoul (token.c_str (), &end, 10);
+          NS_ABORT_MSG_IF (!port || *end != '\0' || value > 0xffff,
+                           "unsupported pcap filter \"" << filter << "\" at " << token);
+          m_ports.insert (static_cast<uint16_t> (value));
+        }
+    }
+  NS_ABORT_MSG_IF (port && m_ports.empty (), "pcap filter \"" << filter << "\" lacks a port");
+}
+
+bool
+BufferedPcapWriter::Classify (const uint8_t *data, uint32_t size, uint32_t &payload) const
+{
+  // link layer: where the network header starts and what it is
+  uint32_t l3 = 0;
+  uint16_t ethertype = 0;
+  payload = 0;
+  switch (m_dataLinkType)
+    {
+    case DLT_IEEE802_11:
+    case DLT_IEEE802_11_RADIO:
+      {
+        if (size < 2)
+          {
+            break;
+          }
+        const uint8_t type = (data[0] >> 2) & 0x3;
+        const uint8_t subtype = (data[0] >> 4) & 0xf;
+        if (type == 0)
+          {
+            payload = 24; // management
+            break;
+          }
+        if (type != 2)
+          {
+            payload = size; // control frames are tiny, keep them whole
+            break;
+          }
+        const bool fourAddress = (data[1] & 0x3) == 0x3;
+        const bool qos = subtype & 0x8;
+        uint32_t len = fourAddress ? 30 : 24;
+        bool amsdu = false;
+        if (qos)
+          {
+            amsdu = size > len && (data[len] & 0x80);
+            len += (data[1] & 0x80) ? 6 : 2; // QoS control and HT control
+          }
+        payload = len;
+        const bool noData = subtype & 0x4;
+        const bool protectedFrame = data[1] & 0x40;
+        if (!noData && !protectedFrame && !amsdu && IsSnap (data, size, len))
+          {
+            ethertype = ReadNtoh16 (data, len + 6);
+            l3 = len + 8;
+          }
+        break;
+      }
+    case DLT_EN10MB:
+      {
+        if (size < 14)
+          {
+            break;
+          }
+        uint32_t len = 12;
+        uint16_t type = ReadNtoh16 (data, len);
+        if (type == ETHERTYPE_VLAN && size >= 18)
+          {
+            len += 4;
+            type = ReadNtoh16 (data, len);
+          }
+        len += 2;
+        payload = len;
+        if (type >= 0x600)
+          {
+            ethertype = type;
+            l3 = len;
+          }
+        else if (IsSnap (data, size, len))
+          {
+            ethertype = ReadNtoh16 (data, len + 6);
+            l3 = len + 8;
+          }
+        break;
+      }
+    case DLT_PPP:
+      {
+        // ns-3 writes the protocol field only, real captures have the
+        // address and control fields first
+        uint32_t len = (size >= 2 && data[0] == 0xff && data[1] == 0x03) ? 2 : 0;
+        if (size < len + 2)
+          {
+            break;
+          }
+        const uint16_t protocol = ReadNtoh16 (data, len);
+        len += 2;
+        payload = len;
+        l3 = len;
+        ethertype = protocol == 0x0021 ? ETHERTYPE_IPV4 : protocol == 0x0057 ? ETHERTYPE_IPV6 : 0;
+        break;
+      }
+    case DLT_RAW:
+      if (size >= 1)
+        {
+          const uint8_t version = data[0] >> 4;
+          ethertype = version == 4 ? ETHERTYPE_IPV4 : version == 6 ? ETHERTYPE_IPV6 : 0;
+        }
+      break;
+    default:
+      break;
+    }
+  payload = std::min (payload, size);
+
+  // network layer
+  uint8_t protocol = 0;
+  uint32_t l4 = 0;
+  if (ethertype == ETHERTYPE_IPV4 && size >= l3 + 20)
+    {
+      const uint32_t ihl = (data[l3] & 0xf) * 4;
+      protocol = data[l3 + 9];
+      payload = std::min (l3 + ihl, size);
+      const uint16_t fragmentOffset = ReadNtoh16 (data, l3 + 6) & 0x1fff;
+      if (fragmentOffset == 0)
+        {
+          l4 = l3 + ihl;
+        }
+    }
+  else if (ethertype == ETHERTYPE_IPV6 && size >= l3 + 40)
+    {
+      protocol = data[l3 + 6];
+      payload = l3 + 40;
+      l4 = payload;
+    }
+
+  // transport layer
+  bool hasPorts = false;
+  uint16_t source = 0;
+  uint16_t destination = 0;
+  if (l4 != 0 && protocol == PROTOCOL_UDP && size >= l4 + 8)
+    {
+      hasPorts = true;
+      payload = l4 + 8;
+    }
+  else if (l4 != 0 && protocol == PROTOCOL_TCP && size >= l4 + 20)
+    {
+      hasPorts = true;
+      payload = std::min (l4 + (data[l4 + 12] >> 4) * 4, size);
+    }
+  if (hasPorts)
+    {
+      source = ReadNtoh16 (data, l4);
+      destination = ReadNtoh16 (data, l4 + 2);
+    }
+
+  if (m_protocol != 0 && protocol != m_protocol)
+    {
+      return false;
+    }
+  if (!m_ports.empty ())
+    {
+      return hasPorts && (m_ports.count (source) || m_ports.count (destination));
+    }
+  return true;
+}
+
+void
+BufferedPcapWriter::Open (std::string filename, uint32_t dataLinkType)
+{
+  NS_LOG_FUNCTION (this << filename << dataLinkType);
+  NS_ABORT_MSG_IF (m_open, "BufferedPcapWriter::Open(): " << m_filename << " already open");
+  SetFilter (m_filter);
+  m_filename = filename;
+  m_dataLinkType = dataLinkType;
+  m_open = true;
+  m_stop = false;
+  m_fileBytes = PCAP_HEADER_SIZE;
+  m_chunk.data.reserve (m_bufferSize);
+  m_chunk.newFile = true;
+  m_scratch.resize (PEEK_SIZE);
+  // the files must be complete when the simulation is over, whoever
+  // still holds a reference to the writer
+  Simulator::ScheduleDestroy (&BufferedPcapWriter::Close, Ptr<BufferedPcapWriter> (this));
+}
+
+void
+BufferedPcapWriter::Write (Time t, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << p);
+  Capture (t, nullptr, p);
+}
+
+void
+BufferedPcapWriter::Write (Time t, const Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << t << &header << p);
+  Capture (t, &header, p);
+}
+
+bool
+BufferedPcapWriter::Accept (Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  m_accepted = nullptr;
+  if (!m_open)
+    {
+      return false;
+    }
+  // classify on the first bytes, before anything is serialized
+  m_peek = p->CopyData (m_scratch.data (), std::min (p->GetSize (), PEEK_SIZE));
+  if (!Classify (m_scratch.data (), m_peek, m_headers))
+    {
+      ++m_filtered;
+      return false;
+    }
+  m_accepted = p;
+  return true;
+}
+
+void
+BufferedPcapWriter::Capture (Time t, const Header *header, Ptr<const Packet> p)
+{
+  if (p != m_accepted && !Accept (p))
+    {
+      return;
+    }
+  m_accepted = nullptr;
+  const uint32_t size = p->GetSize ();
+  const uint32_t peek = m_peek;
+  const uint32_t headers = m_headers;
+
+  uint32_t prefixSize = 0;
+  if (header != nullptr)
+    {
+      prefixSize = header->GetSerializedSize ();
+      Buffer buffer;
+      buffer.AddAtStart (prefixSize);
+      header->Serialize (buffer.Begin ());
+      m_prefix.resize (prefixSize);
+      buffer.CopyData (m_prefix.data (), prefixSize);
+    }
+  const uint32_t keep = static_cast<uint32_t> (std::min<uint64_t> (size, static_cast<uint64_t> (headers)
+                                                                   + m_payloadSnapLen));
+  const uint32_t record = PCAP_RECORD_HEADER_SIZE + prefixSize + keep;
+
+  if (m_maxFileSize != 0 && m_fileBytes > PCAP_HEADER_SIZE
+      && m_fileBytes + record > m_maxFileSize)
+    {
+      Flush ();
+      m_chunk.newFile = true;
+      m_fileBytes = PCAP_HEADER_SIZE;
+    }
+
+  const int64_t us = t.GetMicroSeconds ();
+  std::vector<uint8_t> &out = m_chunk.data;
+  Append32 (out, static_cast<uint32_t> (us / 1000000));
+  Append32 (out, static_cast<uint32_t> (us % 1000000));
+  Append32 (out, prefixSize + keep);
+  Append32 (out, prefixSize + size);
+  out.insert (out.end (), m_prefix.begin (), m_prefix.begin () + prefixSize);
+  if (keep <= peek)
+    {
+      out.insert (out.end (), m_scratch.begin (), m_scratch.begin () + keep);
+    }
+  else
+    {
+      const std::size_t offset = out.size ();
+      out.resize (offset + keep);
+      p->CopyData (out.data () + offset, keep);
+    }
+  m_fileBytes += record;
+  ++m_captured;
+
+  if (out.size () >= m_bufferSize)
+    {
+      Flush ();
+    }
+}
+
+void
+BufferedPcapWriter::Flush (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  // bound the memory held by a slow disk
+  m_cv.wait (lock, [this] () { return m_pending.size () < m_maxPending; });
+  m_pending.push_back (std::move (m_chunk));
+  m_chunk.newFile = false;
+  if (m_free.empty ())
+    {
+      m_chunk.data = std::vector<uint8_t> ();
+      m_chunk.data.reserve (m_bufferSize);
+    }
+  else
+    {
+      m_chunk.data = std::move (m_free.back ());
+      m_free.pop_back ();
+    }
+  if (!m_thread.joinable ())
+    {
+      m_thread = std::thread (&BufferedPcapWriter::Run, this);
+    }
+  lock.unlock ();
+  m_cv.notify_all ();
+}
+
+void
+BufferedPcapWriter::Run (void)
+{
+  std::ofstream file;
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      m_cv.wait (lock, [this] () { return !m_pending.empty () || m_stop; });
+      if (m_pending.empty ())
+        {
+          break;
+        }
+      Chunk chunk = std::move (m_pending.front ());
+      m_pending.pop_front ();
+      const uint32_t k = chunk.newFile ? m_files++ : 0;
+      lock.unlock ();
+      m_cv.notify_all ();
+
+      if (chunk.newFile)
+        {
+          const std::string name = m_maxFileSize == 0 ? m_filename
+            : GetRotatedFilename (m_filename, m_maxFiles == 0 ? k : k % m_maxFiles);
+          file.close ();
+          file.open (name, std::ios::out | std::ios::binary | std::ios::trunc);
+          NS_ABORT_MSG_UNLESS (file.is_open (), "BufferedPcapWriter: cannot open " << name);
+          std::vector<uint8_t> header;
+          Append32 (header, PCAP_MAGIC);
+          Append32 (header, 2 | (4 << 16)); // version 2.4
+          Append32 (header, 0);             // GMT
+          Append32 (header, 0);             // accuracy of the time stamps
+          Append32 (header, PCAP_SNAPLEN);
+          Append32 (header, m_dataLinkType);
+          file.write (reinterpret_cast<const char *> (header.data ()), header.size ());
+        }
+      file.write (reinterpret_cast<const char *> (chunk.data.data ()), chunk.data.size ());
+      NS_ABORT_MSG_IF (file.fail (), "BufferedPcapWriter: write error");
+
+      chunk.data.clear ();
+      lock.lock ();
+      if (m_free.size () < m_maxPending)
+        {
+          m_free.push_back (std::move (chunk.data));
+        }
+    }
+  file.close ();
+}
+
+void
+BufferedPcapWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_open)
+    {
+      return;
+    }
+  m_open = false;
+  m_accepted = nullptr;
+  Flush ();
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all ();
+  m_thread.join ();
+  m_free.clear ();
+  m_chunk.data = std::vector<uint8_t> ();
+  NS_LOG_INFO (m_filename << ": " << m_captured << " records, " << m_filtered
+                          << " filtered, " << GetNFiles () << " files");
+}
+
+uint32_t
+BufferedPcapWriter::GetDataLinkType (void) const
+{
+  return m_dataLinkType;
+}
+
+uint64_t
+BufferedPcapWriter::GetNCaptured (void) const
+{
+  return m_captured;
+}
+
+uint64_t
+BufferedPcapWriter::GetNFiltered (void) const
+{
+  return m_filtered;
+}
+
+uint32_t
+BufferedPcapWriter::GetNFiles (void) const
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  return m_files;
+}
+
+} // namespace ns3
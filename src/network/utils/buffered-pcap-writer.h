@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BUFFERED_PCAP_WRITER_H
+#define BUFFERED_PCAP_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Header;
+class Packet;
+
+/**
+ * \ingroup network
+ *
+ * \brief Size-bounded, filtered pcap capture written by a background
+ * thread.
+ *
+ * Unlike PcapFileWrapper, which serializes and writes every packet
+ * synchronously, this writer
+ *
+ *  - looks at the first bytes of a packet only, to find its IP protocol,
+ *    ports and where the transport payload starts, and drops the packets
+ *    rejected by Filter before anything else is copied;
+ *  - truncates every record to the link, network and transport headers
+ *    plus the first PayloadSnapLen bytes of payload (the original length
+ *    is kept in the record header);
+ *  - appends the records to an in-memory chunk of BufferSize bytes which
+ *    is handed to a writer thread when full;
+ *  - rotates to a new file when the current one would exceed
+ *    MaxFileSize, reusing the oldest of MaxFiles names (a ring, as
+ *    tcpdump -C/-W does).  The files are named "<base>-<k>.pcap".
+ *
+ * Filter is a small subset of the pcap filter language: an optional
+ * protocol ("udp" or "tcp") followed by an optional list of ports,
+ * e.g. "udp port 19574" or "port 19574 or port 5683".  A port matches
+ * either the source or the destination port.  With a filter, packets
+ * that are not IPv4 or IPv6 (beacons, acknowledgments, ARP, ...) and
+ * non-first IPv4 fragments are dropped.
+ *
+ * The link types understood are 802.11 (with or without radiotap),
+ * Ethernet, PPP and raw IP.  IPv6 extension headers and encrypted or
+ * aggregated (A-MSDU) 802.11 frames are not parsed: they carry no
+ * transport header as far as the filter is concerned.
+ *
+ * The files are complete once Close() has been called, which happens
+ * at the latest on Simulator::Destroy().  The writer thread does not
+ * survive a fork(), so a writer must be opened in the process that
+ * uses it.
+ */
+class BufferedPcapWriter : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  BufferedPcapWriter ();
+  virtual ~BufferedPcapWriter ();
+
+  /**
+   * \brief Start the capture.
+   * \param filename the pcap file, used as the base name when rotating.
+   * \param dataLinkType the data link type of the records (PcapHelper::DataLinkType).
+   */
+  void Open (std::string filename, uint32_t dataLinkType);
+
+  /**
+   * \brief Flush the pending records, stop the writer thread and close
+   * the file.  Further writes are ignored.
+   */
+  void Close (void);
+
+  /**
+   * \brief Capture a packet.
+   * \param t the time stamp of the record.
+   * \param p the packet, starting with the link layer header.
+   */
+  void Write (Time t, Ptr<const Packet> p);
+
+  /**
+   * \brief Capture a packet behind a pseudo header (e.g. radiotap).
+   * \param t the time stamp of the record.
+   * \param header the header written in front of the packet, which is
+   *        not subject to the snap length.
+   * \param p the packet, starting with the link layer header.
+   */
+  void Write (Time t, const Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Apply the filter to a packet ahead of Write(), so that the
+   * caller builds the pseudo header of the kept packets only.  A Write()
+   * of the same packet right after does not filter it again.
+   * \param p the packet, starting with the link layer header.
+   * \return true if the packet passes the filter.
+   */
+  bool Accept (Ptr<const Packet> p);
+
+  /**
+   * \return the data link type given to Open().
+   */
+  uint32_t GetDataLinkType (void) const;
+
+  /**
+   * \return the number of records captured so far.
+   */
+  uint64_t GetNCaptured (void) const;
+
+  /**
+   * \return the number of packets rejected by the filter so far.
+   */
+  uint64_t GetNFiltered (void) const;
+
+  /**
+   * \return the number of files opened so far (including reused names).
+   */
+  uint32_t GetNFiles (void) const;
+
+  /**
+   * \brief Name of the k-th file of a rotation.
+   * \param filename the base name given to Open().
+   * \param k the file index.
+   * \return "<base>-<k><extension>"
+   */
+  static std::string GetRotatedFilename (std::string filename, uint32_t k);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Parse the filter expression into m_protocol and m_ports.
+   * \param filter the expression.
+   */
+  void SetFilter (std::string filter);
+
+  /**
+   * \brief Find the transport protocol and ports of a frame.
+   * \param data the first bytes of the frame.
+   * \param size the number of bytes in data.
+   * \param [out] payload offset of the transport payload (or of the
+   *        link payload if the frame is not IP).
+   * \return true if the frame passes the filter.
+   */
+  bool Classify (const uint8_t *data, uint32_t size, uint32_t &payload) const;
+
+  /**
+   * \brief Filter a packet and append its record to the current chunk.
+   * \param t the time stamp.
+   * \param header the pseudo header, or nullptr.
+   * \param p the packet.
+   */
+  void Capture (Time t, const Header *header, Ptr<const Packet> p);
+
+  /** \brief Hand the current chunk to the writer thread. */
+  void Flush (void);
+
+  /** \brief Body of the writer thread. */
+  void Run (void);
+
+  /** A buffer of serialized records. */
+  struct Chunk
+  {
+    std::vector<uint8_t> data; //!< Records, in pcap format.
+    bool newFile;              //!< Switch to the next file before writing.
+  };
+
+  uint32_t m_payloadSnapLen;   //!< Transport payload bytes kept per record.
+  std::string m_filter;        //!< The filter expression.
+  uint64_t m_maxFileSize;      //!< Rotation threshold in bytes (0: one file).
+  uint32_t m_maxFiles;         //!< Names in the ring (0: never reused).
+  uint32_t m_bufferSize;       //!< Chunk size handed to the thread.
+  uint32_t m_maxPending;       //!< Chunks queued before Write() blocks.
+
+  uint8_t m_protocol;          //!< IP protocol to keep (0: any).
+  std::set<uint16_t> m_ports;  //!< Ports to keep (empty: any).
+
+  std::string m_filename;      //!< Base name.
+  uint32_t m_dataLinkType;     //!< Link type of the records.
+  bool m_open;                 //!< Between Open() and Close().
+  uint64_t m_fileBytes;        //!< Bytes of the current file, including queued ones.
+  Chunk m_chunk;               //!< Chunk being filled.
+  std::vector<uint8_t> m_scratch; //!< Header bytes of the current packet.
+  std::vector<uint8_t> m_prefix;  //!< Serialized pseudo header of the current packet.
+  Ptr<const Packet> m_accepted; //!< Packet accepted by Accept() and not written yet.
+  uint32_t m_peek;             //!< Bytes of the current packet in m_scratch.
+  uint32_t m_headers;          //!< Header bytes of the current packet.
+  uint64_t m_captured;         //!< Records captured.
+  uint64_t m_filtered;         //!< Packets dropped by the filter.
+
+  std::thread m_thread;        //!< The writer thread.
+  mutable std::mutex m_mutex;  //!< Protects the members below.
+  std::condition_variable m_cv; //!< Signals m_pending, m_free and m_stop changes.
+  std::deque<Chunk> m_pending; //!< Chunks waiting to be written.
+  std::vector<std::vector<uint8_t> > m_free; //!< Written chunks, for reuse.
+  bool m_stop;                 //!< Ask the thread to exit once m_pending is empty.
+  uint32_t m_files;            //!< Files opened by the thread.
+};
+
+} // namespace ns3
+
+#endif /* BUFFERED_PCAP_WRITER_H */
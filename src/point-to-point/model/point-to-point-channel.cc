@@ -22,6 +22,8 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/threaded-simulator-impl.h"
 
 namespace ns3 {
 
@@ -57,7 +59,8 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
-    m_nDevices (0)
+    m_nDevices (0),
+    m_crossing (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -80,6 +83,19 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      Ptr<Node> a = m_link[0].m_src->GetNode ();
+      Ptr<Node> b = m_link[1].m_src->GetNode ();
+      m_crossing = a && b && a->GetSystemId () != b->GetSystemId ();
+      if (m_crossing)
+        {
+          m_link[0].m_dstNode = b->GetId ();
+          m_link[1].m_dstNode = a->GetId ();
+        }
+      if (m_crossing && m_delay.IsStrictlyPositive ())
+        {
+          // the delay is the lookahead between the two partitions
+          ThreadedSimulatorImpl::BoundLookAhead (m_delay);
+        }
     }
 }
 
@@ -97,9 +113,21 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
-                                  txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p->Copy ());
+  if (m_crossing)
+    {
+      // the receiver may run on another thread: neither the packet nor
+      // the reference count of the device can be shared with it, so it
+      // gets a copy owning its own buffer and tags, and a raw pointer
+      Simulator::ScheduleWithContext (m_link[wire].m_dstNode,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      PeekPointer (m_link[wire].m_dst), p->DeepCopy ());
+    }
+  else
+    {
+      Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      m_link[wire].m_dst, p->Copy ());
+    }
 
   // Call the tx anim callback on the net device
   m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
@@ -194,14 +194,21 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstNode (0) {}
 
-    WireState                  m_state; //!< State of the link
-    Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
-    Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    WireState                  m_state;   //!< State of the link
+    Ptr<PointToPointNetDevice> m_src;     //!< First NetDevice
+    Ptr<PointToPointNetDevice> m_dst;     //!< Second NetDevice
+    uint32_t                   m_dstNode; //!< Node id of the second NetDevice, if m_crossing
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
+  /**
+   * The devices are in two partitions of a ThreadedSimulatorImpl, so the
+   * receptions run on another thread than the transmissions and are
+   * handed a Packet::DeepCopy() of the packet.
+   */
+  bool    m_crossing;
 };
 
 } // namespace ns3
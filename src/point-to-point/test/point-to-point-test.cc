@@ -24,8 +24,15 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/threaded-simulator-impl.h"
+#include "ns3/application.h"
+#include "ns3/data-rate.h"
+#include "ns3/uinteger.h"
 
+#include <atomic>
+#include <functional>
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -130,6 +137,223 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Application running a function when it starts
+ */
+class PointToPointStartApplication : public Application
+{
+public:
+  /**
+   * \brief Create the application
+   *
+   * \param start Function to run when the application starts.
+   */
+  PointToPointStartApplication (std::function<void ()> start);
+
+private:
+  void StartApplication (void) override;
+
+  std::function<void ()> m_start; //!< Run when the application starts
+};
+
+PointToPointStartApplication::PointToPointStartApplication (std::function<void ()> start)
+  : m_start (start)
+{
+}
+
+void
+PointToPointStartApplication::StartApplication (void)
+{
+  m_start ();
+}
+
+/**
+ * \brief Test class for PointToPoint model under ThreadedSimulatorImpl
+ *
+ * Two nodes of different system ids exchange packets over a
+ * PointToPointChannel, which makes them run on two threads; the
+ * receptions must be those of the default simulator.  The first node
+ * sends from events scheduled with its context, the second one from an
+ * Application, whose events must run in the partition of the node as
+ * well.
+ */
+class PointToPointThreadedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointThreadedTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /// A received packet.
+  struct Reception
+  {
+    int64_t time;      //!< Reception time, in time steps.
+    uint32_t size;     //!< Packet size.
+    uint8_t first;     //!< First payload byte.
+  };
+
+  /**
+   * \brief Send packets of increasing sizes, one per millisecond
+   *
+   * \param device NetDevice to send from.
+   * \param fill Payload byte.
+   * \param n Number of packets left to send.
+   */
+  void SendPackets (Ptr<PointToPointNetDevice> device, uint8_t fill, uint32_t n);
+  /**
+   * \brief Callback function which records the received packets
+   *
+   * \param dev The receiving device.
+   * \param pkt The received packet.
+   * \param mode The protocol mode used.
+   * \param sender The sender address.
+   *
+   * \return A boolean indicating packet handled properly.
+   */
+  bool RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
+  /**
+   * \brief Run the exchange
+   *
+   * \param threaded Whether to use ThreadedSimulatorImpl.
+   * \return The receptions of both devices.
+   */
+  std::vector<Reception> RunExchange (bool threaded);
+  /**
+   * \brief Check that the running event is in the partition of its node
+   */
+  void CheckPartition (void);
+
+  Ptr<NetDevice> m_devB;             //!< The device of the second node
+  std::vector<Reception> m_rxA;      //!< Receptions of the first node
+  std::vector<Reception> m_rxB;      //!< Receptions of the second node
+  bool m_threaded;                   //!< Whether ThreadedSimulatorImpl runs
+  std::atomic<uint32_t> m_misplaced; //!< Events run outside of the partition of their node
+};
+
+PointToPointThreadedTest::PointToPointThreadedTest ()
+  : TestCase ("PointToPoint between two partitions of ThreadedSimulatorImpl")
+{
+}
+
+void
+PointToPointThreadedTest::CheckPartition (void)
+{
+  if (m_threaded
+      && ThreadedSimulatorImpl::GetCurrentPartition ()
+      != ThreadedSimulatorImpl::GetPartition (Simulator::GetContext ()))
+    {
+      m_misplaced++;
+    }
+}
+
+void
+PointToPointThreadedTest::SendPackets (Ptr<PointToPointNetDevice> device, uint8_t fill, uint32_t n)
+{
+  CheckPartition ();
+  std::vector<uint8_t> payload (100 + n, fill);
+  device->Send (Create<Packet> (payload.data (), payload.size ()), device->GetBroadcast (), 0x800);
+  if (n > 1)
+    {
+      Simulator::Schedule (MilliSeconds (1), &PointToPointThreadedTest::SendPackets,
+                           this, device, fill, n - 1);
+    }
+}
+
+bool
+PointToPointThreadedTest::RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
+{
+  CheckPartition ();
+  Reception rx;
+  rx.time = Simulator::Now ().GetTimeStep ();
+  rx.size = pkt->GetSize ();
+  pkt->CopyData (&rx.first, 1);
+  // each partition only touches its own vector
+  (dev == m_devB ? m_rxB : m_rxA).push_back (rx);
+  return true;
+}
+
+std::vector<PointToPointThreadedTest::Reception>
+PointToPointThreadedTest::RunExchange (bool threaded)
+{
+  if (threaded)
+    {
+      Ptr<ThreadedSimulatorImpl> impl = CreateObject<ThreadedSimulatorImpl> ();
+      impl->SetAttribute ("MaxThreads", UintegerValue (2));
+      Simulator::SetImplementation (impl);
+    }
+  m_rxA.clear ();
+  m_rxB.clear ();
+  m_threaded = threaded;
+  m_misplaced = 0;
+  Ptr<Node> a = CreateObject<Node> (0);
+  Ptr<Node> b = CreateObject<Node> (1);
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devA->SetDataRate (DataRate ("10Mbps"));
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->SetDataRate (DataRate ("10Mbps"));
+  devA->Attach (channel);
+  devB->Attach (channel);
+  m_devB = devB;
+
+  devA->SetReceiveCallback (MakeCallback (&PointToPointThreadedTest::RxPacket, this));
+  devB->SetReceiveCallback (MakeCallback (&PointToPointThreadedTest::RxPacket, this));
+
+  // the sends run in the context of their node, hence in its partition:
+  // explicitly for the first node, through Node::Initialize and
+  // Application::StartApplication for the second one
+  Simulator::ScheduleWithContext (a->GetId (), Seconds (1), &PointToPointThreadedTest::SendPackets,
+                                  this, devA, 0xaa, 50);
+  Ptr<Application> app = CreateObject<PointToPointStartApplication> ([this, devB] ()
+    {
+      SendPackets (devB, 0xbb, 50);
+    });
+  app->SetStartTime (Seconds (1));
+  b->AddApplication (app);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_devB = 0;
+
+  std::vector<Reception> receptions = m_rxA;
+  receptions.insert (receptions.end (), m_rxB.begin (), m_rxB.end ());
+  return receptions;
+}
+
+void
+PointToPointThreadedTest::DoRun (void)
+{
+  std::vector<Reception> expected = RunExchange (false);
+  NS_TEST_ASSERT_MSG_EQ (expected.size (), 100, "every packet received");
+  Time lookAhead = ThreadedSimulatorImpl::GetLookAhead ();
+
+  std::vector<Reception> actual = RunExchange (true);
+  NS_TEST_EXPECT_MSG_EQ (m_misplaced.load (), 0, "events run outside of the partition of their node");
+  NS_TEST_ASSERT_MSG_EQ (actual.size (), expected.size (), "same number of packets");
+  for (std::size_t i = 0; i < expected.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (actual[i].time, expected[i].time, "reception time " << i);
+      NS_TEST_EXPECT_MSG_EQ (actual[i].size, expected[i].size, "packet size " << i);
+      NS_TEST_EXPECT_MSG_EQ (+actual[i].first, +expected[i].first, "payload " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (lookAhead, MilliSeconds (2), "channel delay as lookahead");
+  NS_TEST_EXPECT_MSG_EQ (+expected.front ().first, 0xbb, "first node receives from the second");
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -146,6 +370,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointThreadedTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
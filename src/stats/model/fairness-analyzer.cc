@@ -0,0 +1,284 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "ns3/fairness-analyzer.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FairnessAnalyzer");
+
+NS_OBJECT_ENSURE_REGISTERED (FairnessAnalyzer);
+
+TypeId
+FairnessAnalyzer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FairnessAnalyzer")
+    .SetParent<Object> ()
+    .SetGroupName ("Stats")
+    .AddConstructor<FairnessAnalyzer> ()
+    .AddAttribute ("Interval",
+                   "Sampling period, the window slides by this amount.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&FairnessAnalyzer::m_interval),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("Window",
+                   "Per flow throughput averaging window, rounded up to a multiple of Interval.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&FairnessAnalyzer::m_window),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("Capacity",
+                   "Capacity of the shared link in bit/s, for the utilization "
+                   "(0: utilization not computed).",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&FairnessAnalyzer::m_capacity),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("ConvergenceThreshold",
+                   "Largest change of the Jain's index between two samples "
+                   "that counts as stable.",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&FairnessAnalyzer::m_threshold),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("ConvergenceSamples",
+                   "Consecutive stable samples needed to declare convergence.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&FairnessAnalyzer::m_convergenceSamples),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("StopOnConvergence",
+                   "Stop the simulation once the Jain's index has converged.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FairnessAnalyzer::m_stopOnConvergence),
+                   MakeBooleanChecker ())
+    .AddAttribute ("OutputFile",
+                   "Write the time series to this csv file (empty: no file).",
+                   StringValue (""),
+                   MakeStringAccessor (&FairnessAnalyzer::m_outputFile),
+                   MakeStringChecker ())
+    .AddTraceSource ("Sample",
+                     "A new sample of the fairness time series.",
+                     MakeTraceSourceAccessor (&FairnessAnalyzer::m_sampleTrace),
+                     "ns3::FairnessAnalyzer::SampleTracedCallback")
+    .AddTraceSource ("Converged",
+                     "The Jain's index has converged.",
+                     MakeTraceSourceAccessor (&FairnessAnalyzer::m_convergedTrace),
+                     "ns3::Time::TracedCallback")
+  ;
+  return tid;
+}
+
+FairnessAnalyzer::FairnessAnalyzer ()
+  : m_nBins (0),
+    m_bin (0),
+    m_stableSamples (0),
+    m_converged (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FairnessAnalyzer::~FairnessAnalyzer ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FairnessAnalyzer::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Stop ();
+  m_flowIndex.clear ();
+  m_flows.clear ();
+  Object::DoDispose ();
+}
+
+void
+FairnessAnalyzer::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (!m_flows.empty () && m_nBins != GetNBins (),
+                   "Window and Interval cannot change once flows are recorded");
+  m_nBins = GetNBins ();
+
+  if (!m_outputFile.empty () && !m_output.is_open ())
+    {
+      m_output.open (m_outputFile);
+      NS_ABORT_MSG_UNLESS (m_output.is_open (), "cannot open " << m_outputFile);
+      m_output << "Time(s),Flows,JainIndex,MaxMinRatio,Throughput(bps),Utilization\n";
+    }
+  m_sampleEvent.Cancel ();
+  m_sampleEvent = Simulator::Schedule (m_interval, &FairnessAnalyzer::Sample, this);
+}
+
+void
+FairnessAnalyzer::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_sampleEvent.Cancel ();
+  if (m_output.is_open ())
+    {
+      m_output.close ();
+    }
+}
+
+void
+FairnessAnalyzer::NotifyRx (uint64_t flow, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << flow << bytes);
+  auto it = m_flowIndex.find (flow);
+  if (it == m_flowIndex.end ())
+    {
+      if (m_nBins == 0)
+        {
+          m_nBins = GetNBins ();
+        }
+      it = m_flowIndex.emplace (flow, m_flows.size ()).first;
+      m_flows.push_back ({std::vector<uint64_t> (m_nBins, 0), 0});
+    }
+  Flow &f = m_flows[it->second];
+  f.bins[m_bin] += bytes;
+  f.windowBytes += bytes;
+}
+
+std::size_t
+FairnessAnalyzer::GetNBins (void) const
+{
+  return static_cast<std::size_t> (std::max (1.0, std::ceil (m_window.GetSeconds ()
+                                                             / m_interval.GetSeconds ())));
+}
+
+const std::vector<FairnessSample> &
+FairnessAnalyzer::GetSamples (void) const
+{
+  return m_samples;
+}
+
+bool
+FairnessAnalyzer::HasConverged (void) const
+{
+  return m_converged;
+}
+
+double
+FairnessAnalyzer::JainIndex (const std::vector<double> &values)
+{
+  double sum = 0;
+  double squares = 0;
+  for (double v : values)
+    {
+      sum += v;
+      squares += v * v;
+    }
+  if (squares == 0)
+    {
+      return 1;
+    }
+  return sum * sum / (values.size () * squares);
+}
+
+void
+FairnessAnalyzer::Sample (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the bins cover Window rounded up to a multiple of Interval, and a
+  // window that is not full yet only covers the time elapsed so far
+  const double window = m_interval.GetSeconds () * std::min (m_nBins, m_samples.size () + 1);
+
+  m_throughputs.clear ();
+  double total = 0;
+  double max = 0;
+  double min = std::numeric_limits<double>::infinity ();
+  for (const Flow &f : m_flows)
+    {
+      const double bps = f.windowBytes * 8 / window;
+      m_throughputs.push_back (bps);
+      total += bps;
+      max = std::max (max, bps);
+      min = std::min (min, bps);
+    }
+
+  FairnessSample sample;
+  sample.time = Simulator::Now ();
+  sample.flows = m_flows.size ();
+  sample.jainIndex = JainIndex (m_throughputs);
+  sample.throughput = total;
+  if (m_flows.empty ())
+    {
+      sample.maxMinRatio = 1;
+    }
+  else if (min == 0)
+    {
+      sample.maxMinRatio = max == 0 ? 1 : std::numeric_limits<double>::infinity ();
+    }
+  else
+    {
+      sample.maxMinRatio = max / min;
+    }
+  sample.utilization = m_capacity > 0 ? total / m_capacity
+    : std::numeric_limits<double>::quiet_NaN ();
+
+  if (!m_samples.empty () && !m_flows.empty ()
+      && std::abs (sample.jainIndex - m_samples.back ().jainIndex) <= m_threshold)
+    {
+      ++m_stableSamples;
+    }
+  else
+    {
+      m_stableSamples = 0;
+    }
+  m_samples.push_back (sample);
+  m_sampleTrace (sample);
+
+  if (m_output.is_open ())
+    {
+      m_output << sample.time.GetSeconds () << ',' << sample.flows << ','
+               << sample.jainIndex << ',' << sample.maxMinRatio << ','
+               << sample.throughput << ',' << sample.utilization << '\n';
+    }
+
+  // slide the window: the oldest bin becomes the current one
+  m_bin = (m_bin + 1) % m_nBins;
+  for (Flow &f : m_flows)
+    {
+      f.windowBytes -= f.bins[m_bin];
+      f.bins[m_bin] = 0;
+    }
+
+  m_sampleEvent = Simulator::Schedule (m_interval, &FairnessAnalyzer::Sample, this);
+
+  if (!m_converged && m_stableSamples >= m_convergenceSamples)
+    {
+      NS_LOG_INFO ("fairness converged at " << sample.time.As (Time::S)
+                   << ", Jain's index " << sample.jainIndex);
+      m_converged = true;
+      m_convergedTrace (sample.time);
+      if (m_stopOnConvergence)
+        {
+          Stop ();
+          Simulator::Stop ();
+        }
+    }
+}
+
+} // namespace ns3
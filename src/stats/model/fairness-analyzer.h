@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FAIRNESS_ANALYZER_H
+#define FAIRNESS_ANALYZER_H
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/traced-callback.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ *
+ * \brief One sample of the fairness time series.
+ */
+struct FairnessSample
+{
+  Time time;            //!< When the sample was taken.
+  uint32_t flows;       //!< Number of flows seen so far.
+  double jainIndex;     //!< Jain's fairness index of the flow throughputs.
+  double maxMinRatio;   //!< Largest over smallest throughput (inf if a flow starves).
+  double throughput;    //!< Aggregate throughput over the window, in bit/s.
+  double utilization;   //!< throughput / Capacity, or NaN without a capacity.
+};
+
+/**
+ * \ingroup stats
+ *
+ * \brief Online fairness and utilization of the flows that reach a
+ * receiver.
+ *
+ * The analyzer is fed with received bytes per flow (NotifyRx) and keeps,
+ * for every flow, the bytes received during the last Window.  The window
+ * slides by Interval: every Interval a sample of the throughputs over the
+ * window is taken, and the Jain's index, the max/min ratio and the link
+ * utilization are emitted through the "Sample" trace source and, if
+ * OutputFile is set, appended to a csv time series.
+ *
+ * A flow that has been seen once keeps counting with its (possibly
+ * zero) throughput afterwards, so starving flows lower the index.
+ *
+ * The fairness is considered converged when the Jain's index changes by
+ * less than ConvergenceThreshold over ConvergenceSamples consecutive
+ * samples.  With StopOnConvergence the simulation is stopped at that
+ * point.
+ *
+ * The window is kept as Window / Interval bins per flow, so Window
+ * should be a multiple of Interval.
+ */
+class FairnessAnalyzer : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  FairnessAnalyzer ();
+  virtual ~FairnessAnalyzer ();
+
+  /**
+   * \brief Start sampling, first sample one Interval from now.
+   */
+  void Start (void);
+
+  /**
+   * \brief Stop sampling.
+   */
+  void Stop (void);
+
+  /**
+   * \brief Account received bytes to a flow.
+   * \param flow the flow identifier (e.g. the source node or address).
+   * \param bytes the number of bytes received.
+   */
+  void NotifyRx (uint64_t flow, uint32_t bytes);
+
+  /**
+   * \return the samples taken so far.
+   */
+  const std::vector<FairnessSample> &GetSamples (void) const;
+
+  /**
+   * \return true if the Jain's index has converged.
+   */
+  bool HasConverged (void) const;
+
+  /**
+   * \brief Jain's fairness index of a set of values.
+   * \param values the throughputs.
+   * \return the index in [1/n, 1], 1 for an empty or all-zero set.
+   */
+  static double JainIndex (const std::vector<double> &values);
+
+  /**
+   * TracedCallback signature for a fairness sample.
+   *
+   * \param [in] sample The new sample.
+   */
+  typedef void (* SampleTracedCallback)(const FairnessSample &sample);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /** Take a sample and slide the window by one bin. */
+  void Sample (void);
+
+  /** \return the number of bins covering Window. */
+  std::size_t GetNBins (void) const;
+
+  /** Bins of one flow, indexed by m_bin. */
+  struct Flow
+  {
+    std::vector<uint64_t> bins;  //!< Bytes received per Interval.
+    uint64_t windowBytes;        //!< Sum of the bins.
+  };
+
+  Time m_interval;               //!< Sampling period.
+  Time m_window;                 //!< Throughput averaging window.
+  double m_capacity;             //!< Link capacity in bit/s (0: unknown).
+  double m_threshold;            //!< Convergence threshold on the index.
+  uint32_t m_convergenceSamples; //!< Stable samples needed to converge.
+  bool m_stopOnConvergence;      //!< Stop the simulator once converged.
+  std::string m_outputFile;      //!< csv time series (empty: none).
+
+  std::size_t m_nBins;           //!< Bins per flow.
+  std::size_t m_bin;             //!< Bin receiving the bytes now.
+  std::unordered_map<uint64_t, std::size_t> m_flowIndex; //!< Flow id to m_flows.
+  std::vector<Flow> m_flows;     //!< Flows, in order of appearance.
+  std::vector<double> m_throughputs; //!< Scratch space of Sample().
+
+  std::vector<FairnessSample> m_samples; //!< The time series.
+  uint32_t m_stableSamples;      //!< Consecutive samples within threshold.
+  bool m_converged;              //!< Convergence reached.
+  EventId m_sampleEvent;         //!< Next sample.
+  std::ofstream m_output;        //!< Opened on Start().
+
+  TracedCallback<const FairnessSample &> m_sampleTrace; //!< New sample.
+  TracedCallback<Time> m_convergedTrace;  //!< Convergence reached.
+};
+
+} // namespace ns3
+
+#endif /* FAIRNESS_ANALYZER_H */
@@ -0,0 +1,239 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+
+#include "ns3/test.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/fairness-analyzer.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief FairnessAnalyzer - Test case for the Jain's index.
+ */
+class FairnessAnalyzerJainTestCase : public TestCase
+{
+public:
+  FairnessAnalyzerJainTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FairnessAnalyzerJainTestCase::FairnessAnalyzerJainTestCase ()
+  : TestCase ("Jain's fairness index")
+{
+}
+
+void
+FairnessAnalyzerJainTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ_TOL (FairnessAnalyzer::JainIndex ({}), 1, 1e-12, "empty set");
+  NS_TEST_ASSERT_MSG_EQ_TOL (FairnessAnalyzer::JainIndex ({0, 0}), 1, 1e-12, "all zero");
+  NS_TEST_ASSERT_MSG_EQ_TOL (FairnessAnalyzer::JainIndex ({5, 5, 5, 5}), 1, 1e-12, "equal shares");
+  NS_TEST_ASSERT_MSG_EQ_TOL (FairnessAnalyzer::JainIndex ({1, 3}), 0.8, 1e-12, "1:3 shares");
+  NS_TEST_ASSERT_MSG_EQ_TOL (FairnessAnalyzer::JainIndex ({1, 0, 0, 0}), 0.25, 1e-12,
+                             "one flow takes everything");
+}
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief FairnessAnalyzer - Test case for the sliding window.
+ */
+class FairnessAnalyzerWindowTestCase : public TestCase
+{
+public:
+  FairnessAnalyzerWindowTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FairnessAnalyzerWindowTestCase::FairnessAnalyzerWindowTestCase ()
+  : TestCase ("Sliding window throughput, fairness and utilization")
+{
+}
+
+void
+FairnessAnalyzerWindowTestCase::DoRun (void)
+{
+  Ptr<FairnessAnalyzer> analyzer = CreateObject<FairnessAnalyzer> ();
+  analyzer->SetAttribute ("Interval", TimeValue (MilliSeconds (100)));
+  analyzer->SetAttribute ("Window", TimeValue (MilliSeconds (200)));
+  analyzer->SetAttribute ("Capacity", DoubleValue (320000));
+  analyzer->Start ();
+
+  // both flows in the first interval, then flow 1 only
+  Simulator::Schedule (MilliSeconds (50), &FairnessAnalyzer::NotifyRx, analyzer, 1, 1000);
+  Simulator::Schedule (MilliSeconds (50), &FairnessAnalyzer::NotifyRx, analyzer, 2, 1000);
+  Simulator::Schedule (MilliSeconds (150), &FairnessAnalyzer::NotifyRx, analyzer, 1, 1000);
+  Simulator::Schedule (MilliSeconds (250), &FairnessAnalyzer::NotifyRx, analyzer, 1, 1000);
+  Simulator::Stop (MilliSeconds (350));
+  Simulator::Run ();
+
+  const std::vector<FairnessSample> &samples = analyzer->GetSamples ();
+  NS_TEST_ASSERT_MSG_EQ (samples.size (), 3, "one sample per interval");
+
+  // 0.1 s: 1000 bytes each over 0.1 s
+  NS_TEST_ASSERT_MSG_EQ (samples[0].flows, 2, "two flows");
+  NS_TEST_ASSERT_MSG_EQ_TOL (samples[0].jainIndex, 1, 1e-12, "equal shares");
+  NS_TEST_ASSERT_MSG_EQ_TOL (samples[0].maxMinRatio, 1, 1e-12, "equal shares");
+  NS_TEST_ASSERT_MSG_EQ_TOL (samples[0].throughput, 160000, 1e-6, "aggregate throughput");
+  NS_TEST_ASSERT_MSG_EQ_TOL (samples[0].utilization, 0.5, 1e-12, "utilization");
+
+  // 0.2 s: 2000 and 1000 bytes over 0.2 s
+  NS_TEST_ASSERT_MSG_EQ_TOL (samples[1].jainIndex, 0.9, 1e-12, "2:1 shares");
+  NS_TEST_ASSERT_MSG_EQ_TOL (samples[1].maxMinRatio, 2, 1e-12, "2:1 shares");
+  NS_TEST_ASSERT_MSG_EQ_TOL (samples[1].throughput, 120000, 1e-6, "aggregate throughput");
+
+  // 0.3 s: the first interval left the window, flow 2 starves
+  NS_TEST_ASSERT_MSG_EQ_TOL (samples[2].jainIndex, 0.5, 1e-12, "flow 2 starves");
+  NS_TEST_ASSERT_MSG_EQ (std::isinf (samples[2].maxMinRatio), true, "flow 2 starves");
+  NS_TEST_ASSERT_MSG_EQ_TOL (samples[2].throughput, 80000, 1e-6, "aggregate throughput");
+
+  NS_TEST_ASSERT_MSG_EQ (analyzer->HasConverged (), false, "index still moving");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief FairnessAnalyzer - Test case for a window which is not a
+ * multiple of the interval.
+ */
+class FairnessAnalyzerRoundedWindowTestCase : public TestCase
+{
+public:
+  FairnessAnalyzerRoundedWindowTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FairnessAnalyzerRoundedWindowTestCase::FairnessAnalyzerRoundedWindowTestCase ()
+  : TestCase ("Window rounded up to a multiple of the interval")
+{
+}
+
+void
+FairnessAnalyzerRoundedWindowTestCase::DoRun (void)
+{
+  Ptr<FairnessAnalyzer> analyzer = CreateObject<FairnessAnalyzer> ();
+  analyzer->SetAttribute ("Interval", TimeValue (MilliSeconds (100)));
+  analyzer->SetAttribute ("Window", TimeValue (MilliSeconds (250)));
+  analyzer->Start ();
+
+  // a constant rate of 1000 bytes per interval
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      Simulator::Schedule (MilliSeconds (50 + 100 * i), &FairnessAnalyzer::NotifyRx, analyzer, 1, 1000);
+    }
+  Simulator::Stop (MilliSeconds (450));
+  Simulator::Run ();
+
+  // the window covers three intervals, the rate must not depend on the
+  // samples of a full window
+  const std::vector<FairnessSample> &samples = analyzer->GetSamples ();
+  NS_TEST_ASSERT_MSG_EQ (samples.size (), 4, "one sample per interval");
+  for (const FairnessSample &sample : samples)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (sample.throughput, 80000, 1e-6,
+                                 "constant throughput at " << sample.time.As (Time::S));
+    }
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief FairnessAnalyzer - Test case for the early stop on convergence.
+ */
+class FairnessAnalyzerConvergenceTestCase : public TestCase
+{
+public:
+  FairnessAnalyzerConvergenceTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Deliver one packet per flow and reschedule.
+   * \param analyzer the analyzer under test
+   */
+  void Deliver (Ptr<FairnessAnalyzer> analyzer);
+};
+
+FairnessAnalyzerConvergenceTestCase::FairnessAnalyzerConvergenceTestCase ()
+  : TestCase ("Stop the simulation once the fairness converged")
+{
+}
+
+void
+FairnessAnalyzerConvergenceTestCase::Deliver (Ptr<FairnessAnalyzer> analyzer)
+{
+  analyzer->NotifyRx (1, 500);
+  analyzer->NotifyRx (2, 500);
+  Simulator::Schedule (MilliSeconds (10), &FairnessAnalyzerConvergenceTestCase::Deliver, this, analyzer);
+}
+
+void
+FairnessAnalyzerConvergenceTestCase::DoRun (void)
+{
+  Ptr<FairnessAnalyzer> analyzer = CreateObject<FairnessAnalyzer> ();
+  analyzer->SetAttribute ("ConvergenceSamples", UintegerValue (3));
+  analyzer->SetAttribute ("StopOnConvergence", BooleanValue (true));
+  analyzer->Start ();
+
+  Simulator::Schedule (MilliSeconds (5), &FairnessAnalyzerConvergenceTestCase::Deliver, this, analyzer);
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (analyzer->HasConverged (), true, "equal flows converge");
+  // first sample at 0.1 s, then three stable ones
+  NS_TEST_ASSERT_MSG_EQ (analyzer->GetSamples ().size (), 4, "stopped after convergence");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), MilliSeconds (400), "stopped early");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup stats-tests
+ *
+ * \brief FairnessAnalyzer TestSuite
+ */
+class FairnessAnalyzerTestSuite : public TestSuite
+{
+public:
+  FairnessAnalyzerTestSuite ();
+};
+
+FairnessAnalyzerTestSuite::FairnessAnalyzerTestSuite ()
+  : TestSuite ("fairness-analyzer", UNIT)
+{
+  AddTestCase (new FairnessAnalyzerJainTestCase, TestCase::QUICK);
+  AddTestCase (new FairnessAnalyzerWindowTestCase, TestCase::QUICK);
+  AddTestCase (new FairnessAnalyzerRoundedWindowTestCase, TestCase::QUICK);
+  AddTestCase (new FairnessAnalyzerConvergenceTestCase, TestCase::QUICK);
+}
+
+/// Static variable for test initialization
+static FairnessAnalyzerTestSuite fairnessAnalyzerTestSuite;
@@ -38,6 +38,7 @@
 #include "ns3/he-configuration.h"
 #include "ns3/obss-pd-algorithm.h"
 #include "ns3/wifi-mac-trailer.h"
+#include "ns3/buffered-pcap-writer.h"
 #include "wifi-helper.h"
 
 namespace ns3 {
@@ -231,6 +232,91 @@ WifiPhyHelper::PcapSniffRxEvent (
     }
 }
 
+/**
+ * \param packet the frame given to a monitor sniffer trace
+ * \param txVector the TXVECTOR of the frame
+ * \return the MPDU, without the A-MPDU subframe header and padding of an
+ *         aggregated frame, sharing the buffer of the given frame
+ */
+static Ptr<const Packet>
+GetSniffedMpdu (Ptr<const Packet> packet, const WifiTxVector &txVector)
+{
+  if (!txVector.IsAggregation ())
+    {
+      return packet;
+    }
+  AmpduSubframeHeader hdr;
+  packet->PeekHeader (hdr);
+  return packet->CreateFragment (hdr.GetSerializedSize (), hdr.GetLength ());
+}
+
+void
+WifiPhyHelper::BufferedPcapSniffTxEvent (
+  Ptr<BufferedPcapWriter> writer,
+  Ptr<const Packet>       packet,
+  uint16_t                channelFreqMhz,
+  WifiTxVector            txVector,
+  MpduInfo                aMpdu,
+  uint16_t                staId)
+{
+  uint32_t dlt = writer->GetDataLinkType ();
+  switch (dlt)
+    {
+    case PcapHelper::DLT_IEEE802_11:
+      writer->Write (Simulator::Now (), packet);
+      return;
+    case PcapHelper::DLT_IEEE802_11_RADIO:
+      {
+        // the radiotap header is built for the frames kept by the filter
+        // only; it strips the A-MPDU subframe header of its own copy
+        Ptr<const Packet> mpdu = GetSniffedMpdu (packet, txVector);
+        if (!writer->Accept (mpdu))
+          {
+            return;
+          }
+        RadiotapHeader header;
+        GetRadiotapHeader (header, packet->Copy (), channelFreqMhz, txVector, aMpdu, staId);
+        writer->Write (Simulator::Now (), header, mpdu);
+        return;
+      }
+    default:
+      NS_ABORT_MSG ("BufferedPcapSniffTxEvent(): Unexpected data link type " << dlt);
+    }
+}
+
+void
+WifiPhyHelper::BufferedPcapSniffRxEvent (
+  Ptr<BufferedPcapWriter> writer,
+  Ptr<const Packet>       packet,
+  uint16_t                channelFreqMhz,
+  WifiTxVector            txVector,
+  MpduInfo                aMpdu,
+  SignalNoiseDbm          signalNoise,
+  uint16_t                staId)
+{
+  uint32_t dlt = writer->GetDataLinkType ();
+  switch (dlt)
+    {
+    case PcapHelper::DLT_IEEE802_11:
+      writer->Write (Simulator::Now (), packet);
+      return;
+    case PcapHelper::DLT_IEEE802_11_RADIO:
+      {
+        Ptr<const Packet> mpdu = GetSniffedMpdu (packet, txVector);
+        if (!writer->Accept (mpdu))
+          {
+            return;
+          }
+        RadiotapHeader header;
+        GetRadiotapHeader (header, packet->Copy (), channelFreqMhz, txVector, aMpdu, staId, signalNoise);
+        writer->Write (Simulator::Now (), header, mpdu);
+        return;
+      }
+    default:
+      NS_ABORT_MSG ("BufferedPcapSniffRxEvent(): Unexpected data link type " << dlt);
+    }
+}
+
 void
 WifiPhyHelper::GetRadiotapHeader (
   RadiotapHeader       &header,
@@ -569,6 +655,17 @@ WifiPhyHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool p
       filename = pcapHelper.GetFilenameFromDevice (prefix, device);
     }
 
+  if (m_bufferedPcap.IsTypeIdSet ())
+    {
+      NS_ABORT_MSG_IF (m_pcapDlt == PcapHelper::DLT_PRISM_HEADER,
+                       "WifiPhyHelper::EnablePcapInternal(): DLT_PRISM_HEADER not implemented");
+      Ptr<BufferedPcapWriter> writer = m_bufferedPcap.Create<BufferedPcapWriter> ();
+      writer->Open (filename, m_pcapDlt);
+      phy->TraceConnectWithoutContext ("MonitorSnifferTx", MakeBoundCallback (&WifiPhyHelper::BufferedPcapSniffTxEvent, writer));
+      phy->TraceConnectWithoutContext ("MonitorSnifferRx", MakeBoundCallback (&WifiPhyHelper::BufferedPcapSniffRxEvent, writer));
+      return;
+    }
+
   Ptr<PcapFileWrapper> file = pcapHelper.CreateFile (filename, std::ios::out, m_pcapDlt);
 
   phy->TraceConnectWithoutContext ("MonitorSnifferTx", MakeBoundCallback (&WifiPhyHelper::PcapSniffTxEvent, file));
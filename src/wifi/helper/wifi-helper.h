@@ -36,6 +36,7 @@ class WifiNetDevice;
 class Node;
 class RadiotapHeader;
 class QueueItem;
+class BufferedPcapWriter;
 
 /**
  * \brief create PHY objects
@@ -146,6 +147,19 @@ public:
    */
   PcapHelper::DataLinkType GetPcapDataLinkType (void) const;
 
+  /**
+   * Capture the pcap traces enabled afterwards through a
+   * BufferedPcapWriter instead of a PcapFileWrapper: packets are filtered
+   * and truncated before they are serialized, and written by a background
+   * thread into size-bounded, rotating files.
+   *
+   * \tparam Args \deduced Template type parameter pack for the sequence of name-value pairs.
+   * \param args A sequence of name-value pairs of the BufferedPcapWriter
+   *        attributes to set (e.g. "Filter", "PayloadSnapLen", "MaxFileSize").
+   */
+  template <typename... Args>
+  void SetBufferedPcap (Args&&... args);
+
 
 protected:
   /**
@@ -182,6 +196,40 @@ protected:
                                 MpduInfo aMpdu,
                                 SignalNoiseDbm signalNoise,
                                 uint16_t staId = SU_STA_ID);
+  /**
+   * \param writer the buffered pcap writer
+   * \param packet the packet
+   * \param channelFreqMhz the channel frequency
+   * \param txVector the TXVECTOR
+   * \param aMpdu the A-MPDU information
+   * \param staId the STA-ID (only used for MU)
+   *
+   * Handle TX pcap through a BufferedPcapWriter.
+   */
+  static void BufferedPcapSniffTxEvent (Ptr<BufferedPcapWriter> writer,
+                                        Ptr<const Packet> packet,
+                                        uint16_t channelFreqMhz,
+                                        WifiTxVector txVector,
+                                        MpduInfo aMpdu,
+                                        uint16_t staId = SU_STA_ID);
+  /**
+   * \param writer the buffered pcap writer
+   * \param packet the packet
+   * \param channelFreqMhz the channel frequency
+   * \param txVector the TXVECTOR
+   * \param aMpdu the A-MPDU information
+   * \param signalNoise the RX signal and noise information
+   * \param staId the STA-ID (only used for MU)
+   *
+   * Handle RX pcap through a BufferedPcapWriter.
+   */
+  static void BufferedPcapSniffRxEvent (Ptr<BufferedPcapWriter> writer,
+                                        Ptr<const Packet> packet,
+                                        uint16_t channelFreqMhz,
+                                        WifiTxVector txVector,
+                                        MpduInfo aMpdu,
+                                        SignalNoiseDbm signalNoise,
+                                        uint16_t staId = SU_STA_ID);
 
   ObjectFactory m_phy; ///< PHY object
   ObjectFactory m_interferenceHelper; ///< interference helper
@@ -260,6 +308,7 @@ private:
                                     bool explicitFilename) override;
 
   PcapHelper::DataLinkType m_pcapDlt; ///< PCAP data link type
+  ObjectFactory m_bufferedPcap;       ///< buffered pcap writer (unset: PcapFileWrapper)
 };
 
 
@@ -459,6 +508,14 @@ WifiPhyHelper::SetPreambleDetectionModel (std::string type, Args&&... args)
   m_preambleDetectionModel.Set (args...);
 }
 
+template <typename... Args>
+void
+WifiPhyHelper::SetBufferedPcap (Args&&... args)
+{
+  m_bufferedPcap.SetTypeId ("ns3::BufferedPcapWriter");
+  m_bufferedPcap.Set (args...);
+}
+
 template <typename... Args>
 void
 WifiHelper::SetRemoteStationManager (std::string type, Args&&... args)
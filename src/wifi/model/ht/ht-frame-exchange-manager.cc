@@ -911,6 +911,14 @@ HtFrameExchangeManager::ForwardPsduDown (Ptr<const WifiPsdu> psdu, WifiTxVector&
       txVector.SetAggregation (true);
     }
 
+  const WifiMacHeader& hdr = psdu->GetHeader (0);
+  if (hdr.IsQosData () && !hdr.GetAddr1 ().IsGroup ())
+    {
+      m_mac->GetQosTxop (hdr.GetQosTid ())->NotifyAirtimeUsed (hdr.GetAddr1 (),
+                                                               m_phy->CalculateTxDuration (psdu->GetSize (), txVector,
+                                                                                           m_phy->GetPhyBand ()));
+    }
+
   m_phy->Send (psdu, txVector);
 }
 
@@ -171,6 +171,12 @@ InterferenceHelper::NiChange::GetEvent (void) const
 }
 
 
+InterferenceHelper::NiChanges::NiChanges ()
+  : start (0)
+{
+}
+
+
 /****************************************************************
  *       The actual InterferenceHelper
  ****************************************************************/
@@ -232,10 +238,6 @@ void
 InterferenceHelper::RemoveBands(void)
 {
   NS_LOG_FUNCTION (this);
-  for (auto it : m_niChangesPerBand)
-    {
-      it.second.clear ();
-    }
   m_niChangesPerBand.clear();
   m_firstPowerPerBand.clear();
 }
@@ -283,12 +285,13 @@ InterferenceHelper::GetEnergyDuration (double energyW, WifiSpectrumBand band)
   Time now = Simulator::Now ();
   auto niIt = m_niChangesPerBand.find (band);
   NS_ASSERT (niIt != m_niChangesPerBand.end ());
-  auto i = GetPreviousPosition (now, niIt);
-  Time end = i->first;
-  for (; i != niIt->second.end (); ++i)
+  const std::vector<TimedNiChange> &changes = niIt->second.changes;
+  std::size_t i = GetPreviousPosition (now, niIt);
+  Time end = changes[i].first;
+  for (; i < changes.size (); ++i)
     {
-      double noiseInterferenceW = i->second.GetPower ();
-      end = i->first;
+      double noiseInterferenceW = changes[i].second.GetPower ();
+      end = changes[i].first;
       if (noiseInterferenceW < energyW)
         {
           break;
@@ -306,16 +309,17 @@ InterferenceHelper::AppendEvent (Ptr<Event> event, bool isStartOfdmaRxing)
       WifiSpectrumBand band = it.first;
       auto niIt = m_niChangesPerBand.find (band);
       NS_ASSERT (niIt != m_niChangesPerBand.end ());
+      std::vector<TimedNiChange> &changes = niIt->second.changes;
       double previousPowerStart = 0;
       double previousPowerEnd = 0;
       auto previousPowerPosition = GetPreviousPosition (event->GetStartTime (), niIt);
-      previousPowerStart = previousPowerPosition->second.GetPower ();
-      previousPowerEnd = GetPreviousPosition (event->GetEndTime (), niIt)->second.GetPower ();
+      previousPowerStart = changes[previousPowerPosition].second.GetPower ();
+      previousPowerEnd = changes[GetPreviousPosition (event->GetEndTime (), niIt)].second.GetPower ();
       if (!m_rxing)
         {
           m_firstPowerPerBand.find (band)->second = previousPowerStart;
           // Always leave the first zero power noise event in the list
-          niIt->second.erase (++(niIt->second.begin ()), ++previousPowerPosition);
+          ExpireNiChanges (previousPowerPosition, niIt);
         }
       else if (isStartOfdmaRxing)
         {
@@ -328,7 +332,7 @@ InterferenceHelper::AppendEvent (Ptr<Event> event, bool isStartOfdmaRxing)
       auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event), niIt);
       for (auto i = first; i != last; ++i)
         {
-          i->second.AddPower (it.second);
+          changes[i].second.AddPower (it.second);
         }
     }
 }
@@ -343,11 +347,12 @@ InterferenceHelper::UpdateEvent (Ptr<Event> event, const RxPowerWattPerChannelBa
       WifiSpectrumBand band = it.first;
       auto niIt = m_niChangesPerBand.find (band);
       NS_ASSERT (niIt != m_niChangesPerBand.end ());
+      std::vector<TimedNiChange> &changes = niIt->second.changes;
       auto first = GetPreviousPosition (event->GetStartTime (), niIt);
       auto last = GetPreviousPosition (event->GetEndTime (), niIt);
       for (auto i = first; i != last; ++i)
         {
-          i->second.AddPower (it.second);
+          changes[i].second.AddPower (it.second);
         }
     }
     event->UpdateRxPowerW (rxPower);
@@ -388,22 +393,33 @@ InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChangesPerB
   double noiseInterferenceW = firstPower_it->second;
   auto niIt = m_niChangesPerBand.find (band);
   NS_ASSERT (niIt != m_niChangesPerBand.end ());
-  auto it = niIt->second.find (event->GetStartTime ());
-  for (; it != niIt->second.end () && it->first < Simulator::Now (); ++it)
+  const std::vector<TimedNiChange> &changes = niIt->second.changes;
+  // the first change at the start of the event, if any
+  auto start = std::lower_bound (changes.begin () + niIt->second.start, changes.end (),
+                                 event->GetStartTime (),
+                                 [] (const TimedNiChange &change, Time moment)
+                                 { return change.first < moment; });
+  if (start != changes.end () && start->first != event->GetStartTime ())
+    {
+      start = changes.end ();
+    }
+  auto it = start;
+  for (; it != changes.end () && it->first < Simulator::Now (); ++it)
     {
       noiseInterferenceW = it->second.GetPower () - event->GetRxPowerW (band);
     }
-  it = niIt->second.find (event->GetStartTime ());
-  NS_ASSERT (it != niIt->second.end ());
-  for (; it != niIt->second.end () && it->second.GetEvent () != event; ++it);
+  it = start;
+  NS_ASSERT (it != changes.end ());
+  for (; it != changes.end () && it->second.GetEvent () != event; ++it);
   NiChanges ni;
-  ni.emplace (event->GetStartTime (), NiChange (0, event));
-  while (++it != niIt->second.end () && it->second.GetEvent () != event)
+  ni.changes.emplace_back (event->GetStartTime (), NiChange (0, event));
+  // the changes are sorted, and between the start and the end of the event
+  while (++it != changes.end () && it->second.GetEvent () != event)
     {
-      ni.insert (*it);
+      ni.changes.push_back (*it);
     }
-  ni.emplace (event->GetEndTime (), NiChange (0, event));
-  nis->insert ({band, ni});
+  ni.changes.emplace_back (event->GetEndTime (), NiChange (0, event));
+  nis->insert ({band, std::move (ni)});
   NS_ASSERT_MSG (noiseInterferenceW >= 0, "CalculateNoiseInterferenceW returns negative value " << noiseInterferenceW);
   return noiseInterferenceW;
 }
@@ -443,8 +459,8 @@ InterferenceHelper::CalculatePayloadPer (Ptr<const Event> event, uint16_t channe
 {
   NS_LOG_FUNCTION (this << channelWidth << band.first << band.second << staId << window.first << window.second);
   double psr = 1.0; /* Packet Success Rate */
-  const auto& niIt = nis->find (band)->second;
-  auto j = niIt.cbegin ();
+  const std::vector<TimedNiChange> &changes = nis->find (band)->second.changes;
+  auto j = changes.cbegin ();
   Time previous = j->first;
   WifiMode payloadMode = event->GetTxVector ().GetMode (staId);
   Time phyPayloadStart = j->first;
@@ -456,7 +472,7 @@ InterferenceHelper::CalculatePayloadPer (Ptr<const Event> event, uint16_t channe
   Time windowEnd = phyPayloadStart + window.second;
   double noiseInterferenceW = m_firstPowerPerBand.find (band)->second;
   double powerW = event->GetRxPowerW (band);
-  while (++j != niIt.cend ())
+  while (++j != changes.cend ())
     {
       Time current = j->first;
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
@@ -493,8 +509,8 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr (Ptr<const Event> event, NiChan
 {
   NS_LOG_FUNCTION (this << band.first << band.second);
   double psr = 1.0; /* Packet Success Rate */
-  auto niIt = nis->find (band)->second;
-  auto j = niIt.begin ();
+  const std::vector<TimedNiChange> &changes = nis->find (band)->second.changes;
+  auto j = changes.cbegin ();
 
   NS_ASSERT (!phyHeaderSections.empty ());
   Time stopLastSection = Seconds (0);
@@ -506,7 +522,7 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr (Ptr<const Event> event, NiChan
   Time previous = j->first;
   double noiseInterferenceW = m_firstPowerPerBand.find (band)->second;
   double powerW = event->GetRxPowerW (band);
-  while (++j != niIt.end ())
+  while (++j != changes.cend ())
     {
       Time current = j->first;
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
@@ -545,11 +561,11 @@ InterferenceHelper::CalculatePhyHeaderPer (Ptr<const Event> event, NiChangesPerB
                                            WifiPpduField header) const
 {
   NS_LOG_FUNCTION (this << band.first << band.second << header);
-  auto niIt = nis->find (band)->second;
+  const std::vector<TimedNiChange> &changes = nis->find (band)->second.changes;
   auto phyEntity = WifiPhy::GetStaticPhyEntity (event->GetTxVector ().GetModulationClass ());
 
   PhyEntity::PhyHeaderSections sections;
-  for (const auto & section : phyEntity->GetPhyHeaderSections (event->GetTxVector (), niIt.begin ()->first))
+  for (const auto & section : phyEntity->GetPhyHeaderSections (event->GetTxVector (), changes.front ().first))
     {
       if (section.first == header)
         {
@@ -622,7 +638,8 @@ InterferenceHelper::EraseEvents (void)
 {
   for (auto niIt = m_niChangesPerBand.begin(); niIt != m_niChangesPerBand.end(); ++niIt)
     {
-      niIt->second.clear ();
+      niIt->second.changes.clear ();
+      niIt->second.start = 0;
       // Always have a zero power noise event in the list
       AddNiChangeEvent (Time (0), NiChange (0.0, 0), niIt);
       m_firstPowerPerBand.at (niIt->first) = 0.0;
@@ -630,13 +647,17 @@ InterferenceHelper::EraseEvents (void)
   m_rxing = false;
 }
 
-InterferenceHelper::NiChanges::iterator
+std::size_t
 InterferenceHelper::GetNextPosition (Time moment, NiChangesPerBand::iterator niIt)
 {
-  return niIt->second.upper_bound (moment);
+  std::vector<TimedNiChange> &changes = niIt->second.changes;
+  return std::upper_bound (changes.begin () + niIt->second.start, changes.end (), moment,
+                           [] (Time moment, const TimedNiChange &change)
+                           { return moment < change.first; })
+         - changes.begin ();
 }
 
-InterferenceHelper::NiChanges::iterator
+std::size_t
 InterferenceHelper::GetPreviousPosition (Time moment, NiChangesPerBand::iterator niIt)
 {
   auto it = GetNextPosition (moment, niIt);
@@ -646,10 +667,30 @@ InterferenceHelper::GetPreviousPosition (Time moment, NiChangesPerBand::iterator
   return it;
 }
 
-InterferenceHelper::NiChanges::iterator
+std::size_t
 InterferenceHelper::AddNiChangeEvent (Time moment, NiChange change, NiChangesPerBand::iterator niIt)
 {
-  return niIt->second.insert (GetNextPosition (moment, niIt), std::make_pair (moment, change));
+  std::vector<TimedNiChange> &changes = niIt->second.changes;
+  auto position = GetNextPosition (moment, niIt);
+  changes.insert (changes.begin () + position, std::make_pair (moment, change));
+  return position;
+}
+
+void
+InterferenceHelper::ExpireNiChanges (std::size_t position, NiChangesPerBand::iterator niIt)
+{
+  NiChanges &ni = niIt->second;
+  if (position == ni.start)
+    {
+      return;
+    }
+  ni.changes[position] = std::make_pair (Time (0), NiChange (0.0, 0));
+  ni.start = position;
+  if (ni.start >= ni.changes.size () / 2)
+    {
+      ni.changes.erase (ni.changes.begin (), ni.changes.begin () + ni.start);
+      ni.start = 0;
+    }
 }
 
 void
@@ -667,10 +708,11 @@ InterferenceHelper::NotifyRxEnd (Time endTime)
   //Update m_firstPowerPerBand for frame capture
   for (auto niIt = m_niChangesPerBand.begin(); niIt != m_niChangesPerBand.end(); ++niIt)
     {
-      NS_ASSERT (niIt->second.size () > 1);
+      NS_ASSERT (niIt->second.changes.size () - niIt->second.start > 1);
       auto it = GetPreviousPosition (endTime, niIt);
+      NS_ASSERT (it > niIt->second.start);
       it--;
-      m_firstPowerPerBand.find (niIt->first)->second = it->second.GetPower ();
+      m_firstPowerPerBand.find (niIt->first)->second = niIt->second.changes[it].second.GetPower ();
     }
 }
 
@@ -22,6 +22,7 @@
 #define INTERFERENCE_HELPER_H
 
 #include "phy-entity.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -354,9 +355,24 @@ private:
   };
 
   /**
-   * typedef for a multimap of NiChange
+   * A NiChange and its time
    */
-  typedef std::multimap<Time, NiChange> NiChanges;
+  typedef std::pair<Time, NiChange> TimedNiChange;
+
+  /**
+   * The NiChanges of a band, sorted by time in a contiguous buffer.
+   * Expiring the changes before a reception only moves the start index
+   * (the change at the new start becomes the zero power noise event);
+   * the expired changes are erased once they fill half of the buffer,
+   * so that expiring is amortized constant time.
+   */
+  struct NiChanges
+  {
+    NiChanges ();
+
+    std::vector<TimedNiChange> changes; //!< the changes, those before start have expired
+    std::size_t start;                  //!< index of the first change in use
+  };
 
   /**
    * Map of NiChanges per band
@@ -435,32 +451,40 @@ private:
   bool m_rxing;                                            //!< flag whether it is in receiving state
 
   /**
-   * Returns an iterator to the first NiChange that is later than moment
+   * Returns the index of the first NiChange that is later than moment
    *
    * \param moment time to check from
    * \param niIt iterator of the band to check
-   * \returns an iterator to the list of NiChanges
+   * \returns an index in the NiChanges of the band
    */
-  NiChanges::iterator GetNextPosition (Time moment, NiChangesPerBand::iterator niIt);
+  std::size_t GetNextPosition (Time moment, NiChangesPerBand::iterator niIt);
   /**
-   * Returns an iterator to the last NiChange that is before than moment
+   * Returns the index of the last NiChange that is before than moment
    *
    * \param moment time to check from
    * \param niIt iterator of the band to check
-   * \returns an iterator to the list of NiChanges
+   * \returns an index in the NiChanges of the band
    */
-  NiChanges::iterator GetPreviousPosition (Time moment, NiChangesPerBand::iterator niIt);
+  std::size_t GetPreviousPosition (Time moment, NiChangesPerBand::iterator niIt);
 
   /**
    * Add NiChange to the list at the appropriate position and
-   * return the iterator of the new event.
+   * return the index of the new event.
    *
    * \param moment time to check from
    * \param change the NiChange to add
    * \param niIt iterator of the band to check
-   * \returns the iterator of the new event
+   * \returns the index of the new event
+   */
+  std::size_t AddNiChangeEvent (Time moment, NiChange change, NiChangesPerBand::iterator niIt);
+  /**
+   * Expire the NiChanges of a band before the one at an index, which
+   * becomes the zero power noise event.
+   *
+   * \param position the index of the first NiChange to keep
+   * \param niIt iterator of the band
    */
-  NiChanges::iterator AddNiChangeEvent (Time moment, NiChange change, NiChangesPerBand::iterator niIt);
+  void ExpireNiChanges (std::size_t position, NiChangesPerBand::iterator niIt);
 };
 
 } //namespace ns3
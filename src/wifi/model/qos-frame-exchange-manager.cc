@@ -531,6 +531,12 @@ QosFrameExchangeManager::ForwardMpduDown (Ptr<WifiMacQueueItem> mpdu, WifiTxVect
       hdr.SetQosEosp ();
       hdr.SetQosQueueSize (m_mac->GetQosTxop (tid)->GetQosQueueSize (tid, hdr.GetAddr1 ()));
     }
+  if (hdr.IsQosData () && !hdr.GetAddr1 ().IsGroup ())
+    {
+      m_mac->GetQosTxop (hdr.GetQosTid ())->NotifyAirtimeUsed (hdr.GetAddr1 (),
+                                                               m_phy->CalculateTxDuration (mpdu->GetSize (), txVector,
+                                                                                           m_phy->GetPhyBand ()));
+    }
   FrameExchangeManager::ForwardMpduDown (mpdu, txVector);
 }
 
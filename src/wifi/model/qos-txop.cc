@@ -82,10 +82,28 @@ QosTxop::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&QosTxop::m_baManager),
                    MakePointerChecker<BlockAckManager> ())
+    .AddAttribute ("AirtimeFairness",
+                   "Whether the unicast QoS Data frames are scheduled by airtime deficit "
+                   "round robin among their receivers, instead of in FIFO order. This is "
+                   "meant for the EDCAFs of an AP.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QosTxop::m_airtimeFairness),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AirtimeQuantum",
+                   "The airtime credited to a receiver at each round of the airtime "
+                   "deficit round robin.",
+                   TimeValue (MicroSeconds (300)),
+                   MakeTimeAccessor (&QosTxop::m_airtimeQuantum),
+                   MakeTimeChecker (NanoSeconds (1)))
     .AddTraceSource ("TxopTrace",
                      "Trace source for TXOP start and duration times",
                      MakeTraceSourceAccessor (&QosTxop::m_txopTrace),
                      "ns3::TracedValueCallback::Time")
+    .AddTraceSource ("Airtime",
+                     "The duration of a PPDU carrying unicast QoS Data frames, "
+                     "and their receiver",
+                     MakeTraceSourceAccessor (&QosTxop::m_airtimeTrace),
+                     "ns3::QosTxop::AirtimeCallback")
   ;
   return tid;
 }
@@ -99,7 +117,8 @@ QosTxop::QosTxop (AcIndex ac)
     m_muCwMax (0),
     m_muAifsn (0),
     m_muEdcaTimer (Seconds (0)),
-    m_muEdcaTimerStartTime (Seconds (0))
+    m_muEdcaTimerStartTime (Seconds (0)),
+    m_airtimeFairness (false)
 {
   NS_LOG_FUNCTION (this);
   m_qosBlockedDestinations = Create<QosBlockedDestinations> ();
@@ -108,6 +127,7 @@ QosTxop::QosTxop (AcIndex ac)
   m_baManager->SetBlockDestinationCallback (MakeCallback (&QosBlockedDestinations::Block, m_qosBlockedDestinations));
   m_baManager->SetUnblockDestinationCallback (MakeCallback (&QosBlockedDestinations::Unblock, m_qosBlockedDestinations));
   m_queue->TraceConnectWithoutContext ("Expired", MakeCallback (&BlockAckManager::NotifyDiscardedMpdu, m_baManager));
+  m_queue->TraceConnectWithoutContext ("Enqueue", MakeCallback (&QosTxop::NotifyAirtimeEnqueue, this));
 }
 
 QosTxop::~QosTxop ()
@@ -358,6 +378,136 @@ QosTxop::PeekNextMpdu (uint8_t tid, Mac48Address recipient, Ptr<const WifiMacQue
 {
   NS_LOG_FUNCTION (this << +tid << recipient << item);
 
+  if (m_airtimeFairness && tid == 8 && recipient.IsBroadcast () && item == nullptr)
+    {
+      return PeekNextMpduByAirtime ();
+    }
+  return DoPeekNextMpdu (tid, recipient, item);
+}
+
+Ptr<const WifiMacQueueItem>
+QosTxop::PeekNextMpduByAirtime (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Frames other than unicast QoS Data frames are sent in FIFO order, when
+  // they are the first available frame
+  Ptr<const WifiMacQueueItem> first = DoPeekNextMpdu (8, Mac48Address::GetBroadcast (), nullptr);
+  if (first != nullptr)
+    {
+      const WifiMacHeader& hdr = first->GetHeader ();
+      if (!hdr.IsQosData () || hdr.GetAddr1 ().IsGroup ())
+        {
+          return first;
+        }
+      ActivateAirtimeStation (hdr.GetAddr1 ());
+    }
+
+  const uint8_t tids[] = {wifiAcList.at (m_ac).GetHighTid (), wifiAcList.at (m_ac).GetLowTid ()};
+  bool backlogged = true;
+
+  while (backlogged)
+    {
+      backlogged = false;
+      auto it = m_airtimeStations.begin ();
+      while (it != m_airtimeStations.end ())
+        {
+          // the oldest frame of the station that can be transmitted now
+          Ptr<const WifiMacQueueItem> mpdu;
+          bool queued = false;
+          for (uint8_t tid : tids)
+            {
+              if (m_queue->GetNPackets (tid, *it) > 0)
+                {
+                  queued = true;
+                  Ptr<const WifiMacQueueItem> item = DoPeekNextMpdu (tid, *it, nullptr);
+                  if (item != nullptr && (mpdu == nullptr || item->GetTimeStamp () < mpdu->GetTimeStamp ()))
+                    {
+                      mpdu = item;
+                    }
+                }
+            }
+
+          if (!queued)
+            {
+              // the station is activated again by its next frame
+              NS_LOG_DEBUG ("No frames queued for " << *it);
+              m_airtimeDeficit[*it].active = false;
+              it = m_airtimeStations.erase (it);
+              continue;
+            }
+          if (mpdu == nullptr)
+            {
+              // the frames are in flight, blocked or beyond the transmit window
+              it++;
+              continue;
+            }
+
+          backlogged = true;
+          Time& deficit = m_airtimeDeficit[*it].deficit;
+          if (deficit.IsStrictlyNegative ())
+            {
+              // the station used up its airtime in this round
+              deficit += m_airtimeQuantum;
+              auto next = std::next (it);
+              m_airtimeStations.splice (m_airtimeStations.end (), m_airtimeStations, it);
+              it = next;
+              continue;
+            }
+
+          NS_LOG_DEBUG ("Serving " << *it << " with airtime deficit " << deficit);
+          return mpdu;
+        }
+    }
+
+  // no station has a frame that can be transmitted now
+  return first;
+}
+
+void
+QosTxop::ActivateAirtimeStation (Mac48Address station)
+{
+  AirtimeStation& state = m_airtimeDeficit[station];
+  if (!state.active)
+    {
+      NS_LOG_DEBUG ("Station " << station << " has frames queued");
+      state.active = true;
+      m_airtimeStations.push_back (station);
+    }
+}
+
+void
+QosTxop::NotifyAirtimeEnqueue (Ptr<const WifiMacQueueItem> item)
+{
+  if (m_airtimeFairness && item->GetHeader ().IsQosData () && !item->GetHeader ().GetAddr1 ().IsGroup ())
+    {
+      ActivateAirtimeStation (item->GetHeader ().GetAddr1 ());
+    }
+}
+
+void
+QosTxop::NotifyAirtimeUsed (Mac48Address station, Time airtime)
+{
+  NS_LOG_FUNCTION (this << station << airtime);
+  m_airtimeTrace (station, airtime);
+  if (m_airtimeFairness)
+    {
+      m_airtimeDeficit[station].deficit -= airtime;
+    }
+}
+
+Time
+QosTxop::GetAirtimeDeficit (Mac48Address station) const
+{
+  auto it = m_airtimeDeficit.find (station);
+  return (it != m_airtimeDeficit.end () ? it->second.deficit : Seconds (0));
+}
+
+Ptr<const WifiMacQueueItem>
+QosTxop::DoPeekNextMpdu (uint8_t tid, Mac48Address recipient, Ptr<const WifiMacQueueItem> item)
+{
+  NS_LOG_FUNCTION (this << +tid << recipient << item);
+
   // lambda to peek the next frame
   auto peek = [this, &tid, &recipient, &item] () -> Ptr<const WifiMacQueueItem>
     {
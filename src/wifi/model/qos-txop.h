@@ -27,6 +27,8 @@
 #include "block-ack-manager.h"
 #include "txop.h"
 #include "qos-utils.h"
+#include <list>
+#include <map>
 
 namespace ns3 {
 
@@ -311,6 +313,10 @@ public:
    * Note that A-MSDU aggregation is never attempted. If the frame has never been
    * transmitted, it is assigned a sequence number peeked from MacTxMiddle.
    *
+   * If AirtimeFairness is enabled, <i>tid</i> is equal to 8, <i>recipient</i> is
+   * the broadcast address and <i>item</i> is a null pointer, a unicast QoS data
+   * frame is returned for the receiver chosen by airtime deficit round robin.
+   *
    * \param tid traffic ID.
    * \param recipient the receiver station address.
    * \param item the item after which the search starts from
@@ -358,6 +364,29 @@ public:
    */
   uint8_t GetQosQueueSize (uint8_t tid, Mac48Address receiver) const;
 
+  /**
+   * Notify that a PPDU carrying unicast QoS Data frames has been transmitted
+   * to the given station. If airtime fairness is enabled, the duration of
+   * the PPDU is charged to the airtime deficit of the station.
+   *
+   * \param station the receiver of the PPDU
+   * \param airtime the duration of the PPDU
+   */
+  void NotifyAirtimeUsed (Mac48Address station, Time airtime);
+  /**
+   * \param station the given station
+   * \return the airtime deficit of the given station
+   */
+  Time GetAirtimeDeficit (Mac48Address station) const;
+
+  /**
+   * TracedCallback signature for the airtime used by a station.
+   *
+   * \param station the receiver of the PPDU
+   * \param airtime the duration of the PPDU
+   */
+  typedef void (* AirtimeCallback)(Mac48Address station, Time airtime);
+
   /**
    * Return true if a TXOP has started.
    *
@@ -459,6 +488,52 @@ private:
    */
   bool IsQosOldPacket (Ptr<const WifiMacQueueItem> mpdu);
 
+  /**
+   * Peek the next frame as PeekNextMpdu does, in FIFO order.
+   *
+   * \param tid traffic ID.
+   * \param recipient the receiver station address.
+   * \param item the item after which the search starts from
+   * \returns the peeked frame.
+   */
+  Ptr<const WifiMacQueueItem> DoPeekNextMpdu (uint8_t tid, Mac48Address recipient,
+                                              Ptr<const WifiMacQueueItem> item);
+  /**
+   * Peek the oldest frame that can be transmitted to the first station, in
+   * round robin order, whose airtime deficit is not negative. A station whose
+   * deficit is negative is credited the airtime quantum and moved to the end
+   * of the round. Frames other than unicast QoS Data frames are only returned
+   * when they are the first available frame.
+   *
+   * The frames of all the stations stay in the single WifiMacQueue of the AC,
+   * which the block ack manager, the aggregators, the lifetime handling and
+   * the flow control of the queue discs work on; the station is picked here,
+   * at peek time, rather than by serving one queue per station.
+   *
+   * \returns the peeked frame.
+   */
+  Ptr<const WifiMacQueueItem> PeekNextMpduByAirtime (void);
+  /**
+   * Add the given station at the end of the round robin, unless it is already
+   * in the round robin.
+   *
+   * \param station the given station
+   */
+  void ActivateAirtimeStation (Mac48Address station);
+  /**
+   * Add the receiver of an enqueued unicast QoS Data frame to the round robin.
+   *
+   * \param item the enqueued item
+   */
+  void NotifyAirtimeEnqueue (Ptr<const WifiMacQueueItem> item);
+
+  /// Airtime deficit round robin state of a station
+  struct AirtimeStation
+  {
+    Time deficit;         //!< airtime the station can use before its next credit
+    bool active = false;  //!< whether the station is in the round robin
+  };
+
   AcIndex m_ac;                                         //!< the access category
   Ptr<QosFrameExchangeManager> m_qosFem;                //!< the QoS Frame Exchange Manager
   Ptr<QosBlockedDestinations> m_qosBlockedDestinations; //!< the QoS blocked destinations
@@ -479,7 +554,13 @@ private:
   Time m_muEdcaTimer;          //!< the MU EDCA Timer
   Time m_muEdcaTimerStartTime; //!< last start time of the MU EDCA Timer
 
+  bool m_airtimeFairness;                                  //!< whether to schedule the receivers by airtime
+  Time m_airtimeQuantum;                                   //!< airtime credited to a station at each round
+  std::list<Mac48Address> m_airtimeStations;               //!< the stations with frames queued, in round robin order
+  std::map<Mac48Address, AirtimeStation> m_airtimeDeficit; //!< the airtime deficit of each station
+
   TracedCallback<Time, Time> m_txopTrace; //!< TXOP trace callback
+  TracedCallback<Mac48Address, Time> m_airtimeTrace; //!< airtime trace callback
 };
 
 } //namespace ns3
@@ -31,12 +31,17 @@ namespace ns3 {
 std::size_t
 WifiAddressTidHash::operator()(const WifiAddressTidPair& addressTidPair) const
 {
-  uint8_t buffer[7];
+  uint8_t buffer[6];
   addressTidPair.first.CopyTo (buffer);
-  buffer[6] = addressTidPair.second;
 
-  std::string s (buffer, buffer + 7);
-  return std::hash<std::string>{} (s);
+  // pack the address and the TID in a single word, it is hashed for every
+  // lookup of the per receiver and TID statistics of the queues
+  uint64_t key = addressTidPair.second;
+  for (uint8_t i = 0; i < 6; i++)
+    {
+      key = (key << 8) | buffer[i];
+    }
+  return std::hash<uint64_t>{} (key);
 }
 
 std::size_t
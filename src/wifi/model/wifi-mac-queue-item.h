@@ -211,6 +211,7 @@ private:
   Time m_tstamp;                                //!< timestamp when the packet arrived at the queue
   DeaggregatedMsdus m_msduList;                 //!< The list of aggregated MSDUs included in this MPDU
   ConstIterator m_queueIt;                      //!< Queue iterator pointing to this MPDU, if queued
+  std::list<ConstIterator>::iterator m_sublistIt; //!< Iterator pointing to this MPDU in its receiver and TID sublist, if queued
   AcIndex m_queueAc;                            //!< AC associated with the queue this MPDU is stored into
   bool m_inFlight;                              //!< whether the MPDU is in flight
 };
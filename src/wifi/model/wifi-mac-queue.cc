@@ -71,10 +71,20 @@ WifiMacQueue::WifiMacQueue (AcIndex ac)
 WifiMacQueue::~WifiMacQueue ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_nQueuedPackets.clear ();
+  m_sublists.clear ();
   m_nQueuedBytes.clear ();
 }
 
+void
+WifiMacQueue::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the base class clears the queue without dequeuing the items
+  m_sublists.clear ();
+  m_nQueuedBytes.clear ();
+  Queue<WifiMacQueueItem>::DoDispose ();
+}
+
 bool
 WifiMacQueue::TtlExceeded (ConstIterator &it, const Time& now)
 {
@@ -279,19 +289,45 @@ WifiMacQueue::PeekByTidAndAddress (uint8_t tid, Mac48Address dest, Ptr<const Wif
   NS_LOG_FUNCTION (this << +tid << dest << item);
   NS_ASSERT (item == nullptr || item->IsQueued ());
 
-  ConstIterator it = (item != nullptr ? std::next (item->m_queueIt) : begin ());
+  auto sublistIt = m_sublists.find (WifiAddressTidPair (dest, tid));
+  if (sublistIt == m_sublists.end ())
+    {
+      NS_LOG_DEBUG ("The queue is empty");
+      return nullptr;
+    }
+  const Sublist& sublist = sublistIt->second;
+
+  Sublist::const_iterator it = sublist.begin ();
+  if (item != nullptr)
+    {
+      if (item->GetHeader ().IsQosData () && item->GetDestinationAddress () == dest
+          && item->GetHeader ().GetQosTid () == tid)
+        {
+          it = std::next (Sublist::const_iterator (item->m_sublistIt));
+        }
+      else
+        {
+          // the search starts from the first packet of the sublist following
+          // the given item in the queue
+          ConstIterator queueIt = std::next (item->m_queueIt);
+          while (queueIt != end () && !((*queueIt)->GetHeader ().IsQosData ()
+                                        && (*queueIt)->GetDestinationAddress () == dest
+                                        && (*queueIt)->GetHeader ().GetQosTid () == tid))
+            {
+              queueIt++;
+            }
+          it = (queueIt != end () ? Sublist::const_iterator ((*queueIt)->m_sublistIt) : sublist.end ());
+        }
+    }
+
   const Time now = Simulator::Now ();
-  while (it != end ())
+  while (it != sublist.end ())
     {
       // skip packets that stayed in the queue for too long. They will be
       // actually removed from the queue by the next call to a non-const method
-      if (now <= (*it)->GetTimeStamp () + m_maxDelay)
+      if (now <= (**it)->GetTimeStamp () + m_maxDelay)
         {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              return *it;
-            }
+          return **it;
         }
       it++;
     }
@@ -425,17 +461,27 @@ WifiMacQueue::GetNPacketsByTidAndAddress (uint8_t tid, Mac48Address dest)
   uint32_t nPackets = 0;
   const Time now = Simulator::Now ();
 
-  for (ConstIterator it = begin (); it != end (); )
+  auto sublistIt = m_sublists.find (WifiAddressTidPair (dest, tid));
+  if (sublistIt == m_sublists.end ())
     {
-      if (!TtlExceeded (it, now))
-        {
-          if ((*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
-              && (*it)->GetHeader ().GetQosTid () == tid)
-            {
-              nPackets++;
-            }
+      NS_LOG_DEBUG ("returns " << nPackets);
+      return nPackets;
+    }
 
-          it++;
+  Sublist& sublist = sublistIt->second;
+  for (auto it = sublist.begin (); it != sublist.end (); )
+    {
+      // move to the next packet first, the current one may be removed, and
+      // the sublist too if it is the last one
+      ConstIterator queueIt = *it++;
+      bool last = (it == sublist.end ());
+      if (!TtlExceeded (queueIt, now))
+        {
+          nPackets++;
+        }
+      if (last)
+        {
+          break;
         }
     }
   NS_LOG_DEBUG ("returns " << nPackets);
@@ -497,25 +543,29 @@ WifiMacQueue::GetNBytes (void)
 uint32_t
 WifiMacQueue::GetNPackets (uint8_t tid, Mac48Address dest) const
 {
-  WifiAddressTidPair addressTidPair (dest, tid);
-  auto it = m_nQueuedPackets.find (addressTidPair);
-  if (it == m_nQueuedPackets.end ())
+  auto it = m_sublists.find (WifiAddressTidPair (dest, tid));
+  if (it == m_sublists.end ())
     {
       return 0;
     }
-  return m_nQueuedPackets.at (addressTidPair);
+  return it->second.size ();
 }
 
 uint32_t
 WifiMacQueue::GetNBytes (uint8_t tid, Mac48Address dest) const
 {
-  WifiAddressTidPair addressTidPair (dest, tid);
-  auto it = m_nQueuedBytes.find (addressTidPair);
+  auto it = m_nQueuedBytes.find (WifiAddressTidPair (dest, tid));
   if (it == m_nQueuedBytes.end ())
     {
       return 0;
     }
-  return m_nQueuedBytes.at (addressTidPair);
+  return it->second;
+}
+
+uint32_t
+WifiMacQueue::GetNSublists (void) const
+{
+  return m_sublists.size ();
 }
 
 bool
@@ -524,27 +574,90 @@ WifiMacQueue::DoEnqueue (ConstIterator pos, Ptr<WifiMacQueueItem> item)
   Iterator ret;
   if (Queue<WifiMacQueueItem>::DoEnqueue (pos, item, ret))
     {
+      // set item's information about its position in the queue
+      item->m_queueAc = m_ac;
+      item->m_queueIt = ret;
       // update statistics about queued packets
       if (item->GetHeader ().IsQosData ())
         {
-          WifiAddressTidPair addressTidPair (item->GetHeader ().GetAddr1 (), item->GetHeader ().GetQosTid ());
-          auto it = m_nQueuedPackets.find (addressTidPair);
-          if (it == m_nQueuedPackets.end ())
-            {
-              m_nQueuedPackets[addressTidPair] = 0;
-              m_nQueuedBytes[addressTidPair] = 0;
-            }
-          m_nQueuedPackets[addressTidPair]++;
-          m_nQueuedBytes[addressTidPair] += item->GetSize ();
+          AddToSublist (item);
         }
-      // set item's information about its position in the queue
-      item->m_queueAc = m_ac;
-      item->m_queueIt = ret;
       return true;
     }
   return false;
 }
 
+void
+WifiMacQueue::AddToSublist (Ptr<WifiMacQueueItem> item)
+{
+  WifiAddressTidPair addressTidPair (item->GetHeader ().GetAddr1 (), item->GetHeader ().GetQosTid ());
+  Sublist& sublist = m_sublists[addressTidPair];
+
+  // the item goes after the closest preceding item of its sublist in the
+  // queue or before the closest following one, hence search both directions
+  // at once. Items are mostly enqueued at either end of the queue or next to
+  // another item of the same sublist (Replace), so the search is short
+  Sublist::iterator sublistPos = sublist.end ();
+  if (!sublist.empty ())
+    {
+      auto sameSublist = [&addressTidPair] (Ptr<const WifiMacQueueItem> other)
+        {
+          return other->GetHeader ().IsQosData ()
+                 && other->GetHeader ().GetAddr1 () == addressTidPair.first
+                 && other->GetHeader ().GetQosTid () == addressTidPair.second;
+        };
+      ConstIterator fwd = std::next (item->m_queueIt);
+      ConstIterator bwd = item->m_queueIt;
+      while (true)
+        {
+          if (fwd == end ())
+            {
+              sublistPos = sublist.end ();
+              break;
+            }
+          if (sameSublist (*fwd))
+            {
+              sublistPos = (*fwd)->m_sublistIt;
+              break;
+            }
+          fwd++;
+          if (bwd == begin ())
+            {
+              sublistPos = sublist.begin ();
+              break;
+            }
+          bwd--;
+          if (sameSublist (*bwd))
+            {
+              sublistPos = std::next ((*bwd)->m_sublistIt);
+              break;
+            }
+        }
+    }
+  item->m_sublistIt = sublist.insert (sublistPos, item->m_queueIt);
+  m_nQueuedBytes[addressTidPair] += item->GetSize ();
+}
+
+void
+WifiMacQueue::RemoveFromSublist (Ptr<const WifiMacQueueItem> item)
+{
+  WifiAddressTidPair addressTidPair (item->GetHeader ().GetAddr1 (), item->GetHeader ().GetQosTid ());
+  auto sublistIt = m_sublists.find (addressTidPair);
+  NS_ASSERT (sublistIt != m_sublists.end ());
+  NS_ASSERT (!sublistIt->second.empty ());
+  auto bytesIt = m_nQueuedBytes.find (addressTidPair);
+  NS_ASSERT (bytesIt != m_nQueuedBytes.end () && bytesIt->second >= item->GetSize ());
+
+  sublistIt->second.erase (item->m_sublistIt);
+  bytesIt->second -= item->GetSize ();
+  // the receivers come and go, drop the pairs having no queued packets
+  if (sublistIt->second.empty ())
+    {
+      m_sublists.erase (sublistIt);
+      m_nQueuedBytes.erase (bytesIt);
+    }
+}
+
 Ptr<WifiMacQueueItem>
 WifiMacQueue::DoDequeue (ConstIterator pos)
 {
@@ -554,13 +667,7 @@ WifiMacQueue::DoDequeue (ConstIterator pos)
 
   if (item != 0 && item->GetHeader ().IsQosData ())
     {
-      WifiAddressTidPair addressTidPair (item->GetHeader ().GetAddr1 (), item->GetHeader ().GetQosTid ());
-      NS_ASSERT (m_nQueuedPackets.find (addressTidPair) != m_nQueuedPackets.end ());
-      NS_ASSERT (m_nQueuedPackets[addressTidPair] >= 1);
-      NS_ASSERT (m_nQueuedBytes[addressTidPair] >= item->GetSize ());
-
-      m_nQueuedPackets[addressTidPair]--;
-      m_nQueuedBytes[addressTidPair] -= item->GetSize ();
+      RemoveFromSublist (item);
     }
 
   if (item != 0)
@@ -579,13 +686,7 @@ WifiMacQueue::DoRemove (ConstIterator pos)
 
   if (item != 0 && item->GetHeader ().IsQosData ())
     {
-      WifiAddressTidPair addressTidPair (item->GetHeader ().GetAddr1 (), item->GetHeader ().GetQosTid ());
-      NS_ASSERT (m_nQueuedPackets.find (addressTidPair) != m_nQueuedPackets.end ());
-      NS_ASSERT (m_nQueuedPackets[addressTidPair] >= 1);
-      NS_ASSERT (m_nQueuedBytes[addressTidPair] >= item->GetSize ());
-
-      m_nQueuedPackets[addressTidPair]--;
-      m_nQueuedBytes[addressTidPair] -= item->GetSize ();
+      RemoveFromSublist (item);
     }
 
   if (item != 0)
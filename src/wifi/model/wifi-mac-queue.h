@@ -168,7 +168,9 @@ public:
    * following <i>item</i> in the queue; otherwise, the search starts from the
    * head of the queue. This method does not remove the packet from the queue.
    * It is typically used by ns3::QosTxop in order to perform correct MSDU aggregation
-   * (A-MSDU).
+   * (A-MSDU). The packets are looked up in the sublist of the given receiver
+   * and TID, hence the complexity does not depend on the packets queued for
+   * other receivers or TIDs.
    *
    * \param tid the given TID
    * \param dest the given destination
@@ -256,8 +258,9 @@ public:
   uint32_t GetNPacketsByAddress (Mac48Address dest);
   /**
    * Return the number of QoS packets having TID equal to <i>tid</i> and
-   * destination address equal to <i>dest</i>.  The complexity is linear in
-   * the size of the queue.
+   * destination address equal to <i>dest</i>, after removing those of them
+   * whose lifetime expired.  The complexity is linear in the number of such
+   * packets.
    *
    * \param tid the given TID
    * \param dest the given destination
@@ -290,6 +293,14 @@ public:
    * \return the number of bytes in the queue
    */
   uint32_t GetNBytes (uint8_t tid, Mac48Address dest) const;
+  /**
+   * Return the number of (receiver, TID) pairs having QoS data packets in
+   * the queue. Packets expired since the last non-const operation on the
+   * queue are included.
+   *
+   * \return the number of (receiver, TID) pairs having queued packets
+   */
+  uint32_t GetNSublists (void) const;
 
   /**
    * \return true if the queue is empty; false otherwise
@@ -370,13 +381,33 @@ private:
    * \return the item.
    */
   Ptr<WifiMacQueueItem> DoRemove (ConstIterator pos);
+  /**
+   * Add the given QoS data item, just enqueued, to the sublist of its
+   * receiver and TID, before the first item of the sublist that follows it
+   * in the queue, and update the statistics of the sublist.
+   *
+   * \param item the item
+   */
+  void AddToSublist (Ptr<WifiMacQueueItem> item);
+  /**
+   * Remove the given QoS data item, about to be dequeued or dropped, from
+   * the sublist of its receiver and TID, and update the statistics of the
+   * sublist.
+   *
+   * \param item the item
+   */
+  void RemoveFromSublist (Ptr<const WifiMacQueueItem> item);
+
+  void DoDispose (void) override;
 
   Time m_maxDelay;                          //!< Time to live for packets in the queue
   DropPolicy m_dropPolicy;                  //!< Drop behavior of queue
   AcIndex m_ac;                             //!< the access category
 
-  /// Per (MAC address, TID) pair queued packets
-  std::unordered_map<WifiAddressTidPair, uint32_t, WifiAddressTidHash> m_nQueuedPackets;
+  /// The queued QoS data frames having the same receiver and TID, in queue order
+  typedef std::list<ConstIterator> Sublist;
+  /// Per (MAC address, TID) pair sublist of queued packets, only for the pairs having queued packets
+  std::unordered_map<WifiAddressTidPair, Sublist, WifiAddressTidHash> m_sublists;
   /// Per (MAC address, TID) pair queued bytes
   std::unordered_map<WifiAddressTidPair, uint32_t, WifiAddressTidHash> m_nQueuedBytes;
 
@@ -21,6 +21,9 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/constant-position-mobility-model.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/node.h"
 #include "ns3/propagation-loss-model.h"
@@ -31,6 +34,9 @@
 #include "wifi-utils.h"
 #include "wifi-ppdu.h"
 #include "wifi-psdu.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace ns3 {
 
@@ -53,11 +59,54 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("SpatialIndex",
+                   "Keep the PHYs in a grid of their positions and only deliver "
+                   "a PPDU to those within range of the sender.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_spatialIndex),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CullingRange",
+                   "Distance (m) beyond which the spatial index skips the PHYs, "
+                   "0 to derive it from the propagation models when they are "
+                   "deterministic.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cullingRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MaxSpeed",
+                   "Bound (m/s) on the speed of the PHYs whose mobility model "
+                   "does not notify its course changes.  The spatial index "
+                   "widens its search accordingly.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxSpeed),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("PropagationCache",
+                   "Reuse the received power and delay computed for a pair of "
+                   "PHYs while neither moves, when the propagation models are "
+                   "deterministic.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_propagationCache),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CacheTolerance",
+                   "Distance (m) a PHY may move before the cached results "
+                   "involving it are computed again, 0 for exact results.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cacheTolerance),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_spatialIndex (false),
+    m_cullingRange (0),
+    m_maxSpeed (0),
+    m_propagationCache (false),
+    m_cacheTolerance (0),
+    m_cellSize (0),
+    m_threshold (0),
+    m_sender (0),
+    m_cacheHits (0),
+    m_cacheMisses (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -68,11 +117,27 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (IndexEntry &entry : m_entries)
+    {
+      entry.mobility->TraceDisconnectWithoutContext ("CourseChange", entry.courseChange);
+    }
+  m_entries.clear ();
+  m_cells.clear ();
+  m_cache.clear ();
+  Channel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
   NS_LOG_FUNCTION (this << loss);
   m_loss = loss;
+  m_ranges.clear ();
+  m_cache.clear ();
 }
 
 void
@@ -80,6 +145,7 @@ YansWifiChannel::SetPropagationDelayModel (const Ptr<PropagationDelayModel> dela
 {
   NS_LOG_FUNCTION (this << delay);
   m_delay = delay;
+  m_cache.clear ();
 }
 
 void
@@ -88,38 +154,318 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double
   NS_LOG_FUNCTION (this << sender << ppdu << txPowerDbm);
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  const bool cached = m_propagationCache && IsDeterministic ();
+  if (cached)
     {
-      if (sender != (*i))
+      if (m_entries.size () != m_phyList.size () && !m_spatialIndex)
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          TrackPhys ();
+        }
+      m_sender = std::find (m_phyList.begin (), m_phyList.end (), sender) - m_phyList.begin ();
+      NS_ASSERT (m_sender < m_phyList.size ());
+      m_senderPosition = senderMobility->GetPosition ();
+    }
+  if (m_spatialIndex)
+    {
+      if (m_entries.size () != m_phyList.size ()
+          || m_maxSpeed * (Simulator::Now () - m_indexTime).GetSeconds () > m_cellSize / 2)
+        {
+          BuildIndex (txPowerDbm);
+        }
+      const double range = GetRange (txPowerDbm);
+      if (std::isfinite (range))
+        {
+          // a PHY may have moved by up to m_maxSpeed since it was indexed
+          const double reach = range + m_maxSpeed * (Simulator::Now () - m_indexTime).GetSeconds ();
+          const Vector center = senderMobility->GetPosition ();
+          const int64_t xMin = GetCellIndex (center.x - reach);
+          const int64_t xMax = GetCellIndex (center.x + reach);
+          const int64_t yMin = GetCellIndex (center.y - reach);
+          const int64_t yMax = GetCellIndex (center.y + reach);
+          m_candidates.clear ();
+          if (static_cast<double> (xMax - xMin + 1) * (yMax - yMin + 1) > m_cells.size ())
             {
-              continue;
+              for (const auto &cell : m_cells)
+                {
+                  m_candidates.insert (m_candidates.end (), cell.second.begin (), cell.second.end ());
+                }
             }
-
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<WifiPpdu> copy = ppdu->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
+          else
             {
-              dstNode = 0xffffffff;
+              for (int64_t x = xMin; x <= xMax; ++x)
+                {
+                  for (int64_t y = yMin; y <= yMax; ++y)
+                    {
+                      auto cell = m_cells.find (GetCellKey (x, y));
+                      if (cell != m_cells.end ())
+                        {
+                          m_candidates.insert (m_candidates.end (), cell->second.begin (), cell->second.end ());
+                        }
+                    }
+                }
             }
-          else
+          // schedule the receptions in the order of m_phyList, as without
+          // the index, so that the events keep their relative order
+          std::sort (m_candidates.begin (), m_candidates.end ());
+          for (uint32_t i : m_candidates)
             {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
+              if (m_phyList[i] != sender
+                  && CalculateDistance (m_entries[i].position, center) <= reach)
+                {
+                  SendTo (sender, senderMobility, i, ppdu, txPowerDbm, cached);
+                }
             }
+          return;
+        }
+    }
+  for (uint32_t i = 0; i < m_phyList.size (); i++)
+    {
+      if (sender != m_phyList[i])
+        {
+          SendTo (sender, senderMobility, i, ppdu, txPowerDbm, cached);
+        }
+    }
+}
+
+void
+YansWifiChannel::SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+                         uint32_t index, Ptr<const WifiPpdu> ppdu, double txPowerDbm,
+                         bool cached) const
+{
+  Ptr<YansWifiPhy> receiver = m_phyList[index];
+  //For now don't account for inter channel interference nor channel bonding
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+  Time delay;
+  double rxPowerDbm;
+  if (cached)
+    {
+      const CacheEntry &entry = GetCached (index, senderMobility, receiverMobility, txPowerDbm);
+      delay = entry.delay;
+      rxPowerDbm = entry.rxPowerDbm;
+    }
+  else
+    {
+      delay = m_delay->GetDelay (senderMobility, receiverMobility);
+      rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+    }
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  Ptr<WifiPpdu> copy = ppdu->Copy ();
+  Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+    }
+
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive,
+                                  receiver, copy, rxPowerDbm);
+}
+
+const YansWifiChannel::CacheEntry &
+YansWifiChannel::GetCached (uint32_t receiver, Ptr<MobilityModel> senderMobility,
+                            Ptr<MobilityModel> receiverMobility, double txPowerDbm) const
+{
+  const Vector rxPosition = receiverMobility->GetPosition ();
+  const IndexEntry &tx = m_entries[m_sender];
+  const IndexEntry &rx = m_entries[receiver];
+  // one entry per ordered pair, for the last TX power used
+  const uint64_t key = (static_cast<uint64_t> (m_sender) << 32) | receiver;
+  auto it = m_cache.find (key);
+  if (it != m_cache.end ())
+    {
+      const CacheEntry &entry = it->second;
+      if (entry.txPowerDbm == txPowerDbm
+          && entry.txEpoch == tx.epoch && entry.rxEpoch == rx.epoch
+          && IsWithinTolerance (entry.txPosition, m_senderPosition)
+          && IsWithinTolerance (entry.rxPosition, rxPosition))
+        {
+          ++m_cacheHits;
+          return entry;
+        }
+    }
+  ++m_cacheMisses;
+  CacheEntry &entry = m_cache[key];
+  entry.txPowerDbm = txPowerDbm;
+  entry.txPosition = m_senderPosition;
+  entry.rxPosition = rxPosition;
+  entry.txEpoch = tx.epoch;
+  entry.rxEpoch = rx.epoch;
+  entry.delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  entry.rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  return entry;
+}
+
+bool
+YansWifiChannel::IsWithinTolerance (const Vector &a, const Vector &b) const
+{
+  if (m_cacheTolerance == 0)
+    {
+      return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+  return CalculateDistance (a, b) <= m_cacheTolerance;
+}
+
+uint64_t
+YansWifiChannel::GetCellKey (int64_t x, int64_t y)
+{
+  return (static_cast<uint64_t> (x) << 32) ^ static_cast<uint32_t> (y);
+}
+
+int64_t
+YansWifiChannel::GetCellIndex (double coordinate) const
+{
+  return static_cast<int64_t> (std::floor (coordinate / m_cellSize));
+}
 
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm);
+void
+YansWifiChannel::BuildIndex (double txPowerDbm) const
+{
+  NS_LOG_FUNCTION (this << txPowerDbm);
+  // the PHYs may have been configured since the last indexing
+  m_threshold = std::numeric_limits<double>::infinity ();
+  for (const Ptr<YansWifiPhy> &phy : m_phyList)
+    {
+      m_threshold = std::min (m_threshold, phy->GetRxSensitivity () - phy->GetRxGain ());
+    }
+  m_ranges.clear ();
+  if (m_cellSize == 0)
+    {
+      // with cells as large as the range, a sender looks at 3x3 cells
+      const double range = GetRange (txPowerDbm);
+      m_cellSize = std::isfinite (range) ? std::max (range, 1.0) : 1000.0;
+    }
+  TrackPhys ();
+  m_cells.clear ();
+  for (uint32_t i = 0; i < m_entries.size (); ++i)
+    {
+      IndexEntry &entry = m_entries[i];
+      entry.position = entry.mobility->GetPosition ();
+      entry.cell = GetCellKey (GetCellIndex (entry.position.x), GetCellIndex (entry.position.y));
+      m_cells[entry.cell].push_back (i);
+    }
+  m_indexTime = Simulator::Now ();
+}
+
+void
+YansWifiChannel::TrackPhys (void) const
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = m_entries.size (); i < m_phyList.size (); ++i)
+    {
+      IndexEntry entry;
+      entry.mobility = m_phyList[i]->GetMobility ();
+      NS_ASSERT (entry.mobility != 0);
+      entry.courseChange = MakeBoundCallback (&YansWifiChannel::CourseChanged, this, i);
+      entry.mobility->TraceConnectWithoutContext ("CourseChange", entry.courseChange);
+      entry.cell = 0;
+      entry.epoch = 0;
+      m_entries.push_back (entry);
+    }
+}
+
+void
+YansWifiChannel::CourseChanged (const YansWifiChannel *channel, uint32_t index,
+                                Ptr<const MobilityModel> mobility)
+{
+  IndexEntry &entry = channel->m_entries[index];
+  ++entry.epoch;
+  if (!channel->m_spatialIndex)
+    {
+      return;
+    }
+  entry.position = mobility->GetPosition ();
+  const uint64_t cell = GetCellKey (channel->GetCellIndex (entry.position.x),
+                                    channel->GetCellIndex (entry.position.y));
+  if (cell == entry.cell)
+    {
+      return;
+    }
+  std::vector<uint32_t> &from = channel->m_cells[entry.cell];
+  from.erase (std::find (from.begin (), from.end (), index));
+  if (from.empty ())
+    {
+      channel->m_cells.erase (entry.cell);
+    }
+  channel->m_cells[cell].push_back (index);
+  entry.cell = cell;
+}
+
+bool
+YansWifiChannel::IsDeterministic (void) const
+{
+  if (m_loss == 0 || m_delay == 0
+      || m_delay->GetInstanceTypeId () != ConstantSpeedPropagationDelayModel::GetTypeId ())
+    {
+      return false;
+    }
+  for (Ptr<PropagationLossModel> loss = m_loss; loss != 0; loss = loss->GetNext ())
+    {
+      const TypeId tid = loss->GetInstanceTypeId ();
+      if (tid != FriisPropagationLossModel::GetTypeId ()
+          && tid != LogDistancePropagationLossModel::GetTypeId ()
+          && tid != ThreeLogDistancePropagationLossModel::GetTypeId ()
+          && tid != RangePropagationLossModel::GetTypeId ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+double
+YansWifiChannel::GetRange (double txPowerDbm) const
+{
+  if (m_cullingRange > 0)
+    {
+      return m_cullingRange;
+    }
+  auto it = m_ranges.find (txPowerDbm);
+  if (it != m_ranges.end ())
+    {
+      return it->second;
+    }
+  double range = std::numeric_limits<double>::infinity ();
+  if (IsDeterministic ())
+    {
+      // these losses only grow with the distance: bracket the distance at
+      // which the signal gets too weak for every PHY, then bisect
+      Ptr<MobilityModel> a = CreateObject<ConstantPositionMobilityModel> ();
+      Ptr<MobilityModel> b = CreateObject<ConstantPositionMobilityModel> ();
+      auto isWeak = [&] (double distance) {
+          b->SetPosition (Vector (distance, 0, 0));
+          return m_loss->CalcRxPower (txPowerDbm, a, b) < m_threshold;
+        };
+      double weak = 1;
+      while (!isWeak (weak) && weak < 1e9)
+        {
+          weak *= 2;
+        }
+      if (isWeak (weak))
+        {
+          double strong = 0;
+          while (weak - strong > 1e-3 * weak)
+            {
+              const double middle = (weak + strong) / 2;
+              (isWeak (middle) ? weak : strong) = middle;
+            }
+          // a margin for the rounding of the distances
+          range = weak * 1.001;
         }
     }
+  NS_LOG_DEBUG ("range at " << txPowerDbm << "dBm: " << range << "m");
+  m_ranges[txPowerDbm] = range;
+  return range;
 }
 
 void
@@ -157,6 +503,18 @@ YansWifiChannel::Add (Ptr<YansWifiPhy> phy)
   m_phyList.push_back (phy);
 }
 
+uint64_t
+YansWifiChannel::GetNCacheHits (void) const
+{
+  return m_cacheHits;
+}
+
+uint64_t
+YansWifiChannel::GetNCacheMisses (void) const
+{
+  return m_cacheMisses;
+}
+
 int64_t
 YansWifiChannel::AssignStreams (int64_t stream)
 {
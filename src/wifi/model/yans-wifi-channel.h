@@ -22,10 +22,17 @@
 #define YANS_WIFI_CHANNEL_H
 
 #include "ns3/channel.h"
+#include "ns3/callback.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
@@ -41,6 +48,29 @@ class WifiPpdu;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * With the SpatialIndex attribute, the receivers are kept in a uniform
+ * grid of their positions, updated when their mobility model notifies a
+ * course change, and Send() only considers those of the cells within
+ * range of the sender.  The range is the CullingRange attribute or,
+ * when it is 0 and both propagation models are deterministic functions
+ * of the distance (Friis, log-distance, three log-distance and range
+ * loss models, constant speed delay model), the distance beyond which
+ * the received power is below the sensitivity of every receiver.  The
+ * receivers within range get exactly the same receive events as
+ * without the index; the others would have dropped the signal as too
+ * weak.  Nodes which move without notifying course changes must bound
+ * their speed with the MaxSpeed attribute.
+ *
+ * With the PropagationCache attribute, and the same deterministic
+ * models, the received power and the delay computed for a pair of PHYs
+ * are kept and reused for the next PPDUs of the sender at the same TX
+ * power.  A result is dropped when the mobility model of either PHY
+ * notifies a course change, or when either PHY has moved by more than
+ * the CacheTolerance attribute from where it was computed.  With a
+ * tolerance of 0 the positions must be unchanged, and the cached
+ * results are exactly those the models would give; a larger tolerance
+ * trades that accuracy for the PHYs which keep moving.
  */
 class YansWifiChannel : public Channel
 {
@@ -96,6 +126,16 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \return the number of receptions whose received power and delay
+   *         were found in the propagation cache
+   */
+  uint64_t GetNCacheHits (void) const;
+  /**
+   * \return the number of receptions whose received power and delay
+   *         were computed and stored in the propagation cache
+   */
+  uint64_t GetNCacheMisses (void) const;
 
 private:
   /**
@@ -114,9 +154,126 @@ private:
    */
   static void Receive (Ptr<YansWifiPhy> receiver, Ptr<WifiPpdu> ppdu, double txPowerDbm);
 
+  void DoDispose (void) override;
+
+  /// A PHY in the spatial index or the propagation cache.
+  struct IndexEntry
+  {
+    Ptr<MobilityModel> mobility;                         //!< Its mobility model
+    Callback<void, Ptr<const MobilityModel> > courseChange; //!< Connected to its CourseChange
+    Vector position;                                     //!< Its position when last indexed
+    uint64_t cell;                                       //!< Key of its cell
+    uint32_t epoch;                                      //!< Number of course changes
+  };
+
+  /// The propagation between two PHYs, computed once.
+  struct CacheEntry
+  {
+    double txPowerDbm;   //!< The TX power it was computed for, in dBm
+    Vector txPosition;   //!< The position of the sender
+    Vector rxPosition;   //!< The position of the receiver
+    uint32_t txEpoch;    //!< The epoch of the sender
+    uint32_t rxEpoch;    //!< The epoch of the receiver
+    double rxPowerDbm;   //!< The received power, in dBm
+    Time delay;          //!< The propagation delay
+  };
+
+  /**
+   * Schedule the reception of a PPDU by one PHY.
+   *
+   * \param sender the PHY object from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param index the index in m_phyList of the PHY to deliver the PPDU to
+   * \param ppdu the PPDU to send
+   * \param txPowerDbm the TX power associated to the packet, in dBm
+   * \param cached whether to look the propagation up in the cache
+   */
+  void SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility,
+               uint32_t index, Ptr<const WifiPpdu> ppdu, double txPowerDbm,
+               bool cached) const;
+  /**
+   * Look up the propagation between two PHYs in the cache, computing
+   * it on a miss.
+   *
+   * \param receiver the index in m_phyList of the receiving PHY
+   * \param senderMobility the mobility model of the sender
+   * \param receiverMobility the mobility model of the receiver
+   * \param txPowerDbm the TX power, in dBm
+   * \return the cached result
+   */
+  const CacheEntry &GetCached (uint32_t receiver, Ptr<MobilityModel> senderMobility,
+                               Ptr<MobilityModel> receiverMobility, double txPowerDbm) const;
+
+  /**
+   * \param x the column of a cell
+   * \param y the row of a cell
+   * \return the key of the cell
+   */
+  static uint64_t GetCellKey (int64_t x, int64_t y);
+  /**
+   * \param coordinate a coordinate, in meters
+   * \return the column or row of the cells holding it
+   */
+  int64_t GetCellIndex (double coordinate) const;
+  /**
+   * Index the PHYs added since the last call, and all positions again.
+   *
+   * \param txPowerDbm the TX power, in dBm, which sizes the cells of a
+   *        new index
+   */
+  void BuildIndex (double txPowerDbm) const;
+  /** Follow the course changes of the PHYs added since the last call. */
+  void TrackPhys (void) const;
+  /**
+   * Count a course change of a PHY and, with the spatial index, move
+   * it to the cell of its current position.
+   *
+   * \param channel the channel
+   * \param index the index of the PHY in m_phyList
+   * \param mobility its mobility model
+   */
+  static void CourseChanged (const YansWifiChannel *channel, uint32_t index,
+                             Ptr<const MobilityModel> mobility);
+  /**
+   * \return true if the received power and the delay only depend on
+   *         the distance, without random variables.
+   */
+  bool IsDeterministic (void) const;
+  /**
+   * \param txPowerDbm the TX power, in dBm
+   * \return the distance beyond which no PHY can receive, infinite if
+   *         it cannot be determined
+   */
+  double GetRange (double txPowerDbm) const;
+  /**
+   * \param a a position
+   * \param b another position
+   * \return true if they are close enough for a cached result
+   */
+  bool IsWithinTolerance (const Vector &a, const Vector &b) const;
+
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+
+  bool m_spatialIndex;                 //!< Whether receivers out of range are skipped
+  double m_cullingRange;               //!< Range given by the user, 0 to derive it
+  double m_maxSpeed;                   //!< Bound on the speed of the PHYs, in m/s
+  bool m_propagationCache;             //!< Whether the propagation results are cached
+  double m_cacheTolerance;             //!< Distance a PHY may move before its results are dropped, in m
+
+  mutable std::vector<IndexEntry> m_entries;   //!< The indexed PHYs, in the order of m_phyList
+  mutable std::unordered_map<uint64_t, std::vector<uint32_t> > m_cells; //!< PHYs of each non-empty cell
+  mutable double m_cellSize;                   //!< Size of the cells, 0 before the first Send
+  mutable Time m_indexTime;                    //!< Time of the last indexing of all positions
+  mutable double m_threshold;                  //!< Lowest RX sensitivity minus RX gain of the PHYs, in dBm
+  mutable std::map<double, double> m_ranges;   //!< Derived range of each TX power
+  mutable std::vector<uint32_t> m_candidates;  //!< Scratch list of the PHYs in range
+  mutable std::unordered_map<uint64_t, CacheEntry> m_cache; //!< Propagation of each (sender, receiver) pair
+  mutable uint32_t m_sender;                   //!< Index of the PHY sending, with the cache
+  mutable Vector m_senderPosition;             //!< Position of the PHY sending, with the cache
+  mutable uint64_t m_cacheHits;                //!< Receptions found in the cache
+  mutable uint64_t m_cacheMisses;              //!< Receptions computed for the cache
 };
 
 } //namespace ns3
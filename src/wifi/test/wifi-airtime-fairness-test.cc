@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/pointer.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/packet-socket-client.h"
+#include "ns3/packet-socket-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/wifi-mac.h"
+#include "ns3/ssid.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/qos-txop.h"
+#include <map>
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Test the airtime deficit round robin of the QosTxop of an AP
+ *
+ * The AP sends saturated downlink traffic to two stations, large frames
+ * to the first one and small frames to the second one, at the same MCS.
+ * In FIFO order both stations get about as many A-MPDUs, hence the first
+ * station gets most of the airtime.  With airtime fairness, both stations
+ * get about half of the airtime.
+ */
+class WifiAirtimeFairnessTest : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param airtimeFairness whether the AP schedules the stations by airtime
+   */
+  WifiAirtimeFairnessTest (bool airtimeFairness);
+
+  /**
+   * Callback invoked when the AP transmits QoS Data frames to a station
+   * \param station the receiver
+   * \param airtime the duration of the PPDU
+   */
+  void Airtime (Mac48Address station, Time airtime);
+
+private:
+  void DoRun (void) override;
+
+  bool m_airtimeFairness;                  ///< whether airtime fairness is enabled
+  std::map<Mac48Address, Time> m_airtime;  ///< airtime used by each station
+};
+
+WifiAirtimeFairnessTest::WifiAirtimeFairnessTest (bool airtimeFairness)
+  : TestCase (std::string ("Check the airtime shares of the stations, airtime fairness ")
+              + (airtimeFairness ? "enabled" : "disabled")),
+    m_airtimeFairness (airtimeFairness)
+{
+}
+
+void
+WifiAirtimeFairnessTest::Airtime (Mac48Address station, Time airtime)
+{
+  m_airtime[station] += airtime;
+}
+
+void
+WifiAirtimeFairnessTest::DoRun (void)
+{
+  RngSeedManager::SetSeed (1);
+  RngSeedManager::SetRun (1);
+  int64_t streamNumber = 100;
+
+  NodeContainer wifiApNode (1);
+  NodeContainer wifiStaNodes (2);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy;
+  phy.SetChannel (channel.Create ());
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211ac);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("VhtMcs7"),
+                                "ControlMode", StringValue ("VhtMcs0"));
+
+  WifiMacHelper mac;
+  Ssid ssid ("wifi-airtime-ssid");
+  mac.SetType ("ns3::StaWifiMac", "Ssid", SsidValue (ssid));
+  NetDeviceContainer staDevices = wifi.Install (phy, mac, wifiStaNodes);
+
+  mac.SetType ("ns3::ApWifiMac", "Ssid", SsidValue (ssid));
+  NetDeviceContainer apDevices = wifi.Install (phy, mac, wifiApNode);
+
+  wifi.AssignStreams (apDevices, streamNumber);
+  wifi.AssignStreams (staDevices, streamNumber);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (1.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (0.0, 1.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (wifiApNode);
+  mobility.Install (wifiStaNodes);
+
+  Ptr<WifiNetDevice> apDevice = DynamicCast<WifiNetDevice> (apDevices.Get (0));
+  PointerValue ptr;
+  apDevice->GetMac ()->GetAttribute ("BE_Txop", ptr);
+  Ptr<QosTxop> edca = ptr.Get<QosTxop> ();
+  edca->SetAttribute ("AirtimeFairness", BooleanValue (m_airtimeFairness));
+  edca->TraceConnectWithoutContext ("Airtime", MakeCallback (&WifiAirtimeFairnessTest::Airtime, this));
+  // keep both stations backlogged during the whole measurement
+  edca->GetWifiMacQueue ()->SetMaxSize (QueueSize ("20000p"));
+
+  PacketSocketHelper packetSocket;
+  packetSocket.Install (wifiApNode);
+  packetSocket.Install (wifiStaNodes);
+
+  // DL frames, large ones to the first station and small ones to the second one
+  const uint32_t packetSizes[] = {1400, 200};
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      PacketSocketAddress socket;
+      socket.SetSingleDevice (apDevice->GetIfIndex ());
+      socket.SetPhysicalAddress (staDevices.Get (i)->GetAddress ());
+      socket.SetProtocol (1);
+
+      Ptr<PacketSocketClient> client = CreateObject<PacketSocketClient> ();
+      client->SetAttribute ("PacketSize", UintegerValue (packetSizes[i]));
+      client->SetAttribute ("MaxPackets", UintegerValue (0));
+      client->SetAttribute ("Interval", TimeValue (MicroSeconds (10)));
+      client->SetRemote (socket);
+      wifiApNode.Get (0)->AddApplication (client);
+      client->SetStartTime (MilliSeconds (500));
+      client->SetStopTime (MilliSeconds (600));
+    }
+
+  Simulator::Stop (MilliSeconds (600));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_airtime.size (), 2, "Both stations should have been served");
+  Time large = m_airtime[Mac48Address::ConvertFrom (staDevices.Get (0)->GetAddress ())];
+  Time small = m_airtime[Mac48Address::ConvertFrom (staDevices.Get (1)->GetAddress ())];
+  double share = large.GetSeconds () / (large + small).GetSeconds ();
+
+  if (m_airtimeFairness)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (share, 0.5, 0.05, "The stations should share the airtime equally");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_GT (share, 0.7, "The station of the large frames should get most of the airtime");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Airtime Fairness Test Suite
+ */
+class WifiAirtimeFairnessTestSuite : public TestSuite
+{
+public:
+  WifiAirtimeFairnessTestSuite ();
+};
+
+WifiAirtimeFairnessTestSuite::WifiAirtimeFairnessTestSuite ()
+  : TestSuite ("wifi-airtime-fairness", UNIT)
+{
+  AddTestCase (new WifiAirtimeFairnessTest (false), TestCase::QUICK);
+  AddTestCase (new WifiAirtimeFairnessTest (true), TestCase::QUICK);
+}
+
+static WifiAirtimeFairnessTestSuite g_wifiAirtimeFairnessTestSuite; ///< the test suite
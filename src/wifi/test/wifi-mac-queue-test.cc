@@ -21,6 +21,8 @@
 #include "ns3/test.h"
 #include "ns3/wifi-mac-queue.h"
 #include "ns3/simulator.h"
+#include "ns3/mac48-address.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -107,6 +109,176 @@ WifiMacQueueDropOldestTest::DoRun ()
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Test the per receiver and TID sublists of the queue.
+ *
+ * Packets for two receivers and two TIDs are enqueued at the end and at the
+ * front of the queue, replaced, removed and let expire.  After each step,
+ * the packets returned by PeekByTidAndAddress, and their number, must be
+ * those found by a scan of the whole queue, and only the pairs having
+ * queued packets must have a sublist.
+ */
+class WifiMacQueueSublistTest : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  WifiMacQueueSublistTest ();
+
+  void DoRun () override;
+
+private:
+  /**
+   * Create a QoS data packet
+   * \param receiver the receiver
+   * \param tid the TID
+   * \return the packet
+   */
+  Ptr<WifiMacQueueItem> CreateItem (Mac48Address receiver, uint8_t tid);
+  /**
+   * Check the sublists of the queue against a scan of the whole queue
+   * \param step the step being checked
+   */
+  void CheckSublists (std::string step);
+
+  Ptr<WifiMacQueue> m_queue;             ///< the queue
+  std::vector<Mac48Address> m_receivers; ///< the receivers
+};
+
+WifiMacQueueSublistTest::WifiMacQueueSublistTest ()
+  : TestCase ("Test the per receiver and TID sublists")
+{
+}
+
+Ptr<WifiMacQueueItem>
+WifiMacQueueSublistTest::CreateItem (Mac48Address receiver, uint8_t tid)
+{
+  WifiMacHeader header;
+  header.SetType (WIFI_MAC_QOSDATA);
+  header.SetAddr1 (receiver);
+  header.SetQosTid (tid);
+  return Create<WifiMacQueueItem> (Create<Packet> (100), header);
+}
+
+void
+WifiMacQueueSublistTest::CheckSublists (std::string step)
+{
+  uint32_t nSublists = 0;
+  for (const auto& receiver : m_receivers)
+    {
+      for (uint8_t tid : {0, 3})
+        {
+          std::vector<Ptr<const WifiMacQueueItem>> expected;
+          uint32_t expectedBytes = 0;
+          for (auto it = m_queue->begin (); it != m_queue->end (); it++)
+            {
+              if ((*it)->GetHeader ().GetAddr1 () == receiver && (*it)->GetHeader ().GetQosTid () == tid)
+                {
+                  expected.push_back (*it);
+                  expectedBytes += (*it)->GetSize ();
+                }
+            }
+          nSublists += (expected.empty () ? 0 : 1);
+          NS_TEST_EXPECT_MSG_EQ (m_queue->GetNBytes (tid, receiver), expectedBytes,
+                                 step << ": unexpected number of bytes for " << receiver << " TID " << +tid);
+          NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (tid, receiver), expected.size (),
+                                 step << ": unexpected number of packets for " << receiver << " TID " << +tid);
+
+          Ptr<const WifiMacQueueItem> item = m_queue->PeekByTidAndAddress (tid, receiver);
+          for (const auto& expectedItem : expected)
+            {
+              NS_TEST_ASSERT_MSG_EQ (item, expectedItem,
+                                     step << ": unexpected packet for " << receiver << " TID " << +tid);
+              item = m_queue->PeekByTidAndAddress (tid, receiver, item);
+            }
+          NS_TEST_EXPECT_MSG_EQ (item, nullptr,
+                                 step << ": unexpected packet after the last one for " << receiver);
+
+          // the search can also start after a packet of another sublist
+          if (!expected.empty ())
+            {
+              Ptr<const WifiMacQueueItem> other = *m_queue->begin ();
+              Ptr<const WifiMacQueueItem> next = nullptr;
+              for (auto it = std::next (m_queue->begin ()); it != m_queue->end () && next == nullptr; it++)
+                {
+                  if ((*it)->GetHeader ().GetAddr1 () == receiver && (*it)->GetHeader ().GetQosTid () == tid)
+                    {
+                      next = *it;
+                    }
+                }
+              NS_TEST_EXPECT_MSG_EQ (m_queue->PeekByTidAndAddress (tid, receiver, other), next,
+                                     step << ": unexpected packet following the head of the queue");
+            }
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNSublists (), nSublists, step << ": unexpected number of sublists");
+}
+
+void
+WifiMacQueueSublistTest::DoRun ()
+{
+  m_queue = CreateObject<WifiMacQueue> (AC_BE);
+  m_queue->SetMaxSize (QueueSize ("100p"));
+  m_receivers = {Mac48Address ("00:00:00:00:00:01"), Mac48Address ("00:00:00:00:00:02")};
+
+  // interleave the receivers and the TIDs
+  for (uint32_t i = 0; i < 12; i++)
+    {
+      m_queue->Enqueue (CreateItem (m_receivers[i % 2], (i % 3 == 0 ? 3 : 0)));
+    }
+  CheckSublists ("Enqueue");
+
+  m_queue->PushFront (CreateItem (m_receivers[1], 0));
+  m_queue->PushFront (CreateItem (m_receivers[0], 3));
+  CheckSublists ("PushFront");
+
+  // replace a packet in the middle of the queue
+  Ptr<const WifiMacQueueItem> middle = *std::next (m_queue->begin (), 7);
+  m_queue->Replace (middle, CreateItem (middle->GetHeader ().GetAddr1 (), middle->GetHeader ().GetQosTid ()));
+  CheckSublists ("Replace");
+
+  Ptr<const WifiMacQueueItem> third = *std::next (m_queue->begin (), 2);
+  m_queue->Remove (third);
+  m_queue->Dequeue ();
+  CheckSublists ("Remove");
+
+  // the packets enqueued later expire later
+  m_queue->SetMaxDelay (MilliSeconds (10));
+  Simulator::Schedule (MilliSeconds (5), [this] ()
+    {
+      for (uint32_t i = 0; i < 4; i++)
+        {
+          m_queue->Enqueue (CreateItem (m_receivers[0], 0));
+        }
+    });
+  Simulator::Schedule (MilliSeconds (12), [this] ()
+    {
+      for (const auto& receiver : m_receivers)
+        {
+          for (uint8_t tid : {0, 3})
+            {
+              uint32_t expected = (receiver == m_receivers[0] && tid == 0 ? 4 : 0);
+              NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPacketsByTidAndAddress (tid, receiver), expected,
+                                     "Only the packets enqueued later should not be expired");
+            }
+        }
+      CheckSublists ("Expire");
+
+      while (m_queue->Dequeue () != nullptr)
+        {
+        }
+      CheckSublists ("Empty");
+    });
+  Simulator::Run ();
+
+  m_queue = nullptr;
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -123,6 +295,7 @@ WifiMacQueueTestSuite::WifiMacQueueTestSuite ()
   : TestSuite ("wifi-mac-queue", UNIT)
 {
   AddTestCase (new WifiMacQueueDropOldestTest, TestCase::QUICK);
+  AddTestCase (new WifiMacQueueSublistTest, TestCase::QUICK);
 }
 
 static WifiMacQueueTestSuite g_wifiMacQueueTestSuite; ///< the test suite
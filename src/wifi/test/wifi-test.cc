@@ -22,6 +22,9 @@
  */
 
 #include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include "ns3/yans-wifi-helper.h"
 #include "ns3/mobility-helper.h"
 #include "ns3/wifi-net-device.h"
@@ -31,6 +34,7 @@
 #include "ns3/interference-helper.h"
 #include "ns3/yans-error-rate-model.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/test.h"
 #include "ns3/pointer.h"
 #include "ns3/rng-seed-manager.h"
@@ -3151,6 +3155,306 @@ HeRuMcsDataRateTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (retval, true, "Data rate verification for RUs above 52-tone RU (included) failed");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel spatial index test
+ *
+ * Nodes spread along a line broadcast frames; one of them moves to the
+ * other end between its two transmissions.  The receptions must be the
+ * same with and without the spatial index of the channel, which must
+ * schedule fewer events.
+ */
+class YansWifiChannelSpatialIndexTest : public TestCase
+{
+public:
+  YansWifiChannelSpatialIndexTest ();
+
+  void DoRun (void) override;
+
+private:
+  /// A received frame.
+  struct Reception
+  {
+    int64_t time;      ///< reception time, in time steps
+    uint32_t receiver; ///< index of the receiving node
+    double signal;     ///< signal power (dBm)
+  };
+
+  /**
+   * Record a received frame.
+   * \param receiver index of the receiving node
+   * \param packet the packet
+   * \param channelFreqMhz the channel frequency
+   * \param txVector the TX vector
+   * \param aMpdu the A-MPDU information
+   * \param signalNoise the signal and noise powers
+   * \param staId the STA-ID
+   */
+  void Receive (uint32_t receiver, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise, uint16_t staId);
+  /**
+   * Send one broadcast frame.
+   * \param dev the device
+   */
+  void SendOnePacket (Ptr<NetDevice> dev);
+  /**
+   * Run the scenario.
+   * \param index whether the channel uses its spatial index
+   * \return the number of events run
+   */
+  uint64_t RunOne (bool index);
+
+  std::vector<Reception> m_receptions; ///< the received frames
+};
+
+YansWifiChannelSpatialIndexTest::YansWifiChannelSpatialIndexTest ()
+  : TestCase ("Spatial index of YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelSpatialIndexTest::Receive (uint32_t receiver, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                                          WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise,
+                                          uint16_t staId)
+{
+  m_receptions.push_back ({Simulator::Now ().GetTimeStep (), receiver, signalNoise.signal});
+}
+
+void
+YansWifiChannelSpatialIndexTest::SendOnePacket (Ptr<NetDevice> dev)
+{
+  dev->Send (Create<Packet> (100), dev->GetBroadcast (), 1);
+}
+
+uint64_t
+YansWifiChannelSpatialIndexTest::RunOne (bool index)
+{
+  m_receptions.clear ();
+  const uint32_t nNodes = 41;
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (30),
+                                 "GridWidth", UintegerValue (nNodes));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  Ptr<YansWifiChannel> yansChannel = channel.Create ();
+  yansChannel->SetAttribute ("SpatialIndex", BooleanValue (index));
+  YansWifiPhyHelper phy;
+  phy.SetChannel (yansChannel);
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<WifiPhy> wifiPhy = DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ();
+      wifiPhy->TraceConnectWithoutContext ("MonitorSnifferRx",
+                                           MakeCallback (&YansWifiChannelSpatialIndexTest::Receive, this)
+                                             .Bind (i));
+      Simulator::Schedule (Seconds (1) + MilliSeconds (10 * i),
+                           &YansWifiChannelSpatialIndexTest::SendOnePacket, this, devices.Get (i));
+    }
+  // the first node moves to the other end of the line, and sends again
+  Ptr<MobilityModel> moving = nodes.Get (0)->GetObject<MobilityModel> ();
+  Simulator::Schedule (Seconds (2), &MobilityModel::SetPosition, moving, Vector (1230, 0, 0));
+  Simulator::Schedule (Seconds (3), &YansWifiChannelSpatialIndexTest::SendOnePacket, this, devices.Get (0));
+
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return events;
+}
+
+void
+YansWifiChannelSpatialIndexTest::DoRun (void)
+{
+  uint64_t eventsWithout = RunOne (false);
+  std::vector<Reception> expected = m_receptions;
+  uint64_t eventsWith = RunOne (true);
+
+  NS_TEST_ASSERT_MSG_GT (expected.size (), 41, "frames received by the neighbors");
+  NS_TEST_ASSERT_MSG_EQ (m_receptions.size (), expected.size (), "same number of receptions");
+  for (std::size_t i = 0; i < expected.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_receptions[i].time, expected[i].time, "time of reception " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_receptions[i].receiver, expected[i].receiver, "receiver of reception " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_receptions[i].signal, expected[i].signal, "signal of reception " << i);
+    }
+  // after its move, the first node is only heard at the other end
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (expected.back ().receiver, 30, "last frame received at the other end");
+  NS_TEST_EXPECT_MSG_LT (eventsWith, eventsWithout, "receivers out of range skipped");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief YansWifiChannel propagation cache test
+ *
+ * Static nodes and one slowly moving node broadcast frames.  With an
+ * exact cache the receptions must be the same as without the cache,
+ * and the static pairs must hit the cache; with a tolerance the frames
+ * of the moving node hit it too, at the cost of a small error on their
+ * received power.
+ */
+class YansWifiChannelPropagationCacheTest : public TestCase
+{
+public:
+  YansWifiChannelPropagationCacheTest ();
+
+  void DoRun (void) override;
+
+private:
+  /// A received frame.
+  struct Reception
+  {
+    int64_t time;      ///< reception time, in time steps
+    uint32_t receiver; ///< index of the receiving node
+    double signal;     ///< signal power (dBm)
+  };
+
+  /**
+   * Record a received frame.
+   * \param receiver index of the receiving node
+   * \param packet the packet
+   * \param channelFreqMhz the channel frequency
+   * \param txVector the TX vector
+   * \param aMpdu the A-MPDU information
+   * \param signalNoise the signal and noise powers
+   * \param staId the STA-ID
+   */
+  void Receive (uint32_t receiver, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise, uint16_t staId);
+  /**
+   * Send one broadcast frame.
+   * \param dev the device
+   */
+  void SendOnePacket (Ptr<NetDevice> dev);
+  /**
+   * Run the scenario.
+   * \param cache whether the channel caches the propagation
+   * \param tolerance the tolerance of the cache, in meters
+   * \return the channel
+   */
+  Ptr<YansWifiChannel> RunOne (bool cache, double tolerance);
+
+  std::vector<Reception> m_receptions; ///< the received frames
+};
+
+YansWifiChannelPropagationCacheTest::YansWifiChannelPropagationCacheTest ()
+  : TestCase ("Propagation cache of YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelPropagationCacheTest::Receive (uint32_t receiver, Ptr<const Packet> packet, uint16_t channelFreqMhz,
+                                              WifiTxVector txVector, MpduInfo aMpdu, SignalNoiseDbm signalNoise,
+                                              uint16_t staId)
+{
+  m_receptions.push_back ({Simulator::Now ().GetTimeStep (), receiver, signalNoise.signal});
+}
+
+void
+YansWifiChannelPropagationCacheTest::SendOnePacket (Ptr<NetDevice> dev)
+{
+  dev->Send (Create<Packet> (100), dev->GetBroadcast (), 1);
+}
+
+Ptr<YansWifiChannel>
+YansWifiChannelPropagationCacheTest::RunOne (bool cache, double tolerance)
+{
+  m_receptions.clear ();
+  const uint32_t nNodes = 5;
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "DeltaX", DoubleValue (10),
+                                 "GridWidth", UintegerValue (nNodes));
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (nodes);
+  // the first node moves away at 1 m/s, without course changes
+  nodes.Get (0)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (-1, 0, 0));
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  Ptr<YansWifiChannel> yansChannel = channel.Create ();
+  yansChannel->SetAttribute ("PropagationCache", BooleanValue (cache));
+  yansChannel->SetAttribute ("CacheTolerance", DoubleValue (tolerance));
+  YansWifiPhyHelper phy;
+  phy.SetChannel (yansChannel);
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("OfdmRate6Mbps"));
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+  wifi.AssignStreams (devices, 1);
+
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<WifiPhy> wifiPhy = DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ();
+      wifiPhy->TraceConnectWithoutContext ("MonitorSnifferRx",
+                                           MakeCallback (&YansWifiChannelPropagationCacheTest::Receive, this)
+                                             .Bind (i));
+      for (uint32_t k = 0; k < 10; ++k)
+        {
+          Simulator::Schedule (Seconds (1) + MilliSeconds (100 * k + 10 * i),
+                               &YansWifiChannelPropagationCacheTest::SendOnePacket, this, devices.Get (i));
+        }
+    }
+
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  return yansChannel;
+}
+
+void
+YansWifiChannelPropagationCacheTest::DoRun (void)
+{
+  // 5 nodes send 10 frames to 4 others
+  const uint64_t nPairs = 5 * 10 * 4;
+  RunOne (false, 0);
+  std::vector<Reception> expected = m_receptions;
+  NS_TEST_ASSERT_MSG_EQ (expected.size (), nPairs, "every frame received by every other node");
+
+  Ptr<YansWifiChannel> exact = RunOne (true, 0);
+  NS_TEST_ASSERT_MSG_EQ (m_receptions.size (), expected.size (), "same number of receptions");
+  for (std::size_t i = 0; i < expected.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_receptions[i].time, expected[i].time, "time of reception " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_receptions[i].receiver, expected[i].receiver, "receiver of reception " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_receptions[i].signal, expected[i].signal, "signal of reception " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (exact->GetNCacheHits () + exact->GetNCacheMisses (), nPairs, "every reception looked up");
+  // the pairs of static nodes are computed once
+  NS_TEST_EXPECT_MSG_EQ (exact->GetNCacheMisses (), 4 * 3 + 10 * 4 + 4 * 10, "misses on the moving node");
+
+  // the first node moves by 2 m in the run, within the tolerance
+  Ptr<YansWifiChannel> bounded = RunOne (true, 3);
+  NS_TEST_ASSERT_MSG_EQ (m_receptions.size (), expected.size (), "same number of receptions");
+  NS_TEST_EXPECT_MSG_EQ (bounded->GetNCacheMisses (), 5 * 4, "each pair computed once");
+  for (std::size_t i = 0; i < expected.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_receptions[i].receiver, expected[i].receiver, "receiver of reception " << i);
+      // at most 3 m further from a node 10 m away, with an exponent of 3
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_receptions[i].signal, expected[i].signal, 30 * std::log10 (1.3),
+                                 "signal of reception " << i);
+    }
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -3183,6 +3487,8 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new IdealRateManagerChannelWidthTest, TestCase::QUICK);
   AddTestCase (new IdealRateManagerMimoTest, TestCase::QUICK);
   AddTestCase (new HeRuMcsDataRateTestCase, TestCase::QUICK);
+  AddTestCase (new YansWifiChannelSpatialIndexTest, TestCase::QUICK);
+  AddTestCase (new YansWifiChannelPropagationCacheTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite
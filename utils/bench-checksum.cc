@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks Buffer::Iterator::CalculateIpChecksum on
+// UDP-like datagrams (an 8 byte header before the payload) of 64 bytes
+// to 9 kB, against the sum of the words read one at a time with
+// Buffer::Iterator::ReadU16.  With --zero, the payload is left in the
+// zero area of the buffer, as the payload of Create<Packet> (size) is.
+// Sample usage:
+//   ./ns3 run 'bench-checksum --bytes=100000000'
+//   ./ns3 run 'bench-checksum --zero'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/buffer.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * The checksum of words read one at a time.
+ * \param i the start of the bytes
+ * \param size the number of bytes
+ * \return the checksum
+ */
+static uint16_t
+ReadChecksum (Buffer::Iterator i, uint16_t size)
+{
+  uint32_t sum = 0;
+  for (int j = 0; j < size / 2; j++)
+    {
+      sum += i.ReadU16 ();
+    }
+  if (size & 1)
+    {
+      sum += i.ReadU8 ();
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+/**
+ * Time the checksums of a buffer.
+ * \param buffer the buffer
+ * \param iterations the number of checksums
+ * \param words whether to read the words one at a time
+ * \param checksum the last checksum
+ * \return the time taken, in ms
+ */
+static int64_t
+Run (const Buffer &buffer, uint32_t iterations, bool words, uint16_t &checksum)
+{
+  const uint16_t size = buffer.GetSize ();
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t n = 0; n < iterations; n++)
+    {
+      checksum = words ? ReadChecksum (buffer.Begin (), size) : buffer.Begin ().CalculateIpChecksum (size);
+    }
+  return time.End ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint64_t bytes = 100000000;
+  bool zero = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the IP checksum of buffers of 64 bytes to 9 kB.");
+  cmd.AddValue ("bytes", "bytes summed for each size", bytes);
+  cmd.AddValue ("zero", "leave the payload in the zero area", zero);
+  cmd.Parse (argc, argv);
+
+  const uint32_t sizes[] = {64, 128, 256, 512, 1024, 1500, 4096, 9000};
+  std::cout << std::setw (6) << "size" << std::setw (14) << "checksum/s"
+            << std::setw (14) << "ReadU16/s" << std::setw (10) << "speedup" << std::endl;
+  for (uint32_t size : sizes)
+    {
+      const uint32_t header = 8;
+      Buffer buffer (zero ? size - header : 0);
+      buffer.AddAtStart (zero ? header : size);
+      Buffer::Iterator i = buffer.Begin ();
+      for (uint32_t j = 0; j < (zero ? header : size); j++)
+        {
+          i.WriteU8 (j * 7 + 1);
+        }
+
+      const uint32_t iterations = std::max<uint64_t> (bytes / size, 1);
+      uint16_t fast;
+      uint16_t slow;
+      const int64_t fastMs = std::max<int64_t> (Run (buffer, iterations, false, fast), 1);
+      const int64_t slowMs = std::max<int64_t> (Run (buffer, iterations, true, slow), 1);
+      if (fast != slow)
+        {
+          std::cerr << "checksum mismatch for " << size << " bytes" << std::endl;
+          return 1;
+        }
+      std::cout << std::setw (6) << size
+                << std::setw (14) << uint64_t (iterations * 1000.0 / fastMs)
+                << std::setw (14) << uint64_t (iterations * 1000.0 / slowMs)
+                << std::setw (10) << std::fixed << std::setprecision (1) << double (slowMs) / fastMs
+                << std::endl;
+    }
+  return 0;
+}
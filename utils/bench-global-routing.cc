@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the computation of the global routes: routers
+// on square grids, each attached to the CSMA LAN of its row and to the
+// one of its column, as APs attached to several backbone segments.  The
+// routers are split into --clusters grids, not connected to each other.
+// It measures the time to build the link state database and to compute
+// the routes of all routers, in --threads threads, then the time to
+// recompute them after a router goes down, with --incremental only for
+// the routers which can reach it.
+// Sample usage:
+//   ./ns3 run 'bench-global-routing --routers=1000'
+//   ./ns3 run 'bench-global-routing --routers=1000 --threads=4'
+//   ./ns3 run 'bench-global-routing --routers=1000 --clusters=10 --incremental'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/csma-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include <cmath>
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * \param nodes the routers
+ * \return the number of routes of the routers
+ */
+static uint64_t
+CountRoutes (NodeContainer nodes)
+{
+  uint64_t count = 0;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      count += (*i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ()->GetNRoutes ();
+    }
+  return count;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t routers = 1000;
+  uint32_t clusters = 1;
+  uint32_t threads = 1;
+  bool incremental = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the computation of the global routes.");
+  cmd.AddValue ("routers", "number of routers", routers);
+  cmd.AddValue ("clusters", "number of grids the routers are split into", clusters);
+  cmd.AddValue ("threads", "threads computing the routes, 0 for one per core", threads);
+  cmd.AddValue ("incremental", "only recompute the routes of the routers affected", incremental);
+  cmd.Parse (argc, argv);
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (threads));
+
+  NodeContainer nodes;
+  nodes.Create (routers);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  CsmaHelper csma;
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  uint32_t lans = 0;
+  for (uint32_t cluster = 0; cluster < clusters; ++cluster)
+    {
+      const uint32_t first = routers * cluster / clusters;
+      const uint32_t size = routers * (cluster + 1) / clusters - first;
+      const uint32_t side = std::ceil (std::sqrt (double (size)));
+      for (uint32_t lan = 0; lan < 2 * side; ++lan)
+        {
+          NodeContainer members;
+          for (uint32_t i = 0; i < size; ++i)
+            {
+              // the LANs of the rows, then those of the columns
+              if (lan < side ? i / side == lan : i % side == lan - side)
+                {
+                  members.Add (nodes.Get (first + i));
+                }
+            }
+          if (members.GetN () > 1)
+            {
+              address.Assign (csma.Install (members));
+              address.NewNetwork ();
+              lans++;
+            }
+        }
+    }
+
+  SystemWallClockMs time;
+  time.Start ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  const int64_t database = time.End ();
+  time.Start ();
+  GlobalRouteManager::InitializeRoutes ();
+  const int64_t routes = time.End ();
+  std::cout << routers << " routers, " << lans << " LANs: database built in " << database
+            << " ms, " << CountRoutes (nodes) << " routes computed in " << routes << " ms" << std::endl;
+
+  // the last router goes down
+  Ptr<Ipv4> ipv4 = nodes.Get (routers - 1)->GetObject<Ipv4> ();
+  for (uint32_t i = 1; i < ipv4->GetNInterfaces (); ++i)
+    {
+      ipv4->SetDown (i);
+    }
+  time.Start ();
+  if (incremental)
+    {
+      Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+    }
+  else
+    {
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+    }
+  const int64_t recompute = time.End ();
+  std::cout << "router down: " << CountRoutes (nodes) << " routes recomputed in " << recompute << " ms" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
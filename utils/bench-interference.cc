@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the InterferenceHelper of a Wi-Fi PHY by
+// replaying a dense-contention trace: PPDUs from many stations which
+// overlap at one receiver.  The receiver locks on the PPDUs which find
+// it idle, and computes their header and payload SNR and PER, which are
+// summed into a checksum to compare implementations.
+// Sample usage:  ./ns3 run 'bench-interference --stations=40 --load=4'
+//
+// A trace can be written with --write and replayed with --trace; each
+// line holds the start (ns), the station, the size (bytes), the rate
+// (Mb/s) and the received power (dBm) of one PPDU.
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/double.h"
+#include "ns3/interference-helper.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/ofdm-phy.h"
+#include "ns3/wifi-phy.h"
+#include "ns3/wifi-ppdu.h"
+#include "ns3/wifi-psdu.h"
+#include "ns3/wifi-utils.h"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+/// A PPDU of the trace.
+struct TraceEntry
+{
+  int64_t start;   //!< Start time, in nanoseconds
+  uint32_t sta;    //!< Sending station
+  uint32_t size;   //!< PSDU size, in bytes
+  uint32_t rate;   //!< OFDM rate, in Mb/s
+  double powerDbm; //!< Received power, in dBm
+};
+
+/// Replays a trace on an InterferenceHelper.
+class Bench
+{
+public:
+  /**
+   * \param trace the PPDUs to replay
+   * \param ccaDbm the power below which the receiver does not lock
+   */
+  Bench (const std::vector<TraceEntry> &trace, double ccaDbm);
+  /**
+   * Replay the trace.
+   * \return the wall clock time, in milliseconds
+   */
+  int64_t Run (void);
+
+  uint64_t m_locked;      //!< PPDUs the receiver locked on
+  double m_snrSum;        //!< Sum of their SNRs (dB)
+  double m_perSum;        //!< Sum of their header and payload PERs
+
+private:
+  /**
+   * Add a PPDU of the trace to the interference.
+   * \param i its index in the trace
+   */
+  void Start (std::size_t i);
+  /**
+   * Compute the SNR and PER of the PPDU the receiver locked on.
+   * \param event its event
+   * \param payload the duration of its payload
+   */
+  void End (Ptr<Event> event, Time payload);
+
+  const std::vector<TraceEntry> &m_trace; //!< The trace
+  double m_ccaDbm;                         //!< Lock threshold, in dBm
+  Ptr<InterferenceHelper> m_interference;  //!< The helper benchmarked
+  bool m_rxing;                            //!< Whether the receiver is locked
+};
+
+Bench::Bench (const std::vector<TraceEntry> &trace, double ccaDbm)
+  : m_locked (0),
+    m_snrSum (0),
+    m_perSum (0),
+    m_trace (trace),
+    m_ccaDbm (ccaDbm),
+    m_rxing (false)
+{
+}
+
+void
+Bench::Start (std::size_t i)
+{
+  const TraceEntry &entry = m_trace[i];
+  WifiTxVector txVector (OfdmPhy::GetOfdmRate (entry.rate * 1000000), 0, WIFI_PREAMBLE_LONG,
+                         800, 1, 1, 0, 20, false);
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetQosTid (0);
+  Ptr<WifiPpdu> ppdu = Create<WifiPpdu> (Create<WifiPsdu> (Create<Packet> (entry.size), hdr), txVector);
+  Time duration = WifiPhy::CalculateTxDuration (ppdu->GetPsdu ()->GetSize (), txVector, WIFI_PHY_BAND_5GHZ);
+  RxPowerWattPerChannelBand rxPower;
+  rxPower.insert ({std::make_pair (0, 0), DbmToW (entry.powerDbm)});
+  Ptr<Event> event = m_interference->Add (ppdu, txVector, duration, rxPower);
+  if (!m_rxing && entry.powerDbm >= m_ccaDbm)
+    {
+      m_rxing = true;
+      m_interference->NotifyRxStart ();
+      Simulator::Schedule (duration, &Bench::End, this, event,
+                           duration - WifiPhy::CalculatePhyPreambleAndHeaderDuration (txVector));
+    }
+}
+
+void
+Bench::End (Ptr<Event> event, Time payload)
+{
+  const WifiSpectrumBand band = std::make_pair (0, 0);
+  PhyEntity::SnrPer header = m_interference->CalculatePhyHeaderSnrPer (event, 20, band,
+                                                                      WIFI_PPDU_FIELD_NON_HT_HEADER);
+  PhyEntity::SnrPer data = m_interference->CalculatePayloadSnrPer (event, 20, band, SU_STA_ID,
+                                                                   std::make_pair (Seconds (0), payload));
+  m_interference->NotifyRxEnd (Simulator::Now ());
+  m_rxing = false;
+  ++m_locked;
+  m_snrSum += RatioToDb (header.snr) + RatioToDb (data.snr);
+  m_perSum += header.per + data.per;
+}
+
+int64_t
+Bench::Run (void)
+{
+  m_interference = CreateObject<InterferenceHelper> ();
+  m_interference->SetNoiseFigure (DbToRatio (7));
+  m_interference->SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+  m_interference->AddBand (std::make_pair (0, 0));
+  for (std::size_t i = 0; i < m_trace.size (); ++i)
+    {
+      Simulator::Schedule (NanoSeconds (m_trace[i].start), &Bench::Start, this, i);
+    }
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  int64_t elapsed = time.End ();
+  Simulator::Destroy ();
+  m_interference->Dispose ();
+  return elapsed;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t stations = 40;
+  uint32_t frames = 200000;
+  double load = 4;
+  double ccaDbm = -82;
+  std::string traceFile;
+  std::string writeFile;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the InterferenceHelper on a dense-contention trace.");
+  cmd.AddValue ("stations", "number of contending stations", stations);
+  cmd.AddValue ("frames", "number of PPDUs of a generated trace", frames);
+  cmd.AddValue ("load", "mean number of overlapping PPDUs of a generated trace", load);
+  cmd.AddValue ("cca", "power (dBm) from which the receiver locks on a PPDU", ccaDbm);
+  cmd.AddValue ("trace", "trace file to replay instead of a generated trace", traceFile);
+  cmd.AddValue ("write", "file to write the trace to", writeFile);
+  cmd.Parse (argc, argv);
+
+  std::vector<TraceEntry> trace;
+  if (!traceFile.empty ())
+    {
+      std::ifstream in (traceFile);
+      TraceEntry entry;
+      while (in >> entry.start >> entry.sta >> entry.size >> entry.rate >> entry.powerDbm)
+        {
+          trace.push_back (entry);
+        }
+    }
+  else
+    {
+      // Poisson arrivals from stations at fixed distances from the receiver
+      const uint32_t sizes[] = {100, 500, 1500};
+      const uint32_t rates[] = {6, 12, 24, 54};
+      Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+      uniform->SetStream (1);
+      std::vector<double> powers (stations);
+      for (double &power : powers)
+        {
+          power = uniform->GetValue (-95, -50);
+        }
+      // mean PPDU duration of the mix, to derive the arrival rate
+      double meanDuration = 0;
+      for (uint32_t size : sizes)
+        {
+          for (uint32_t rate : rates)
+            {
+              WifiTxVector txVector (OfdmPhy::GetOfdmRate (rate * 1000000), 0, WIFI_PREAMBLE_LONG,
+                                     800, 1, 1, 0, 20, false);
+              meanDuration += WifiPhy::CalculateTxDuration (size + 30, txVector, WIFI_PHY_BAND_5GHZ).GetSeconds ();
+            }
+        }
+      meanDuration /= 3 * 4;
+      Ptr<ExponentialRandomVariable> gap = CreateObject<ExponentialRandomVariable> ();
+      gap->SetStream (2);
+      gap->SetAttribute ("Mean", DoubleValue (meanDuration / load * 1e9));
+      double now = 0;
+      for (uint32_t i = 0; i < frames; ++i)
+        {
+          now += gap->GetValue ();
+          TraceEntry entry;
+          entry.start = static_cast<int64_t> (now);
+          entry.sta = uniform->GetInteger (0, stations - 1);
+          entry.size = sizes[uniform->GetInteger (0, 2)];
+          entry.rate = rates[uniform->GetInteger (0, 3)];
+          entry.powerDbm = powers[entry.sta];
+          trace.push_back (entry);
+        }
+    }
+  if (!writeFile.empty ())
+    {
+      std::ofstream out (writeFile);
+      out << std::setprecision (17);
+      for (const TraceEntry &entry : trace)
+        {
+          out << entry.start << " " << entry.sta << " " << entry.size << " "
+              << entry.rate << " " << entry.powerDbm << std::endl;
+        }
+    }
+
+  Bench bench (trace, ccaDbm);
+  int64_t elapsed = bench.Run ();
+  std::cout << std::setprecision (17)
+            << trace.size () << " PPDUs, " << bench.m_locked << " received in "
+            << elapsed << " ms (" << (elapsed > 0 ? 1000 * trace.size () / elapsed : 0)
+            << " PPDUs/s)" << std::endl
+            << "checksum: SNR " << bench.m_snrSum << " dB, PER " << bench.m_perSum << std::endl;
+  return 0;
+}
@@ -26,6 +26,8 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -142,6 +144,183 @@ BenchHeader<N>::Deserialize (Buffer::Iterator start)
   return N;
 }
 
+/**
+ * BenchFieldsHeader class used for benchmarking the serialization of a
+ * header field by field: a 20 byte header laid out as an IPv4 header,
+ * written and read with the WriteU8, WriteHtonU16 ... methods of
+ * Buffer::Iterator, or with plain stores and loads into the bytes of
+ * Buffer::Iterator::ReserveContiguous.
+ */
+template <bool CONTIGUOUS>
+class BenchFieldsHeader : public Header
+{
+public:
+  BenchFieldsHeader ();
+  /**
+   * \returns true if the header has been deserialized with the fields
+   *          serialized.
+   */
+  bool IsOk (void) const;
+
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+private:
+  uint8_t m_u8[6];   ///< the 8 bit fields
+  uint16_t m_u16[3]; ///< the 16 bit fields
+  uint32_t m_u32[2]; ///< the 32 bit fields
+  bool m_ok;         ///< variable to track whether deserialization succeeded
+};
+
+template <bool CONTIGUOUS>
+BenchFieldsHeader<CONTIGUOUS>::BenchFieldsHeader ()
+  : m_u8 {0x45, 0, 64, 17, 0x40, 0},
+    m_u16 {548, 1234, 0},
+    m_u32 {0x0a010101, 0x0a010102},
+    m_ok (false)
+{}
+
+template <bool CONTIGUOUS>
+bool
+BenchFieldsHeader<CONTIGUOUS>::IsOk (void) const
+{
+  return m_ok;
+}
+
+template <bool CONTIGUOUS>
+TypeId
+BenchFieldsHeader<CONTIGUOUS>::GetTypeId (void)
+{
+  static TypeId tid = TypeId (CONTIGUOUS ? "ns3::BenchFieldsHeader<true>" : "ns3::BenchFieldsHeader<false>")
+    .SetParent<Header> ()
+    .SetGroupName ("Utils")
+    .HideFromDocumentation ()
+    .AddConstructor<BenchFieldsHeader <CONTIGUOUS> > ()
+    ;
+  return tid;
+}
+template <bool CONTIGUOUS>
+TypeId
+BenchFieldsHeader<CONTIGUOUS>::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+template <bool CONTIGUOUS>
+void
+BenchFieldsHeader<CONTIGUOUS>::Print (std::ostream &os) const
+{
+  NS_ASSERT (false);
+}
+template <bool CONTIGUOUS>
+uint32_t
+BenchFieldsHeader<CONTIGUOUS>::GetSerializedSize (void) const
+{
+  return 20;
+}
+template <bool CONTIGUOUS>
+void
+BenchFieldsHeader<CONTIGUOUS>::Serialize (Buffer::Iterator start) const
+{
+  if (!CONTIGUOUS)
+    {
+      start.WriteU8 (m_u8[0]);
+      start.WriteU8 (m_u8[1]);
+      start.WriteHtonU16 (m_u16[0]);
+      start.WriteHtonU16 (m_u16[1]);
+      start.WriteU8 (m_u8[4]);
+      start.WriteU8 (m_u8[5]);
+      start.WriteU8 (m_u8[2]);
+      start.WriteU8 (m_u8[3]);
+      start.WriteU16 (m_u16[2]);
+      start.WriteHtonU32 (m_u32[0]);
+      start.WriteHtonU32 (m_u32[1]);
+      return;
+    }
+  uint8_t copy[20];
+  uint8_t *bytes = start.ReserveContiguous (20);
+  uint8_t *fields = bytes != 0 ? bytes : copy;
+  fields[0] = m_u8[0];
+  fields[1] = m_u8[1];
+  fields[2] = m_u16[0] >> 8;
+  fields[3] = m_u16[0] & 0xff;
+  fields[4] = m_u16[1] >> 8;
+  fields[5] = m_u16[1] & 0xff;
+  fields[6] = m_u8[4];
+  fields[7] = m_u8[5];
+  fields[8] = m_u8[2];
+  fields[9] = m_u8[3];
+  fields[10] = m_u16[2] & 0xff;
+  fields[11] = m_u16[2] >> 8;
+  for (uint32_t j = 0; j < 4; j++)
+    {
+      fields[12 + j] = (m_u32[0] >> (24 - 8 * j)) & 0xff;
+      fields[16 + j] = (m_u32[1] >> (24 - 8 * j)) & 0xff;
+    }
+  if (bytes == 0)
+    {
+      start.Write (copy, 20);
+    }
+}
+template <bool CONTIGUOUS>
+uint32_t
+BenchFieldsHeader<CONTIGUOUS>::Deserialize (Buffer::Iterator start)
+{
+  uint8_t u8[6];
+  uint16_t u16[3];
+  uint32_t u32[2];
+  uint8_t copy[20];
+  if (!CONTIGUOUS)
+    {
+      u8[0] = start.ReadU8 ();
+      u8[1] = start.ReadU8 ();
+      u16[0] = start.ReadNtohU16 ();
+      u16[1] = start.ReadNtohU16 ();
+      u8[4] = start.ReadU8 ();
+      u8[5] = start.ReadU8 ();
+      u8[2] = start.ReadU8 ();
+      u8[3] = start.ReadU8 ();
+      u16[2] = start.ReadU16 ();
+      u32[0] = start.ReadNtohU32 ();
+      u32[1] = start.ReadNtohU32 ();
+    }
+  else
+    {
+      const uint8_t *fields = start.ReserveContiguous (20);
+      if (fields == 0)
+        {
+          start.Read (copy, 20);
+          fields = copy;
+        }
+      u8[0] = fields[0];
+      u8[1] = fields[1];
+      u16[0] = (fields[2] << 8) | fields[3];
+      u16[1] = (fields[4] << 8) | fields[5];
+      u8[4] = fields[6];
+      u8[5] = fields[7];
+      u8[2] = fields[8];
+      u8[3] = fields[9];
+      u16[2] = fields[10] | (fields[11] << 8);
+      u32[0] = 0;
+      u32[1] = 0;
+      for (uint32_t j = 0; j < 4; j++)
+        {
+          u32[0] = (u32[0] << 8) | fields[12 + j];
+          u32[1] = (u32[1] << 8) | fields[16 + j];
+        }
+    }
+  m_ok = std::equal (u8, u8 + 6, m_u8) && std::equal (u16, u16 + 3, m_u16)
+    && std::equal (u32, u32 + 2, m_u32);
+  return 20;
+}
+
 /// BenchTag class used for benchmarking packet serialization/deserialization
 template <int N>
 class BenchTag : public Tag
@@ -310,6 +489,61 @@ benchFragment (uint32_t n)
   }
 }
 
+static void
+benchDatagram (uint32_t n)
+{
+  // the send and receive path of a CoAP message over UDP: application
+  // header and trace tag, UDP and IPv4 headers, a copy for the trace
+  BenchHeader<12> coap;
+  BenchHeader<8> udp;
+  BenchHeader<20> ipv4;
+  BenchTag<10> trace;
+  BenchTag<4> flow;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (512);
+      p->AddHeader (coap);
+      p->AddPacketTag (trace);
+      p->AddHeader (udp);
+      p->AddPacketTag (flow);
+      p->AddHeader (ipv4);
+      Ptr<Packet> copy = p->Copy ();
+      p->RemoveHeader (ipv4);
+      p->RemovePacketTag (flow);
+      p->RemoveHeader (udp);
+      p->PeekPacketTag (trace);
+      p->RemoveHeader (coap);
+    }
+}
+
+static void
+benchProvenance (uint32_t n)
+{
+  // benchDatagram, with the provenance of the packet instead of the
+  // trace tag
+  BenchHeader<12> coap;
+  BenchHeader<8> udp;
+  BenchHeader<20> ipv4;
+  BenchTag<4> flow;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (512);
+      p->AddHeader (coap);
+      p->SetProvenance (PacketProvenance (1, 0, i, Simulator::Now ()));
+      p->AddHeader (udp);
+      p->AddPacketTag (flow);
+      p->AddHeader (ipv4);
+      Ptr<Packet> copy = p->Copy ();
+      p->RemoveHeader (ipv4);
+      p->RemovePacketTag (flow);
+      p->RemoveHeader (udp);
+      NS_ABORT_UNLESS (p->GetProvenance ().GetSequence () == i);
+      p->RemoveHeader (coap);
+    }
+}
+
 static void
 benchByteTags (uint32_t n)
 {
@@ -328,6 +562,35 @@ benchByteTags (uint32_t n)
     }
 }
 
+template <bool CONTIGUOUS>
+static void
+benchHeaderFields (uint32_t n)
+{
+  BenchFieldsHeader<CONTIGUOUS> ipv4;
+  Buffer buffer (512);
+  buffer.AddAtStart (ipv4.GetSerializedSize ());
+  for (uint32_t i = 0; i < n; i++)
+    {
+      ipv4.Serialize (buffer.Begin ());
+      ipv4.Deserialize (buffer.Begin ());
+    }
+  NS_ABORT_MSG_UNLESS (ipv4.IsOk (), "bad deserialization");
+}
+
+template <bool CONTIGUOUS>
+static void
+benchPacketFields (uint32_t n)
+{
+  BenchFieldsHeader<CONTIGUOUS> ipv4;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (512);
+      p->AddHeader (ipv4);
+      p->RemoveHeader (ipv4);
+    }
+  NS_ABORT_MSG_UNLESS (ipv4.IsOk (), "bad deserialization");
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -362,12 +625,14 @@ int main (int argc, char *argv[])
   uint32_t n = 0;
   uint32_t minIterations = 1;
   bool enablePrinting = false;
+  bool pooling = true;
 
   CommandLine cmd (__FILE__);
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("pooling", "recycle packets, buffer data and packet tags", pooling);
   cmd.Parse (argc, argv);
 
   if (n == 0)
@@ -376,6 +641,11 @@ int main (int argc, char *argv[])
         "by command-line argument --n=(number of packets)" << std::endl;
       exit (1);
     }
+  Packet::SetPooling (pooling);
+  // stop tracking the Time values created so far, as a running
+  // simulation does, so that the provenance benchmark pays what an
+  // application pays for Simulator::Now ()
+  Simulator::Run ();
   std::cout << "Running bench-packets with n=" << n << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
@@ -385,6 +655,18 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchHeaderFields<false>, n, minIterations, "Header field by field");
+  runBench (&benchHeaderFields<true>, n, minIterations, "Header in contiguous bytes");
+  runBench (&benchPacketFields<false>, n, minIterations, "Add/remove header field by field");
+  runBench (&benchPacketFields<true>, n, minIterations, "Add/remove header in contiguous bytes");
+  uint64_t heap = Packet::GetNHeapAllocated ();
+  runBench (&benchDatagram, n, minIterations, "Datagram with headers and small tags");
+  std::cout << (Packet::GetNHeapAllocated () - heap) / double (n * minIterations)
+            << " heap allocations per datagram (packets, buffers and tags)" << std::endl;
+  heap = Packet::GetNHeapAllocated ();
+  runBench (&benchProvenance, n, minIterations, "Datagram with headers and provenance");
+  std::cout << (Packet::GetNHeapAllocated () - heap) / double (n * minIterations)
+            << " heap allocations per datagram (packets, buffers and tags)" << std::endl;
 
   return 0;
 }
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the forwarding lookups of the global and static
+// routing: a node gets a table of random host and network routes, and
+// looks up the routes to random destinations, with the prefix index of
+// the routing protocol and with its linear search of the routes.  Without
+// --routes, tables of 100 to 100000 routes are measured.
+// Sample usage:
+//   ./ns3 run 'bench-routing'
+//   ./ns3 run 'bench-routing --routes=10000 --static'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/packet.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Fill a routing protocol with random routes: host routes, as
+ * GlobalRouteManager adds for the interfaces of the other nodes, and
+ * network routes of /16 to /28 in 10.0.0.0/8.
+ * \param routing the routing protocol
+ * \param routes the number of routes
+ * \param rng the random variable
+ * \param networks the networks of the routes, filled
+ */
+template <typename Routing>
+static void
+AddRoutes (Ptr<Routing> routing, uint32_t routes, Ptr<UniformRandomVariable> rng, std::vector<uint32_t> *networks)
+{
+  for (uint32_t i = 0; i < routes; i++)
+    {
+      uint32_t length = i % 2 == 0 ? 32 : rng->GetInteger (16, 28);
+      Ipv4Mask mask (0xffffffff << (32 - length));
+      Ipv4Address network = Ipv4Address ((10 << 24) | rng->GetInteger (0, 0xffffff)).CombineMask (mask);
+      Ipv4Address gateway ((172 << 24) | (16 << 16) | rng->GetInteger (1, 254));
+      routing->AddNetworkRouteTo (network, mask, gateway, rng->GetInteger (1, 3));
+      networks->push_back (network.Get ());
+    }
+}
+
+/**
+ * Look up the routes to random destinations: half of them in the
+ * networks of the routes, the others anywhere in 10.0.0.0/8.
+ * \param routing the routing protocol
+ * \param lookups the number of lookups
+ * \param networks the networks of the routes
+ * \param rng the random variable
+ * \return the number of routes found
+ */
+static uint32_t
+Lookup (Ptr<Ipv4RoutingProtocol> routing, uint32_t lookups, const std::vector<uint32_t> &networks,
+        Ptr<UniformRandomVariable> rng)
+{
+  uint32_t found = 0;
+  Ptr<Packet> packet = Create<Packet> ();
+  Ipv4Header header;
+  Socket::SocketErrno sockerr;
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      uint32_t dest = i % 2 == 0 ? networks[rng->GetInteger (0, networks.size () - 1)] | (i & 0xf)
+                                 : (10 << 24) | rng->GetInteger (0, 0xffffff);
+      header.SetDestination (Ipv4Address (dest));
+      if (routing->RouteOutput (packet, header, 0, sockerr) != 0)
+        {
+          found++;
+        }
+    }
+  return found;
+}
+
+/**
+ * Measure the lookups of a routing protocol, with and without its prefix
+ * index.
+ * \param ipv4 the IPv4 stack of the node
+ * \param routes the number of routes
+ * \param lookups the number of lookups
+ * \param useStatic whether to measure Ipv4StaticRouting rather than Ipv4GlobalRouting
+ */
+static void
+Bench (Ptr<Ipv4> ipv4, uint32_t routes, uint32_t lookups, bool useStatic)
+{
+  std::cout << routes << " routes:";
+  for (uint32_t linear = 0; linear < 2; linear++)
+    {
+      Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+      rng->SetStream (1);
+      std::vector<uint32_t> networks;
+      Ptr<Ipv4RoutingProtocol> routing;
+      if (useStatic)
+        {
+          Ptr<Ipv4StaticRouting> staticRouting = CreateObject<Ipv4StaticRouting> ();
+          staticRouting->SetAttribute ("UsePrefixIndex", BooleanValue (linear == 0));
+          staticRouting->SetIpv4 (ipv4);
+          AddRoutes (staticRouting, routes, rng, &networks);
+          routing = staticRouting;
+        }
+      else
+        {
+          Ptr<Ipv4GlobalRouting> globalRouting = CreateObject<Ipv4GlobalRouting> ();
+          globalRouting->SetAttribute ("UsePrefixIndex", BooleanValue (linear == 0));
+          globalRouting->SetIpv4 (ipv4);
+          AddRoutes (globalRouting, routes, rng, &networks);
+          routing = globalRouting;
+        }
+
+      // the first lookup builds the index
+      SystemWallClockMs time;
+      time.Start ();
+      Lookup (routing, 1, networks, rng);
+      const int64_t build = time.End ();
+      time.Start ();
+      const uint32_t found = Lookup (routing, lookups, networks, rng);
+      const int64_t run = time.End ();
+      std::cout << (linear ? "  linear " : "  indexed ")
+                << run * 1e6 / lookups << " ns/lookup";
+      if (!linear)
+        {
+          std::cout << " (index built in " << build << " ms, " << found << " found)";
+        }
+      routing->Dispose ();
+    }
+  std::cout << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t routes = 0;
+  uint32_t lookups = 20000;
+  bool useStatic = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the forwarding lookups of the global and static routing.");
+  cmd.AddValue ("routes", "number of routes (0 for 100 to 100000)", routes);
+  cmd.AddValue ("lookups", "number of lookups", lookups);
+  cmd.AddValue ("static", "measure Ipv4StaticRouting rather than Ipv4GlobalRouting", useStatic);
+  cmd.Parse (argc, argv);
+
+  NodeContainer node;
+  node.Create (1);
+  SimpleNetDeviceHelper devices;
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ipv4AddressHelper address;
+  address.SetBase ("172.16.0.0", "255.255.0.0");
+  address.Assign (devices.Install (NodeContainer (node, node, node)));
+  Ptr<Ipv4> ipv4 = node.Get (0)->GetObject<Ipv4> ();
+
+  std::cout << (useStatic ? "Ipv4StaticRouting" : "Ipv4GlobalRouting") << ", "
+            << lookups << " lookups" << std::endl;
+  if (routes != 0)
+    {
+      Bench (ipv4, routes, lookups, useStatic);
+    }
+  else
+    {
+      for (routes = 100; routes <= 100000; routes *= 10)
+        {
+          Bench (ipv4, routes, lookups, useStatic);
+        }
+    }
+  Simulator::Destroy ();
+  return 0;
+}
@@ -200,6 +200,73 @@ GetRandomStream (std::string filename)
 
 
 
+/**
+ * Print the table header, then run the benchmark with one scheduler.
+ * \param factory the scheduler
+ * \param order extra description of the scheduler
+ * \param bench the benchmark
+ * \param pop the event population size
+ * \param total the total number of events to run
+ * \param runs the number of runs
+ */
+void
+RunScheduler (ObjectFactory factory, std::string order, Bench *bench,
+              uint32_t pop, uint32_t total, uint32_t runs)
+{
+  Simulator::SetScheduler (factory);
+
+  LOG ("");
+  LOGME ("scheduler: " << factory.GetTypeId ().GetName () << order);
+
+  // table header
+  LOG ("");
+  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+       std::left << std::setw (3 * g_fwidth) << "Initialization:" <<
+       std::left << std::setw (3 * g_fwidth) << "Simulation:");
+  LOG (std::left << std::setw (g_fwidth) << "" <<
+       std::left << std::setw (g_fwidth) << "Time (s)" <<
+       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
+       std::left << std::setw (g_fwidth) << "Time (s)" <<
+       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+  LOG (std::setfill ('-') <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::right << std::setw (g_fwidth) << " " <<
+       std::setfill (' ')
+       );
+
+  // prime
+  DEB ("priming");
+  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
+  bench->SetPopulation (pop);
+  bench->SetTotal (total);
+  bench->RunBench ();
+
+  const uint64_t allocated = EventImpl::GetNAllocated ();
+  const uint64_t heapAllocated = EventImpl::GetNHeapAllocated ();
+  const Time start = Simulator::Now ();
+  for (uint32_t i = 0; i < runs; i++)
+    {
+      std::cout << std::setw (g_fwidth) << i;
+
+      bench->RunBench ();
+    }
+
+  const double seconds = (Simulator::Now () - start).GetSeconds ();
+  LOGME ("events allocated: " << EventImpl::GetNAllocated () - allocated <<
+         ", from the heap: " << EventImpl::GetNHeapAllocated () - heapAllocated <<
+         " (" << (EventImpl::GetNHeapAllocated () - heapAllocated) / seconds <<
+         " per simulated second)");
+  Simulator::Destroy ();
+}
+
+
 int main (int argc, char *argv[])
 {
 
@@ -208,6 +275,8 @@ int main (int argc, char *argv[])
   bool schedList          = false;
   bool schedMap           = true;
   bool schedPriorityQueue = false;
+  bool schedLadder        = false;
+  bool schedAll           = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
@@ -223,13 +292,24 @@ int main (int argc, char *argv[])
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in s.\n"
+             "\n"
+             "The event population of the CoAP WifiTest scenario can be\n"
+             "recorded with\n"
+             "  ./ns3 run \"CoAP/example --WhichTest=3 --EventTrace=events.txt\"\n"
+             "which prints the peak population at the end, then replayed\n"
+             "on every scheduler with\n"
+             "  --all --file=events.txt --pop=<peak population>\n"
+             "\n"
+             "Executed events are recycled unless --EventPooling=false.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
   cmd.AddValue ("calrev", "reverse ordering in the CalendarScheduler", calRev);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
   cmd.AddValue ("pri",   "use PriorityQueue",             schedPriorityQueue);
+  cmd.AddValue ("ladder", "use LadderScheduler",          schedLadder);
+  cmd.AddValue ("all",   "run every scheduler in turn",   schedAll);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
@@ -258,8 +338,10 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::PriorityQueueScheduler");
     }
-      
-  Simulator::SetScheduler (factory);
+  if (schedLadder)
+    {
+      factory.SetTypeId ("ns3::LadderScheduler");
+    }
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
@@ -269,7 +351,6 @@ int main (int argc, char *argv[])
     {
       order = ": insertion order: " + std::string (calRev ? "reverse" : "normal");
     }
-  LOGME ("scheduler: " << factory.GetTypeId ().GetName () << order);
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
@@ -277,45 +358,34 @@ int main (int argc, char *argv[])
   Bench *bench = new Bench (pop, total);
   bench->SetRandomStream (GetRandomStream (filename));
 
-  // table header
-  LOG ("");
-  LOG (std::left << std::setw (g_fwidth) << "Run #" <<
-       std::left << std::setw (3 * g_fwidth) << "Initialization:" <<
-       std::left << std::setw (3 * g_fwidth) << "Simulation:");
-  LOG (std::left << std::setw (g_fwidth) << "" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" <<
-       std::left << std::setw (g_fwidth) << "Time (s)" <<
-       std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
-       std::left << std::setw (g_fwidth) << "Per (s/ev)" );
-  LOG (std::setfill ('-') <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::right << std::setw (g_fwidth) << " " <<
-       std::setfill (' ')
-       );
-
-  // prime
-  DEB ("priming");
-  std::cout << std::left << std::setw (g_fwidth) << "(prime)";
-  bench->RunBench ();
-
-  bench->SetPopulation (pop);
-  bench->SetTotal (total);
-  for (uint32_t i = 0; i < runs; i++)
+  if (schedAll)
     {
-      std::cout << std::setw (g_fwidth) << i;
-
-      bench->RunBench ();
+      const char *schedulers[] = {
+        "ns3::CalendarScheduler",
+        "ns3::HeapScheduler",
+        "ns3::ListScheduler",
+        "ns3::MapScheduler",
+        "ns3::PriorityQueueScheduler",
+        "ns3::LadderScheduler",
+      };
+      for (const char *scheduler : schedulers)
+        {
+          ObjectFactory each (scheduler);
+          std::string eachOrder;
+          if (each.GetTypeId ().GetName () == "ns3::CalendarScheduler")
+            {
+              each.Set ("Reverse", BooleanValue (calRev));
+              eachOrder = ": insertion order: " + std::string (calRev ? "reverse" : "normal");
+            }
+          RunScheduler (each, eachOrder, bench, pop, total, runs);
+        }
+    }
+  else
+    {
+      RunScheduler (factory, order, bench, pop, total, runs);
     }
 
   LOG ("");
-  Simulator::Destroy ();
   delete bench;
   return 0;
 }
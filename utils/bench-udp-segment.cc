@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the UDP send path: several nodes, each with a
+// point-to-point link to a sink, send datagrams to the sink at a fixed
+// rate, a burst of --segments datagrams at a time.  A burst is sent as
+// many datagrams, or with --gso as one super-datagram which the IPv4
+// layer splits into the datagrams (the SegmentSize of UdpSocketImpl).
+// Sample usage:
+//   ./ns3 run 'bench-udp-segment --nodes=10 --segments=8'
+//   ./ns3 run 'bench-udp-segment --nodes=10 --segments=8 --gso'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/node-container.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/socket.h"
+#include "ns3/packet.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+/// Number of datagrams received by the sink.
+static uint64_t g_received = 0;
+
+/**
+ * Receive all the datagrams waiting at the sink.
+ * \param socket the socket of the sink
+ */
+static void
+Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      ++g_received;
+    }
+}
+
+/**
+ * Send a burst of datagrams, and schedule the next one.
+ * \param socket the socket of the sender
+ * \param size the payload size of each datagram
+ * \param segments the number of datagrams of the burst
+ * \param gso whether the burst is sent as one super-datagram
+ * \param interval the time between two bursts
+ */
+static void
+SendBurst (Ptr<Socket> socket, uint32_t size, uint32_t segments, bool gso, Time interval)
+{
+  if (gso)
+    {
+      socket->Send (Create<Packet> (size * segments));
+    }
+  else
+    {
+      for (uint32_t i = 0; i < segments; ++i)
+        {
+          socket->Send (Create<Packet> (size));
+        }
+    }
+  Simulator::Schedule (interval, &SendBurst, socket, size, segments, gso, interval);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nodes = 10;
+  uint32_t size = 1024;
+  uint32_t rate = 10000;
+  uint32_t segments = 8;
+  double simulTime = 10;
+  bool gso = false;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the UDP send path, with and without segmentation offload.");
+  cmd.AddValue ("nodes", "number of senders", nodes);
+  cmd.AddValue ("size", "payload size of each datagram, in bytes", size);
+  cmd.AddValue ("rate", "datagrams sent per second by each sender", rate);
+  cmd.AddValue ("segments", "datagrams sent at a time", segments);
+  cmd.AddValue ("simulTime", "simulated time, in seconds", simulTime);
+  cmd.AddValue ("gso", "send each burst as one super-datagram", gso);
+  cmd.Parse (argc, argv);
+
+  NodeContainer sink;
+  sink.Create (1);
+  NodeContainer senders;
+  senders.Create (nodes);
+  InternetStackHelper internet;
+  internet.Install (sink);
+  internet.Install (senders);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1us"));
+  Ipv4AddressHelper address;
+  Ptr<Socket> sinkSocket = Socket::CreateSocket (sink.Get (0), UdpSocketFactory::GetTypeId ());
+  sinkSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sinkSocket->SetRecvCallback (MakeCallback (&Receive));
+  const Time interval = Seconds (double (segments) / rate);
+  for (uint32_t i = 0; i < nodes; ++i)
+    {
+      NetDeviceContainer devices = p2p.Install (sink.Get (0), senders.Get (i));
+      std::ostringstream network;
+      network << "10." << 1 + i / 250 << "." << i % 250 << ".0";
+      address.SetBase (network.str ().c_str (), "255.255.255.0");
+      Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+      Ptr<Socket> socket = Socket::CreateSocket (senders.Get (i), UdpSocketFactory::GetTypeId ());
+      if (gso)
+        {
+          socket->SetAttribute ("SegmentSize", UintegerValue (size));
+        }
+      socket->Connect (InetSocketAddress (interfaces.GetAddress (0), 9));
+      // spread the senders over the first interval
+      Simulator::Schedule (Seconds (interval.GetSeconds () * i / nodes), &SendBurst, socket, size, segments, gso, interval);
+    }
+
+  Simulator::Stop (Seconds (simulTime));
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  const int64_t run = time.End ();
+  const uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+
+  std::cout << g_received << " datagrams received in " << run << " ms: "
+            << g_received * 1000.0 / std::max<int64_t> (run, 1) << " datagrams/s, "
+            << events << " events" << std::endl;
+  return 0;
+}
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the trace-driven mobility of many nodes: the
+// time to install a trajectory set on the nodes, and then to query the
+// positions of all nodes periodically.
+// Sample usage:
+//   ./ns3 run 'bench-waypoints --generate --nodes=10000 --duration=3600'
+//   ./ns3 run 'bench-waypoints --nodes=10000'
+//
+// --generate writes a binary waypoint file of random flights (and, with
+// --ns2, the same waypoints as an ns-2 trace).  Without it, the file is
+// installed with BinaryWaypointMobilityHelper (or the ns-2 trace with
+// Ns2MobilityHelper, with --ns2).
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/node-container.h"
+#include "ns3/mobility-model.h"
+#include "ns3/binary-waypoint-mobility-helper.h"
+#include "ns3/ns2-mobility-helper.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \return the resident memory of the process, in kB, from /proc
+ */
+static uint64_t
+GetResidentKb (void)
+{
+  std::ifstream status ("/proc/self/status");
+  std::string key;
+  uint64_t value = 0;
+  while (status >> key)
+    {
+      if (key == "VmRSS:")
+        {
+          status >> value;
+          break;
+        }
+    }
+  return value;
+}
+
+/**
+ * Query the positions of all nodes.
+ * \param nodes the nodes
+ * \param sum the sum of the coordinates, updated
+ */
+static void
+Sample (NodeContainer nodes, double *sum)
+{
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Vector position = (*i)->GetObject<MobilityModel> ()->GetPosition ();
+      *sum += position.x + position.y + position.z;
+    }
+}
+
+/**
+ * Write random flights: every interval, each node picks a new speed and
+ * heading, and climbs or descends a little.
+ * \param filename the binary waypoint file
+ * \param ns2 the ns-2 trace to write too, if not empty
+ * \param nodes the number of nodes
+ * \param duration the duration of the flights, in seconds
+ * \param interval the time between two waypoints, in seconds
+ */
+static void
+Generate (std::string filename, std::string ns2, uint32_t nodes, double duration, double interval)
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (1);
+  std::vector<BinaryWaypoint> waypoints;
+  std::ofstream trace;
+  if (!ns2.empty ())
+    {
+      trace.open (ns2);
+    }
+  const uint32_t steps = duration / interval;
+  waypoints.reserve (uint64_t (nodes) * (steps + 1));
+  for (uint32_t node = 0; node < nodes; ++node)
+    {
+      Vector position (uniform->GetValue (0, 5000), uniform->GetValue (0, 5000), uniform->GetValue (50, 150));
+      for (uint32_t step = 0; step <= steps; ++step)
+        {
+          const double heading = uniform->GetValue (0, 2 * M_PI);
+          const double speed = uniform->GetValue (5, 20);
+          Vector velocity (speed * std::cos (heading), speed * std::sin (heading), uniform->GetValue (-1, 1));
+          BinaryWaypoint waypoint = {node, 0, int64_t (step * interval * 1e9),
+                                     position.x, position.y, position.z,
+                                     velocity.x, velocity.y, velocity.z};
+          waypoints.push_back (waypoint);
+          if (trace.is_open ())
+            {
+              if (step == 0)
+                {
+                  trace << "$node_(" << node << ") set X_ " << position.x << "\n"
+                        << "$node_(" << node << ") set Y_ " << position.y << "\n"
+                        << "$node_(" << node << ") set Z_ " << position.z << "\n";
+                }
+              else
+                {
+                  trace << "$ns_ at " << step * interval << " \"$node_(" << node << ") setdest "
+                        << position.x << " " << position.y << " " << speed << "\"\n";
+                }
+            }
+          position = position + Vector (velocity.x * interval, velocity.y * interval, velocity.z * interval);
+        }
+    }
+  BinaryWaypointFile::Write (filename, waypoints);
+  std::cout << waypoints.size () << " waypoints written to " << filename << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nodes = 10000;
+  double duration = 3600;
+  double interval = 10;
+  double simulTime = 60;
+  double sampling = 1;
+  bool generate = false;
+  bool ns2 = false;
+  std::string filename = "/tmp/bench-waypoints.bin";
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the installation and the queries of trace-driven mobility.");
+  cmd.AddValue ("nodes", "number of nodes", nodes);
+  cmd.AddValue ("duration", "duration of the generated flights, in seconds", duration);
+  cmd.AddValue ("interval", "time between two generated waypoints, in seconds", interval);
+  cmd.AddValue ("simulTime", "simulated time, in seconds", simulTime);
+  cmd.AddValue ("sampling", "time between two queries of all positions, in seconds", sampling);
+  cmd.AddValue ("generate", "write the trajectories instead of running them", generate);
+  cmd.AddValue ("ns2", "use an ns-2 trace with Ns2MobilityHelper", ns2);
+  cmd.AddValue ("file", "binary waypoint file (.ns_movements appended for the ns-2 trace)", filename);
+  cmd.Parse (argc, argv);
+
+  const std::string ns2File = filename + ".ns_movements";
+  if (generate)
+    {
+      Generate (filename, ns2 ? ns2File : "", nodes, duration, interval);
+      return 0;
+    }
+
+  NodeContainer c;
+  c.Create (nodes);
+  const uint64_t residentBefore = GetResidentKb ();
+  SystemWallClockMs time;
+  time.Start ();
+  if (ns2)
+    {
+      Ns2MobilityHelper helper (ns2File);
+      helper.Install (c.Begin (), c.End ());
+    }
+  else
+    {
+      BinaryWaypointMobilityHelper helper (filename);
+      helper.Install (c);
+    }
+  const int64_t install = time.End ();
+  const uint64_t residentInstalled = GetResidentKb ();
+
+  double sum = 0;
+  for (double t = 0; t < simulTime; t += sampling)
+    {
+      Simulator::Schedule (Seconds (t), &Sample, c, &sum);
+    }
+  Simulator::Stop (Seconds (simulTime));
+  time.Start ();
+  Simulator::Run ();
+  const int64_t run = time.End ();
+  const uint64_t residentRun = GetResidentKb ();
+  Simulator::Destroy ();
+
+  std::cout << nodes << " nodes installed in " << install << " ms, +"
+            << residentInstalled - residentBefore << " kB resident" << std::endl
+            << simulTime / sampling << " queries of all positions in " << run << " ms, +"
+            << residentRun - residentInstalled << " kB resident" << std::endl
+            << "checksum: " << sum << std::endl;
+  return 0;
+}
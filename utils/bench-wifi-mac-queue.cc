@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the lookups of the MPDUs of an A-MPDU in the
+// WifiMacQueue of a saturated AP.  The queue holds the frames of many
+// stations, interleaved; for each PPDU, the MPDUs of the next station are
+// looked up with PeekByTidAndAddress, then dequeued, and as many new frames
+// are enqueued for the stations in turn.  The same lookups are done by a scan of
+// the whole queue, as the queue did before it kept a sublist per receiver
+// and TID.
+// Sample usage:  ./ns3 run 'bench-wifi-mac-queue --ppdus=20000 --mpdus=64'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/wifi-mac-queue.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Look up the next frame of a receiver and TID by a scan of the queue.
+ * \param queue the queue
+ * \param tid the TID
+ * \param dest the receiver
+ * \param it the position following the previous frame, updated
+ * \return the frame, or null
+ */
+static Ptr<const WifiMacQueueItem>
+ScanNext (Ptr<WifiMacQueue> queue, uint8_t tid, Mac48Address dest, WifiMacQueue::ConstIterator &it)
+{
+  const Time now = Simulator::Now ();
+  for (; it != queue->end (); it++)
+    {
+      if (now <= (*it)->GetTimeStamp () + queue->GetMaxDelay ()
+          && (*it)->GetHeader ().IsQosData () && (*it)->GetDestinationAddress () == dest
+          && (*it)->GetHeader ().GetQosTid () == tid)
+        {
+          return *it++;
+        }
+    }
+  return nullptr;
+}
+
+/**
+ * Time the lookups of the A-MPDUs of a saturated AP.
+ * \param stations the number of stations
+ * \param depth the number of frames queued per station
+ * \param ppdus the number of PPDUs
+ * \param mpdus the number of MPDUs per PPDU
+ * \param scan whether to scan the whole queue
+ * \param found the number of frames looked up
+ * \param lookupUs the time taken by the lookups alone, in microseconds
+ * \return the time taken, in ms
+ */
+static int64_t
+Run (uint32_t stations, uint32_t depth, uint32_t ppdus, uint32_t mpdus, bool scan, uint64_t &found,
+     double &lookupUs)
+{
+  Ptr<WifiMacQueue> queue = CreateObject<WifiMacQueue> (AC_BE);
+  queue->SetMaxSize (QueueSize (QueueSizeUnit::PACKETS, stations * depth));
+  std::vector<Mac48Address> receivers;
+  for (uint32_t i = 0; i < stations; i++)
+    {
+      receivers.push_back (Mac48Address::Allocate ());
+    }
+  Ptr<Packet> packet = Create<Packet> (1400);
+  auto enqueue = [&queue, &packet] (Mac48Address receiver)
+    {
+      WifiMacHeader header;
+      header.SetType (WIFI_MAC_QOSDATA);
+      header.SetAddr1 (receiver);
+      header.SetQosTid (0);
+      queue->Enqueue (Create<WifiMacQueueItem> (packet, header));
+    };
+  for (uint32_t n = 0; n < depth; n++)
+    {
+      for (const auto& receiver : receivers)
+        {
+          enqueue (receiver);
+        }
+    }
+
+  std::vector<Ptr<const WifiMacQueueItem>> ampdu;
+  uint32_t next = 0;
+  found = 0;
+  std::chrono::steady_clock::duration lookup {0};
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t p = 0; p < ppdus; p++)
+    {
+      Mac48Address receiver = receivers[p % stations];
+      ampdu.clear ();
+      auto start = std::chrono::steady_clock::now ();
+      if (scan)
+        {
+          WifiMacQueue::ConstIterator it = queue->begin ();
+          Ptr<const WifiMacQueueItem> item;
+          while (ampdu.size () < mpdus && (item = ScanNext (queue, 0, receiver, it)) != nullptr)
+            {
+              ampdu.push_back (item);
+            }
+        }
+      else
+        {
+          Ptr<const WifiMacQueueItem> item = queue->PeekByTidAndAddress (0, receiver);
+          while (ampdu.size () < mpdus && item != nullptr)
+            {
+              ampdu.push_back (item);
+              item = queue->PeekByTidAndAddress (0, receiver, item);
+            }
+        }
+      lookup += std::chrono::steady_clock::now () - start;
+      found += ampdu.size ();
+      // new frames arrive for all the stations in turn
+      for (const auto& mpdu : ampdu)
+        {
+          queue->DequeueIfQueued (mpdu);
+          enqueue (receivers[next++ % stations]);
+        }
+    }
+  int64_t ms = time.End ();
+  lookupUs = std::chrono::duration<double, std::micro> (lookup).count ();
+  queue->Dispose ();
+  return ms;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t ppdus = 20000;
+  uint32_t mpdus = 64;
+  uint32_t depth = 64;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the A-MPDU lookups in the WifiMacQueue of a saturated AP.");
+  cmd.AddValue ("ppdus", "number of PPDUs for each number of stations", ppdus);
+  cmd.AddValue ("mpdus", "maximum number of MPDUs per PPDU", mpdus);
+  cmd.AddValue ("depth", "number of frames queued per station", depth);
+  cmd.Parse (argc, argv);
+
+  // the Time values created before the simulation starts are all recorded
+  Simulator::Run ();
+
+  const uint32_t stationCounts[] = {1, 10, 40, 100};
+  std::cout << std::setw (9) << "stations"
+            << std::setw (14) << "sublist us" << std::setw (14) << "scan us" << std::setw (10) << "speedup"
+            << std::setw (16) << "sublist ppdu/s" << std::setw (14) << "scan ppdu/s" << std::endl;
+  for (uint32_t stations : stationCounts)
+    {
+      uint64_t fast;
+      uint64_t slow;
+      double fastUs;
+      double slowUs;
+      const int64_t fastMs = std::max<int64_t> (Run (stations, depth, ppdus, mpdus, false, fast, fastUs), 1);
+      const int64_t slowMs = std::max<int64_t> (Run (stations, depth, ppdus, mpdus, true, slow, slowUs), 1);
+      if (fast != slow)
+        {
+          std::cerr << "lookup mismatch for " << stations << " stations" << std::endl;
+          return 1;
+        }
+      // the lookup time of an A-MPDU, then the PPDUs built per second,
+      // including the dequeue of the MPDUs and the enqueue of new ones
+      std::cout << std::setw (9) << stations
+                << std::setw (14) << std::fixed << std::setprecision (2) << fastUs / ppdus
+                << std::setw (14) << slowUs / ppdus
+                << std::setw (10) << std::setprecision (1) << slowUs / fastUs
+                << std::setw (16) << uint64_t (ppdus * 1000.0 / fastMs)
+                << std::setw (14) << uint64_t (ppdus * 1000.0 / slowMs)
+                << std::endl;
+    }
+  Simulator::Destroy ();
+  return 0;
+}